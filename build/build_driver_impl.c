@@ -9,9 +9,11 @@ enum supported_module_name {
     TP_MODULE,
     GAME_SERVER_MODULE,
     GAME_CLIENT_MODULE,
+    GAME_BOT_MODULE,
     GAME_MODULE,
     GFX_MODULE,
     G_MODELFORMAT_COMPILER_MODULE,
+    G_NETFORMAT_COMPILER_MODULE,
 
     _SUPPORTED_MODULE_NAME_SIZE
 };
@@ -36,10 +38,12 @@ static void supported_module__init_common_module(supported_module_t* self);
 static void supported_module__init_debug_module(supported_module_t* self);
 static void supported_module__init_game_server_module(supported_module_t* self);
 static void supported_module__init_game_client_module(supported_module_t* self);
+static void supported_module__init_game_bot_module(supported_module_t* self);
 static void supported_module__init_transport_protocol_module(supported_module_t* self);
 static void supported_module__init_game_module(supported_module_t* self);
 static void supported_module__init_gfx_module(supported_module_t* self);
 static void supported_module__init_g_modelformat_compiler_module(supported_module_t* self);
+static void supported_module__init_g_netformat_compiler_module(supported_module_t* self);
 
 static compiler_t c_compiler;
 static compiler_t cpp_compiler;
@@ -65,6 +69,10 @@ static supported_module_t supported_modules[_SUPPORTED_MODULE_NAME_SIZE] = {
         .dir = "game_client",
         .supported_module__init_and_compile = &supported_module__init_game_client_module
     },
+    {
+        .dir = "game_bot",
+        .supported_module__init_and_compile = &supported_module__init_game_bot_module
+    },
     {
         .dir = "game",
         .supported_module__init_and_compile = &supported_module__init_game_module
@@ -76,6 +84,10 @@ static supported_module_t supported_modules[_SUPPORTED_MODULE_NAME_SIZE] = {
     {
         .dir = "g_modelformat_compiler",
         .supported_module__init_and_compile = &supported_module__init_g_modelformat_compiler_module
+    },
+    {
+        .dir = "g_netformat_compiler",
+        .supported_module__init_and_compile = &supported_module__init_g_netformat_compiler_module
     }
 };
 
@@ -138,6 +150,35 @@ static void supported_module__init_common_module(supported_module_t* self) {
     module_file__add_common_cflags(thread_file);
     module_file__add_debug_cflags(thread_file);
 
+    module_file_t histogram_file = module__add_file(self->module, "histogram.c");
+
+    module_file__add_common_cflags(histogram_file);
+    module_file__add_debug_cflags(histogram_file);
+
+    module_file_t metrics_file = module__add_file(self->module, "metrics.c");
+
+    module_file__add_common_cflags(metrics_file);
+    module_file__add_debug_cflags(metrics_file);
+
+    module_file_t memory_file = module__add_file(self->module, "memory.c");
+
+    module_file__add_common_cflags(memory_file);
+    module_file__add_debug_cflags(memory_file);
+
+    module_file_t timer_wheel_file = module__add_file(self->module, "timer_wheel.c");
+
+    module_file__add_common_cflags(timer_wheel_file);
+    module_file__add_debug_cflags(timer_wheel_file);
+
+    module_file_t lz_file = module__add_file(self->module, "lz.c");
+
+    module_file__add_common_cflags(lz_file);
+    module_file__add_debug_cflags(lz_file);
+
+    module_file_t spsc_queue_file = module__add_file(self->module, "spsc_queue.c");
+
+    module_file__add_common_cflags(spsc_queue_file);
+    module_file__add_debug_cflags(spsc_queue_file);
 
     module__append_lflag(self->module, "-lm");
 
@@ -206,6 +247,23 @@ static void supported_module__init_game_client_module(supported_module_t* self)
     module__add_supported_dependency(self->module, GFX_MODULE);
 }
 
+static void supported_module__init_game_bot_module(supported_module_t* self) {
+    module_file_t game_bot_file = module__add_file(self->module, "game_bot.c");
+    module_file__add_common_cflags(game_bot_file);
+    module_file__add_debug_cflags(game_bot_file);
+
+    if (self->is_link_option) {
+        module_file_t game_bot_driver_file = module__add_file(self->module, "game_bot_driver.c");
+        module_file__add_common_cflags(game_bot_driver_file);
+        module_file__add_debug_cflags(game_bot_driver_file);
+    }
+
+    // note: no game or gfx, so it runs headless
+    module__add_supported_dependency(self->module, TP_MODULE);
+    module__add_supported_dependency(self->module, COMMON_MODULE);
+    module__add_supported_dependency(self->module, DEBUG_MODULE);
+}
+
 static void supported_module__init_transport_protocol_module(supported_module_t* self) {
     module_file_t tp_file = module__add_file(self->module, "tp.c");
 
@@ -217,6 +275,77 @@ static void supported_module__init_transport_protocol_module(supported_module_t*
     module_file__add_common_cflags(packet_file);
     module_file__add_debug_cflags(packet_file);
 
+    module_file_t packet_format_file = module__add_file(self->module, "packet_format.c");
+
+    module_file__add_common_cflags(packet_format_file);
+    module_file__add_debug_cflags(packet_format_file);
+
+    module_file_t event_loop_file = module__add_file(self->module, "event_loop.c");
+
+    module_file__add_common_cflags(event_loop_file);
+    module_file__add_debug_cflags(event_loop_file);
+
+    module_file_t frame_file = module__add_file(self->module, "frame.c");
+
+    module_file__add_common_cflags(frame_file);
+    module_file__add_debug_cflags(frame_file);
+
+    module_file_t channel_file = module__add_file(self->module, "channel.c");
+
+    module_file__add_common_cflags(channel_file);
+    module_file__add_debug_cflags(channel_file);
+
+    module_file_t ack_window_file = module__add_file(self->module, "ack_window.c");
+
+    module_file__add_common_cflags(ack_window_file);
+    module_file__add_debug_cflags(ack_window_file);
+
+    module_file_t send_rate_file = module__add_file(self->module, "send_rate.c");
+
+    module_file__add_common_cflags(send_rate_file);
+    module_file__add_debug_cflags(send_rate_file);
+
+    module_file_t link_conditioner_file = module__add_file(self->module, "link_conditioner.c");
+
+    module_file__add_common_cflags(link_conditioner_file);
+    module_file__add_debug_cflags(link_conditioner_file);
+
+    module_file_t packet_pool_file = module__add_file(self->module, "packet_pool.c");
+
+    module_file__add_common_cflags(packet_pool_file);
+    module_file__add_debug_cflags(packet_pool_file);
+
+    module_file_t tp_shm_file = module__add_file(self->module, "tp_shm.c");
+
+    module_file__add_common_cflags(tp_shm_file);
+    module_file__add_debug_cflags(tp_shm_file);
+
+    module_file_t prediction_file = module__add_file(self->module, "prediction.c");
+
+    module_file__add_common_cflags(prediction_file);
+    module_file__add_debug_cflags(prediction_file);
+
+    module_file_t snapshot_buffer_file = module__add_file(self->module, "snapshot_buffer.c");
+
+    module_file__add_common_cflags(snapshot_buffer_file);
+    module_file__add_debug_cflags(snapshot_buffer_file);
+
+    module_file_t priority_accumulator_file = module__add_file(self->module, "priority_accumulator.c");
+
+    module_file__add_common_cflags(priority_accumulator_file);
+    module_file__add_debug_cflags(priority_accumulator_file);
+
+    module_file_t interest_grid_file = module__add_file(self->module, "interest_grid.c");
+
+    module_file__add_common_cflags(interest_grid_file);
+    module_file__add_debug_cflags(interest_grid_file);
+
+    module_file_t tp_capture_file = module__add_file(self->module, "tp_capture.c");
+
+    module_file__add_common_cflags(tp_capture_file);
+    module_file__add_debug_cflags(tp_capture_file);
+
+    module__add_supported_dependency(self->module, COMMON_MODULE);
     module__add_supported_dependency(self->module, DEBUG_MODULE);
 }
 
@@ -283,6 +412,26 @@ static void supported_module__init_g_modelformat_compiler_module(supported_modul
     module__add_supported_dependency(self->module, COMMON_MODULE);
 }
 
+static void supported_module__init_g_netformat_compiler_module(supported_module_t* self) {
+    module_file_t compiler_file = module__add_file(self->module, "compiler.c");
+
+    module_file__add_common_cflags(compiler_file);
+    module_file__add_debug_cflags(compiler_file);
+
+    module_file_t scan_file = module__add_file(self->module, "scan.c");
+
+    module_file__add_common_cflags(scan_file);
+    module_file__add_debug_cflags(scan_file);
+
+    if (self->is_link_option) {
+        module_file_t driver_file = module__add_file(self->module, "driver.c");
+        module_file__add_common_cflags(driver_file);
+        module_file__add_debug_cflags(driver_file);
+    }
+
+    module__add_supported_dependency(self->module, COMMON_MODULE);
+}
+
 static void supported_module__init_and_compile_wrapper(supported_module_t* self) {
     if (module__is_compiled(self->module)) {
         return ;
@@ -0,0 +1,22 @@
+#ifndef DEBUG_MODULE_H
+# define DEBUG_MODULE_H
+
+/**
+ * @note Lives in common, so that common modules can tag resources with it without depending on the debug module
+*/
+typedef enum debug_module {
+    DEBUG_MODULE_APP,
+    DEBUG_MODULE_GFX,
+    DEBUG_MODULE_GL,
+    DEBUG_MODULE_VULKAN,
+    DEBUG_MODULE_GAME,
+    DEBUG_MODULE_GAME_SERVER,
+    DEBUG_MODULE_GAME_CLIENT,
+    DEBUG_MODULE_GAME_BOT,
+    DEBUG_MODULE_COMMON,
+    DEBUG_MODULE_TP,
+
+    _DEBUG_MODULE_SIZE
+} debug_module_t;
+
+#endif // DEBUG_MODULE_H
@@ -54,6 +54,9 @@ hash_map_key_t* hash_map__insert(hash_map_t* self, const hash_map_key_t* key, co
     if (_entry->type != HASH_MAP_ENTRY_TYPE_NON_EMPTY) {
         ++self->fill;
     }
+    if (_entry->type == HASH_MAP_ENTRY_TYPE_TOMBSTONE) {
+        --self->tombstones;
+    }
 
     hash_map_key_t* found_key = hash_map__internal_entry_to_key(_entry);
     hash_map_value_t* found_value = hash_map__internal_entry_to_value(self, _entry);
@@ -79,6 +82,7 @@ bool hash_map__remove(hash_map_t* self, const hash_map_key_t* key) {
 
     _entry->type = HASH_MAP_ENTRY_TYPE_TOMBSTONE;
     --self->fill;
+    ++self->tombstones;
 
     return true;
 }
@@ -91,8 +95,13 @@ uint32_t hash_map__capacity(hash_map_t* self) {
     return self->memory_size / _hash_map__entry_size(self);
 }
 
+uint32_t hash_map__tombstones(hash_map_t* self) {
+    return self->tombstones;
+}
+
 void hash_map__clear(hash_map_t* self) {
     self->fill = 0;
+    self->tombstones = 0;
     const uint32_t capacity = hash_map__capacity(self);
     for (uint32_t index = 0; index < capacity; ++index) {
         _hash_map_entry_t* _entry = hash_map__at(self, index);
@@ -160,5 +169,5 @@ hash_map_value_t* hash_map__value(hash_map_t* self, hash_map_key_t* key) {
 }
 
 hash_map_key_t* hash_map__key(hash_map_t* self, hash_map_value_t* value) {
-    return (hash_map_value_t*) ((char*) value - self->size_of_value);
+    return (hash_map_key_t*) ((char*) value - self->size_of_key);
 }
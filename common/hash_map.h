@@ -12,6 +12,7 @@ typedef struct hash_map {
     uint32_t            size_of_key;
     uint32_t            size_of_value;
     uint32_t            fill;
+    uint32_t            tombstones;
     uint32_t            (*hash_fn)(const hash_map_key_t*);
     bool                (*eq_fn)(const hash_map_key_t*, const hash_map_key_t*);
     void*               memory;
@@ -38,6 +39,11 @@ hash_map_value_t* hash_map__find(hash_map_t* self, const hash_map_key_t* key);
 
 uint32_t hash_map__size(hash_map_t* self);
 uint32_t hash_map__capacity(hash_map_t* self);
+/**
+ * @brief Number of entries that were removed but still lengthen probe sequences until the next clear
+ * @note Once this grows large, it's worth clearing and reinserting the live entries
+*/
+uint32_t hash_map__tombstones(hash_map_t* self);
 
 hash_map_key_t* hash_map__begin(hash_map_t* self);
 hash_map_key_t* hash_map__next(hash_map_t* self, hash_map_key_t* key);
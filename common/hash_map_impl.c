@@ -78,8 +78,8 @@ static _hash_map_entry_t* _hash_map__find(hash_map_t* self, const hash_map_key_t
         
         index = (index + 1) % capacity;
         if (index == start_index) {
-            // full
-            return NULL;
+            // note: no empty entry left, a tombstone can still be reused
+            return tombstone;
         }
     }
 
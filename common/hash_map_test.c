@@ -0,0 +1,103 @@
+#include "hash_map.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define CAPACITY 97
+#define KEYS     (2 * CAPACITY)
+
+// few buckets, so probe sequences are long and cross each other
+static uint32_t hash_fn__colliding(const hash_map_key_t* key) {
+    return *(const uint32_t*) key % 13;
+}
+
+static bool eq_fn__u32(const hash_map_key_t* key_a, const hash_map_key_t* key_b) {
+    return *(const uint32_t*) key_a == *(const uint32_t*) key_b;
+}
+
+int main() {
+    // entries are 16 bytes, so the values stay aligned
+    static uint64_t memory[2 * CAPACITY];
+    hash_map_t hash_map;
+    if (!hash_map__create(&hash_map, memory, sizeof(memory), sizeof(uint32_t), sizeof(uint64_t), &hash_fn__colliding, &eq_fn__u32)) {
+        printf("failed to create the hash map\n");
+        return 1;
+    }
+    printf("entry size: %u, capacity: %u\n", hash_map__entry_size(sizeof(uint32_t), sizeof(uint64_t)), hash_map__capacity(&hash_map));
+
+    // the model, keys are drawn from twice the capacity, so the map runs full and collects tombstones
+    bool     is_present[KEYS] = { 0 };
+    uint64_t values[KEYS];
+    uint32_t fill = 0;
+    uint32_t errors = 0;
+
+    srand(1);
+    for (uint32_t step = 0; step < 2000000; ++step) {
+        const uint32_t key = (uint32_t) rand() % KEYS;
+        const int action = rand() % 16;
+        if (action < 7) {
+            const uint64_t value = ((uint64_t) rand() << 32) | step;
+            const bool is_full = fill == CAPACITY && !is_present[key];
+            hash_map_key_t* inserted = hash_map__insert(&hash_map, &key, &value);
+            if (!inserted != is_full) {
+                printf("step %u, insert %u: %s\n", step, key, is_full ? "inserted into a full map" : "failed");
+                ++errors;
+            }
+            if (inserted && !is_present[key]) {
+                ++fill;
+            }
+            if (inserted) {
+                is_present[key] = true;
+                values[key]     = value;
+            }
+        } else if (action < 12) {
+            if (hash_map__remove(&hash_map, &key) != is_present[key]) {
+                printf("step %u, remove %u: expected %d\n", step, key, is_present[key]);
+                ++errors;
+            }
+            if (is_present[key]) {
+                --fill;
+            }
+            is_present[key] = false;
+        } else if (action < 15) {
+            uint64_t* value = hash_map__find(&hash_map, &key);
+            if (!value != !is_present[key] || (value && *value != values[key])) {
+                printf("step %u, find %u: expected %d\n", step, key, is_present[key]);
+                ++errors;
+            }
+        } else if (rand() % 1024 == 0) {
+            hash_map__clear(&hash_map);
+            for (uint32_t key_index = 0; key_index < KEYS; ++key_index) {
+                is_present[key_index] = false;
+            }
+            fill = 0;
+        }
+
+        if (step % 256 != 0) {
+            continue ;
+        }
+        // walks the whole map, every key and value once, and back from the value to the key
+        uint32_t keys_walked = 0;
+        for (hash_map_key_t* key_walked = hash_map__begin(&hash_map); key_walked != hash_map__end(&hash_map); key_walked = hash_map__next(&hash_map, key_walked)) {
+            const uint32_t key_value = *(uint32_t*) key_walked;
+            hash_map_value_t* value = hash_map__value(&hash_map, key_walked);
+            ++keys_walked;
+            if (
+                key_value >= KEYS || !is_present[key_value] ||
+                *(uint64_t*) value != values[key_value] || hash_map__key(&hash_map, value) != key_walked
+            ) {
+                printf("step %u, walked %u wrong\n", step, key_value);
+                ++errors;
+            }
+        }
+        if (keys_walked != fill || hash_map__size(&hash_map) != fill) {
+            printf("step %u, walked %u, size %u, expected %u\n", step, keys_walked, hash_map__size(&hash_map), fill);
+            ++errors;
+        }
+    }
+
+    printf("size: %u, tombstones: %u, errors: %u\n", fill, hash_map__tombstones(&hash_map), errors);
+
+    return errors == 0 ? 0 : 1;
+}
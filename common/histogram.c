@@ -0,0 +1,152 @@
+#include "histogram.h"
+
+#include <assert.h>
+#include <string.h>
+
+static uint32_t histogram__bucket_index(uint64_t value);
+static uint64_t histogram__bucket_highest_value(uint32_t bucket_index);
+
+static uint32_t histogram__bucket_index(uint64_t value) {
+    if (value < (1ULL << (HISTOGRAM_SUB_BUCKET_BITS + 1))) {
+        return (uint32_t) value;
+    }
+
+    const uint32_t msb_index = 63 - __builtin_clzll(value);
+    const uint32_t shift     = msb_index - HISTOGRAM_SUB_BUCKET_BITS;
+
+    return (shift << HISTOGRAM_SUB_BUCKET_BITS) + (uint32_t) (value >> shift);
+}
+
+static uint64_t histogram__bucket_highest_value(uint32_t bucket_index) {
+    if (bucket_index < (1U << (HISTOGRAM_SUB_BUCKET_BITS + 1))) {
+        return bucket_index;
+    }
+
+    const uint32_t shift       = (bucket_index >> HISTOGRAM_SUB_BUCKET_BITS) - 1;
+    const uint64_t lowest_value = (uint64_t) (bucket_index - (shift << HISTOGRAM_SUB_BUCKET_BITS)) << shift;
+
+    return lowest_value + (1ULL << shift) - 1;
+}
+
+void histogram__create(histogram_t* self) {
+    histogram__clear(self);
+}
+
+void histogram__clear(histogram_t* self) {
+    memset(self, 0, sizeof(*self));
+    self->min = (uint64_t) -1;
+}
+
+void histogram__record(histogram_t* self, uint64_t value) {
+    const uint64_t value_max = (1ULL << HISTOGRAM_VALUE_BITS) - 1;
+    if (value > value_max) {
+        value = value_max;
+    }
+
+    const uint32_t bucket_index = histogram__bucket_index(value);
+    assert(bucket_index < HISTOGRAM_BUCKETS_SIZE);
+    ++self->buckets[bucket_index];
+
+    ++self->count;
+    self->sum += value;
+    if (value < self->min) {
+        self->min = value;
+    }
+    if (value > self->max) {
+        self->max = value;
+    }
+}
+
+void histogram__record_atomic(histogram_t* self, uint64_t value) {
+    const uint64_t value_max = (1ULL << HISTOGRAM_VALUE_BITS) - 1;
+    if (value > value_max) {
+        value = value_max;
+    }
+
+    const uint32_t bucket_index = histogram__bucket_index(value);
+    assert(bucket_index < HISTOGRAM_BUCKETS_SIZE);
+
+    // note: single writer, so a relaxed load + store is enough and avoids locked instructions
+    __atomic_store_n(&self->buckets[bucket_index], __atomic_load_n(&self->buckets[bucket_index], __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&self->sum, __atomic_load_n(&self->sum, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+    if (value < __atomic_load_n(&self->min, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&self->min, value, __ATOMIC_RELAXED);
+    }
+    if (value > __atomic_load_n(&self->max, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&self->max, value, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&self->count, __atomic_load_n(&self->count, __ATOMIC_RELAXED) + 1, __ATOMIC_RELEASE);
+}
+
+void histogram__load(histogram_t* self, const histogram_t* src) {
+    self->count = __atomic_load_n(&src->count, __ATOMIC_ACQUIRE);
+    self->sum   = __atomic_load_n(&src->sum, __ATOMIC_RELAXED);
+    self->min   = __atomic_load_n(&src->min, __ATOMIC_RELAXED);
+    self->max   = __atomic_load_n(&src->max, __ATOMIC_RELAXED);
+    for (uint32_t bucket_index = 0; bucket_index < HISTOGRAM_BUCKETS_SIZE; ++bucket_index) {
+        self->buckets[bucket_index] = __atomic_load_n(&src->buckets[bucket_index], __ATOMIC_RELAXED);
+    }
+}
+
+void histogram__record_time(histogram_t* self, double s) {
+    histogram__record(self, s > 0.0 ? (uint64_t) (s * 1000000000.0) : 0);
+}
+
+void histogram__merge(histogram_t* self, const histogram_t* other) {
+    for (uint32_t bucket_index = 0; bucket_index < HISTOGRAM_BUCKETS_SIZE; ++bucket_index) {
+        self->buckets[bucket_index] += other->buckets[bucket_index];
+    }
+
+    self->count += other->count;
+    self->sum   += other->sum;
+    if (other->min < self->min) {
+        self->min = other->min;
+    }
+    if (other->max > self->max) {
+        self->max = other->max;
+    }
+}
+
+uint64_t histogram__percentile(const histogram_t* self, double percentile) {
+    if (self->count == 0) {
+        return 0;
+    }
+
+    if (percentile < 0.0) {
+        percentile = 0.0;
+    } else if (percentile > 100.0) {
+        percentile = 100.0;
+    }
+
+    uint64_t count_to_reach = (uint64_t) (percentile / 100.0 * self->count + 0.5);
+    if (count_to_reach == 0) {
+        count_to_reach = 1;
+    }
+
+    uint64_t count_so_far = 0;
+    for (uint32_t bucket_index = 0; bucket_index < HISTOGRAM_BUCKETS_SIZE; ++bucket_index) {
+        count_so_far += self->buckets[bucket_index];
+        if (count_so_far >= count_to_reach) {
+            const uint64_t result = histogram__bucket_highest_value(bucket_index);
+            return result < self->max ? result : self->max;
+        }
+    }
+
+    return self->max;
+}
+
+uint64_t histogram__count(const histogram_t* self) {
+    return self->count;
+}
+
+uint64_t histogram__min(const histogram_t* self) {
+    return self->count == 0 ? 0 : self->min;
+}
+
+uint64_t histogram__max(const histogram_t* self) {
+    return self->max;
+}
+
+double histogram__mean(const histogram_t* self) {
+    return self->count == 0 ? 0.0 : (double) self->sum / (double) self->count;
+}
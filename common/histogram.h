@@ -0,0 +1,56 @@
+#ifndef HISTOGRAM_H
+# define HISTOGRAM_H
+
+# include <stdint.h>
+
+# include "helper_macros.h"
+
+/**
+ * Log-linear histogram: values below 2^(HISTOGRAM_SUB_BUCKET_BITS + 1) are stored exactly,
+ * above that every power of two is split into 2^HISTOGRAM_SUB_BUCKET_BITS linear sub-buckets,
+ * so the relative error of a reported value is at most 1 / 2^HISTOGRAM_SUB_BUCKET_BITS
+*/
+# define HISTOGRAM_SUB_BUCKET_BITS 5
+// values at or above 2^HISTOGRAM_VALUE_BITS are clamped into the last bucket
+# define HISTOGRAM_VALUE_BITS      40
+# define HISTOGRAM_BUCKETS_SIZE    ((HISTOGRAM_VALUE_BITS - HISTOGRAM_SUB_BUCKET_BITS + 1) << HISTOGRAM_SUB_BUCKET_BITS)
+
+struct         histogram;
+typedef struct histogram histogram_t;
+
+struct histogram {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+    uint64_t buckets[HISTOGRAM_BUCKETS_SIZE];
+};
+
+PUBLIC_API void histogram__create(histogram_t* self);
+PUBLIC_API void histogram__clear(histogram_t* self);
+
+//! @note O(1), doesn't allocate
+PUBLIC_API void histogram__record(histogram_t* self, uint64_t value);
+//! @brief Records time in seconds with nanosecond resolution
+PUBLIC_API void histogram__record_time(histogram_t* self, double s);
+PUBLIC_API void histogram__merge(histogram_t* self, const histogram_t* other);
+
+/**
+ * @brief Same as histogram__record, but safe to be read concurrently with histogram__load
+ * @note Single writer only
+*/
+PUBLIC_API void histogram__record_atomic(histogram_t* self, uint64_t value);
+//! @brief Copies a histogram that is being written by histogram__record_atomic from another thread
+PUBLIC_API void histogram__load(histogram_t* self, const histogram_t* src);
+
+/**
+ * @param percentile [0, 100]
+ * @returns The highest value that is equivalent to the bucket the percentile falls into, never more than the recorded max
+*/
+PUBLIC_API uint64_t histogram__percentile(const histogram_t* self, double percentile);
+PUBLIC_API uint64_t histogram__count(const histogram_t* self);
+PUBLIC_API uint64_t histogram__min(const histogram_t* self);
+PUBLIC_API uint64_t histogram__max(const histogram_t* self);
+PUBLIC_API double histogram__mean(const histogram_t* self);
+
+#endif // HISTOGRAM_H
@@ -0,0 +1,577 @@
+#include "lz.h"
+
+#include "memory.h"
+
+#include <string.h>
+
+//! @note A position is tried again 1 + (literals since the last match >> LZ_SKIP_SHIFT) bytes later, so input that doesn't compress is skimmed
+# define LZ_SKIP_SHIFT                6
+# define LZ_LENGTH_NIBBLE_MAX         15
+# define LZ_WINDOW_CAPACITY           (LZ_WINDOW_SIZE + LZ_BLOCK_SIZE_MAX)
+# define LZ_ONE_SHOT_HASH_BITS_MIN    8
+//! @note Short copies are done in steps of this many bytes when there is room past them, instead of exactly
+# define LZ_WILD_COPY_SIZE            16
+
+/**
+ * Training scores segments of the samples by how many samples each of their k-mers appears in
+ * k-mers that appear in a single sample score nothing, the dictionary is there for what the inputs have in common
+*/
+# define LZ_TRAIN_KMER_SIZE           8
+# define LZ_TRAIN_HASH_BITS           20
+# define LZ_TRAIN_SEGMENT_SIZE        64
+# define LZ_TRAIN_SEGMENT_STRIDE      16
+
+typedef struct lz_train_segment {
+    uint64_t score;
+    uint32_t offset;
+    uint32_t size;
+} lz_train_segment_t;
+
+static uint32_t lz__read32(const uint8_t* p);
+static uint64_t lz__read64(const uint8_t* p);
+static uint32_t lz__hash(uint32_t sequence, uint32_t hash_bits);
+//! @returns Number of equal bytes at the start of 'a' and 'b', at most 'size_max'
+static uint32_t lz__count_equal(const uint8_t* a, const uint8_t* b, uint32_t size_max);
+static bool lz__write_length(uint8_t** cur, const uint8_t* end, uint32_t length);
+static bool lz__read_length(const uint8_t** cur, const uint8_t* end, uint32_t* length);
+//! @param match_size 0 for the last sequence of the block
+static bool lz__write_sequence(uint8_t** cur, const uint8_t* end, const uint8_t* literals, uint32_t literals_size, uint32_t offset, uint32_t match_size);
+//! @note 'distance' may be less than 'size', the bytes copied are then repeated
+static void lz__copy_match(uint8_t* dst, const uint8_t* src, uint32_t size, uint32_t distance);
+//! @note Writes up to LZ_WILD_COPY_SIZE - 1 bytes past 'size', 'src' must be at least LZ_WILD_COPY_SIZE behind 'dst' if they overlap
+static void lz__wild_copy(uint8_t* dst, const uint8_t* src, uint32_t size);
+
+/**
+ * @param window holds the stream from position 'window_start' up to 'block_end'
+ * @param hash_table stream positions, entries before 'window_start' are ignored
+*/
+static bool lz__compress_block(
+    const uint8_t* window, uint32_t window_start, uint32_t block_start, uint32_t block_end,
+    uint32_t* hash_table, uint32_t hash_bits, const lz_dictionary_t* dictionary,
+    uint8_t* dst, uint32_t dst_size, uint32_t* bytes_written
+);
+//! @param history start of the stream kept before 'dst', matches can reach back to it
+static bool lz__decompress_block(
+    const uint8_t* src, uint32_t src_size,
+    const uint8_t* history, uint8_t* dst, const uint8_t* dst_end, const lz_dictionary_t* dictionary,
+    uint32_t* bytes_written
+);
+
+static uint64_t lz_train__kmer_hash(const uint8_t* p);
+static uint64_t lz_train__score(const uint8_t* segment, uint32_t segment_size, const uint32_t* kmer_counts);
+static void lz_train__heap_push(lz_train_segment_t* heap, uint32_t* heap_fill, lz_train_segment_t segment);
+static lz_train_segment_t lz_train__heap_pop(lz_train_segment_t* heap, uint32_t* heap_fill);
+
+static uint32_t lz__read32(const uint8_t* p) {
+    uint32_t result;
+    memcpy(&result, p, sizeof(result));
+
+    return result;
+}
+
+static uint64_t lz__read64(const uint8_t* p) {
+    uint64_t result;
+    memcpy(&result, p, sizeof(result));
+
+    return result;
+}
+
+static uint32_t lz__hash(uint32_t sequence, uint32_t hash_bits) {
+    return (sequence * 2654435761u) >> (32 - hash_bits);
+}
+
+static uint32_t lz__count_equal(const uint8_t* a, const uint8_t* b, uint32_t size_max) {
+    uint32_t result = 0;
+    while (size_max - result >= 8) {
+        const uint64_t diff = lz__read64(a + result) ^ lz__read64(b + result);
+        if (diff) {
+            return result + (__builtin_ctzll(diff) >> 3);
+        }
+        result += 8;
+    }
+    while (result < size_max && a[result] == b[result]) {
+        ++result;
+    }
+
+    return result;
+}
+
+static bool lz__write_length(uint8_t** cur, const uint8_t* end, uint32_t length) {
+    // note: the nibble in the token holds LZ_LENGTH_NIBBLE_MAX of it
+    length -= LZ_LENGTH_NIBBLE_MAX;
+    while (length >= 255) {
+        if (*cur == end) {
+            return false;
+        }
+        *(*cur)++ = 255;
+        length -= 255;
+    }
+    if (*cur == end) {
+        return false;
+    }
+    *(*cur)++ = (uint8_t) length;
+
+    return true;
+}
+
+static bool lz__read_length(const uint8_t** cur, const uint8_t* end, uint32_t* length) {
+    uint8_t byte = 255;
+    while (byte == 255) {
+        if (*cur == end || *length > UINT32_MAX - 255) {
+            return false;
+        }
+        byte = *(*cur)++;
+        *length += byte;
+    }
+
+    return true;
+}
+
+static bool lz__write_sequence(uint8_t** cur, const uint8_t* end, const uint8_t* literals, uint32_t literals_size, uint32_t offset, uint32_t match_size) {
+    if (*cur == end) {
+        return false;
+    }
+    const uint32_t match_nibble = match_size == 0 ? 0 : match_size - LZ_MATCH_SIZE_MIN;
+    uint8_t* token = (*cur)++;
+    *token = (uint8_t) (
+        ((literals_size < LZ_LENGTH_NIBBLE_MAX ? literals_size : LZ_LENGTH_NIBBLE_MAX) << 4) |
+        (match_nibble < LZ_LENGTH_NIBBLE_MAX ? match_nibble : LZ_LENGTH_NIBBLE_MAX)
+    );
+    if (literals_size >= LZ_LENGTH_NIBBLE_MAX && !lz__write_length(cur, end, literals_size)) {
+        return false;
+    }
+    if ((uint64_t) (end - *cur) < literals_size) {
+        return false;
+    }
+    memcpy(*cur, literals, literals_size);
+    *cur += literals_size;
+    if (match_size == 0) {
+        return true;
+    }
+
+    if (end - *cur < 2) {
+        return false;
+    }
+    *(*cur)++ = (uint8_t) offset;
+    *(*cur)++ = (uint8_t) (offset >> 8);
+    if (match_nibble >= LZ_LENGTH_NIBBLE_MAX && !lz__write_length(cur, end, match_nibble)) {
+        return false;
+    }
+
+    return true;
+}
+
+static void lz__copy_match(uint8_t* dst, const uint8_t* src, uint32_t size, uint32_t distance) {
+    if (distance >= size) {
+        memcpy(dst, src, size);
+        return ;
+    }
+
+    uint32_t copied = 0;
+    if (distance >= 8) {
+        for (; size - copied >= 8; copied += 8) {
+            memcpy(dst + copied, src + copied, 8);
+        }
+    }
+    for (; copied < size; ++copied) {
+        dst[copied] = src[copied];
+    }
+}
+
+static void lz__wild_copy(uint8_t* dst, const uint8_t* src, uint32_t size) {
+    uint32_t copied = 0;
+    do {
+        memcpy(dst + copied, src + copied, LZ_WILD_COPY_SIZE);
+        copied += LZ_WILD_COPY_SIZE;
+    } while (copied < size);
+}
+
+static bool lz__compress_block(
+    const uint8_t* window, uint32_t window_start, uint32_t block_start, uint32_t block_end,
+    uint32_t* hash_table, uint32_t hash_bits, const lz_dictionary_t* dictionary,
+    uint8_t* dst, uint32_t dst_size, uint32_t* bytes_written
+) {
+    uint8_t* cur = dst;
+    const uint8_t* end = dst + dst_size;
+    const uint8_t* block_end_p = window + (block_end - window_start);
+    uint32_t anchor = block_start;
+    uint32_t position = block_start;
+    // note: the last LZ_MATCH_SIZE_MIN - 1 bytes can't start a match, they end up in the last literals
+    while ((uint64_t) position + LZ_MATCH_SIZE_MIN <= block_end) {
+        const uint8_t* p = window + (position - window_start);
+        const uint32_t sequence = lz__read32(p);
+        uint32_t* hash_entry = &hash_table[lz__hash(sequence, hash_bits)];
+        const uint32_t candidate = *hash_entry;
+        *hash_entry = position;
+
+        uint32_t offset = 0;
+        uint32_t match_size = 0;
+        if (
+            candidate >= window_start && candidate < position && position - candidate <= LZ_WINDOW_SIZE &&
+            lz__read32(window + (candidate - window_start)) == sequence
+        ) {
+            offset = position - candidate;
+            match_size = LZ_MATCH_SIZE_MIN + lz__count_equal(
+                window + (candidate - window_start) + LZ_MATCH_SIZE_MIN, p + LZ_MATCH_SIZE_MIN,
+                (uint32_t) (block_end_p - p) - LZ_MATCH_SIZE_MIN
+            );
+        } else if (dictionary && position < LZ_WINDOW_SIZE) {
+            const uint32_t dictionary_candidate = dictionary->hash_table[lz__hash(sequence, LZ_DICTIONARY_HASH_BITS)];
+            const uint32_t dictionary_offset = position + dictionary->size - dictionary_candidate;
+            if (
+                dictionary_candidate + LZ_MATCH_SIZE_MIN <= dictionary->size && dictionary_offset <= LZ_WINDOW_SIZE &&
+                lz__read32(dictionary->data + dictionary_candidate) == sequence
+            ) {
+                // note: stops at the end of the dictionary, even though the decoder could carry on into the stream
+                const uint32_t dictionary_left = dictionary->size - dictionary_candidate - LZ_MATCH_SIZE_MIN;
+                const uint32_t block_left = (uint32_t) (block_end_p - p) - LZ_MATCH_SIZE_MIN;
+                offset = dictionary_offset;
+                match_size = LZ_MATCH_SIZE_MIN + lz__count_equal(
+                    dictionary->data + dictionary_candidate + LZ_MATCH_SIZE_MIN, p + LZ_MATCH_SIZE_MIN,
+                    dictionary_left < block_left ? dictionary_left : block_left
+                );
+            }
+        }
+
+        if (match_size == 0) {
+            position += 1 + ((position - anchor) >> LZ_SKIP_SHIFT);
+            continue ;
+        }
+
+        if (!lz__write_sequence(&cur, end, window + (anchor - window_start), position - anchor, offset, match_size)) {
+            return false;
+        }
+        position += match_size;
+        anchor = position;
+        // note: indexes a position inside the match too, the next match often starts near its end
+        if (block_end - position >= 2) {
+            const uint32_t inside_position = position - 2;
+            hash_table[lz__hash(lz__read32(window + (inside_position - window_start)), hash_bits)] = inside_position;
+        }
+    }
+
+    if (!lz__write_sequence(&cur, end, window + (anchor - window_start), block_end - anchor, 0, 0)) {
+        return false;
+    }
+    *bytes_written = (uint32_t) (cur - dst);
+
+    return true;
+}
+
+static bool lz__decompress_block(
+    const uint8_t* src, uint32_t src_size,
+    const uint8_t* history, uint8_t* dst, const uint8_t* dst_end, const lz_dictionary_t* dictionary,
+    uint32_t* bytes_written
+) {
+    const uint8_t* cur = src;
+    const uint8_t* end = src + src_size;
+    uint8_t* out = dst;
+    while (true) {
+        if (cur == end) {
+            return false;
+        }
+        const uint8_t token = *cur++;
+
+        uint32_t literals_size = token >> 4;
+        if (literals_size == LZ_LENGTH_NIBBLE_MAX && !lz__read_length(&cur, end, &literals_size)) {
+            return false;
+        }
+        if ((uint64_t) (end - cur) >= (uint64_t) literals_size + LZ_WILD_COPY_SIZE && (uint64_t) (dst_end - out) >= (uint64_t) literals_size + LZ_WILD_COPY_SIZE) {
+            lz__wild_copy(out, cur, literals_size);
+        } else if ((uint64_t) (end - cur) < literals_size || (uint64_t) (dst_end - out) < literals_size) {
+            return false;
+        } else {
+            memcpy(out, cur, literals_size);
+        }
+        cur += literals_size;
+        out += literals_size;
+        if (cur == end) {
+            break ;
+        }
+
+        if (end - cur < 2) {
+            return false;
+        }
+        const uint32_t offset = (uint32_t) cur[0] | ((uint32_t) cur[1] << 8);
+        cur += 2;
+        uint32_t match_size = token & LZ_LENGTH_NIBBLE_MAX;
+        if (match_size == LZ_LENGTH_NIBBLE_MAX && !lz__read_length(&cur, end, &match_size)) {
+            return false;
+        }
+        match_size += LZ_MATCH_SIZE_MIN;
+        if (offset == 0 || (uint64_t) (dst_end - out) < match_size) {
+            return false;
+        }
+
+        const uint32_t history_size = (uint32_t) (out - history);
+        if (offset <= history_size) {
+            if (offset >= LZ_WILD_COPY_SIZE && (uint64_t) (dst_end - out) >= (uint64_t) match_size + LZ_WILD_COPY_SIZE) {
+                lz__wild_copy(out, out - offset, match_size);
+            } else {
+                lz__copy_match(out, out - offset, match_size, offset);
+            }
+        } else {
+            const uint32_t dictionary_back = offset - history_size;
+            if (!dictionary || dictionary_back > dictionary->size) {
+                return false;
+            }
+            const uint32_t dictionary_copied = match_size < dictionary_back ? match_size : dictionary_back;
+            memcpy(out, dictionary->data + dictionary->size - dictionary_back, dictionary_copied);
+            // note: a match that runs off the end of the dictionary carries on from the start of the stream
+            lz__copy_match(out + dictionary_copied, history, match_size - dictionary_copied, history_size + dictionary_copied);
+        }
+        out += match_size;
+    }
+    *bytes_written = (uint32_t) (out - dst);
+
+    return true;
+}
+
+bool lz_dictionary__create(lz_dictionary_t* self, const void* data, uint32_t size) {
+    if (size > LZ_DICTIONARY_SIZE_MAX) {
+        return false;
+    }
+
+    memset(self, 0, sizeof(*self));
+    self->data = memory__malloc(DEBUG_MODULE_COMMON, size ? size : 1);
+    if (!self->data) {
+        return false;
+    }
+    memcpy(self->data, data, size);
+    self->size = size;
+    // note: later positions overwrite earlier ones, the closer to the end, the smaller the offset
+    for (uint32_t position = 0; position + LZ_MATCH_SIZE_MIN <= size; ++position) {
+        self->hash_table[lz__hash(lz__read32(self->data + position), LZ_DICTIONARY_HASH_BITS)] = position;
+    }
+
+    return true;
+}
+
+void lz_dictionary__destroy(lz_dictionary_t* self) {
+    memory__free(DEBUG_MODULE_COMMON, self->data);
+    self->data = 0;
+    self->size = 0;
+}
+
+static uint64_t lz_train__kmer_hash(const uint8_t* p) {
+    return (lz__read64(p) * 0x9e3779b97f4a7c15ull) >> (64 - LZ_TRAIN_HASH_BITS);
+}
+
+static uint64_t lz_train__score(const uint8_t* segment, uint32_t segment_size, const uint32_t* kmer_counts) {
+    uint64_t result = 0;
+    for (uint32_t offset = 0; offset + LZ_TRAIN_KMER_SIZE <= segment_size; ++offset) {
+        const uint32_t kmer_count = kmer_counts[lz_train__kmer_hash(segment + offset)];
+        if (kmer_count > 1) {
+            result += kmer_count;
+        }
+    }
+
+    return result;
+}
+
+static void lz_train__heap_push(lz_train_segment_t* heap, uint32_t* heap_fill, lz_train_segment_t segment) {
+    uint32_t index = (*heap_fill)++;
+    while (index > 0) {
+        const uint32_t parent = (index - 1) / 2;
+        if (heap[parent].score >= segment.score) {
+            break ;
+        }
+        heap[index] = heap[parent];
+        index = parent;
+    }
+    heap[index] = segment;
+}
+
+static lz_train_segment_t lz_train__heap_pop(lz_train_segment_t* heap, uint32_t* heap_fill) {
+    const lz_train_segment_t result = heap[0];
+    const lz_train_segment_t last = heap[--*heap_fill];
+    uint32_t index = 0;
+    while (true) {
+        uint32_t child = 2 * index + 1;
+        if (child >= *heap_fill) {
+            break ;
+        }
+        if (child + 1 < *heap_fill && heap[child + 1].score > heap[child].score) {
+            ++child;
+        }
+        if (heap[child].score <= last.score) {
+            break ;
+        }
+        heap[index] = heap[child];
+        index = child;
+    }
+    if (*heap_fill > 0) {
+        heap[index] = last;
+    }
+
+    return result;
+}
+
+uint32_t lz_dictionary__train(
+    const void* samples, const uint32_t* sample_sizes, uint32_t samples_size,
+    void* dictionary, uint32_t dictionary_size
+) {
+    const uint8_t* samples_data = samples;
+    uint8_t* dictionary_data = dictionary;
+    uint64_t samples_data_size = 0;
+    for (uint32_t sample_index = 0; sample_index < samples_size; ++sample_index) {
+        samples_data_size += sample_sizes[sample_index];
+    }
+    if (samples_data_size > UINT32_MAX) {
+        return 0;
+    }
+
+    uint32_t* kmer_counts = memory__calloc(DEBUG_MODULE_COMMON, 1 << LZ_TRAIN_HASH_BITS, sizeof(*kmer_counts));
+    uint32_t* kmer_last_sample = memory__calloc(DEBUG_MODULE_COMMON, 1 << LZ_TRAIN_HASH_BITS, sizeof(*kmer_last_sample));
+    const uint32_t heap_size = (uint32_t) (samples_data_size / LZ_TRAIN_SEGMENT_STRIDE + samples_size);
+    lz_train_segment_t* heap = memory__malloc(DEBUG_MODULE_COMMON, (heap_size ? heap_size : 1) * sizeof(*heap));
+    uint32_t result = 0;
+    if (!kmer_counts || !kmer_last_sample || !heap) {
+        goto end;
+    }
+
+    // note: a k-mer counts once per sample it appears in
+    uint32_t sample_offset = 0;
+    for (uint32_t sample_index = 0; sample_index < samples_size; ++sample_index) {
+        const uint8_t* sample = samples_data + sample_offset;
+        for (uint32_t offset = 0; offset + LZ_TRAIN_KMER_SIZE <= sample_sizes[sample_index]; ++offset) {
+            const uint64_t kmer_hash = lz_train__kmer_hash(sample + offset);
+            if (kmer_last_sample[kmer_hash] != sample_index + 1) {
+                kmer_last_sample[kmer_hash] = sample_index + 1;
+                ++kmer_counts[kmer_hash];
+            }
+        }
+        sample_offset += sample_sizes[sample_index];
+    }
+
+    uint32_t heap_fill = 0;
+    sample_offset = 0;
+    for (uint32_t sample_index = 0; sample_index < samples_size; ++sample_index) {
+        const uint32_t sample_size = sample_sizes[sample_index];
+        for (uint32_t offset = 0; offset + LZ_TRAIN_KMER_SIZE <= sample_size; offset += LZ_TRAIN_SEGMENT_STRIDE) {
+            lz_train_segment_t segment;
+            segment.offset = sample_offset + offset;
+            segment.size   = sample_size - offset < LZ_TRAIN_SEGMENT_SIZE ? sample_size - offset : LZ_TRAIN_SEGMENT_SIZE;
+            segment.score  = lz_train__score(samples_data + segment.offset, segment.size, kmer_counts);
+            if (segment.score > 0) {
+                lz_train__heap_push(heap, &heap_fill, segment);
+            }
+        }
+        sample_offset += sample_size;
+    }
+
+    // note: lazy greedy, scores only go down as segments are picked, so the top one is rescored and picked if it's still the best
+    // the dictionary fills from its end, the best segments are the cheapest to refer to
+    while (heap_fill > 0 && result < dictionary_size) {
+        lz_train_segment_t segment = lz_train__heap_pop(heap, &heap_fill);
+        segment.score = lz_train__score(samples_data + segment.offset, segment.size, kmer_counts);
+        if (segment.score == 0) {
+            continue ;
+        }
+        if (heap_fill > 0 && segment.score < heap[0].score) {
+            lz_train__heap_push(heap, &heap_fill, segment);
+            continue ;
+        }
+
+        const uint32_t segment_size = dictionary_size - result < segment.size ? dictionary_size - result : segment.size;
+        result += segment_size;
+        memcpy(dictionary_data + dictionary_size - result, samples_data + segment.offset, segment_size);
+        for (uint32_t offset = 0; offset + LZ_TRAIN_KMER_SIZE <= segment.size; ++offset) {
+            kmer_counts[lz_train__kmer_hash(samples_data + segment.offset + offset)] = 0;
+        }
+    }
+    if (result < dictionary_size) {
+        memmove(dictionary_data, dictionary_data + dictionary_size - result, result);
+    }
+
+end:
+    memory__free(DEBUG_MODULE_COMMON, heap);
+    memory__free(DEBUG_MODULE_COMMON, kmer_last_sample);
+    memory__free(DEBUG_MODULE_COMMON, kmer_counts);
+
+    return result;
+}
+
+bool lz_encoder__create(lz_encoder_t* self, const lz_dictionary_t* dictionary) {
+    memset(self, 0, sizeof(*self));
+    self->dictionary = dictionary;
+    self->window = memory__malloc(DEBUG_MODULE_COMMON, LZ_WINDOW_CAPACITY);
+
+    return self->window != 0;
+}
+
+void lz_encoder__destroy(lz_encoder_t* self) {
+    memory__free(DEBUG_MODULE_COMMON, self->window);
+    self->window = 0;
+}
+
+bool lz_encoder__compress(lz_encoder_t* self, const void* src, uint32_t src_size, void* dst, uint32_t dst_size, uint32_t* bytes_written) {
+    if (src_size > LZ_BLOCK_SIZE_MAX) {
+        return false;
+    }
+
+    if (self->window_fill + src_size > LZ_WINDOW_CAPACITY) {
+        const uint32_t window_shift = self->window_fill - LZ_WINDOW_SIZE;
+        memmove(self->window, self->window + window_shift, LZ_WINDOW_SIZE);
+        self->window_start += window_shift;
+        self->window_fill = LZ_WINDOW_SIZE;
+    }
+    memcpy(self->window + self->window_fill, src, src_size);
+    const uint32_t block_start = self->window_start + self->window_fill;
+    self->window_fill += src_size;
+
+    return lz__compress_block(
+        self->window, self->window_start, block_start, block_start + src_size,
+        self->hash_table, LZ_HASH_BITS, self->dictionary,
+        dst, dst_size, bytes_written
+    );
+}
+
+bool lz_decoder__create(lz_decoder_t* self, const lz_dictionary_t* dictionary) {
+    memset(self, 0, sizeof(*self));
+    self->dictionary = dictionary;
+    self->window = memory__malloc(DEBUG_MODULE_COMMON, LZ_WINDOW_CAPACITY);
+
+    return self->window != 0;
+}
+
+void lz_decoder__destroy(lz_decoder_t* self) {
+    memory__free(DEBUG_MODULE_COMMON, self->window);
+    self->window = 0;
+}
+
+bool lz_decoder__decompress(lz_decoder_t* self, const void* src, uint32_t src_size, void* dst, uint32_t dst_size, uint32_t* bytes_written) {
+    // note: the same as the encoder, it only slides once the stream is past the reach of the dictionary
+    if (self->window_fill + LZ_BLOCK_SIZE_MAX > LZ_WINDOW_CAPACITY) {
+        memmove(self->window, self->window + self->window_fill - LZ_WINDOW_SIZE, LZ_WINDOW_SIZE);
+        self->window_fill = LZ_WINDOW_SIZE;
+    }
+
+    uint8_t* block = self->window + self->window_fill;
+    const uint32_t block_size_max = dst_size < LZ_BLOCK_SIZE_MAX ? dst_size : LZ_BLOCK_SIZE_MAX;
+    uint32_t block_size = 0;
+    if (!lz__decompress_block(src, src_size, self->window, block, block + block_size_max, self->dictionary, &block_size)) {
+        return false;
+    }
+    memcpy(dst, block, block_size);
+    self->window_fill += block_size;
+    *bytes_written = block_size;
+
+    return true;
+}
+
+bool lz__compress(const void* src, uint32_t src_size, void* dst, uint32_t dst_size, const lz_dictionary_t* dictionary, uint32_t* bytes_written) {
+    // note: small inputs only clear as much of the table as they can fill
+    uint32_t hash_bits = LZ_ONE_SHOT_HASH_BITS_MIN;
+    while (hash_bits < LZ_HASH_BITS && (1u << hash_bits) < src_size) {
+        ++hash_bits;
+    }
+    uint32_t hash_table[1 << LZ_HASH_BITS];
+    memset(hash_table, 0, sizeof(hash_table[0]) << hash_bits);
+
+    return lz__compress_block(src, 0, 0, src_size, hash_table, hash_bits, dictionary, dst, dst_size, bytes_written);
+}
+
+bool lz__decompress(const void* src, uint32_t src_size, void* dst, uint32_t dst_size, const lz_dictionary_t* dictionary, uint32_t* bytes_written) {
+    return lz__decompress_block(src, src_size, dst, dst, (uint8_t*) dst + dst_size, dictionary, bytes_written);
+}
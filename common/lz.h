@@ -0,0 +1,108 @@
+#ifndef LZ_H
+# define LZ_H
+
+# include <stdint.h>
+# include <stdbool.h>
+
+# include "helper_macros.h"
+
+struct         lz_dictionary;
+struct         lz_encoder;
+struct         lz_decoder;
+typedef struct lz_dictionary lz_dictionary_t;
+typedef struct lz_encoder    lz_encoder_t;
+typedef struct lz_decoder    lz_decoder_t;
+
+/**
+ * Byte oriented LZ77 compression, tuned for decompression speed and for inputs as small as a datagram
+ * A block is a list of sequences, each one is:
+ *   uint8_t token, bits 4-7: number of literals, bits 0-3: match length - LZ_MATCH_SIZE_MIN, 15 means length bytes follow
+ *   the length bytes of the literals, each one is added to the length, 255 means another one follows
+ *   the literals
+ *   uint16_t offset of the match, little endian, how far back from the current position it starts
+ *   the length bytes of the match
+ * The last sequence of a block has literals only, the block ends after them
+ *
+ * Matches reach back at most LZ_WINDOW_SIZE bytes, into the earlier blocks of the stream, and past the start of the stream
+ * into the end of the dictionary, as if the dictionary preceded the stream
+ * Inputs that are too small to compress on their own, like datagrams, are compressed one by one against a dictionary
+ * trained from samples of them, see lz_dictionary__train
+*/
+# define LZ_MATCH_SIZE_MIN        4
+# define LZ_WINDOW_SIZE           65535
+//! @note Largest block of a stream, one-shot inputs have no limit
+# define LZ_BLOCK_SIZE_MAX        (1 << 16)
+# define LZ_HASH_BITS             12
+# define LZ_DICTIONARY_HASH_BITS  14
+# define LZ_DICTIONARY_SIZE_MAX   LZ_WINDOW_SIZE
+//! @note Largest compressed size of 'size' bytes, that of input that doesn't compress
+# define LZ_COMPRESS_BOUND(size)  ((size) + (size) / 255 + 16)
+
+struct lz_dictionary {
+    uint8_t* data;
+    uint32_t size;
+    //! @note Newest position of every hash of LZ_MATCH_SIZE_MIN bytes of the data
+    uint32_t hash_table[1 << LZ_DICTIONARY_HASH_BITS];
+};
+
+/**
+ * Streams compress block by block, a block can refer to the blocks before it, so they have to be decompressed in the same order
+ * They keep the last LZ_WINDOW_SIZE bytes of the stream, and enough room after them for a block
+ * @note Positions are 32 bits, a stream is at most 4 GiB
+*/
+struct lz_encoder {
+    const lz_dictionary_t* dictionary;
+    uint8_t*               window;
+    uint32_t               window_fill;
+    //! @note Stream position of window[0]
+    uint32_t               window_start;
+    uint32_t               hash_table[1 << LZ_HASH_BITS];
+};
+
+struct lz_decoder {
+    const lz_dictionary_t* dictionary;
+    uint8_t*               window;
+    uint32_t               window_fill;
+};
+
+/**
+ * @brief Copies 'data' and indexes it, compressing against it has no setup cost
+ * @param size at most LZ_DICTIONARY_SIZE_MAX, only the end of a larger one would be in reach
+*/
+PUBLIC_API bool lz_dictionary__create(lz_dictionary_t* self, const void* data, uint32_t size);
+PUBLIC_API void lz_dictionary__destroy(lz_dictionary_t* self);
+
+/**
+ * @brief Picks the segments of the samples whose content is the most common across them, greedily, until 'dictionary' is full
+ * @param samples the samples one after the other, 'sample_sizes' splits them
+ * @returns Size of the dictionary, less than 'dictionary_size' if the samples don't have that much to offer, 0 on failure
+*/
+PUBLIC_API uint32_t lz_dictionary__train(
+    const void* samples, const uint32_t* sample_sizes, uint32_t samples_size,
+    void* dictionary, uint32_t dictionary_size
+);
+
+//! @param dictionary optional, must outlive the encoder
+PUBLIC_API bool lz_encoder__create(lz_encoder_t* self, const lz_dictionary_t* dictionary);
+PUBLIC_API void lz_encoder__destroy(lz_encoder_t* self);
+/**
+ * @param src_size at most LZ_BLOCK_SIZE_MAX
+ * @returns false if the block doesn't fit into 'dst', LZ_COMPRESS_BOUND(src_size) always does, the stream is unusable then
+*/
+PUBLIC_API bool lz_encoder__compress(lz_encoder_t* self, const void* src, uint32_t src_size, void* dst, uint32_t dst_size, uint32_t* bytes_written);
+
+//! @param dictionary the one the stream was compressed with, must outlive the decoder
+PUBLIC_API bool lz_decoder__create(lz_decoder_t* self, const lz_dictionary_t* dictionary);
+PUBLIC_API void lz_decoder__destroy(lz_decoder_t* self);
+//! @returns false if the block is malformed or it decompresses to more than 'dst_size' or LZ_BLOCK_SIZE_MAX, the stream is unusable then
+PUBLIC_API bool lz_decoder__decompress(lz_decoder_t* self, const void* src, uint32_t src_size, void* dst, uint32_t dst_size, uint32_t* bytes_written);
+
+/**
+ * @brief Compresses 'src' as a stream of a single block, without allocating
+ * @param dictionary optional
+*/
+PUBLIC_API bool lz__compress(const void* src, uint32_t src_size, void* dst, uint32_t dst_size, const lz_dictionary_t* dictionary, uint32_t* bytes_written);
+//! @note 'dst' past the decompressed bytes may be overwritten, leave room past them for it to decompress faster
+PUBLIC_API bool lz__decompress(const void* src, uint32_t src_size, void* dst, uint32_t dst_size, const lz_dictionary_t* dictionary, uint32_t* bytes_written);
+
+#endif // LZ_H
@@ -0,0 +1,240 @@
+#include "lz.h"
+#include "system.h"
+#include "file.h"
+#include "memory.h"
+#include "debug.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Ratio and speed of the lz module
+ *   lz_benchmark <file>...              compresses each file as a stream of LZ_BLOCK_SIZE_MAX blocks, like an asset or a checkpoint
+ *   lz_benchmark -samples <capture>     a capture is a list of uint16_t little endian size + payload, like the datagrams of a session
+ *                                       a dictionary is trained on the first half, the second half is compressed one by one
+*/
+# define LZ_BENCHMARK_REPEAT          16
+# define LZ_BENCHMARK_DICTIONARY_SIZE (16 * 1024)
+
+static uint8_t* read_file(const char* path, uint32_t* size) {
+    size_t file_size = 0;
+    file_t file;
+    if (!file__size(path, &file_size) || !file__open(&file, path, FILE_ACCESS_MODE_READ, FILE_CREATION_MODE_OPEN)) {
+        return 0;
+    }
+    *size = (uint32_t) file_size;
+    uint8_t* result = memory__malloc(DEBUG_MODULE_COMMON, file_size ? file_size : 1);
+    // note: a read can return less than asked for
+    size_t offset = 0;
+    while (result && offset < file_size) {
+        size_t bytes_read = 0;
+        if (!file__read(&file, result + offset, file_size - offset, &bytes_read) || bytes_read == 0) {
+            memory__free(DEBUG_MODULE_COMMON, result);
+            result = 0;
+            break ;
+        }
+        offset += bytes_read;
+    }
+    file__close(&file);
+
+    return result;
+}
+
+static int benchmark_file(const char* path) {
+    uint32_t size = 0;
+    uint8_t* data = read_file(path, &size);
+    const uint32_t blocks_size = (size + LZ_BLOCK_SIZE_MAX - 1) / LZ_BLOCK_SIZE_MAX;
+    uint8_t* compressed = memory__malloc(DEBUG_MODULE_COMMON, (uint64_t) blocks_size * LZ_COMPRESS_BOUND(LZ_BLOCK_SIZE_MAX) + 1);
+    uint32_t* compressed_sizes = memory__malloc(DEBUG_MODULE_COMMON, (blocks_size + 1) * sizeof(*compressed_sizes));
+    uint8_t* decompressed = memory__malloc(DEBUG_MODULE_COMMON, size + 1);
+    lz_encoder_t* encoder = memory__malloc(DEBUG_MODULE_COMMON, sizeof(*encoder));
+    lz_decoder_t* decoder = memory__malloc(DEBUG_MODULE_COMMON, sizeof(*decoder));
+    int result = 1;
+    if (!data || !compressed || !compressed_sizes || !decompressed || !encoder || !decoder) {
+        debug__write_and_flush(DEBUG_MODULE_COMMON, DEBUG_ERROR, "can't read '%s'", path);
+        goto end;
+    }
+
+    double time_compress = 0.0;
+    double time_decompress = 0.0;
+    uint64_t compressed_size = 0;
+    for (uint32_t repeat = 0; repeat < LZ_BENCHMARK_REPEAT; ++repeat) {
+        lz_encoder__create(encoder, 0);
+        compressed_size = 0;
+        double time_start = system__get_time();
+        for (uint32_t block_index = 0; block_index < blocks_size; ++block_index) {
+            const uint32_t block_offset = block_index * LZ_BLOCK_SIZE_MAX;
+            const uint32_t block_size = size - block_offset < LZ_BLOCK_SIZE_MAX ? size - block_offset : LZ_BLOCK_SIZE_MAX;
+            lz_encoder__compress(encoder, data + block_offset, block_size, compressed + compressed_size, LZ_COMPRESS_BOUND(block_size), &compressed_sizes[block_index]);
+            compressed_size += compressed_sizes[block_index];
+        }
+        time_compress += system__get_time() - time_start;
+        lz_encoder__destroy(encoder);
+
+        lz_decoder__create(decoder, 0);
+        uint64_t compressed_offset = 0;
+        time_start = system__get_time();
+        for (uint32_t block_index = 0; block_index < blocks_size; ++block_index) {
+            uint32_t block_size = 0;
+            if (!lz_decoder__decompress(decoder, compressed + compressed_offset, compressed_sizes[block_index], decompressed + block_index * LZ_BLOCK_SIZE_MAX, LZ_BLOCK_SIZE_MAX, &block_size)) {
+                debug__write_and_flush(DEBUG_MODULE_COMMON, DEBUG_ERROR, "'%s' doesn't decompress", path);
+                lz_decoder__destroy(decoder);
+                goto end;
+            }
+            compressed_offset += compressed_sizes[block_index];
+        }
+        time_decompress += system__get_time() - time_start;
+        lz_decoder__destroy(decoder);
+    }
+    if (memcmp(data, decompressed, size) != 0) {
+        debug__write_and_flush(DEBUG_MODULE_COMMON, DEBUG_ERROR, "'%s' doesn't round trip", path);
+        goto end;
+    }
+
+    const double bytes_processed = (double) size * LZ_BENCHMARK_REPEAT;
+    debug__write_and_flush(
+        DEBUG_MODULE_COMMON, DEBUG_INFO,
+        "%s: %u -> %llu bytes, ratio %.3f, compress %.3f GB/s, decompress %.3f GB/s",
+        path, size, (unsigned long long) compressed_size, compressed_size ? (double) size / (double) compressed_size : 0.0,
+        bytes_processed / time_compress / 1e9, bytes_processed / time_decompress / 1e9
+    );
+    result = 0;
+
+end:
+    memory__free(DEBUG_MODULE_COMMON, decoder);
+    memory__free(DEBUG_MODULE_COMMON, encoder);
+    memory__free(DEBUG_MODULE_COMMON, decompressed);
+    memory__free(DEBUG_MODULE_COMMON, compressed_sizes);
+    memory__free(DEBUG_MODULE_COMMON, compressed);
+    memory__free(DEBUG_MODULE_COMMON, data);
+
+    return result;
+}
+
+static bool benchmark_samples_with(
+    const char* name, const uint8_t* samples, const uint32_t* sample_sizes, uint32_t samples_size, const lz_dictionary_t* dictionary
+) {
+    uint8_t compressed[LZ_COMPRESS_BOUND(65535)];
+    uint8_t decompressed[65535];
+    uint64_t size = 0;
+    uint64_t compressed_size = 0;
+    double time_decompress = 0.0;
+    uint32_t sample_offset = 0;
+    for (uint32_t sample_index = 0; sample_index < samples_size; ++sample_index) {
+        const uint8_t* sample = samples + sample_offset;
+        uint32_t sample_compressed_size = 0;
+        lz__compress(sample, sample_sizes[sample_index], compressed, sizeof(compressed), dictionary, &sample_compressed_size);
+        const double time_start = system__get_time();
+        for (uint32_t repeat = 0; repeat < LZ_BENCHMARK_REPEAT; ++repeat) {
+            uint32_t decompressed_size = 0;
+            lz__decompress(compressed, sample_compressed_size, decompressed, sizeof(decompressed), dictionary, &decompressed_size);
+        }
+        time_decompress += system__get_time() - time_start;
+        if (memcmp(sample, decompressed, sample_sizes[sample_index]) != 0) {
+            debug__write_and_flush(DEBUG_MODULE_COMMON, DEBUG_ERROR, "sample %u doesn't round trip", sample_index);
+            return false;
+        }
+        size += sample_sizes[sample_index];
+        compressed_size += sample_compressed_size;
+        sample_offset += sample_sizes[sample_index];
+    }
+
+    debug__write_and_flush(
+        DEBUG_MODULE_COMMON, DEBUG_INFO,
+        "  %-18s %llu -> %llu bytes, ratio %.3f, decompress %.3f GB/s",
+        name, (unsigned long long) size, (unsigned long long) compressed_size, compressed_size ? (double) size / (double) compressed_size : 0.0,
+        (double) size * LZ_BENCHMARK_REPEAT / time_decompress / 1e9
+    );
+
+    return true;
+}
+
+static int benchmark_samples(const char* path) {
+    uint32_t size = 0;
+    uint8_t* capture = read_file(path, &size);
+    uint8_t* samples = memory__malloc(DEBUG_MODULE_COMMON, size + 1);
+    uint32_t* sample_sizes = memory__malloc(DEBUG_MODULE_COMMON, (size / 2 + 1) * sizeof(*sample_sizes));
+    uint8_t* dictionary_data = memory__malloc(DEBUG_MODULE_COMMON, LZ_BENCHMARK_DICTIONARY_SIZE);
+    lz_dictionary_t* dictionary = memory__malloc(DEBUG_MODULE_COMMON, sizeof(*dictionary));
+    int result = 1;
+    if (!capture || !samples || !sample_sizes || !dictionary_data || !dictionary) {
+        debug__write_and_flush(DEBUG_MODULE_COMMON, DEBUG_ERROR, "can't read '%s'", path);
+        goto end;
+    }
+
+    uint32_t samples_size = 0;
+    uint32_t samples_data_size = 0;
+    for (uint32_t offset = 0; offset + 2 <= size;) {
+        const uint32_t sample_size = (uint32_t) capture[offset] | ((uint32_t) capture[offset + 1] << 8);
+        offset += 2;
+        if (size - offset < sample_size) {
+            break ;
+        }
+        memcpy(samples + samples_data_size, capture + offset, sample_size);
+        sample_sizes[samples_size++] = sample_size;
+        samples_data_size += sample_size;
+        offset += sample_size;
+    }
+
+    const uint32_t training_size = samples_size / 2;
+    uint32_t training_data_size = 0;
+    for (uint32_t sample_index = 0; sample_index < training_size; ++sample_index) {
+        training_data_size += sample_sizes[sample_index];
+    }
+    const double time_start = system__get_time();
+    const uint32_t dictionary_size = lz_dictionary__train(samples, sample_sizes, training_size, dictionary_data, LZ_BENCHMARK_DICTIONARY_SIZE);
+    const double time_train = system__get_time() - time_start;
+    lz_dictionary__create(dictionary, dictionary_data, dictionary_size);
+
+    debug__write_and_flush(
+        DEBUG_MODULE_COMMON, DEBUG_INFO,
+        "%s: %u samples, dictionary of %u bytes trained on %u of them in %.3fs",
+        path, samples_size, dictionary_size, training_size, time_train
+    );
+    if (
+        benchmark_samples_with("without dictionary", samples + training_data_size, sample_sizes + training_size, samples_size - training_size, 0) &&
+        benchmark_samples_with("with dictionary", samples + training_data_size, sample_sizes + training_size, samples_size - training_size, dictionary)
+    ) {
+        result = 0;
+    }
+    lz_dictionary__destroy(dictionary);
+
+end:
+    memory__free(DEBUG_MODULE_COMMON, dictionary);
+    memory__free(DEBUG_MODULE_COMMON, dictionary_data);
+    memory__free(DEBUG_MODULE_COMMON, sample_sizes);
+    memory__free(DEBUG_MODULE_COMMON, samples);
+    memory__free(DEBUG_MODULE_COMMON, capture);
+
+    return result;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <file>... | -samples <capture>\n", argv[0]);
+        return 1;
+    }
+
+    if (!debug__init_module()) {
+        return 1;
+    }
+    system__init();
+
+    int result = 0;
+    if (strcmp(argv[1], "-samples") == 0) {
+        result = argc == 3 ? benchmark_samples(argv[2]) : 1;
+    } else {
+        for (int arg_index = 1; result == 0 && arg_index < argc; ++arg_index) {
+            result = benchmark_file(argv[arg_index]);
+        }
+    }
+
+    debug__lock();
+    debug__write_memory_stats(system__get_time());
+    debug__flush(DEBUG_MODULE_COMMON, DEBUG_INFO);
+    debug__unlock();
+
+    debug__deinit_module();
+
+    return result;
+}
@@ -0,0 +1,295 @@
+#include "lz.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INPUT_SIZE_MAX    (LZ_BLOCK_SIZE_MAX + 4096)
+#define DICTIONARY_SIZE   2048
+
+static lz_dictionary_t dictionary;
+static uint8_t         dictionary_data[DICTIONARY_SIZE];
+static uint8_t         input[INPUT_SIZE_MAX];
+static uint8_t         compressed[LZ_COMPRESS_BOUND(INPUT_SIZE_MAX)];
+static uint8_t         expected[INPUT_SIZE_MAX];
+static uint32_t        errors;
+
+static bool model__read_length(const uint8_t* src, uint32_t src_size, uint32_t* cur, uint32_t* length) {
+    uint8_t byte = 255;
+    while (byte == 255) {
+        if (*cur == src_size || *length > UINT32_MAX - 255) {
+            return false;
+        }
+        byte = src[(*cur)++];
+        *length += byte;
+    }
+
+    return true;
+}
+
+// a byte at a time decoder of a one-shot block, as if the dictionary came right before 'dst'
+static bool model__decompress(
+    const uint8_t* src, uint32_t src_size, uint8_t* dst, uint32_t dst_size,
+    const uint8_t* dictionary, uint32_t dictionary_size, uint32_t* bytes_written
+) {
+    uint32_t cur = 0;
+    uint32_t out = 0;
+    while (true) {
+        if (cur == src_size) {
+            return false;
+        }
+        const uint8_t token = src[cur++];
+        uint32_t literals_size = token >> 4;
+        if (literals_size == 15 && !model__read_length(src, src_size, &cur, &literals_size)) {
+            return false;
+        }
+        if (src_size - cur < literals_size || dst_size - out < literals_size) {
+            return false;
+        }
+        for (uint32_t literal_index = 0; literal_index < literals_size; ++literal_index) {
+            dst[out++] = src[cur++];
+        }
+        if (cur == src_size) {
+            break ;
+        }
+
+        if (src_size - cur < 2) {
+            return false;
+        }
+        const uint32_t offset = (uint32_t) src[cur] | ((uint32_t) src[cur + 1] << 8);
+        cur += 2;
+        uint32_t match_size = token & 15;
+        if (match_size == 15 && !model__read_length(src, src_size, &cur, &match_size)) {
+            return false;
+        }
+        if (offset == 0 || offset > out + dictionary_size || dst_size - out < (uint64_t) match_size + LZ_MATCH_SIZE_MIN) {
+            return false;
+        }
+        match_size += LZ_MATCH_SIZE_MIN;
+        for (uint32_t match_index = 0; match_index < match_size; ++match_index) {
+            const uint32_t from = out + dictionary_size - offset;
+            dst[out] = from < dictionary_size ? dictionary[from] : dst[from - dictionary_size];
+            ++out;
+        }
+    }
+    *bytes_written = out;
+
+    return true;
+}
+
+static void input__fill(uint8_t* data, uint32_t size) {
+    const int kind = rand() % 4;
+    for (uint32_t byte_index = 0; byte_index < size; ++byte_index) {
+        if (kind == 0) {
+            data[byte_index] = (uint8_t) rand();
+        } else if (kind == 1) {
+            data[byte_index] = (uint8_t) ('a' + rand() % 3);
+        } else if (kind == 2 && byte_index > 0 && rand() % 32 != 0) {
+            data[byte_index] = data[byte_index - 1];
+        } else {
+            // pieces of the dictionary with some noise, like datagrams of the same session
+            data[byte_index] = rand() % 16 == 0 ? (uint8_t) rand() : dictionary_data[(byte_index * 7 + (uint32_t) rand() % 3) % DICTIONARY_SIZE];
+        }
+    }
+}
+
+static uint32_t random_size() {
+    const int kind = rand() % 8;
+    if (kind == 0) {
+        return (uint32_t) rand() % 16;
+    }
+    if (kind == 1) {
+        return LZ_BLOCK_SIZE_MAX - 8 + (uint32_t) rand() % 16;
+    }
+    if (kind == 2) {
+        return (uint32_t) rand() % INPUT_SIZE_MAX;
+    }
+    return (uint32_t) rand() % 2000;
+}
+
+// decompresses into a buffer of exactly 'dst_size', so a sanitizer catches writes past it, and checks it against the model
+static void check_decompress(const uint8_t* src, uint32_t src_size, uint32_t dst_size, const lz_dictionary_t* with_dictionary, const char* what) {
+    uint8_t* src_exact = malloc(src_size ? src_size : 1);
+    uint8_t* dst = malloc(dst_size ? dst_size : 1);
+    memcpy(src_exact, src, src_size);
+    uint32_t size = 0;
+    uint32_t size_expected = 0;
+    const bool is_ok = lz__decompress(src_exact, src_size, dst, dst_size, with_dictionary, &size);
+    const bool is_ok_expected = model__decompress(
+        src_exact, src_size, expected, dst_size < INPUT_SIZE_MAX ? dst_size : INPUT_SIZE_MAX,
+        with_dictionary ? with_dictionary->data : 0, with_dictionary ? with_dictionary->size : 0, &size_expected
+    );
+    if (is_ok != is_ok_expected || (is_ok && (size != size_expected || memcmp(dst, expected, size) != 0))) {
+        printf("%s: %u bytes into %u, decompressed %d, %u bytes, expected %d, %u bytes\n", what, src_size, dst_size, is_ok, size, is_ok_expected, size_expected);
+        ++errors;
+    }
+    free(dst);
+    free(src_exact);
+}
+
+int main() {
+    srand(1);
+    for (uint32_t byte_index = 0; byte_index < DICTIONARY_SIZE; ++byte_index) {
+        dictionary_data[byte_index] = byte_index % 13 == 0 ? (uint8_t) rand() : (uint8_t) ('A' + byte_index % 23);
+    }
+    if (!lz_dictionary__create(&dictionary, dictionary_data, DICTIONARY_SIZE)) {
+        printf("failed to create the dictionary\n");
+        return 1;
+    }
+
+    // one-shot round trips, into exactly the room they need and into a byte less
+    for (uint32_t trial = 0; trial < 3000; ++trial) {
+        const lz_dictionary_t* with_dictionary = rand() % 2 ? &dictionary : 0;
+        const uint32_t size = random_size();
+        input__fill(input, size);
+        uint32_t compressed_size = 0;
+        if (!lz__compress(input, size, compressed, LZ_COMPRESS_BOUND(size), with_dictionary, &compressed_size)) {
+            printf("%u bytes didn't compress within the bound\n", size);
+            ++errors;
+            continue ;
+        }
+
+        uint8_t* decompressed = malloc(size ? size : 1);
+        uint32_t decompressed_size = 0;
+        if (
+            !lz__decompress(compressed, compressed_size, decompressed, size, with_dictionary, &decompressed_size) ||
+            decompressed_size != size || memcmp(decompressed, input, size) != 0
+        ) {
+            printf("%u bytes, %u compressed, dictionary %d, didn't round trip\n", size, compressed_size, with_dictionary != 0);
+            ++errors;
+        }
+        free(decompressed);
+        check_decompress(compressed, compressed_size, size, with_dictionary, "round trip");
+        if (size > 0) {
+            check_decompress(compressed, compressed_size, size - 1, with_dictionary, "a byte short");
+        }
+        check_decompress(compressed, compressed_size, size + (uint32_t) rand() % 64, with_dictionary, "room to spare");
+    }
+
+    // streams, later blocks repeat earlier ones so matches reach back across blocks and into the dictionary
+    for (uint32_t trial = 0; trial < 40; ++trial) {
+        const lz_dictionary_t* with_dictionary = rand() % 2 ? &dictionary : 0;
+        lz_encoder_t encoder;
+        lz_decoder_t decoder;
+        lz_encoder__create(&encoder, with_dictionary);
+        lz_decoder__create(&decoder, with_dictionary);
+        uint32_t size_previous = 0;
+        for (uint32_t block_index = 0; block_index < 12; ++block_index) {
+            uint32_t size = random_size();
+            size = size < LZ_BLOCK_SIZE_MAX ? size : LZ_BLOCK_SIZE_MAX;
+            if (block_index == 0 || size > size_previous || rand() % 2) {
+                input__fill(input, size);
+            }
+            size_previous = size;
+            uint32_t compressed_size = 0;
+            uint32_t decompressed_size = 0;
+            static uint8_t decompressed[LZ_BLOCK_SIZE_MAX];
+            if (
+                !lz_encoder__compress(&encoder, input, size, compressed, LZ_COMPRESS_BOUND(size), &compressed_size) ||
+                !lz_decoder__decompress(&decoder, compressed, compressed_size, decompressed, sizeof(decompressed), &decompressed_size) ||
+                decompressed_size != size || memcmp(decompressed, input, size) != 0
+            ) {
+                printf("stream %u, block %u of %u bytes didn't round trip\n", trial, block_index, size);
+                ++errors;
+                break ;
+            }
+        }
+        lz_decoder__destroy(&decoder);
+        lz_encoder__destroy(&encoder);
+    }
+
+    // hand-made blocks, offsets from 0 to past the dictionary, matches that overlap themselves and run out of the dictionary into the output
+    for (uint32_t trial = 0; trial < 200000; ++trial) {
+        const lz_dictionary_t* with_dictionary = rand() % 2 ? &dictionary : 0;
+        const uint32_t dictionary_size = with_dictionary ? DICTIONARY_SIZE : 0;
+        uint8_t  block[512];
+        uint32_t block_size = 0;
+        uint32_t out = 0;
+        for (int sequences = rand() % 6; sequences >= 0 && block_size + 64 < sizeof(block); --sequences) {
+            const bool is_last = sequences == 0;
+            const uint32_t literals_size = rand() % 4 == 0 ? 15 + (uint32_t) rand() % 20 : (uint32_t) rand() % 20;
+            const uint32_t match_nibble = (uint32_t) rand() % 16;
+            block[block_size++] = (uint8_t) (((literals_size < 15 ? literals_size : 15) << 4) | match_nibble);
+            if (literals_size >= 15) {
+                block[block_size++] = (uint8_t) (literals_size - 15);
+            }
+            for (uint32_t literal_index = 0; literal_index < literals_size; ++literal_index) {
+                block[block_size++] = (uint8_t) rand();
+            }
+            out += literals_size;
+            if (is_last) {
+                break ;
+            }
+
+            const int offset_kind = rand() % 6;
+            uint32_t offset = (uint32_t) rand() % 65536;
+            if (offset_kind == 0) {
+                offset = 1 + (uint32_t) rand() % 20;
+            } else if (offset_kind == 1) {
+                offset = out + dictionary_size - 2 + (uint32_t) rand() % 5;
+            } else if (offset_kind == 2) {
+                offset = out + 1 + (uint32_t) rand() % 8;
+            } else if (offset_kind == 3) {
+                offset = (uint32_t) rand() % 2;
+            }
+            block[block_size++] = (uint8_t) offset;
+            block[block_size++] = (uint8_t) (offset >> 8);
+            uint32_t match_size = match_nibble + LZ_MATCH_SIZE_MIN;
+            if (match_nibble == 15) {
+                const uint32_t match_extra = rand() % 8 == 0 ? 255 + (uint32_t) rand() % 40 : (uint32_t) rand() % 40;
+                for (uint32_t extra = match_extra; ; extra -= 255) {
+                    block[block_size++] = (uint8_t) (extra < 255 ? extra : 255);
+                    if (extra < 255) {
+                        break ;
+                    }
+                }
+                match_size += match_extra;
+            }
+            out += match_size;
+        }
+        // note: cut short, flipped, or as made, the end of the block is where the wild copies get tight
+        if (rand() % 4 == 0 && block_size > 0) {
+            block_size = (uint32_t) rand() % block_size;
+        }
+        if (rand() % 4 == 0 && block_size > 0) {
+            block[(uint32_t) rand() % block_size] ^= (uint8_t) (1 << (rand() % 8));
+        }
+        const int dst_kind = rand() % 4;
+        const uint32_t dst_size =
+            dst_kind == 0 ? out :
+            dst_kind == 1 ? out + (uint32_t) rand() % 32 :
+            dst_kind == 2 ? (out > 0 ? (uint32_t) rand() % out : 0) :
+            (uint32_t) rand() % 1024;
+        check_decompress(block, block_size, dst_size, with_dictionary, "hand-made block");
+    }
+
+    // lengths past 32 bits, and the longest match that can be encoded, which mustn't wrap around once LZ_MATCH_SIZE_MIN is added
+    const uint32_t lengths_size = 16843007;
+    uint8_t* overflow = malloc(lengths_size + 16);
+    uint32_t overflow_size = 0;
+    overflow[overflow_size++] = 0xf0;
+    memset(overflow + overflow_size, 255, lengths_size + 8);
+    overflow_size += lengths_size + 8;
+    check_decompress(overflow, overflow_size, 1024, 0, "literals length past 32 bits");
+    for (uint32_t last_length_byte = 0; last_length_byte < 2; ++last_length_byte) {
+        overflow_size = 0;
+        overflow[overflow_size++] = 0x1f;
+        overflow[overflow_size++] = 'a';
+        overflow[overflow_size++] = 1;
+        overflow[overflow_size++] = 0;
+        memset(overflow + overflow_size, 255, lengths_size);
+        overflow_size += lengths_size;
+        // note: 15 + 255 * lengths_size + 254 is the longest, another 255 is past 32 bits
+        overflow[overflow_size++] = last_length_byte == 0 ? 254 : 255;
+        overflow[overflow_size++] = 0x00;
+        check_decompress(overflow, overflow_size, 1024, 0, last_length_byte == 0 ? "longest match" : "match length past 32 bits");
+    }
+    free(overflow);
+
+    lz_dictionary__destroy(&dictionary);
+
+    printf("errors: %u\n", errors);
+
+    return errors == 0 ? 0 : 1;
+}
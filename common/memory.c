@@ -0,0 +1,184 @@
+#include "memory.h"
+
+#if defined(MEMORY_TRACKING)
+
+# include <assert.h>
+# include <stdio.h>
+# include <string.h>
+# include <execinfo.h>
+
+# define MEMORY_HEADER_MAGIC          0x6d656d6fU
+# define MEMORY_STACK_SAMPLES_SIZE    256
+# define MEMORY_STACK_FRAMES_SIZE     16
+
+typedef struct memory_header {
+    uint64_t size;
+    uint32_t module;
+    uint32_t magic;
+} memory_header_t;
+
+typedef struct memory_stack_sample {
+    uint32_t module;
+    uint32_t frames_size;
+    uint64_t size;
+    void*    frames[MEMORY_STACK_FRAMES_SIZE];
+} memory_stack_sample_t;
+
+typedef struct memory {
+    memory_stats_t        stats[_DEBUG_MODULE_SIZE];
+
+    uint32_t              sample_period;
+    uint64_t              allocations_since_sampling;
+    uint32_t              stack_samples_top;
+    memory_stack_sample_t stack_samples[MEMORY_STACK_SAMPLES_SIZE];
+} memory_t;
+
+static memory_t memory;
+
+static void memory__on_alloc(debug_module_t module, uint64_t size);
+static void memory__on_free(debug_module_t module, uint64_t size);
+static void memory__sample_stack(debug_module_t module, uint64_t size);
+static void* memory__header_to_p(memory_header_t* header);
+static memory_header_t* memory__p_to_header(void* p);
+
+static void memory__on_alloc(debug_module_t module, uint64_t size) {
+    assert(module < _DEBUG_MODULE_SIZE);
+    memory_stats_t* stats = &memory.stats[module];
+
+    const uint64_t live_bytes = __atomic_add_fetch(&stats->live_bytes, size, __ATOMIC_RELAXED);
+    uint64_t peak_bytes = __atomic_load_n(&stats->peak_bytes, __ATOMIC_RELAXED);
+    while (live_bytes > peak_bytes && !__atomic_compare_exchange_n(&stats->peak_bytes, &peak_bytes, live_bytes, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+    __atomic_add_fetch(&stats->allocated_bytes, size, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&stats->allocations, 1, __ATOMIC_RELAXED);
+
+    if (__atomic_load_n(&memory.sample_period, __ATOMIC_RELAXED) != 0) {
+        memory__sample_stack(module, size);
+    }
+}
+
+static void memory__on_free(debug_module_t module, uint64_t size) {
+    assert(module < _DEBUG_MODULE_SIZE);
+    memory_stats_t* stats = &memory.stats[module];
+
+    __atomic_sub_fetch(&stats->live_bytes, size, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&stats->frees, 1, __ATOMIC_RELAXED);
+}
+
+static void memory__sample_stack(debug_module_t module, uint64_t size) {
+    const uint64_t allocations_since_sampling = __atomic_add_fetch(&memory.allocations_since_sampling, 1, __ATOMIC_RELAXED);
+    if (allocations_since_sampling % __atomic_load_n(&memory.sample_period, __ATOMIC_RELAXED) != 0) {
+        return ;
+    }
+
+    const uint32_t stack_sample_index = __atomic_fetch_add(&memory.stack_samples_top, 1, __ATOMIC_RELAXED) % MEMORY_STACK_SAMPLES_SIZE;
+    memory_stack_sample_t* stack_sample = &memory.stack_samples[stack_sample_index];
+    stack_sample->module      = module;
+    stack_sample->size        = size;
+    stack_sample->frames_size = backtrace(stack_sample->frames, MEMORY_STACK_FRAMES_SIZE);
+}
+
+static void* memory__header_to_p(memory_header_t* header) {
+    return header + 1;
+}
+
+static memory_header_t* memory__p_to_header(void* p) {
+    memory_header_t* header = (memory_header_t*) p - 1;
+    // note: catches memory that was allocated by libc directly
+    assert(header->magic == MEMORY_HEADER_MAGIC);
+
+    return header;
+}
+
+void* memory__malloc(debug_module_t module, size_t size) {
+    memory_header_t* header = malloc(sizeof(*header) + size);
+    if (!header) {
+        return 0;
+    }
+
+    header->size   = size;
+    header->module = module;
+    header->magic  = MEMORY_HEADER_MAGIC;
+    memory__on_alloc(module, size);
+
+    return memory__header_to_p(header);
+}
+
+void* memory__calloc(debug_module_t module, size_t count, size_t size) {
+    if (size != 0 && count > (SIZE_MAX - sizeof(memory_header_t)) / size) {
+        return 0;
+    }
+
+    void* result = memory__malloc(module, count * size);
+    if (result) {
+        memset(result, 0, count * size);
+    }
+
+    return result;
+}
+
+void* memory__realloc(debug_module_t module, void* p, size_t size) {
+    if (!p) {
+        return memory__malloc(module, size);
+    }
+
+    memory_header_t* header = memory__p_to_header(p);
+    const uint64_t   old_size   = header->size;
+    const uint32_t   old_module = header->module;
+    memory_header_t* new_header = realloc(header, sizeof(*header) + size);
+    if (!new_header) {
+        return 0;
+    }
+
+    memory__on_free(old_module, old_size);
+    new_header->size   = size;
+    new_header->module = module;
+    memory__on_alloc(module, size);
+
+    return memory__header_to_p(new_header);
+}
+
+void memory__free(debug_module_t module, void* p) {
+    (void) module;
+    if (!p) {
+        return ;
+    }
+
+    memory_header_t* header = memory__p_to_header(p);
+    // note: account to the module that allocated it, in case ownership was transferred
+    memory__on_free(header->module, header->size);
+    header->magic = 0;
+    free(header);
+}
+
+bool memory__get_stats(debug_module_t module, memory_stats_t* stats) {
+    if (module >= _DEBUG_MODULE_SIZE) {
+        return false;
+    }
+
+    memory_stats_t* module_stats = &memory.stats[module];
+    stats->live_bytes      = __atomic_load_n(&module_stats->live_bytes, __ATOMIC_RELAXED);
+    stats->peak_bytes      = __atomic_load_n(&module_stats->peak_bytes, __ATOMIC_RELAXED);
+    stats->allocated_bytes = __atomic_load_n(&module_stats->allocated_bytes, __ATOMIC_RELAXED);
+    stats->allocations     = __atomic_load_n(&module_stats->allocations, __ATOMIC_RELAXED);
+    stats->frees           = __atomic_load_n(&module_stats->frees, __ATOMIC_RELAXED);
+
+    return true;
+}
+
+void memory__set_stack_sampling(uint32_t sample_period) {
+    __atomic_store_n(&memory.allocations_since_sampling, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&memory.sample_period, sample_period, __ATOMIC_RELAXED);
+}
+
+void memory__write_stack_samples(int fd) {
+    const uint32_t stack_samples_top = __atomic_load_n(&memory.stack_samples_top, __ATOMIC_RELAXED);
+    const uint32_t stack_samples_size = stack_samples_top < MEMORY_STACK_SAMPLES_SIZE ? stack_samples_top : MEMORY_STACK_SAMPLES_SIZE;
+    for (uint32_t stack_sample_index = 0; stack_sample_index < stack_samples_size; ++stack_sample_index) {
+        memory_stack_sample_t* stack_sample = &memory.stack_samples[stack_sample_index];
+        dprintf(fd, "sample #%u, module #%u, %llu bytes:\n", stack_sample_index, stack_sample->module, (unsigned long long) stack_sample->size);
+        backtrace_symbols_fd(stack_sample->frames, stack_sample->frames_size, fd);
+    }
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef MEMORY_H
+# define MEMORY_H
+
+# include <stdint.h>
+# include <stdbool.h>
+# include <stddef.h>
+# include <stdlib.h>
+
+# include "helper_macros.h"
+# include "debug_module.h"
+
+/**
+ * Allocator that every module routes its heap allocations through, tagged by the module that owns them
+ * @note Tracking is only compiled in debug builds, in release builds these are inlined to the libc calls
+ * @note Memory allocated by memory__* must be released by memory__*, and vice versa for libc
+*/
+
+typedef struct memory_stats {
+    uint64_t live_bytes;
+    uint64_t peak_bytes;
+    // note: total bytes allocated over the lifetime of the module, sample it over time to get the allocation rate
+    uint64_t allocated_bytes;
+    uint64_t allocations;
+    uint64_t frees;
+} memory_stats_t;
+
+# if defined(DEBUG)
+#  define MEMORY_TRACKING
+# endif
+
+# if defined(MEMORY_TRACKING)
+
+PUBLIC_API void* memory__malloc(debug_module_t module, size_t size);
+PUBLIC_API void* memory__calloc(debug_module_t module, size_t count, size_t size);
+PUBLIC_API void* memory__realloc(debug_module_t module, void* p, size_t size);
+PUBLIC_API void memory__free(debug_module_t module, void* p);
+
+//! @note Atomic
+PUBLIC_API bool memory__get_stats(debug_module_t module, memory_stats_t* stats);
+
+/**
+ * @brief Records the call stack of every 'sample_period'-th allocation into a fixed ring
+ * @param sample_period 0 disables sampling
+*/
+PUBLIC_API void memory__set_stack_sampling(uint32_t sample_period);
+//! @brief Writes the symbolized sampled call stacks to the file descriptor
+PUBLIC_API void memory__write_stack_samples(int fd);
+
+# else
+
+static inline void* memory__malloc(debug_module_t module, size_t size) {
+    (void) module;
+    return malloc(size);
+}
+
+static inline void* memory__calloc(debug_module_t module, size_t count, size_t size) {
+    (void) module;
+    return calloc(count, size);
+}
+
+static inline void* memory__realloc(debug_module_t module, void* p, size_t size) {
+    (void) module;
+    return realloc(p, size);
+}
+
+static inline void memory__free(debug_module_t module, void* p) {
+    (void) module;
+    free(p);
+}
+
+static inline bool memory__get_stats(debug_module_t module, memory_stats_t* stats) {
+    (void) module;
+    (void) stats;
+    return false;
+}
+
+static inline void memory__set_stack_sampling(uint32_t sample_period) {
+    (void) sample_period;
+}
+
+static inline void memory__write_stack_samples(int fd) {
+    (void) fd;
+}
+
+# endif
+
+#endif // MEMORY_H
@@ -0,0 +1,259 @@
+#include "metrics.h"
+
+#include "histogram.h"
+#include "thread.h"
+#include "memory.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "metrics_impl.c"
+
+bool metrics__init_module() {
+    memset(&metrics, 0, sizeof(metrics));
+
+    metrics.exporter_fd = -1;
+    metrics.register_mutex = mutex__create();
+    if (!metrics.register_mutex) {
+        return false;
+    }
+
+    return true;
+}
+
+void metrics__deinit_module() {
+    if (metrics.exporter_thread) {
+        shutdown(metrics.exporter_fd, SHUT_RDWR);
+        thread__destroy(metrics.exporter_thread);
+        close(metrics.exporter_fd);
+        if (metrics.exporter_path[0] != '\0') {
+            unlink(metrics.exporter_path);
+        }
+    }
+
+    metrics_thread_t* thread = metrics.threads;
+    while (thread) {
+        metrics_thread_t* next = thread->next;
+        for (uint32_t metric_index = 0; metric_index < METRICS_SIZE; ++metric_index) {
+            memory__free(DEBUG_MODULE_COMMON, thread->histograms[metric_index]);
+        }
+        memory__free(DEBUG_MODULE_COMMON, thread);
+        thread = next;
+    }
+    metrics_thread = 0;
+
+    if (metrics.register_mutex) {
+        mutex__destroy(metrics.register_mutex);
+    }
+}
+
+bool metrics__register(metric_t* metric, const char* name, metric_type_t type) {
+    assert(type < _METRIC_TYPE_SIZE);
+    if (strlen(name) >= METRIC_NAME_SIZE) {
+        return false;
+    }
+
+    mutex__lock(metrics.register_mutex);
+
+    for (uint32_t metric_index = 0; metric_index < metrics.metrics_top; ++metric_index) {
+        if (strcmp(metrics.names[metric_index], name) == 0) {
+            mutex__unlock(metrics.register_mutex);
+            if (metrics.types[metric_index] != type) {
+                return false;
+            }
+            *metric = metric_index;
+            return true;
+        }
+    }
+
+    if (metrics.metrics_top == METRICS_SIZE) {
+        mutex__unlock(metrics.register_mutex);
+        return false;
+    }
+
+    const uint32_t metric_index = metrics.metrics_top;
+    strcpy(metrics.names[metric_index], name);
+    metrics.types[metric_index]  = type;
+    metrics.gauges[metric_index] = 0;
+    // note: publish the slot after its name and type are written
+    __atomic_store_n(&metrics.metrics_top, metric_index + 1, __ATOMIC_RELEASE);
+
+    mutex__unlock(metrics.register_mutex);
+
+    *metric = metric_index;
+
+    return true;
+}
+
+void metric__add(metric_t self, uint64_t value) {
+    assert(self < METRICS_SIZE && metrics.types[self] == METRIC_TYPE_COUNTER);
+    metrics_thread_t* thread = metrics__ensure_thread();
+    if (!thread) {
+        return ;
+    }
+
+    // note: single writer, so a relaxed load + store is enough and avoids locked instructions
+    __atomic_store_n(&thread->counters[self], __atomic_load_n(&thread->counters[self], __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+}
+
+void metric__set(metric_t self, double value) {
+    assert(self < METRICS_SIZE && metrics.types[self] == METRIC_TYPE_GAUGE);
+    uint64_t value_bits;
+    memcpy(&value_bits, &value, sizeof(value_bits));
+    __atomic_store_n(&metrics.gauges[self], value_bits, __ATOMIC_RELAXED);
+}
+
+void metric__record(metric_t self, uint64_t value) {
+    assert(self < METRICS_SIZE && metrics.types[self] == METRIC_TYPE_HISTOGRAM);
+    metrics_thread_t* thread = metrics__ensure_thread();
+    if (!thread) {
+        return ;
+    }
+
+    histogram_t* histogram = thread->histograms[self];
+    if (!histogram) {
+        histogram = memory__malloc(DEBUG_MODULE_COMMON, sizeof(*histogram));
+        if (!histogram) {
+            return ;
+        }
+        histogram__create(histogram);
+        __atomic_store_n(&thread->histograms[self], histogram, __ATOMIC_RELEASE);
+    }
+
+    histogram__record_atomic(histogram, value);
+}
+
+void metric__record_time(metric_t self, double s) {
+    metric__record(self, s > 0.0 ? (uint64_t) (s * 1000000000.0) : 0);
+}
+
+void metrics__snapshot(str_builder_t* str_builder) {
+    histogram_t* histogram_thread = memory__malloc(DEBUG_MODULE_COMMON, sizeof(*histogram_thread));
+    histogram_t* histogram_total  = memory__malloc(DEBUG_MODULE_COMMON, sizeof(*histogram_total));
+    if (!histogram_thread || !histogram_total) {
+        memory__free(DEBUG_MODULE_COMMON, histogram_thread);
+        memory__free(DEBUG_MODULE_COMMON, histogram_total);
+        return ;
+    }
+
+    const uint32_t metrics_top = __atomic_load_n(&metrics.metrics_top, __ATOMIC_ACQUIRE);
+    metrics_thread_t* threads  = __atomic_load_n(&metrics.threads, __ATOMIC_ACQUIRE);
+    for (uint32_t metric_index = 0; metric_index < metrics_top; ++metric_index) {
+        const char* name = metrics.names[metric_index];
+        const metric_type_t type = metrics.types[metric_index];
+        str_builder__fappend(str_builder, "# TYPE %s %s\n", name, metric_type__to_str(type));
+        switch (type) {
+        case METRIC_TYPE_COUNTER: {
+            uint64_t value = 0;
+            for (metrics_thread_t* thread = threads; thread; thread = thread->next) {
+                value += __atomic_load_n(&thread->counters[metric_index], __ATOMIC_RELAXED);
+            }
+            str_builder__fappend(str_builder, "%s %llu\n", name, (unsigned long long) value);
+        } break ;
+        case METRIC_TYPE_GAUGE: {
+            const uint64_t value_bits = __atomic_load_n(&metrics.gauges[metric_index], __ATOMIC_RELAXED);
+            double value;
+            memcpy(&value, &value_bits, sizeof(value));
+            str_builder__fappend(str_builder, "%s %.9g\n", name, value);
+        } break ;
+        case METRIC_TYPE_HISTOGRAM: {
+            histogram__create(histogram_total);
+            for (metrics_thread_t* thread = threads; thread; thread = thread->next) {
+                histogram_t* histogram = __atomic_load_n(&thread->histograms[metric_index], __ATOMIC_ACQUIRE);
+                if (histogram) {
+                    histogram__load(histogram_thread, histogram);
+                    histogram__merge(histogram_total, histogram_thread);
+                }
+            }
+            const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+            for (uint32_t quantile_index = 0; quantile_index < ARRAY_SIZE(quantiles); ++quantile_index) {
+                str_builder__fappend(
+                    str_builder, "%s{quantile=\"%g\"} %llu\n",
+                    name, quantiles[quantile_index], (unsigned long long) histogram__percentile(histogram_total, quantiles[quantile_index] * 100.0)
+                );
+            }
+            str_builder__fappend(str_builder, "%s_max %llu\n", name, (unsigned long long) histogram__max(histogram_total));
+            str_builder__fappend(str_builder, "%s_sum %llu\n", name, (unsigned long long) histogram_total->sum);
+            str_builder__fappend(str_builder, "%s_count %llu\n", name, (unsigned long long) histogram__count(histogram_total));
+        } break ;
+        default: assert(false);
+        }
+    }
+
+    memory__free(DEBUG_MODULE_COMMON, histogram_thread);
+    memory__free(DEBUG_MODULE_COMMON, histogram_total);
+}
+
+bool metrics__serve_unix(const char* path) {
+    if (metrics.exporter_thread) {
+        return false;
+    }
+
+    struct sockaddr_un addr = { 0 };
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path) || strlen(path) >= sizeof(metrics.exporter_path)) {
+        return false;
+    }
+    strcpy(addr.sun_path, path);
+
+    int32_t listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd == -1) {
+        perror(0);
+        return false;
+    }
+
+    unlink(path);
+    if (bind(listen_fd, (const struct sockaddr*) &addr, sizeof(addr)) == -1) {
+        perror(0);
+        close(listen_fd);
+        return false;
+    }
+
+    if (!metrics__serve(listen_fd)) {
+        unlink(path);
+        return false;
+    }
+    strcpy(metrics.exporter_path, path);
+
+    return true;
+}
+
+bool metrics__serve_tcp(uint16_t port) {
+    if (metrics.exporter_thread) {
+        return false;
+    }
+
+    struct sockaddr_in addr = { 0 };
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port        = htons(port);
+
+    int32_t listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, IPPROTO_TCP);
+    if (listen_fd == -1) {
+        perror(0);
+        return false;
+    }
+
+    int opt = 1;
+    if (setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, (const void*) &opt, sizeof(opt)) != 0) {
+        perror(0);
+        close(listen_fd);
+        return false;
+    }
+
+    if (bind(listen_fd, (const struct sockaddr*) &addr, sizeof(addr)) == -1) {
+        perror(0);
+        close(listen_fd);
+        return false;
+    }
+
+    return metrics__serve(listen_fd);
+}
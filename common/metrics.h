@@ -0,0 +1,54 @@
+#ifndef METRICS_H
+# define METRICS_H
+
+# include <stdint.h>
+# include <stdbool.h>
+
+# include "str_builder.h"
+# include "helper_macros.h"
+
+# define METRICS_SIZE 64
+
+typedef uint32_t metric_t;
+
+typedef enum metric_type {
+    // monotonic, summed across threads on read
+    METRIC_TYPE_COUNTER,
+    // last written value wins
+    METRIC_TYPE_GAUGE,
+    // merged across threads on read
+    METRIC_TYPE_HISTOGRAM,
+
+    _METRIC_TYPE_SIZE
+} metric_type_t;
+
+PUBLIC_API bool metrics__init_module();
+PUBLIC_API void metrics__deinit_module();
+
+/**
+ * @brief Registers a metric, or returns the already registered one if the name and type matches
+ * @note Blocking, call it on startup, not on the hot path
+*/
+PUBLIC_API bool metrics__register(metric_t* metric, const char* name, metric_type_t type);
+
+//! @note Lock-free, each thread writes its own slot
+PUBLIC_API void metric__add(metric_t self, uint64_t value);
+//! @note Lock-free
+PUBLIC_API void metric__set(metric_t self, double value);
+//! @note Lock-free, each thread writes its own histogram which is allocated on the thread's first record
+PUBLIC_API void metric__record(metric_t self, uint64_t value);
+//! @note Lock-free, records time in seconds with nanosecond resolution
+PUBLIC_API void metric__record_time(metric_t self, double s);
+
+//! @brief Aggregates every thread's values and appends them in a text exposition format
+PUBLIC_API void metrics__snapshot(str_builder_t* str_builder);
+
+/**
+ * @brief Serves metrics__snapshot to every client that connects to the unix domain socket at 'path' from a background thread
+ * @note The socket file is removed and recreated
+*/
+PUBLIC_API bool metrics__serve_unix(const char* path);
+//! @brief Same as metrics__serve_unix, but on a tcp port bound to the loopback interface
+PUBLIC_API bool metrics__serve_tcp(uint16_t port);
+
+#endif // METRICS_H
@@ -0,0 +1,121 @@
+struct         metrics;
+struct         metrics_thread;
+typedef struct metrics        metrics_t;
+typedef struct metrics_thread metrics_thread_t;
+
+# define METRIC_NAME_SIZE 64
+
+/**
+ * Every thread that writes a metric owns one of these, so writes never contend,
+ * readers walk the list and aggregate
+ * @note Blocks are never freed until metrics__deinit_module, so values of exited threads stay visible
+*/
+struct metrics_thread {
+    uint64_t          counters[METRICS_SIZE];
+    histogram_t*      histograms[METRICS_SIZE];
+    metrics_thread_t* next;
+};
+
+struct metrics {
+    char              names[METRICS_SIZE][METRIC_NAME_SIZE];
+    metric_type_t     types[METRICS_SIZE];
+    // note: bit pattern of the double value
+    uint64_t          gauges[METRICS_SIZE];
+    uint32_t          metrics_top;
+    metrics_thread_t* threads;
+    mutex_t           register_mutex;
+
+    int32_t           exporter_fd;
+    char              exporter_path[108];
+    thread_t          exporter_thread;
+};
+
+static metrics_t metrics;
+static __thread metrics_thread_t* metrics_thread;
+
+static metrics_thread_t* metrics__ensure_thread();
+static const char* metric_type__to_str(metric_type_t type);
+static void metrics__exporter_worker(void* user_data);
+static bool metrics__serve(int32_t listen_fd);
+
+static metrics_thread_t* metrics__ensure_thread() {
+    if (metrics_thread) {
+        return metrics_thread;
+    }
+
+    metrics_thread_t* result = memory__calloc(DEBUG_MODULE_COMMON, 1, sizeof(*result));
+    if (!result) {
+        return 0;
+    }
+
+    result->next = __atomic_load_n(&metrics.threads, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&metrics.threads, &result->next, result, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+    }
+    metrics_thread = result;
+
+    return result;
+}
+
+static const char* metric_type__to_str(metric_type_t type) {
+    switch (type) {
+    case METRIC_TYPE_COUNTER:   return "counter";
+    case METRIC_TYPE_GAUGE:     return "gauge";
+    case METRIC_TYPE_HISTOGRAM: return "summary";
+    default: assert(false);
+    }
+
+    return 0;
+}
+
+static void metrics__exporter_worker(void* user_data) {
+    const int32_t listen_fd = (int32_t) (intptr_t) user_data;
+
+    str_builder_t str_builder;
+    str_builder__create(&str_builder);
+    while (true) {
+        int32_t client_fd = accept(listen_fd, 0, 0);
+        if (client_fd == -1) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue ;
+            }
+            // note: listening socket was shut down
+            break ;
+        }
+
+        str_builder__clear(&str_builder);
+        metrics__snapshot(&str_builder);
+
+        const char* snapshot = str_builder__str(&str_builder);
+        size_t snapshot_len = str_builder__len(&str_builder);
+        while (snapshot_len > 0) {
+            ssize_t bytes_written = send(client_fd, snapshot, snapshot_len, MSG_NOSIGNAL);
+            if (bytes_written <= 0) {
+                break ;
+            }
+            snapshot     += bytes_written;
+            snapshot_len -= bytes_written;
+        }
+
+        close(client_fd);
+    }
+    str_builder__destroy(&str_builder);
+}
+
+static bool metrics__serve(int32_t listen_fd) {
+    if (listen(listen_fd, 8) == -1) {
+        close(listen_fd);
+        return false;
+    }
+
+    thread_t exporter_thread = thread__create(&metrics__exporter_worker, (void*) (intptr_t) listen_fd);
+    if (!exporter_thread) {
+        close(listen_fd);
+        return false;
+    }
+
+    metrics.exporter_fd     = listen_fd;
+    metrics.exporter_thread = exporter_thread;
+    thread__start_execution(exporter_thread);
+
+    return true;
+}
@@ -0,0 +1,63 @@
+#include "spsc_queue.h"
+
+#include "memory.h"
+
+#include <string.h>
+
+bool spsc_queue__create(spsc_queue_t* self, uint32_t element_size, uint32_t elements_size) {
+    memset(self, 0, sizeof(*self));
+    if (element_size == 0 || elements_size == 0 || (1u << 31) < elements_size) {
+        return false;
+    }
+
+    uint32_t elements_size_pow2 = 1;
+    while (elements_size_pow2 < elements_size) {
+        elements_size_pow2 <<= 1;
+    }
+
+    self->elements = memory__malloc(DEBUG_MODULE_COMMON, (uint64_t) element_size * elements_size_pow2);
+    if (!self->elements) {
+        return false;
+    }
+    self->element_size  = element_size;
+    self->elements_size = elements_size_pow2;
+
+    return true;
+}
+
+void spsc_queue__destroy(spsc_queue_t* self) {
+    memory__free(DEBUG_MODULE_COMMON, self->elements);
+    self->elements = 0;
+}
+
+void* spsc_queue__reserve(spsc_queue_t* self) {
+    if (self->head - self->tail_cached == self->elements_size) {
+        // note: acquire, so the consumer is done reading the slot before it's overwritten
+        self->tail_cached = __atomic_load_n(&self->tail, __ATOMIC_ACQUIRE);
+        if (self->head - self->tail_cached == self->elements_size) {
+            return 0;
+        }
+    }
+
+    return self->elements + (uint64_t) (self->head & (self->elements_size - 1)) * self->element_size;
+}
+
+void spsc_queue__push(spsc_queue_t* self) {
+    // note: release, so the element is visible before the index that publishes it
+    __atomic_store_n(&self->head, self->head + 1, __ATOMIC_RELEASE);
+}
+
+void* spsc_queue__front(spsc_queue_t* self) {
+    if (self->tail == self->head_cached) {
+        self->head_cached = __atomic_load_n(&self->head, __ATOMIC_ACQUIRE);
+        if (self->tail == self->head_cached) {
+            return 0;
+        }
+    }
+
+    return self->elements + (uint64_t) (self->tail & (self->elements_size - 1)) * self->element_size;
+}
+
+void spsc_queue__pop(spsc_queue_t* self) {
+    __atomic_store_n(&self->tail, self->tail + 1, __ATOMIC_RELEASE);
+}
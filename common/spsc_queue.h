@@ -0,0 +1,53 @@
+#ifndef SPSC_QUEUE_H
+# define SPSC_QUEUE_H
+
+# include <stdint.h>
+# include <stdbool.h>
+
+# include "helper_macros.h"
+
+struct         spsc_queue;
+typedef struct spsc_queue spsc_queue_t;
+
+/**
+ * Lock-free bounded queue of fixed size elements between exactly one producer and one consumer thread
+ * Elements are written and read in place: the producer reserves a slot, fills it and pushes it,
+ * the consumer peeks at the front, reads it and pops it, so nothing is copied twice
+ * Each side caches the index of the other side and only reloads it when the queue looks full or empty,
+ * so the shared cache lines bounce between the cores once per batch, not once per element
+*/
+# define SPSC_QUEUE_CACHE_LINE_SIZE 64
+
+struct spsc_queue {
+    uint8_t*  elements;
+    uint32_t  element_size;
+    //! @note Power of two
+    uint32_t  elements_size;
+    uint8_t   _padding0[SPSC_QUEUE_CACHE_LINE_SIZE - sizeof(uint8_t*) - 2 * sizeof(uint32_t)];
+
+    //! @note Written by the producer only, indices grow forever and wrap around uint32_t
+    uint32_t  head;
+    uint32_t  tail_cached;
+    uint8_t   _padding1[SPSC_QUEUE_CACHE_LINE_SIZE - 2 * sizeof(uint32_t)];
+
+    //! @note Written by the consumer only
+    uint32_t  tail;
+    uint32_t  head_cached;
+    uint8_t   _padding2[SPSC_QUEUE_CACHE_LINE_SIZE - 2 * sizeof(uint32_t)];
+};
+
+//! @param elements_size rounded up to a power of two
+PUBLIC_API bool spsc_queue__create(spsc_queue_t* self, uint32_t element_size, uint32_t elements_size);
+PUBLIC_API void spsc_queue__destroy(spsc_queue_t* self);
+
+//! @note Producer only
+//! @returns Slot of the next element, published by spsc_queue__push, 0 if the queue is full
+PUBLIC_API void* spsc_queue__reserve(spsc_queue_t* self);
+PUBLIC_API void spsc_queue__push(spsc_queue_t* self);
+
+//! @note Consumer only
+//! @returns Oldest element, it stays valid until spsc_queue__pop, 0 if the queue is empty
+PUBLIC_API void* spsc_queue__front(spsc_queue_t* self);
+PUBLIC_API void spsc_queue__pop(spsc_queue_t* self);
+
+#endif // SPSC_QUEUE_H
@@ -1,5 +1,7 @@
 #include "str_builder.h"
 
+#include "memory.h"
+
 #include <assert.h>
 #include <stdio.h>
 #include <string.h>
@@ -38,7 +40,7 @@ static size_t str_builder__ensure_size_left(str_builder_t* self, size_t bytes_to
         }
 
         const size_t old_cur = self->cur - self->start;
-        self->start = realloc(self->start, new_size);
+        self->start = memory__realloc(DEBUG_MODULE_COMMON, self->start, new_size);
         self->end   = self->start + new_size;
         self->cur   = self->start + old_cur;
     }
@@ -57,7 +59,7 @@ void str_builder__create_static(str_builder_t* self, void* memory, size_t memory
 
 void str_builder__create(str_builder_t* self) {
     const size_t memory_size = 1;
-    self->start     = malloc(memory_size);
+    self->start     = memory__malloc(DEBUG_MODULE_COMMON, memory_size);
     self->cur       = self->start;
     self->end       = self->start + memory_size;
     self->is_static = 0;
@@ -67,7 +69,7 @@ void str_builder__create(str_builder_t* self) {
 
 void str_builder__destroy(str_builder_t* self) {
     assert(!self->is_static);
-    free(self->start);
+    memory__free(DEBUG_MODULE_COMMON, self->start);
 }
 
 size_t str_builder__prepend(str_builder_t* self, const void* in, size_t in_size) {
@@ -86,3 +86,7 @@ void system__usleep(double us) {
 double system__get_time() {
     return system__platform_get_tick() * g_tick_resolution - g_time_at_start;
 }
+
+double system__get_time_from_platform_ns(uint64_t platform_ns) {
+    return platform_ns / 1000000000.0 - g_time_at_start;
+}
@@ -13,4 +13,8 @@ PUBLIC_API void system__usleep(double us);
 // @returns returns time in seconds since system__init was called
 PUBLIC_API double system__get_time();
 
+// @returns time in seconds since system__init was called of a timestamp taken from the clock system__get_time is based on
+// @note On linux this is CLOCK_REALTIME, which is what kernel socket timestamps use
+PUBLIC_API double system__get_time_from_platform_ns(uint64_t platform_ns);
+
 #endif // SYSTEM_H
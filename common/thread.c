@@ -1,6 +1,12 @@
+// note: for pthread_setaffinity_np and the CPU_* macros
+#define _GNU_SOURCE
+
 #include "thread.h"
 
+#include "memory.h"
+
 #include <pthread.h>
+#include <sched.h>
 #include <stdlib.h>
 
 struct mutex {
@@ -34,23 +40,22 @@ thread_t thread__create(
     void (*worker_fn)(void* user_data),
     void* user_data
 ) {
-    thread_t result = calloc(1, sizeof(*result));
+    thread_t result = memory__calloc(DEBUG_MODULE_COMMON, 1, sizeof(*result));
     result->user_data.user_data = user_data;
     result->user_data.worker_fn = worker_fn;
     result->mutex_start_execution = mutex__create();
     mutex__lock(result->mutex_start_execution);
     if (pthread_create(&result->_, 0, &thread__execute_worker_fn, result) != 0) {
-        free(result);
+        memory__free(DEBUG_MODULE_COMMON, result);
         return 0;
     }
     return result;
 }
 
 void thread__destroy(thread_t self) {
-    pthread_join(self->_, 0);
     thread__wait_execution(self);
     mutex__destroy(self->mutex_start_execution);
-    free(self);
+    memory__free(DEBUG_MODULE_COMMON, self);
 }
 
 void thread__start_execution(thread_t self) {
@@ -69,11 +74,56 @@ void thread__test_cancel() {
     pthread_testcancel();
 }
 
+uint32_t thread__cores_size() {
+    cpu_set_t cpu_set;
+    if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+        return 1;
+    }
+    const int32_t result = CPU_COUNT(&cpu_set);
+
+    return result < 1 ? 1 : (uint32_t) result;
+}
+
+uint32_t thread__cores(uint32_t* cpus, uint32_t cpus_size) {
+    cpu_set_t cpu_set_allowed;
+    if (sched_getaffinity(0, sizeof(cpu_set_allowed), &cpu_set_allowed) != 0) {
+        return 0;
+    }
+
+    // note: the allowed cores aren't necessarily the first ones, for example in a container
+    uint32_t cores_size = 0;
+    for (uint32_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &cpu_set_allowed)) {
+            continue ;
+        }
+        if (cores_size < cpus_size) {
+            cpus[cores_size] = cpu;
+        }
+        ++cores_size;
+    }
+
+    return cores_size;
+}
+
+bool thread__pin_current(uint32_t core) {
+    uint32_t cpus[CPU_SETSIZE];
+    const uint32_t cores_size = thread__cores(cpus, CPU_SETSIZE);
+    if (cores_size == 0) {
+        return false;
+    }
+
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpus[core % cores_size], &cpu_set);
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+}
+
 mutex_t mutex__create() {
-    mutex_t result = calloc(1, sizeof(*result));
+    mutex_t result = memory__calloc(DEBUG_MODULE_COMMON, 1, sizeof(*result));
 
     if (pthread_mutex_init(&result->_, 0) != 0) {
-        free(result);
+        memory__free(DEBUG_MODULE_COMMON, result);
         return 0;
     }
 
@@ -2,6 +2,7 @@
 # define THREAD_H
 
 # include <stdint.h>
+# include <stdbool.h>
 
 struct         thread;
 struct         mutex;
@@ -21,6 +22,21 @@ void thread__wait_execution(thread_t self);
 void thread__cancel_execution(thread_t self);
 void thread__test_cancel();
 
+//! @returns Number of cores the process may run on
+uint32_t thread__cores_size();
+/**
+ * @brief Lists the cores the process may run on, in the order thread__pin_current indexes them
+ * @param cpus filled with the cpu numbers of the first 'cpus_size' of them
+ * @returns Number of cores the process may run on, 0 if the platform doesn't support it
+*/
+uint32_t thread__cores(uint32_t* cpus, uint32_t cpus_size);
+/**
+ * @brief Pins the calling thread to a single core, the scheduler no longer moves it, so it keeps its caches warm
+ * @param core index into the cores the process may run on, see thread__cores, modulo their number
+ * @returns false if the platform doesn't support it
+*/
+bool thread__pin_current(uint32_t core);
+
 mutex_t mutex__create();
 void mutex__destroy(mutex_t self);
 
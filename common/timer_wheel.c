@@ -0,0 +1,173 @@
+#include "timer_wheel.h"
+
+#include <assert.h>
+#include <string.h>
+#include <math.h>
+
+static uint64_t timer_wheel__time_to_tick(timer_wheel_t* self, double time);
+static void timer_wheel__link(timer_wheel_t* self, timer_wheel_timer_t* timer);
+static void timer_wheel__unlink(timer_wheel_t* self, timer_wheel_timer_t* timer);
+static void timer_wheel__cascade(timer_wheel_t* self, uint32_t level);
+
+static uint64_t timer_wheel__time_to_tick(timer_wheel_t* self, double time) {
+    const double ticks = (time - self->time_start) / self->tick_duration;
+    return ticks > 0.0 ? (uint64_t) ticks : 0;
+}
+
+static void timer_wheel__link(timer_wheel_t* self, timer_wheel_timer_t* timer) {
+    const uint64_t tick_expire = timer->tick_expire;
+
+    // note: the level is the highest group of bits in which the expiry differs from the current tick
+    uint32_t level = 0;
+    const uint64_t tick_diff = tick_expire ^ self->tick_current;
+    while (level < TIMER_WHEEL_LEVELS_SIZE && (tick_diff >> (TIMER_WHEEL_LEVEL_BITS * (level + 1))) != 0) {
+        ++level;
+    }
+
+    uint32_t slot = 0;
+    if (level == TIMER_WHEEL_LEVELS_SIZE) {
+        level = TIMER_WHEEL_LEVELS_SIZE - 1;
+        const uint64_t ticks_range = (uint64_t) 1 << (TIMER_WHEEL_LEVEL_BITS * TIMER_WHEEL_LEVELS_SIZE);
+        if (tick_expire - self->tick_current < ticks_range) {
+            // note: in range, but past the wrap of the last level, its slot is only cascaded again after the wrap
+            slot = (tick_expire >> (TIMER_WHEEL_LEVEL_BITS * level)) & (TIMER_WHEEL_LEVEL_SIZE - 1);
+        } else {
+            // note: out of range, park it in the slot of the last level that is cascaded last and relink from there
+            slot = ((self->tick_current >> (TIMER_WHEEL_LEVEL_BITS * level)) - 1) & (TIMER_WHEEL_LEVEL_SIZE - 1);
+        }
+    } else {
+        slot = (tick_expire >> (TIMER_WHEEL_LEVEL_BITS * level)) & (TIMER_WHEEL_LEVEL_SIZE - 1);
+    }
+
+    timer_wheel_timer_t** head = &self->slots[level][slot];
+    timer->prev = 0;
+    timer->next = *head;
+    if (*head) {
+        (*head)->prev = timer;
+    }
+    *head = timer;
+    timer->slot_index = level * TIMER_WHEEL_LEVEL_SIZE + slot;
+    self->slots_occupied[level] |= (uint64_t) 1 << slot;
+}
+
+static void timer_wheel__unlink(timer_wheel_t* self, timer_wheel_timer_t* timer) {
+    assert(timer->slot_index != TIMER_WHEEL_SLOT_NONE);
+    const uint32_t level = timer->slot_index / TIMER_WHEEL_LEVEL_SIZE;
+    const uint32_t slot  = timer->slot_index % TIMER_WHEEL_LEVEL_SIZE;
+
+    if (timer->prev) {
+        timer->prev->next = timer->next;
+    } else {
+        self->slots[level][slot] = timer->next;
+        if (!timer->next) {
+            self->slots_occupied[level] &= ~((uint64_t) 1 << slot);
+        }
+    }
+    if (timer->next) {
+        timer->next->prev = timer->prev;
+    }
+
+    timer->next = 0;
+    timer->prev = 0;
+    timer->slot_index = TIMER_WHEEL_SLOT_NONE;
+}
+
+static void timer_wheel__cascade(timer_wheel_t* self, uint32_t level) {
+    const uint32_t slot = (self->tick_current >> (TIMER_WHEEL_LEVEL_BITS * level)) & (TIMER_WHEEL_LEVEL_SIZE - 1);
+    if (!(self->slots_occupied[level] & ((uint64_t) 1 << slot))) {
+        return ;
+    }
+
+    timer_wheel_timer_t* timer = self->slots[level][slot];
+    self->slots[level][slot] = 0;
+    self->slots_occupied[level] &= ~((uint64_t) 1 << slot);
+    while (timer) {
+        timer_wheel_timer_t* next = timer->next;
+        timer_wheel__link(self, timer);
+        timer = next;
+    }
+}
+
+void timer_wheel__create(timer_wheel_t* self, double time, double tick_duration) {
+    assert(tick_duration > 0.0);
+    memset(self, 0, sizeof(*self));
+    self->time_start    = time;
+    self->tick_duration = tick_duration;
+}
+
+void timer_wheel_timer__create(timer_wheel_timer_t* self, void (*timer__expire)(timer_wheel_timer_t* self, void* user_data)) {
+    memset(self, 0, sizeof(*self));
+    self->slot_index    = TIMER_WHEEL_SLOT_NONE;
+    self->timer__expire = timer__expire;
+}
+
+bool timer_wheel_timer__is_scheduled(timer_wheel_timer_t* self) {
+    return self->slot_index != TIMER_WHEEL_SLOT_NONE;
+}
+
+void timer_wheel__schedule(timer_wheel_t* self, timer_wheel_timer_t* timer, double time_expire) {
+    if (timer_wheel_timer__is_scheduled(timer)) {
+        timer_wheel__unlink(self, timer);
+    } else {
+        ++self->timers_scheduled;
+    }
+
+    // note: round up, so it never expires early
+    const double ticks = ceil((time_expire - self->time_start) / self->tick_duration);
+    timer->tick_expire = ticks > 0.0 ? (uint64_t) ticks : 0;
+    // note: due timers go into the next tick, the current one has already been processed
+    if (timer->tick_expire <= self->tick_current) {
+        timer->tick_expire = self->tick_current + 1;
+    }
+    timer_wheel__link(self, timer);
+}
+
+void timer_wheel__cancel(timer_wheel_t* self, timer_wheel_timer_t* timer) {
+    if (!timer_wheel_timer__is_scheduled(timer)) {
+        return ;
+    }
+
+    timer_wheel__unlink(self, timer);
+    assert(self->timers_scheduled > 0);
+    --self->timers_scheduled;
+}
+
+uint32_t timer_wheel__advance(timer_wheel_t* self, double time, void* user_data) {
+    const uint64_t tick_target = timer_wheel__time_to_tick(self, time);
+    uint32_t timers_expired = 0;
+    while (self->tick_current < tick_target) {
+        if (self->timers_scheduled == 0) {
+            self->tick_current = tick_target;
+            break ;
+        }
+
+        ++self->tick_current;
+
+        // note: higher levels first, so timers can cascade down multiple levels in the same tick
+        for (uint32_t level = TIMER_WHEEL_LEVELS_SIZE - 1; level > 0; --level) {
+            const uint64_t level_mask = ((uint64_t) 1 << (TIMER_WHEEL_LEVEL_BITS * level)) - 1;
+            if ((self->tick_current & level_mask) == 0) {
+                timer_wheel__cascade(self, level);
+            }
+        }
+
+        const uint32_t slot = self->tick_current & (TIMER_WHEEL_LEVEL_SIZE - 1);
+        while (self->slots[0][slot]) {
+            timer_wheel_timer_t* timer = self->slots[0][slot];
+            assert(timer->tick_expire <= self->tick_current);
+            timer_wheel__cancel(self, timer);
+            ++timers_expired;
+            timer->timer__expire(timer, user_data);
+        }
+    }
+
+    return timers_expired;
+}
+
+uint32_t timer_wheel__size(timer_wheel_t* self) {
+    return self->timers_scheduled;
+}
+
+double timer_wheel__time(timer_wheel_t* self) {
+    return self->time_start + (double) self->tick_current * self->tick_duration;
+}
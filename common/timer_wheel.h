@@ -0,0 +1,69 @@
+#ifndef TIMER_WHEEL_H
+# define TIMER_WHEEL_H
+
+# include <stdint.h>
+# include <stdbool.h>
+
+struct         timer_wheel;
+struct         timer_wheel_timer;
+typedef struct timer_wheel       timer_wheel_t;
+typedef struct timer_wheel_timer timer_wheel_timer_t;
+
+# define TIMER_WHEEL_LEVEL_BITS  6
+# define TIMER_WHEEL_LEVEL_SIZE  (1 << TIMER_WHEEL_LEVEL_BITS)
+# define TIMER_WHEEL_LEVELS_SIZE 4
+# define TIMER_WHEEL_SLOT_NONE   ((uint32_t) -1)
+
+/**
+ * Intrusive, embed it in the object that owns the timer and recover the owner in the expire callback
+*/
+struct timer_wheel_timer {
+    timer_wheel_timer_t* next;
+    timer_wheel_timer_t* prev;
+    uint64_t             tick_expire;
+    //! @note level * TIMER_WHEEL_LEVEL_SIZE + slot, TIMER_WHEEL_SLOT_NONE if not scheduled
+    uint32_t             slot_index;
+    void                 (*timer__expire)(timer_wheel_timer_t* self, void* user_data);
+};
+
+/**
+ * Hierarchical timing wheel, each level covers TIMER_WHEEL_LEVEL_SIZE times the range of the previous one
+ * Schedule, cancel and reschedule are O(1), advancing costs O(expired timers) plus O(1) per tick elapsed
+ * Timers further than the range of the wheel are parked in the last level and cascaded again until they are in range
+*/
+struct timer_wheel {
+    timer_wheel_timer_t* slots[TIMER_WHEEL_LEVELS_SIZE][TIMER_WHEEL_LEVEL_SIZE];
+    //! @note A bit is set if the slot of that level is non-empty
+    uint64_t             slots_occupied[TIMER_WHEEL_LEVELS_SIZE];
+    uint64_t             tick_current;
+    double               time_start;
+    double               tick_duration;
+    uint32_t             timers_scheduled;
+};
+
+/**
+ * @param time current time, the wheel starts at tick 0 from here
+ * @param tick_duration resolution of the wheel, timers never expire early but can expire up to a tick late
+*/
+void timer_wheel__create(timer_wheel_t* self, double time, double tick_duration);
+
+void timer_wheel_timer__create(timer_wheel_timer_t* self, void (*timer__expire)(timer_wheel_timer_t* self, void* user_data));
+bool timer_wheel_timer__is_scheduled(timer_wheel_timer_t* self);
+
+//! @note Reschedules if already scheduled
+void timer_wheel__schedule(timer_wheel_t* self, timer_wheel_timer_t* timer, double time_expire);
+//! @note Does nothing if not scheduled
+void timer_wheel__cancel(timer_wheel_t* self, timer_wheel_timer_t* timer);
+
+/**
+ * @brief Moves the wheel up to 'time' and calls the expire callback of every timer that expired along the way
+ * @note Callbacks may schedule or cancel any timer, including the one expiring
+ * @returns Number of timers that expired
+*/
+uint32_t timer_wheel__advance(timer_wheel_t* self, double time, void* user_data);
+
+uint32_t timer_wheel__size(timer_wheel_t* self);
+//! @returns Time of the current tick, inside an expire callback it's the time the timer expired at
+double   timer_wheel__time(timer_wheel_t* self);
+
+#endif // TIMER_WHEEL_H
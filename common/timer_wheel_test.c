@@ -0,0 +1,138 @@
+#include "timer_wheel.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stddef.h>
+
+#define TIMERS 4096
+#define TICK   1.0
+// past the range of the wheel, so these get parked and cascaded again
+#define DELAY_FAR 20000000
+
+typedef struct test_timer {
+    timer_wheel_timer_t timer;
+    bool                is_scheduled;
+    double              time_expire;
+    // when it must have expired by, a time in the past is due on the next tick
+    double              time_due;
+} test_timer_t;
+
+static timer_wheel_t wheel;
+static test_timer_t  timers[TIMERS];
+static uint32_t      timers_scheduled;
+static uint32_t      expired;
+static uint32_t      errors;
+
+static double random_delay() {
+    const int kind = rand() % 16;
+    if (kind == 0) {
+        return (double) (rand() % DELAY_FAR);
+    }
+    if (kind < 4) {
+        return -(double) (rand() % 1000) / 100.0;
+    }
+    return (double) (rand() % 30000) / 100.0;
+}
+
+static void schedule(test_timer_t* timer, double time_expire) {
+    const double time_now = timer_wheel__time(&wheel);
+    if (!timer->is_scheduled) {
+        ++timers_scheduled;
+    }
+    timer->is_scheduled = true;
+    timer->time_expire  = time_expire;
+    timer->time_due     = time_expire > time_now ? time_expire : time_now;
+    timer_wheel__schedule(&wheel, &timer->timer, time_expire);
+}
+
+static void cancel(test_timer_t* timer) {
+    if (timer->is_scheduled) {
+        --timers_scheduled;
+    }
+    timer->is_scheduled = false;
+    timer_wheel__cancel(&wheel, &timer->timer);
+}
+
+static void timer__expire(timer_wheel_timer_t* timer, void* user_data) {
+    (void) user_data;
+    test_timer_t* test_timer = (test_timer_t*) ((char*) timer - offsetof(test_timer_t, timer));
+    const double time_now = timer_wheel__time(&wheel);
+    ++expired;
+    // never early, at most a tick late
+    if (!test_timer->is_scheduled || time_now < test_timer->time_expire || time_now - test_timer->time_due > TICK + 1e-6) {
+        printf("expired wrong, expire: %.3f, due: %.3f, now: %.3f\n", test_timer->time_expire, test_timer->time_due, time_now);
+        ++errors;
+    }
+    test_timer->is_scheduled = false;
+    --timers_scheduled;
+
+    // from inside the callback: reschedule itself, cancel or schedule another one
+    const int action = rand() % 8;
+    if (action == 0) {
+        schedule(test_timer, time_now + random_delay());
+    } else if (action == 1) {
+        cancel(&timers[rand() % TIMERS]);
+    } else if (action == 2) {
+        schedule(&timers[rand() % TIMERS], time_now + random_delay());
+    }
+}
+
+static void check() {
+    const double time_now = timer_wheel__time(&wheel);
+    if (timer_wheel__size(&wheel) != timers_scheduled) {
+        printf("size: %u, expected: %u\n", timer_wheel__size(&wheel), timers_scheduled);
+        ++errors;
+    }
+    for (uint32_t timer_index = 0; timer_index < TIMERS; ++timer_index) {
+        test_timer_t* timer = &timers[timer_index];
+        if (timer->is_scheduled != timer_wheel_timer__is_scheduled(&timer->timer)) {
+            printf("timer %u, scheduled: %d, in the wheel: %d\n", timer_index, timer->is_scheduled, timer_wheel_timer__is_scheduled(&timer->timer));
+            ++errors;
+        } else if (timer->is_scheduled && timer->time_due + TICK <= time_now - 1e-6) {
+            printf("timer %u missed, due: %.3f, now: %.3f\n", timer_index, timer->time_due, time_now);
+            ++errors;
+        }
+    }
+}
+
+int main() {
+    double time = 100.25;
+    timer_wheel__create(&wheel, time, TICK);
+    for (uint32_t timer_index = 0; timer_index < TIMERS; ++timer_index) {
+        timer_wheel_timer__create(&timers[timer_index].timer, &timer__expire);
+    }
+
+    srand(1);
+    for (uint32_t step = 0; step < 200000; ++step) {
+        test_timer_t* timer = &timers[rand() % TIMERS];
+        const int action = rand() % 8;
+        if (action < 5) {
+            schedule(timer, time + random_delay());
+        } else if (action == 5) {
+            cancel(timer);
+        }
+
+        // mostly around a tick, sometimes far enough to cascade every level
+        const int advance = rand() % 64;
+        if (advance == 0) {
+            time += (double) (rand() % 20000);
+        } else if (advance < 16) {
+            time += (double) (rand() % 5000) / 10.0;
+        } else {
+            time += (double) (rand() % 150) / 100.0;
+        }
+        timer_wheel__advance(&wheel, time, NULL);
+        if (step % 64 == 0) {
+            check();
+        }
+    }
+
+    time += (double) DELAY_FAR + 1000.0;
+    timer_wheel__advance(&wheel, time, NULL);
+    check();
+
+    printf("expired: %u, scheduled: %u, errors: %u\n", expired, timers_scheduled, errors);
+
+    return errors == 0 ? 0 : 1;
+}
@@ -2,6 +2,7 @@
 
 #include "str_builder.h"
 #include "helper_macros.h"
+#include "memory.h"
 
 #include <string.h>
 #include <stdio.h>
@@ -143,3 +144,20 @@ bool debug__get_message_module_availability(debug_module_t module) {
     ASSERT(module < _DEBUG_MODULE_SIZE);
     return debug.modules[module].available;
 }
+
+void debug__write_memory_stats(double time_elapsed) {
+    for (uint32_t module_index = 0; module_index < _DEBUG_MODULE_SIZE; ++module_index) {
+        memory_stats_t memory_stats;
+        if (!memory__get_stats((debug_module_t) module_index, &memory_stats) || memory_stats.allocations == 0) {
+            continue ;
+        }
+
+        const uint64_t allocated_bytes = memory_stats.allocated_bytes - debug.allocated_bytes_prev[module_index];
+        debug.allocated_bytes_prev[module_index] = memory_stats.allocated_bytes;
+        debug__writeln(
+            "    %-20s live: %10lluB, peak: %10lluB, rate: %12.1lfB/s, allocations: %llu, frees: %llu",
+            debug_module__to_str((debug_module_t) module_index), (unsigned long long) memory_stats.live_bytes, (unsigned long long) memory_stats.peak_bytes,
+            time_elapsed > 0.0 ? allocated_bytes / time_elapsed : 0.0, (unsigned long long) memory_stats.allocations, (unsigned long long) memory_stats.frees
+        );
+    }
+}
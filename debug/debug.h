@@ -8,6 +8,7 @@
 
 # include "thread.h"
 # include "helper_macros.h"
+# include "debug_module.h"
 
 // todo: turn some of the message types that are resource-intensitve into compile-time api
 
@@ -29,18 +30,6 @@ typedef enum debug_message_type {
     _DEBUG_MESSAGE_TYPE_SIZE
 } debug_message_type_t;
 
-typedef enum debug_module {
-    DEBUG_MODULE_APP,
-    DEBUG_MODULE_GFX,
-    DEBUG_MODULE_GL,
-    DEBUG_MODULE_VULKAN,
-    DEBUG_MODULE_GAME,
-    DEBUG_MODULE_GAME_SERVER,
-    DEBUG_MODULE_GAME_CLIENT,
-
-    _DEBUG_MODULE_SIZE
-} debug_module_t;
-
 /**
  * @brief Call before non-atomic operations
 */
@@ -67,4 +56,11 @@ PUBLIC_API void debug__set_message_module_availability(debug_module_t module, bo
 //! @note Atomic
 PUBLIC_API bool debug__get_message_module_availability(debug_module_t module);
 
+/**
+ * @brief Writes live/peak bytes and the allocation rate since the previous call of every module that allocated
+ * @note Non-atomic
+ * @note Writes nothing if memory tracking is compiled out
+*/
+PUBLIC_API void debug__write_memory_stats(double time_elapsed);
+
 #endif // DEBUG_H
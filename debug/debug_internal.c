@@ -10,6 +10,8 @@ typedef struct debug {
     FILE*    error_file;
 
     mutex_t  write_mutex;
+
+    uint64_t allocated_bytes_prev[_DEBUG_MODULE_SIZE];
 } debug_t;
 
 static debug_t debug;
@@ -41,6 +43,9 @@ static const char* debug_module__to_str(debug_module_t module) {
     case DEBUG_MODULE_GAME:        return "game";
     case DEBUG_MODULE_GAME_SERVER: return "game server";
     case DEBUG_MODULE_GAME_CLIENT: return "game client";
+    case DEBUG_MODULE_GAME_BOT:    return "game bot";
+    case DEBUG_MODULE_COMMON:      return "common";
+    case DEBUG_MODULE_TP:          return "transport protocol";
     default: ASSERT(false);
     }
 
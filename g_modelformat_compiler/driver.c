@@ -8,6 +8,7 @@
 #include "file.h"
 #include "str_builder.h"
 #include "helper_macros.h"
+#include "memory.h"
 
 static int compile_or_decompile_file(const char* dst_path, const char* src_path, str_builder_t (*compiler)(const char* source, size_t source_len, int* result));
 
@@ -22,11 +23,11 @@ static int compile_or_decompile_file(const char* dst_path, const char* src_path,
         return 1;
     }
 
-    char* src_buffer = malloc(src_file_size + 1);
+    char* src_buffer = memory__malloc(DEBUG_MODULE_APP, src_file_size + 1);
     size_t bytes_read = 0;
     if (!file__read(&src_file, src_buffer, src_file_size, &bytes_read)) {
         file__close(&src_file);
-        free(src_buffer);
+        memory__free(DEBUG_MODULE_APP, src_buffer);
         return 1;
     }
     assert(bytes_read <= src_file_size);
@@ -35,7 +36,7 @@ static int compile_or_decompile_file(const char* dst_path, const char* src_path,
     file_t dst_file;
     if (!file__open(&dst_file, dst_path, FILE_ACCESS_MODE_WRITE, FILE_CREATION_MODE_CREATE)) {
         file__close(&src_file);
-        free(src_buffer);
+        memory__free(DEBUG_MODULE_APP, src_buffer);
         return 1;
     }
 
@@ -45,7 +46,7 @@ static int compile_or_decompile_file(const char* dst_path, const char* src_path,
 
     file__close(&dst_file);
     file__close(&src_file);
-    free(src_buffer);
+    memory__free(DEBUG_MODULE_APP, src_buffer);
     str_builder__destroy(&str);
 
     return result;
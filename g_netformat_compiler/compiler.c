@@ -0,0 +1,43 @@
+#include "compiler.h"
+
+#include "helper_macros.h"
+#include "memory.h"
+#include "scan.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "compiler_impl.c"
+
+int compile(const char* ascii_source, size_t ascii_source_len, const char* name, str_builder_t* header, str_builder_t* implementation) {
+    compiler_t* compiler = memory__calloc(DEBUG_MODULE_APP, 1, sizeof(*compiler));
+    if (!compiler) {
+        return 1;
+    }
+
+    compiler__create(compiler, ascii_source, ascii_source_len, name, header, implementation);
+    compiler__eat(compiler);
+
+    while (
+        !compiler__is_at_end(compiler) &&
+        !compiler->panic
+    ) {
+        compiler__compile_declaration(compiler);
+    }
+
+    if (!compiler->panic) {
+        compiler__emit_header(compiler);
+        compiler__emit_implementation(compiler);
+    }
+
+    const int result = compiler->panic ? 1 : 0;
+    memory__free(DEBUG_MODULE_APP, compiler);
+
+    return result;
+}
@@ -0,0 +1,13 @@
+#ifndef COMPILER_H
+# define COMPILER_H
+
+# include "str_builder.h"
+
+/**
+ * @brief Compiles a message schema into a C header and its implementation with bit-packing read/write functions
+ * @param name name of the generated files without extension, used for the include guard and the include of the header
+ * @returns 0 on success, errors are written to stderr
+*/
+int compile(const char* ascii_source, size_t ascii_source_len, const char* name, str_builder_t* header, str_builder_t* implementation);
+
+#endif // COMPILER_H
@@ -0,0 +1,1313 @@
+struct         compiler;
+struct         declaration;
+struct         field;
+struct         field_type;
+enum           declaration_kind;
+enum           field_type_kind;
+
+typedef struct compiler         compiler_t;
+typedef struct declaration      declaration_t;
+typedef struct field            field_t;
+typedef struct field_type       field_type_t;
+typedef enum   declaration_kind declaration_kind_t;
+typedef enum   field_type_kind  field_type_kind_t;
+
+# define COMPILER_NAME_SIZE         64
+# define COMPILER_DECLARATIONS_SIZE 128
+# define COMPILER_FIELDS_SIZE       64
+# define COMPILER_ENUM_VALUES_SIZE  64
+//! @note Largest amount of bits a single read or write moves, see netformat_writer__write
+# define COMPILER_FIELD_BITS_MAX    32
+//! @note Quantized floats are computed in float, so the steps have to fit into its mantissa
+# define COMPILER_FLOAT_STEPS_MAX   (1 << 24)
+# define COMPILER_ARRAY_SIZE_MAX    65535
+# define COMPILER_MESSAGE_BITS_MAX  (((uint64_t) 1 << 31) - 1)
+
+enum declaration_kind {
+    DECLARATION_KIND_ENUM,
+    DECLARATION_KIND_MESSAGE
+};
+
+enum field_type_kind {
+    FIELD_TYPE_KIND_BOOL,
+    FIELD_TYPE_KIND_INT,
+    FIELD_TYPE_KIND_FLOAT,
+    FIELD_TYPE_KIND_ENUM,
+    FIELD_TYPE_KIND_MESSAGE
+};
+
+struct field_type {
+    field_type_kind_t kind;
+    //! @note Bits of a single element
+    uint32_t          bits;
+
+    //! FIELD_TYPE_KIND_INT
+    int64_t           int_min;
+    int64_t           int_max;
+
+    //! FIELD_TYPE_KIND_FLOAT
+    double            float_min;
+    double            float_max;
+    uint32_t          float_steps;
+
+    //! FIELD_TYPE_KIND_ENUM and FIELD_TYPE_KIND_MESSAGE
+    uint32_t          declaration_index;
+};
+
+struct field {
+    char         name[COMPILER_NAME_SIZE];
+    field_type_t type;
+    //! @note 0 if the field is not an array
+    uint32_t     array_size;
+    uint64_t     bits_max;
+    uint64_t     delta_bits_max;
+};
+
+struct declaration {
+    declaration_kind_t kind;
+    char               name[COMPILER_NAME_SIZE];
+
+    //! DECLARATION_KIND_ENUM
+    char               values[COMPILER_ENUM_VALUES_SIZE][COMPILER_NAME_SIZE];
+    uint32_t           values_size;
+
+    //! DECLARATION_KIND_MESSAGE
+    field_t            fields[COMPILER_FIELDS_SIZE];
+    uint32_t           fields_size;
+    uint64_t           bits_max;
+    //! @note Can be larger than bits_max, as every field has a bit for whether it changed
+    uint64_t           delta_bits_max;
+};
+
+struct compiler {
+    scanner_t      scanner;
+    token_t        token_cur;
+    token_t        token_prev;
+
+    int panic;
+
+    const char*    name;
+    declaration_t  declarations[COMPILER_DECLARATIONS_SIZE];
+    uint32_t       declarations_size;
+
+    str_builder_t* header;
+    str_builder_t* implementation;
+};
+
+static void compiler__create(compiler_t* self, const char* source, size_t source_len, const char* name, str_builder_t* header, str_builder_t* implementation);
+static int compiler__is_at_end(compiler_t* self);
+static token_t compiler__eat(compiler_t* self);
+static token_t compiler__peak(compiler_t* self);
+static int compiler__eat_err(compiler_t* self, token_type_t token_type, const char* format, ...);
+static int compiler__eat_name_err(compiler_t* self, char* name, const char* format, ...);
+static int compiler__eat_integer_err(compiler_t* self, int64_t* integer, const char* format, ...);
+static int compiler__eat_real_err(compiler_t* self, double* real, const char* format, ...);
+static void compiler__err(compiler_t* self, const char* format, ...);
+static void compiler__verr(compiler_t* self, const char* format, va_list ap);
+
+static declaration_t* compiler__find_declaration(compiler_t* self, const char* name, uint32_t* declaration_index);
+static void compiler__compile_declaration(compiler_t* self);
+static void compiler__compile_enum(compiler_t* self, declaration_t* declaration);
+static void compiler__compile_message(compiler_t* self, declaration_t* declaration);
+static void compiler__compile_field(compiler_t* self, declaration_t* declaration);
+//! @param is_array_allowed arrays can't be nested
+static void compiler__compile_field_type(compiler_t* self, field_t* field, bool is_array_allowed);
+
+static void compiler__emit_header(compiler_t* self);
+static void compiler__emit_implementation(compiler_t* self);
+static void compiler__emit_message_write(compiler_t* self, declaration_t* declaration);
+static void compiler__emit_message_read(compiler_t* self, declaration_t* declaration);
+static void compiler__emit_message_is_changed(compiler_t* self, declaration_t* declaration);
+static void compiler__emit_message_write_delta(compiler_t* self, declaration_t* declaration);
+static void compiler__emit_message_read_delta(compiler_t* self, declaration_t* declaration);
+static void compiler__emit_field_type_is_changed(compiler_t* self, field_type_t* field_type, const char* path, const char* base_path);
+//! @param base_path if not null, the field is written as a delta against it
+static void compiler__emit_field_type_write(compiler_t* self, field_type_t* field_type, const char* path, const char* base_path, const char* indent);
+//! @param base_path if not null, the field is read as a delta against it
+static void compiler__emit_field_type_read(compiler_t* self, field_type_t* field_type, const char* path, const char* base_path, const char* indent);
+
+static uint32_t bits__required(uint64_t value);
+static const char* field_type__c_type(compiler_t* compiler, field_type_t* self, char* buffer, uint32_t buffer_size);
+static const char* field_type__float_scale_literal(field_type_t* self, char* buffer, uint32_t buffer_size);
+//! @brief Float literal that rounds to the same float as 'value', so range checks in float agree with the schema
+static const char* float__to_literal(double value, char* buffer, uint32_t buffer_size);
+static void name__to_upper(const char* name, char* buffer, uint32_t buffer_size);
+static bool name__is_c_keyword(const char* name);
+
+static const char* netformat_runtime =
+    "struct         netformat_writer;\n"
+    "struct         netformat_reader;\n"
+    "typedef struct netformat_writer netformat_writer_t;\n"
+    "typedef struct netformat_reader netformat_reader_t;\n"
+    "\n"
+    "//! @note Fields are appended lsb first into a 64-bit scratch that is stored a 32-bit word at a time\n"
+    "struct netformat_writer {\n"
+    "    uint8_t* cur;\n"
+    "    uint64_t scratch;\n"
+    "    uint32_t scratch_bits;\n"
+    "    bool     error;\n"
+    "};\n"
+    "\n"
+    "struct netformat_reader {\n"
+    "    const uint8_t* cur;\n"
+    "    const uint8_t* end;\n"
+    "    uint64_t       scratch;\n"
+    "    uint32_t       scratch_bits;\n"
+    "    //! @note Past the end zeros are read, this is checked against the size once at the end\n"
+    "    uint64_t       bits_read;\n"
+    "    bool           error;\n"
+    "};\n"
+    "\n"
+    "static inline void netformat_writer__write(netformat_writer_t* self, uint32_t value, uint32_t bits) {\n"
+    "    self->scratch |= ((uint64_t) value & (((uint64_t) 1 << bits) - 1)) << self->scratch_bits;\n"
+    "    self->scratch_bits += bits;\n"
+    "    if (self->scratch_bits >= 32) {\n"
+    "        const uint32_t word = (uint32_t) self->scratch;\n"
+    "        self->cur[0] = (uint8_t) word;\n"
+    "        self->cur[1] = (uint8_t) (word >> 8);\n"
+    "        self->cur[2] = (uint8_t) (word >> 16);\n"
+    "        self->cur[3] = (uint8_t) (word >> 24);\n"
+    "        self->cur += 4;\n"
+    "        self->scratch >>= 32;\n"
+    "        self->scratch_bits -= 32;\n"
+    "    }\n"
+    "}\n"
+    "\n"
+    "static inline void netformat_writer__flush(netformat_writer_t* self) {\n"
+    "    while (self->scratch_bits > 0) {\n"
+    "        *self->cur++ = (uint8_t) self->scratch;\n"
+    "        self->scratch >>= 8;\n"
+    "        self->scratch_bits = self->scratch_bits > 8 ? self->scratch_bits - 8 : 0;\n"
+    "    }\n"
+    "}\n"
+    "\n"
+    "static inline uint32_t netformat_reader__read(netformat_reader_t* self, uint32_t bits) {\n"
+    "    if (self->scratch_bits < bits) {\n"
+    "        uint32_t word = 0;\n"
+    "        if (self->end - self->cur >= 4) {\n"
+    "            word = (uint32_t) self->cur[0] | ((uint32_t) self->cur[1] << 8) | ((uint32_t) self->cur[2] << 16) | ((uint32_t) self->cur[3] << 24);\n"
+    "            self->cur += 4;\n"
+    "        } else {\n"
+    "            for (uint32_t byte_index = 0; self->cur < self->end; ++byte_index) {\n"
+    "                word |= (uint32_t) *self->cur++ << (byte_index << 3);\n"
+    "            }\n"
+    "        }\n"
+    "        self->scratch |= (uint64_t) word << self->scratch_bits;\n"
+    "        self->scratch_bits += 32;\n"
+    "    }\n"
+    "\n"
+    "    const uint32_t value = (uint32_t) (self->scratch & (((uint64_t) 1 << bits) - 1));\n"
+    "    self->scratch >>= bits;\n"
+    "    self->scratch_bits -= bits;\n"
+    "    self->bits_read += bits;\n"
+    "\n"
+    "    return value;\n"
+    "}\n"
+    "\n"
+    "//! @note Out of range values, including NaN, quantize to 0, they are flagged as errors by the caller\n"
+    "static inline uint32_t netformat__quantize(float value, float min, float max, float scale, uint32_t steps) {\n"
+    "    const uint32_t quantized = value >= min && value <= max ? (uint32_t) ((value - min) * scale + 0.5f) : 0;\n"
+    "\n"
+    "    return quantized > steps ? steps : quantized;\n"
+    "}\n"
+    "\n"
+    "static inline float netformat__dequantize(uint32_t quantized, float min, float resolution) {\n"
+    "    return min + (float) quantized * resolution;\n"
+    "}\n";
+
+static void compiler__create(compiler_t* self, const char* source, size_t source_len, const char* name, str_builder_t* header, str_builder_t* implementation) {
+    memset(self, 0, sizeof(*self));
+
+    scanner__create(&self->scanner, source, source_len);
+    self->name           = name;
+    self->header         = header;
+    self->implementation = implementation;
+}
+
+static int compiler__is_at_end(compiler_t* self) {
+    return self->token_cur.type == TOKEN_EOF;
+}
+
+static token_t compiler__eat(compiler_t* self) {
+    self->token_prev = self->token_cur;
+    self->token_cur = scanner__next_token(&self->scanner);
+    while (self->token_cur.type == TOKEN_COMMENT) {
+        self->token_cur = scanner__next_token(&self->scanner);
+    }
+
+    return self->token_prev;
+}
+
+static token_t compiler__peak(compiler_t* self) {
+    return self->token_cur;
+}
+
+static int compiler__eat_err(compiler_t* self, token_type_t token_type, const char* format, ...) {
+    token_t token = compiler__eat(self);
+    if (token.type != token_type) {
+        va_list ap;
+        va_start(ap, format);
+        compiler__verr(self, format, ap);
+        va_end(ap);
+        return 1;
+    }
+
+    return 0;
+}
+
+static int compiler__eat_name_err(compiler_t* self, char* name, const char* format, ...) {
+    token_t token = compiler__eat(self);
+    if (token.type != TOKEN_IDENTIFIER || token.lexeme_len >= COMPILER_NAME_SIZE) {
+        va_list ap;
+        va_start(ap, format);
+        compiler__verr(self, format, ap);
+        va_end(ap);
+        return 1;
+    }
+
+    memcpy(name, token.lexeme, token.lexeme_len);
+    name[token.lexeme_len] = '\0';
+
+    if (name__is_c_keyword(name)) {
+        compiler__err(self, "'%s' is a C keyword, it can't be used as a name", name);
+        return 1;
+    }
+
+    return 0;
+}
+
+static int compiler__eat_integer_err(compiler_t* self, int64_t* integer, const char* format, ...) {
+    token_t token = compiler__eat(self);
+    if (token.type != TOKEN_INTEGER) {
+        va_list ap;
+        va_start(ap, format);
+        compiler__verr(self, format, ap);
+        va_end(ap);
+        return 1;
+    }
+
+    *integer = token__to_s64(&token);
+
+    return 0;
+}
+
+static int compiler__eat_real_err(compiler_t* self, double* real, const char* format, ...) {
+    token_t token = compiler__eat(self);
+    if (token.type != TOKEN_INTEGER && token.type != TOKEN_REAL) {
+        va_list ap;
+        va_start(ap, format);
+        compiler__verr(self, format, ap);
+        va_end(ap);
+        return 1;
+    }
+
+    *real = token__to_r64(&token);
+
+    return 0;
+}
+
+static void compiler__err(compiler_t* self, const char* format, ...) {
+    va_list ap;
+    va_start(ap, format);
+    compiler__verr(self, format, ap);
+    va_end(ap);
+}
+
+static void compiler__verr(compiler_t* self, const char* format, va_list ap) {
+    if (self->panic) {
+        return ;
+    }
+    self->panic = 1;
+
+    const char* line_start = self->token_prev.lexeme;
+    while (line_start > self->scanner.source_start) {
+        if (*(line_start - 1) == '\n') {
+            break ;
+        }
+        --line_start;
+    }
+    const char* line_end = self->token_prev.lexeme;
+    while (line_end < self->scanner.source_end && *line_end != '\n' && *line_end != '\r') {
+        ++line_end;
+    }
+    const char* error_at = self->token_prev.lexeme;
+    fprintf(
+        stderr,
+        "error: %u:%u - %u:%u: ",
+        self->token_prev.line_s, self->token_prev.col_s,
+        self->token_prev.line_e, self->token_prev.col_e
+    );
+    vfprintf(stderr, format, ap);
+    fprintf(stderr, "\n%.*s\n", (uint32_t) (line_end - line_start), line_start);
+    fprintf(stderr, "%*c^\n", (uint32_t) (error_at - line_start), ' ');
+    fflush(stderr);
+}
+
+static declaration_t* compiler__find_declaration(compiler_t* self, const char* name, uint32_t* declaration_index) {
+    for (uint32_t index = 0; index < self->declarations_size; ++index) {
+        if (strcmp(self->declarations[index].name, name) == 0) {
+            if (declaration_index) {
+                *declaration_index = index;
+            }
+            return &self->declarations[index];
+        }
+    }
+
+    return 0;
+}
+
+static void compiler__compile_declaration(compiler_t* self) {
+    if (compiler__eat_err(self, TOKEN_LEFT_PAREN, "expected left paren at the start of a declaration")) {
+        return ;
+    }
+
+    if (self->declarations_size == COMPILER_DECLARATIONS_SIZE) {
+        compiler__err(self, "too many declarations, at most %u are supported", COMPILER_DECLARATIONS_SIZE);
+        return ;
+    }
+    declaration_t* declaration = &self->declarations[self->declarations_size];
+
+    token_t token = compiler__eat(self);
+    if (token__is(&token, "enum")) {
+        declaration->kind = DECLARATION_KIND_ENUM;
+    } else if (token__is(&token, "message")) {
+        declaration->kind = DECLARATION_KIND_MESSAGE;
+    } else {
+        compiler__err(self, "expected 'enum' or 'message'");
+        return ;
+    }
+
+    if (compiler__eat_name_err(self, declaration->name, "expected the name of the declaration, at most %u characters", COMPILER_NAME_SIZE - 1)) {
+        return ;
+    }
+    if (compiler__find_declaration(self, declaration->name, 0)) {
+        compiler__err(self, "'%s' is already declared", declaration->name);
+        return ;
+    }
+
+    switch (declaration->kind) {
+        case DECLARATION_KIND_ENUM:    compiler__compile_enum(self, declaration);    break ;
+        case DECLARATION_KIND_MESSAGE: compiler__compile_message(self, declaration); break ;
+        default: assert(false);
+    }
+    if (self->panic) {
+        return ;
+    }
+
+    if (compiler__eat_err(self, TOKEN_RIGHT_PAREN, "expected right paren at the end of the declaration")) {
+        return ;
+    }
+
+    ++self->declarations_size;
+}
+
+static void compiler__compile_enum(compiler_t* self, declaration_t* declaration) {
+    if (compiler__eat_err(self, TOKEN_LEFT_PAREN, "expected left paren at the start of the enum values")) {
+        return ;
+    }
+
+    while (compiler__peak(self).type == TOKEN_IDENTIFIER) {
+        if (declaration->values_size == COMPILER_ENUM_VALUES_SIZE) {
+            compiler__eat(self);
+            compiler__err(self, "too many enum values, at most %u are supported", COMPILER_ENUM_VALUES_SIZE);
+            return ;
+        }
+        char* value = declaration->values[declaration->values_size];
+        if (compiler__eat_name_err(self, value, "expected enum value, at most %u characters", COMPILER_NAME_SIZE - 1)) {
+            return ;
+        }
+        for (uint32_t value_index = 0; value_index < declaration->values_size; ++value_index) {
+            if (strcmp(declaration->values[value_index], value) == 0) {
+                compiler__err(self, "'%s' is already a value of the enum", value);
+                return ;
+            }
+        }
+        ++declaration->values_size;
+    }
+
+    if (compiler__eat_err(self, TOKEN_RIGHT_PAREN, "expected right paren at the end of the enum values")) {
+        return ;
+    }
+
+    if (declaration->values_size == 0) {
+        compiler__err(self, "enum must have at least one value");
+        return ;
+    }
+}
+
+static void compiler__compile_message(compiler_t* self, declaration_t* declaration) {
+    while (compiler__peak(self).type == TOKEN_LEFT_PAREN && !self->panic) {
+        compiler__compile_field(self, declaration);
+    }
+    if (self->panic) {
+        return ;
+    }
+
+    if (declaration->fields_size == 0) {
+        compiler__err(self, "message must have at least one field");
+        return ;
+    }
+}
+
+static void compiler__compile_field(compiler_t* self, declaration_t* declaration) {
+    compiler__eat(self);
+
+    if (declaration->fields_size == COMPILER_FIELDS_SIZE) {
+        compiler__err(self, "too many fields, at most %u are supported", COMPILER_FIELDS_SIZE);
+        return ;
+    }
+    field_t* field = &declaration->fields[declaration->fields_size];
+
+    if (compiler__eat_name_err(self, field->name, "expected the name of the field, at most %u characters", COMPILER_NAME_SIZE - 1)) {
+        return ;
+    }
+    for (uint32_t field_index = 0; field_index < declaration->fields_size; ++field_index) {
+        if (strcmp(declaration->fields[field_index].name, field->name) == 0) {
+            compiler__err(self, "'%s' is already a field of the message", field->name);
+            return ;
+        }
+    }
+
+    compiler__compile_field_type(self, field, true);
+    if (self->panic) {
+        return ;
+    }
+
+    if (compiler__eat_err(self, TOKEN_RIGHT_PAREN, "expected right paren at the end of the field")) {
+        return ;
+    }
+
+    declaration->bits_max       += field->bits_max;
+    declaration->delta_bits_max += field->delta_bits_max;
+    if (declaration->delta_bits_max > COMPILER_MESSAGE_BITS_MAX) {
+        compiler__err(self, "message is too large, at most %llu bits are supported", (unsigned long long) COMPILER_MESSAGE_BITS_MAX);
+        return ;
+    }
+
+    ++declaration->fields_size;
+}
+
+static void compiler__compile_field_type(compiler_t* self, field_t* field, bool is_array_allowed) {
+    field_type_t* field_type = &field->type;
+
+    if (compiler__eat_err(self, TOKEN_LEFT_PAREN, "expected left paren at the start of the type")) {
+        return ;
+    }
+
+    token_t token = compiler__eat(self);
+    if (token__is(&token, "bool")) {
+        field_type->kind = FIELD_TYPE_KIND_BOOL;
+        field_type->bits = 1;
+    } else if (token__is(&token, "int")) {
+        field_type->kind = FIELD_TYPE_KIND_INT;
+        if (
+            compiler__eat_integer_err(self, &field_type->int_min, "expected the minimum of the int") ||
+            compiler__eat_integer_err(self, &field_type->int_max, "expected the maximum of the int")
+        ) {
+            return ;
+        }
+        if (field_type->int_min > field_type->int_max) {
+            compiler__err(self, "minimum of the int is larger than its maximum");
+            return ;
+        }
+        if (field_type->int_min < INT32_MIN || field_type->int_max > UINT32_MAX || (field_type->int_min < 0 && field_type->int_max > INT32_MAX)) {
+            compiler__err(self, "int range must fit into either int32_t or uint32_t");
+            return ;
+        }
+        field_type->bits = bits__required((uint64_t) (field_type->int_max - field_type->int_min));
+    } else if (token__is(&token, "bits")) {
+        field_type->kind = FIELD_TYPE_KIND_INT;
+        int64_t bits = 0;
+        if (compiler__eat_integer_err(self, &bits, "expected the number of bits")) {
+            return ;
+        }
+        if (bits < 1 || bits > COMPILER_FIELD_BITS_MAX) {
+            compiler__err(self, "number of bits must be in [1, %u]", COMPILER_FIELD_BITS_MAX);
+            return ;
+        }
+        field_type->int_min = 0;
+        field_type->int_max = (int64_t) (((uint64_t) 1 << bits) - 1);
+        field_type->bits    = (uint32_t) bits;
+    } else if (token__is(&token, "float")) {
+        field_type->kind = FIELD_TYPE_KIND_FLOAT;
+        double resolution = 0.0;
+        if (
+            compiler__eat_real_err(self, &field_type->float_min, "expected the minimum of the float") ||
+            compiler__eat_real_err(self, &field_type->float_max, "expected the maximum of the float") ||
+            compiler__eat_real_err(self, &resolution, "expected the resolution of the float")
+        ) {
+            return ;
+        }
+        if (!(field_type->float_min <= field_type->float_max)) {
+            compiler__err(self, "minimum of the float is larger than its maximum");
+            return ;
+        }
+        if (!(resolution > 0.0)) {
+            compiler__err(self, "resolution of the float must be positive");
+            return ;
+        }
+        const double steps = ceil((field_type->float_max - field_type->float_min) / resolution);
+        if (steps > COMPILER_FLOAT_STEPS_MAX) {
+            compiler__err(self, "resolution is too fine for the range, at most %u steps are supported", COMPILER_FLOAT_STEPS_MAX);
+            return ;
+        }
+        field_type->float_steps = (uint32_t) steps;
+        field_type->bits        = bits__required(field_type->float_steps);
+    } else if (token__is(&token, "enum") || token__is(&token, "message")) {
+        const declaration_kind_t kind = token__is(&token, "enum") ? DECLARATION_KIND_ENUM : DECLARATION_KIND_MESSAGE;
+        char name[COMPILER_NAME_SIZE];
+        if (compiler__eat_name_err(self, name, "expected the name of the %s", kind == DECLARATION_KIND_ENUM ? "enum" : "message")) {
+            return ;
+        }
+        declaration_t* declaration = compiler__find_declaration(self, name, &field_type->declaration_index);
+        if (!declaration || declaration->kind != kind) {
+            compiler__err(self, "'%s' is not a declared %s, declarations must come before their use", name, kind == DECLARATION_KIND_ENUM ? "enum" : "message");
+            return ;
+        }
+        if (kind == DECLARATION_KIND_ENUM) {
+            field_type->kind = FIELD_TYPE_KIND_ENUM;
+            field_type->bits = bits__required(declaration->values_size - 1);
+        } else {
+            field_type->kind = FIELD_TYPE_KIND_MESSAGE;
+            // note: not moved in a single read or write, so it's not limited by COMPILER_FIELD_BITS_MAX
+            field->bits_max       = declaration->bits_max;
+            field->delta_bits_max = 1 + declaration->delta_bits_max;
+        }
+    } else if (token__is(&token, "array")) {
+        if (!is_array_allowed) {
+            compiler__err(self, "arrays can't be nested, wrap the inner one into a message");
+            return ;
+        }
+        int64_t array_size = 0;
+        if (compiler__eat_integer_err(self, &array_size, "expected the maximum number of elements of the array")) {
+            return ;
+        }
+        if (array_size < 1 || array_size > COMPILER_ARRAY_SIZE_MAX) {
+            compiler__err(self, "maximum number of elements must be in [1, %u]", COMPILER_ARRAY_SIZE_MAX);
+            return ;
+        }
+        compiler__compile_field_type(self, field, false);
+        if (self->panic) {
+            return ;
+        }
+        field->array_size = (uint32_t) array_size;
+        // note: elements past the fill of the base are written in full, which is never more than their delta
+        field->bits_max       = bits__required(field->array_size) + field->array_size * field->bits_max;
+        field->delta_bits_max = bits__required(field->array_size) + field->array_size * field->delta_bits_max;
+    } else {
+        compiler__err(self, "expected one of the types: bool, int, bits, float, enum, message or array");
+        return ;
+    }
+
+    if (field_type->kind != FIELD_TYPE_KIND_MESSAGE && field->array_size == 0) {
+        field->bits_max = field_type->bits;
+        // note: a bool is sent as whether it flipped, constants are not sent at all
+        if (field_type->kind == FIELD_TYPE_KIND_BOOL) {
+            field->delta_bits_max = 1;
+        } else {
+            field->delta_bits_max = field_type->bits == 0 ? 0 : 1 + field_type->bits;
+        }
+    }
+
+    if (compiler__eat_err(self, TOKEN_RIGHT_PAREN, "expected right paren at the end of the type")) {
+        return ;
+    }
+}
+
+static void compiler__emit_header(compiler_t* self) {
+    str_builder_t* out = self->header;
+    char name_upper[COMPILER_NAME_SIZE];
+    name__to_upper(self->name, name_upper, sizeof(name_upper));
+
+    str_builder__fappend(out, "// generated by g_netformat_compiler, do not edit\n");
+    str_builder__fappend(out, "#ifndef %s_H\n", name_upper);
+    str_builder__fappend(out, "# define %s_H\n\n", name_upper);
+    str_builder__fappend(out, "# include <stdint.h>\n");
+    str_builder__fappend(out, "# include <stdbool.h>\n\n");
+
+    int name_width = 0;
+    for (uint32_t declaration_index = 0; declaration_index < self->declarations_size; ++declaration_index) {
+        declaration_t* declaration = &self->declarations[declaration_index];
+        str_builder__fappend(out, "%-14s %s;\n", declaration->kind == DECLARATION_KIND_ENUM ? "enum" : "struct", declaration->name);
+        name_width = MAX(name_width, (int) strlen(declaration->name));
+    }
+    for (uint32_t declaration_index = 0; declaration_index < self->declarations_size; ++declaration_index) {
+        declaration_t* declaration = &self->declarations[declaration_index];
+        str_builder__fappend(out, "typedef %-6s %-*s %s_t;\n", declaration->kind == DECLARATION_KIND_ENUM ? "enum" : "struct", name_width, declaration->name, declaration->name);
+    }
+
+    for (uint32_t declaration_index = 0; declaration_index < self->declarations_size; ++declaration_index) {
+        declaration_t* declaration = &self->declarations[declaration_index];
+        char declaration_upper[COMPILER_NAME_SIZE];
+        name__to_upper(declaration->name, declaration_upper, sizeof(declaration_upper));
+        str_builder__fappend(out, "\n");
+
+        if (declaration->kind == DECLARATION_KIND_ENUM) {
+            str_builder__fappend(out, "enum %s {\n", declaration->name);
+            for (uint32_t value_index = 0; value_index < declaration->values_size; ++value_index) {
+                char value_upper[COMPILER_NAME_SIZE];
+                name__to_upper(declaration->values[value_index], value_upper, sizeof(value_upper));
+                str_builder__fappend(out, "    %s_%s,\n", declaration_upper, value_upper);
+            }
+            str_builder__fappend(out, "\n    _%s_SIZE\n", declaration_upper);
+            str_builder__fappend(out, "};\n");
+            continue ;
+        }
+
+        str_builder__fappend(out, "# define %s_BITS_MAX %llu\n", declaration_upper, (unsigned long long) declaration->bits_max);
+        str_builder__fappend(out, "# define %s_SIZE_MAX %llu\n", declaration_upper, (unsigned long long) ((declaration->bits_max + 7) >> 3));
+        str_builder__fappend(out, "# define %s_DELTA_BITS_MAX %llu\n", declaration_upper, (unsigned long long) declaration->delta_bits_max);
+        str_builder__fappend(out, "# define %s_DELTA_SIZE_MAX %llu\n", declaration_upper, (unsigned long long) ((declaration->delta_bits_max + 7) >> 3));
+        for (uint32_t field_index = 0; field_index < declaration->fields_size; ++field_index) {
+            field_t* field = &declaration->fields[field_index];
+            if (field->array_size) {
+                char field_upper[COMPILER_NAME_SIZE];
+                name__to_upper(field->name, field_upper, sizeof(field_upper));
+                str_builder__fappend(out, "# define %s_%s_SIZE %u\n", declaration_upper, field_upper, field->array_size);
+            }
+        }
+        str_builder__fappend(out, "\n");
+
+        int c_type_width = (int) strlen("uint32_t");
+        for (uint32_t field_index = 0; field_index < declaration->fields_size; ++field_index) {
+            char c_type[COMPILER_NAME_SIZE + 2];
+            c_type_width = MAX(c_type_width, (int) strlen(field_type__c_type(self, &declaration->fields[field_index].type, c_type, sizeof(c_type))));
+        }
+        str_builder__fappend(out, "struct %s {\n", declaration->name);
+        for (uint32_t field_index = 0; field_index < declaration->fields_size; ++field_index) {
+            field_t* field = &declaration->fields[field_index];
+            char c_type[COMPILER_NAME_SIZE + 2];
+            field_type__c_type(self, &field->type, c_type, sizeof(c_type));
+            if (field->array_size) {
+                char field_upper[COMPILER_NAME_SIZE];
+                name__to_upper(field->name, field_upper, sizeof(field_upper));
+                str_builder__fappend(out, "    %-*s %s[%s_%s_SIZE];\n", c_type_width, c_type, field->name, declaration_upper, field_upper);
+                str_builder__fappend(out, "    %-*s %s_fill;\n", c_type_width, "uint32_t", field->name);
+            } else {
+                str_builder__fappend(out, "    %-*s %s;\n", c_type_width, c_type, field->name);
+            }
+        }
+        str_builder__fappend(out, "};\n\n");
+
+        str_builder__fappend(out, "/**\n");
+        str_builder__fappend(out, " * @brief Bit-packs 'self' into 'buffer'\n");
+        str_builder__fappend(out, " * @returns false if a field is out of its range or 'buffer_size' is less than %s_SIZE_MAX\n", declaration_upper);
+        str_builder__fappend(out, "*/\n");
+        str_builder__fappend(out, "bool %s__write(const %s_t* self, void* buffer, uint32_t buffer_size, uint32_t* bytes_written);\n", declaration->name, declaration->name);
+        str_builder__fappend(out, "/**\n");
+        str_builder__fappend(out, " * @returns false if 'buffer' is truncated or a field is out of its range, the content of 'self' is unspecified then\n");
+        str_builder__fappend(out, "*/\n");
+        str_builder__fappend(out, "bool %s__read(%s_t* self, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read);\n", declaration->name, declaration->name);
+        str_builder__fappend(out, "\n");
+        str_builder__fappend(out, "//! @returns true if 'self' differs from 'base' as sent, so after quantization\n");
+        str_builder__fappend(out, "bool %s__is_changed(const %s_t* self, const %s_t* base);\n", declaration->name, declaration->name, declaration->name);
+        str_builder__fappend(out, "/**\n");
+        str_builder__fappend(out, " * @brief Bit-packs 'self' as a delta against 'base', every field has a bit for whether it changed and only changed fields are sent\n");
+        str_builder__fappend(out, " * @note Array elements past the fill of 'base' are sent in full\n");
+        str_builder__fappend(out, " * @note Nested messages that did not change are skipped whole, so they are only range checked as part of 'base'\n");
+        str_builder__fappend(out, " * @returns false if a field is out of its range or 'buffer_size' is less than %s_DELTA_SIZE_MAX\n", declaration_upper);
+        str_builder__fappend(out, "*/\n");
+        str_builder__fappend(out, "bool %s__write_delta(const %s_t* self, const %s_t* base, void* buffer, uint32_t buffer_size, uint32_t* bytes_written);\n", declaration->name, declaration->name, declaration->name);
+        str_builder__fappend(out, "/**\n");
+        str_builder__fappend(out, " * @param base must be what the reader decoded for the 'base' of the writer, 'self' and 'base' can be the same\n");
+        str_builder__fappend(out, " * @returns false if 'buffer' is truncated or a field is out of its range, the content of 'self' is unspecified then\n");
+        str_builder__fappend(out, "*/\n");
+        str_builder__fappend(out, "bool %s__read_delta(%s_t* self, const %s_t* base, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read);\n", declaration->name, declaration->name, declaration->name);
+    }
+
+    str_builder__fappend(out, "\n#endif // %s_H\n", name_upper);
+}
+
+static void compiler__emit_implementation(compiler_t* self) {
+    str_builder_t* out = self->implementation;
+
+    str_builder__fappend(out, "// generated by g_netformat_compiler, do not edit\n");
+    str_builder__fappend(out, "#include \"%s.h\"\n\n", self->name);
+    str_builder__fappend(out, "#include <stddef.h>\n\n");
+    str_builder__append(out, netformat_runtime, strlen(netformat_runtime));
+    str_builder__fappend(out, "\n");
+
+    for (uint32_t declaration_index = 0; declaration_index < self->declarations_size; ++declaration_index) {
+        declaration_t* declaration = &self->declarations[declaration_index];
+        if (declaration->kind == DECLARATION_KIND_MESSAGE) {
+            str_builder__fappend(out, "static void %s__write_bits(netformat_writer_t* writer, const %s_t* self);\n", declaration->name, declaration->name);
+            str_builder__fappend(out, "static void %s__read_bits(netformat_reader_t* reader, %s_t* self);\n", declaration->name, declaration->name);
+            str_builder__fappend(out, "static void %s__write_delta_bits(netformat_writer_t* writer, const %s_t* self, const %s_t* base);\n", declaration->name, declaration->name, declaration->name);
+            str_builder__fappend(out, "static void %s__read_delta_bits(netformat_reader_t* reader, %s_t* self, const %s_t* base);\n", declaration->name, declaration->name, declaration->name);
+        }
+    }
+
+    for (uint32_t declaration_index = 0; declaration_index < self->declarations_size; ++declaration_index) {
+        declaration_t* declaration = &self->declarations[declaration_index];
+        if (declaration->kind == DECLARATION_KIND_MESSAGE) {
+            compiler__emit_message_write(self, declaration);
+            compiler__emit_message_read(self, declaration);
+            compiler__emit_message_is_changed(self, declaration);
+            compiler__emit_message_write_delta(self, declaration);
+            compiler__emit_message_read_delta(self, declaration);
+        }
+    }
+}
+
+static void compiler__emit_message_write(compiler_t* self, declaration_t* declaration) {
+    str_builder_t* out = self->implementation;
+    char declaration_upper[COMPILER_NAME_SIZE];
+    name__to_upper(declaration->name, declaration_upper, sizeof(declaration_upper));
+
+    str_builder__fappend(out, "\nstatic void %s__write_bits(netformat_writer_t* writer, const %s_t* self) {\n", declaration->name, declaration->name);
+    for (uint32_t field_index = 0; field_index < declaration->fields_size; ++field_index) {
+        field_t* field = &declaration->fields[field_index];
+        char path[2 * COMPILER_NAME_SIZE];
+        if (field->array_size) {
+            str_builder__fappend(out, "    {\n");
+            str_builder__fappend(out, "        writer->error |= self->%s_fill > %u;\n", field->name, field->array_size);
+            str_builder__fappend(out, "        const uint32_t fill = self->%s_fill > %u ? %u : self->%s_fill;\n", field->name, field->array_size, field->array_size, field->name);
+            str_builder__fappend(out, "        netformat_writer__write(writer, fill, %u);\n", bits__required(field->array_size));
+            str_builder__fappend(out, "        for (uint32_t element_index = 0; element_index < fill; ++element_index) {\n");
+            snprintf(path, sizeof(path), "self->%s[element_index]", field->name);
+            compiler__emit_field_type_write(self, &field->type, path, 0, "            ");
+            str_builder__fappend(out, "        }\n");
+            str_builder__fappend(out, "    }\n");
+        } else {
+            snprintf(path, sizeof(path), "self->%s", field->name);
+            compiler__emit_field_type_write(self, &field->type, path, 0, "    ");
+        }
+    }
+    str_builder__fappend(out, "}\n");
+
+    str_builder__fappend(out, "\nbool %s__write(const %s_t* self, void* buffer, uint32_t buffer_size, uint32_t* bytes_written) {\n", declaration->name, declaration->name);
+    str_builder__fappend(out, "    if (buffer_size < %s_SIZE_MAX) {\n", declaration_upper);
+    str_builder__fappend(out, "        return false;\n");
+    str_builder__fappend(out, "    }\n\n");
+    str_builder__fappend(out, "    netformat_writer_t writer = { .cur = buffer };\n");
+    str_builder__fappend(out, "    %s__write_bits(&writer, self);\n", declaration->name);
+    str_builder__fappend(out, "    netformat_writer__flush(&writer);\n");
+    str_builder__fappend(out, "    if (writer.error) {\n");
+    str_builder__fappend(out, "        return false;\n");
+    str_builder__fappend(out, "    }\n\n");
+    str_builder__fappend(out, "    if (bytes_written) {\n");
+    str_builder__fappend(out, "        *bytes_written = (uint32_t) (writer.cur - (uint8_t*) buffer);\n");
+    str_builder__fappend(out, "    }\n\n");
+    str_builder__fappend(out, "    return true;\n");
+    str_builder__fappend(out, "}\n");
+}
+
+static void compiler__emit_message_read(compiler_t* self, declaration_t* declaration) {
+    str_builder_t* out = self->implementation;
+
+    str_builder__fappend(out, "\nstatic void %s__read_bits(netformat_reader_t* reader, %s_t* self) {\n", declaration->name, declaration->name);
+    for (uint32_t field_index = 0; field_index < declaration->fields_size; ++field_index) {
+        field_t* field = &declaration->fields[field_index];
+        char path[2 * COMPILER_NAME_SIZE];
+        if (field->array_size) {
+            const uint32_t fill_bits = bits__required(field->array_size);
+            str_builder__fappend(out, "    {\n");
+            str_builder__fappend(out, "        uint32_t fill = netformat_reader__read(reader, %u);\n", fill_bits);
+            if (field->array_size != (((uint64_t) 1 << fill_bits) - 1)) {
+                str_builder__fappend(out, "        reader->error |= fill > %u;\n", field->array_size);
+                str_builder__fappend(out, "        fill = fill > %u ? %u : fill;\n", field->array_size, field->array_size);
+            }
+            str_builder__fappend(out, "        self->%s_fill = fill;\n", field->name);
+            str_builder__fappend(out, "        for (uint32_t element_index = 0; element_index < fill; ++element_index) {\n");
+            snprintf(path, sizeof(path), "self->%s[element_index]", field->name);
+            compiler__emit_field_type_read(self, &field->type, path, 0, "            ");
+            str_builder__fappend(out, "        }\n");
+            str_builder__fappend(out, "    }\n");
+        } else {
+            snprintf(path, sizeof(path), "self->%s", field->name);
+            compiler__emit_field_type_read(self, &field->type, path, 0, "    ");
+        }
+    }
+    str_builder__fappend(out, "}\n");
+
+    str_builder__fappend(out, "\nbool %s__read(%s_t* self, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read) {\n", declaration->name, declaration->name);
+    str_builder__fappend(out, "    netformat_reader_t reader = { .cur = buffer, .end = (const uint8_t*) buffer + buffer_size };\n");
+    str_builder__fappend(out, "    %s__read_bits(&reader, self);\n", declaration->name);
+    str_builder__fappend(out, "    if (reader.error || reader.bits_read > ((uint64_t) buffer_size << 3)) {\n");
+    str_builder__fappend(out, "        return false;\n");
+    str_builder__fappend(out, "    }\n\n");
+    str_builder__fappend(out, "    if (bytes_read) {\n");
+    str_builder__fappend(out, "        *bytes_read = (uint32_t) ((reader.bits_read + 7) >> 3);\n");
+    str_builder__fappend(out, "    }\n\n");
+    str_builder__fappend(out, "    return true;\n");
+    str_builder__fappend(out, "}\n");
+}
+
+static void compiler__emit_message_is_changed(compiler_t* self, declaration_t* declaration) {
+    str_builder_t* out = self->implementation;
+
+    str_builder__fappend(out, "\nbool %s__is_changed(const %s_t* self, const %s_t* base) {\n", declaration->name, declaration->name, declaration->name);
+    for (uint32_t field_index = 0; field_index < declaration->fields_size; ++field_index) {
+        field_t* field = &declaration->fields[field_index];
+        char path[2 * COMPILER_NAME_SIZE];
+        char base_path[2 * COMPILER_NAME_SIZE];
+        if (field->array_size) {
+            snprintf(path, sizeof(path), "self->%s[element_index]", field->name);
+            snprintf(base_path, sizeof(base_path), "base->%s[element_index]", field->name);
+            str_builder__fappend(out, "    if (self->%s_fill != base->%s_fill) {\n", field->name, field->name);
+            str_builder__fappend(out, "        return true;\n");
+            str_builder__fappend(out, "    }\n");
+            str_builder__fappend(out, "    for (uint32_t element_index = 0; element_index < self->%s_fill && element_index < %u; ++element_index) {\n", field->name, field->array_size);
+            str_builder__fappend(out, "        if (");
+            compiler__emit_field_type_is_changed(self, &field->type, path, base_path);
+            str_builder__fappend(out, ") {\n");
+            str_builder__fappend(out, "            return true;\n");
+            str_builder__fappend(out, "        }\n");
+            str_builder__fappend(out, "    }\n");
+        } else {
+            snprintf(path, sizeof(path), "self->%s", field->name);
+            snprintf(base_path, sizeof(base_path), "base->%s", field->name);
+            str_builder__fappend(out, "    if (");
+            compiler__emit_field_type_is_changed(self, &field->type, path, base_path);
+            str_builder__fappend(out, ") {\n");
+            str_builder__fappend(out, "        return true;\n");
+            str_builder__fappend(out, "    }\n");
+        }
+    }
+    str_builder__fappend(out, "\n    return false;\n");
+    str_builder__fappend(out, "}\n");
+}
+
+static void compiler__emit_message_write_delta(compiler_t* self, declaration_t* declaration) {
+    str_builder_t* out = self->implementation;
+    char declaration_upper[COMPILER_NAME_SIZE];
+    name__to_upper(declaration->name, declaration_upper, sizeof(declaration_upper));
+
+    str_builder__fappend(out, "\nstatic void %s__write_delta_bits(netformat_writer_t* writer, const %s_t* self, const %s_t* base) {\n", declaration->name, declaration->name, declaration->name);
+    for (uint32_t field_index = 0; field_index < declaration->fields_size; ++field_index) {
+        field_t* field = &declaration->fields[field_index];
+        char path[2 * COMPILER_NAME_SIZE];
+        char base_path[2 * COMPILER_NAME_SIZE];
+        if (field->array_size) {
+            snprintf(path, sizeof(path), "self->%s[element_index]", field->name);
+            snprintf(base_path, sizeof(base_path), "base->%s[element_index]", field->name);
+            str_builder__fappend(out, "    {\n");
+            str_builder__fappend(out, "        writer->error |= self->%s_fill > %u;\n", field->name, field->array_size);
+            str_builder__fappend(out, "        const uint32_t fill        = self->%s_fill > %u ? %u : self->%s_fill;\n", field->name, field->array_size, field->array_size, field->name);
+            str_builder__fappend(out, "        const uint32_t base_fill   = base->%s_fill > %u ? %u : base->%s_fill;\n", field->name, field->array_size, field->array_size, field->name);
+            str_builder__fappend(out, "        const uint32_t common_fill = fill < base_fill ? fill : base_fill;\n");
+            str_builder__fappend(out, "        netformat_writer__write(writer, fill, %u);\n", bits__required(field->array_size));
+            str_builder__fappend(out, "        uint32_t element_index = 0;\n");
+            str_builder__fappend(out, "        for (; element_index < common_fill; ++element_index) {\n");
+            compiler__emit_field_type_write(self, &field->type, path, base_path, "            ");
+            str_builder__fappend(out, "        }\n");
+            str_builder__fappend(out, "        for (; element_index < fill; ++element_index) {\n");
+            compiler__emit_field_type_write(self, &field->type, path, 0, "            ");
+            str_builder__fappend(out, "        }\n");
+            str_builder__fappend(out, "    }\n");
+        } else {
+            snprintf(path, sizeof(path), "self->%s", field->name);
+            snprintf(base_path, sizeof(base_path), "base->%s", field->name);
+            compiler__emit_field_type_write(self, &field->type, path, base_path, "    ");
+        }
+    }
+    str_builder__fappend(out, "}\n");
+
+    str_builder__fappend(out, "\nbool %s__write_delta(const %s_t* self, const %s_t* base, void* buffer, uint32_t buffer_size, uint32_t* bytes_written) {\n", declaration->name, declaration->name, declaration->name);
+    str_builder__fappend(out, "    if (buffer_size < %s_DELTA_SIZE_MAX) {\n", declaration_upper);
+    str_builder__fappend(out, "        return false;\n");
+    str_builder__fappend(out, "    }\n\n");
+    str_builder__fappend(out, "    netformat_writer_t writer = { .cur = buffer };\n");
+    str_builder__fappend(out, "    %s__write_delta_bits(&writer, self, base);\n", declaration->name);
+    str_builder__fappend(out, "    netformat_writer__flush(&writer);\n");
+    str_builder__fappend(out, "    if (writer.error) {\n");
+    str_builder__fappend(out, "        return false;\n");
+    str_builder__fappend(out, "    }\n\n");
+    str_builder__fappend(out, "    if (bytes_written) {\n");
+    str_builder__fappend(out, "        *bytes_written = (uint32_t) (writer.cur - (uint8_t*) buffer);\n");
+    str_builder__fappend(out, "    }\n\n");
+    str_builder__fappend(out, "    return true;\n");
+    str_builder__fappend(out, "}\n");
+}
+
+static void compiler__emit_message_read_delta(compiler_t* self, declaration_t* declaration) {
+    str_builder_t* out = self->implementation;
+
+    str_builder__fappend(out, "\nstatic void %s__read_delta_bits(netformat_reader_t* reader, %s_t* self, const %s_t* base) {\n", declaration->name, declaration->name, declaration->name);
+    for (uint32_t field_index = 0; field_index < declaration->fields_size; ++field_index) {
+        field_t* field = &declaration->fields[field_index];
+        char path[2 * COMPILER_NAME_SIZE];
+        char base_path[2 * COMPILER_NAME_SIZE];
+        if (field->array_size) {
+            const uint32_t fill_bits = bits__required(field->array_size);
+            snprintf(path, sizeof(path), "self->%s[element_index]", field->name);
+            snprintf(base_path, sizeof(base_path), "base->%s[element_index]", field->name);
+            str_builder__fappend(out, "    {\n");
+            // note: before the fill of 'self' is written, in case it's the same as 'base'
+            str_builder__fappend(out, "        const uint32_t base_fill = base->%s_fill > %u ? %u : base->%s_fill;\n", field->name, field->array_size, field->array_size, field->name);
+            str_builder__fappend(out, "        uint32_t fill = netformat_reader__read(reader, %u);\n", fill_bits);
+            if (field->array_size != (((uint64_t) 1 << fill_bits) - 1)) {
+                str_builder__fappend(out, "        reader->error |= fill > %u;\n", field->array_size);
+                str_builder__fappend(out, "        fill = fill > %u ? %u : fill;\n", field->array_size, field->array_size);
+            }
+            str_builder__fappend(out, "        self->%s_fill = fill;\n", field->name);
+            str_builder__fappend(out, "        const uint32_t common_fill = fill < base_fill ? fill : base_fill;\n");
+            str_builder__fappend(out, "        uint32_t element_index = 0;\n");
+            str_builder__fappend(out, "        for (; element_index < common_fill; ++element_index) {\n");
+            compiler__emit_field_type_read(self, &field->type, path, base_path, "            ");
+            str_builder__fappend(out, "        }\n");
+            str_builder__fappend(out, "        for (; element_index < fill; ++element_index) {\n");
+            compiler__emit_field_type_read(self, &field->type, path, 0, "            ");
+            str_builder__fappend(out, "        }\n");
+            str_builder__fappend(out, "    }\n");
+        } else {
+            snprintf(path, sizeof(path), "self->%s", field->name);
+            snprintf(base_path, sizeof(base_path), "base->%s", field->name);
+            compiler__emit_field_type_read(self, &field->type, path, base_path, "    ");
+        }
+    }
+    str_builder__fappend(out, "}\n");
+
+    str_builder__fappend(out, "\nbool %s__read_delta(%s_t* self, const %s_t* base, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read) {\n", declaration->name, declaration->name, declaration->name);
+    str_builder__fappend(out, "    netformat_reader_t reader = { .cur = buffer, .end = (const uint8_t*) buffer + buffer_size };\n");
+    str_builder__fappend(out, "    %s__read_delta_bits(&reader, self, base);\n", declaration->name);
+    str_builder__fappend(out, "    if (reader.error || reader.bits_read > ((uint64_t) buffer_size << 3)) {\n");
+    str_builder__fappend(out, "        return false;\n");
+    str_builder__fappend(out, "    }\n\n");
+    str_builder__fappend(out, "    if (bytes_read) {\n");
+    str_builder__fappend(out, "        *bytes_read = (uint32_t) ((reader.bits_read + 7) >> 3);\n");
+    str_builder__fappend(out, "    }\n\n");
+    str_builder__fappend(out, "    return true;\n");
+    str_builder__fappend(out, "}\n");
+}
+
+static void compiler__emit_field_type_is_changed(compiler_t* self, field_type_t* field_type, const char* path, const char* base_path) {
+    str_builder_t* out = self->implementation;
+
+    switch (field_type->kind) {
+    case FIELD_TYPE_KIND_BOOL:
+    case FIELD_TYPE_KIND_INT:
+    case FIELD_TYPE_KIND_ENUM: {
+        str_builder__fappend(out, "%s != %s", path, base_path);
+    } break ;
+    case FIELD_TYPE_KIND_FLOAT: {
+        // note: compared as sent, changes below the resolution are not changes
+        char min_literal[64];
+        char max_literal[64];
+        char scale_literal[64];
+        float__to_literal(field_type->float_min, min_literal, sizeof(min_literal));
+        float__to_literal(field_type->float_max, max_literal, sizeof(max_literal));
+        field_type__float_scale_literal(field_type, scale_literal, sizeof(scale_literal));
+        str_builder__fappend(
+            out, "netformat__quantize(%s, %s, %s, %s, %u) != netformat__quantize(%s, %s, %s, %s, %u)",
+            path, min_literal, max_literal, scale_literal, field_type->float_steps,
+            base_path, min_literal, max_literal, scale_literal, field_type->float_steps
+        );
+    } break ;
+    case FIELD_TYPE_KIND_MESSAGE: {
+        declaration_t* declaration = &self->declarations[field_type->declaration_index];
+        str_builder__fappend(out, "%s__is_changed(&%s, &%s)", declaration->name, path, base_path);
+    } break ;
+    default: assert(false);
+    }
+}
+
+static void compiler__emit_field_type_write(compiler_t* self, field_type_t* field_type, const char* path, const char* base_path, const char* indent) {
+    str_builder_t* out = self->implementation;
+
+    // note: in a delta the value is always written, but with 0 bits if it did not change, this keeps it branchless
+    char bits[64];
+    if (base_path) {
+        snprintf(bits, sizeof(bits), "is_changed ? %u : 0", field_type->bits);
+    } else {
+        snprintf(bits, sizeof(bits), "%u", field_type->bits);
+    }
+
+    switch (field_type->kind) {
+    case FIELD_TYPE_KIND_BOOL: {
+        if (base_path) {
+            // note: whether it flipped, which is no more than the value itself
+            str_builder__fappend(out, "%snetformat_writer__write(writer, %s != %s, 1);\n", indent, path, base_path);
+        } else {
+            str_builder__fappend(out, "%snetformat_writer__write(writer, %s ? 1 : 0, 1);\n", indent, path);
+        }
+    } break ;
+    case FIELD_TYPE_KIND_INT: {
+        char c_type[COMPILER_NAME_SIZE + 2];
+        field_type__c_type(self, field_type, c_type, sizeof(c_type));
+        int64_t c_type_min = 0;
+        int64_t c_type_max = 0;
+        if      (strcmp(c_type, "uint8_t")  == 0) { c_type_min = 0;         c_type_max = UINT8_MAX;  }
+        else if (strcmp(c_type, "uint16_t") == 0) { c_type_min = 0;         c_type_max = UINT16_MAX; }
+        else if (strcmp(c_type, "uint32_t") == 0) { c_type_min = 0;         c_type_max = UINT32_MAX; }
+        else if (strcmp(c_type, "int8_t")   == 0) { c_type_min = INT8_MIN;  c_type_max = INT8_MAX;   }
+        else if (strcmp(c_type, "int16_t")  == 0) { c_type_min = INT16_MIN; c_type_max = INT16_MAX;  }
+        else if (strcmp(c_type, "int32_t")  == 0) { c_type_min = INT32_MIN; c_type_max = INT32_MAX;  }
+        else assert(false);
+
+        // note: only the checks the type can fail, otherwise they are always false and warned about
+        if (field_type->int_min > c_type_min && field_type->int_max < c_type_max) {
+            str_builder__fappend(out, "%swriter->error |= (%s < %lld) | (%s > %lld);\n", indent, path, (long long) field_type->int_min, path, (long long) field_type->int_max);
+        } else if (field_type->int_min > c_type_min) {
+            str_builder__fappend(out, "%swriter->error |= %s < %lld;\n", indent, path, (long long) field_type->int_min);
+        } else if (field_type->int_max < c_type_max) {
+            str_builder__fappend(out, "%swriter->error |= %s > %lld;\n", indent, path, (long long) field_type->int_max);
+        }
+        if (field_type->bits == 0) {
+            break ;
+        }
+        if (base_path) {
+            str_builder__fappend(out, "%s{\n", indent);
+            str_builder__fappend(out, "%s    const bool is_changed = %s != %s;\n", indent, path, base_path);
+            str_builder__fappend(out, "%s    netformat_writer__write(writer, is_changed, 1);\n", indent);
+            str_builder__fappend(out, "%s    ", indent);
+        } else {
+            str_builder__fappend(out, "%s", indent);
+        }
+        if (field_type->int_min == 0) {
+            str_builder__fappend(out, "netformat_writer__write(writer, (uint32_t) %s, %s);\n", path, bits);
+        } else {
+            str_builder__fappend(out, "netformat_writer__write(writer, (uint32_t) ((int64_t) %s - (%lld)), %s);\n", path, (long long) field_type->int_min, bits);
+        }
+        if (base_path) {
+            str_builder__fappend(out, "%s}\n", indent);
+        }
+    } break ;
+    case FIELD_TYPE_KIND_FLOAT: {
+        char min_literal[64];
+        char max_literal[64];
+        char scale_literal[64];
+        float__to_literal(field_type->float_min, min_literal, sizeof(min_literal));
+        float__to_literal(field_type->float_max, max_literal, sizeof(max_literal));
+        field_type__float_scale_literal(field_type, scale_literal, sizeof(scale_literal));
+
+        str_builder__fappend(out, "%s{\n", indent);
+        str_builder__fappend(out, "%s    const float value = %s;\n", indent, path);
+        str_builder__fappend(out, "%s    // note: also true for NaN\n", indent);
+        str_builder__fappend(out, "%s    writer->error |= !(value >= %s && value <= %s);\n", indent, min_literal, max_literal);
+        if (field_type->bits > 0) {
+            str_builder__fappend(out, "%s    const uint32_t quantized = netformat__quantize(value, %s, %s, %s, %u);\n", indent, min_literal, max_literal, scale_literal, field_type->float_steps);
+            if (base_path) {
+                str_builder__fappend(out, "%s    const bool is_changed = quantized != netformat__quantize(%s, %s, %s, %s, %u);\n", indent, base_path, min_literal, max_literal, scale_literal, field_type->float_steps);
+                str_builder__fappend(out, "%s    netformat_writer__write(writer, is_changed, 1);\n", indent);
+            }
+            str_builder__fappend(out, "%s    netformat_writer__write(writer, quantized, %s);\n", indent, bits);
+        }
+        str_builder__fappend(out, "%s}\n", indent);
+    } break ;
+    case FIELD_TYPE_KIND_ENUM: {
+        declaration_t* declaration = &self->declarations[field_type->declaration_index];
+        char declaration_upper[COMPILER_NAME_SIZE];
+        name__to_upper(declaration->name, declaration_upper, sizeof(declaration_upper));
+        str_builder__fappend(out, "%swriter->error |= (uint32_t) %s >= _%s_SIZE;\n", indent, path, declaration_upper);
+        if (field_type->bits == 0) {
+            break ;
+        }
+        if (base_path) {
+            str_builder__fappend(out, "%s{\n", indent);
+            str_builder__fappend(out, "%s    const bool is_changed = %s != %s;\n", indent, path, base_path);
+            str_builder__fappend(out, "%s    netformat_writer__write(writer, is_changed, 1);\n", indent);
+            str_builder__fappend(out, "%s    netformat_writer__write(writer, (uint32_t) %s, %s);\n", indent, path, bits);
+            str_builder__fappend(out, "%s}\n", indent);
+        } else {
+            str_builder__fappend(out, "%snetformat_writer__write(writer, (uint32_t) %s, %s);\n", indent, path, bits);
+        }
+    } break ;
+    case FIELD_TYPE_KIND_MESSAGE: {
+        declaration_t* declaration = &self->declarations[field_type->declaration_index];
+        if (base_path) {
+            str_builder__fappend(out, "%s{\n", indent);
+            str_builder__fappend(out, "%s    const bool is_changed = %s__is_changed(&%s, &%s);\n", indent, declaration->name, path, base_path);
+            str_builder__fappend(out, "%s    netformat_writer__write(writer, is_changed, 1);\n", indent);
+            str_builder__fappend(out, "%s    if (is_changed) {\n", indent);
+            str_builder__fappend(out, "%s        %s__write_delta_bits(writer, &%s, &%s);\n", indent, declaration->name, path, base_path);
+            str_builder__fappend(out, "%s    }\n", indent);
+            str_builder__fappend(out, "%s}\n", indent);
+        } else {
+            str_builder__fappend(out, "%s%s__write_bits(writer, &%s);\n", indent, declaration->name, path);
+        }
+    } break ;
+    default: assert(false);
+    }
+}
+
+static void compiler__emit_field_type_read(compiler_t* self, field_type_t* field_type, const char* path, const char* base_path, const char* indent) {
+    str_builder_t* out = self->implementation;
+
+    char bits[64];
+    if (base_path) {
+        snprintf(bits, sizeof(bits), "is_changed ? %u : 0", field_type->bits);
+    } else {
+        snprintf(bits, sizeof(bits), "%u", field_type->bits);
+    }
+
+    switch (field_type->kind) {
+    case FIELD_TYPE_KIND_BOOL: {
+        if (base_path) {
+            str_builder__fappend(out, "%s%s = (netformat_reader__read(reader, 1) != 0) != %s;\n", indent, path, base_path);
+        } else {
+            str_builder__fappend(out, "%s%s = netformat_reader__read(reader, 1) != 0;\n", indent, path);
+        }
+    } break ;
+    case FIELD_TYPE_KIND_INT: {
+        char c_type[COMPILER_NAME_SIZE + 2];
+        field_type__c_type(self, field_type, c_type, sizeof(c_type));
+        if (field_type->bits == 0) {
+            str_builder__fappend(out, "%s%s = (%s) %lld;\n", indent, path, c_type, (long long) field_type->int_min);
+            break ;
+        }
+
+        const uint64_t range = (uint64_t) (field_type->int_max - field_type->int_min);
+        str_builder__fappend(out, "%s{\n", indent);
+        if (base_path) {
+            str_builder__fappend(out, "%s    const bool     is_changed = netformat_reader__read(reader, 1) != 0;\n", indent);
+        }
+        str_builder__fappend(out, "%s    const uint32_t value = netformat_reader__read(reader, %s);\n", indent, bits);
+        if (range != (((uint64_t) 1 << field_type->bits) - 1)) {
+            str_builder__fappend(out, "%s    reader->error |= value > %llu;\n", indent, (unsigned long long) range);
+        }
+        str_builder__fappend(out, "%s    %s = ", indent, path);
+        if (base_path) {
+            str_builder__fappend(out, "!is_changed ? %s : ", base_path);
+        }
+        if (field_type->int_min == 0) {
+            str_builder__fappend(out, "(%s) value;\n", c_type);
+        } else {
+            str_builder__fappend(out, "(%s) ((int64_t) value + (%lld));\n", c_type, (long long) field_type->int_min);
+        }
+        str_builder__fappend(out, "%s}\n", indent);
+    } break ;
+    case FIELD_TYPE_KIND_FLOAT: {
+        char min_literal[64];
+        char resolution_literal[64];
+        float__to_literal(field_type->float_min, min_literal, sizeof(min_literal));
+        if (field_type->bits == 0) {
+            str_builder__fappend(out, "%s%s = %s;\n", indent, path, min_literal);
+            break ;
+        }
+
+        float__to_literal((field_type->float_max - field_type->float_min) / (double) field_type->float_steps, resolution_literal, sizeof(resolution_literal));
+        str_builder__fappend(out, "%s{\n", indent);
+        if (base_path) {
+            str_builder__fappend(out, "%s    const bool     is_changed = netformat_reader__read(reader, 1) != 0;\n", indent);
+        }
+        str_builder__fappend(out, "%s    const uint32_t quantized = netformat_reader__read(reader, %s);\n", indent, bits);
+        if (field_type->float_steps != (((uint64_t) 1 << field_type->bits) - 1)) {
+            str_builder__fappend(out, "%s    reader->error |= quantized > %u;\n", indent, field_type->float_steps);
+        }
+        if (base_path) {
+            str_builder__fappend(out, "%s    %s = !is_changed ? %s : netformat__dequantize(quantized, %s, %s);\n", indent, path, base_path, min_literal, resolution_literal);
+        } else {
+            str_builder__fappend(out, "%s    %s = netformat__dequantize(quantized, %s, %s);\n", indent, path, min_literal, resolution_literal);
+        }
+        str_builder__fappend(out, "%s}\n", indent);
+    } break ;
+    case FIELD_TYPE_KIND_ENUM: {
+        declaration_t* declaration = &self->declarations[field_type->declaration_index];
+        char declaration_upper[COMPILER_NAME_SIZE];
+        name__to_upper(declaration->name, declaration_upper, sizeof(declaration_upper));
+        if (field_type->bits == 0) {
+            str_builder__fappend(out, "%s%s = (%s_t) 0;\n", indent, path, declaration->name);
+            break ;
+        }
+
+        str_builder__fappend(out, "%s{\n", indent);
+        if (base_path) {
+            str_builder__fappend(out, "%s    const bool     is_changed = netformat_reader__read(reader, 1) != 0;\n", indent);
+        }
+        str_builder__fappend(out, "%s    const uint32_t value = netformat_reader__read(reader, %s);\n", indent, bits);
+        if (declaration->values_size != ((uint64_t) 1 << field_type->bits)) {
+            str_builder__fappend(out, "%s    reader->error |= value >= _%s_SIZE;\n", indent, declaration_upper);
+        }
+        if (base_path) {
+            str_builder__fappend(out, "%s    %s = !is_changed ? %s : (%s_t) value;\n", indent, path, base_path, declaration->name);
+        } else {
+            str_builder__fappend(out, "%s    %s = (%s_t) value;\n", indent, path, declaration->name);
+        }
+        str_builder__fappend(out, "%s}\n", indent);
+    } break ;
+    case FIELD_TYPE_KIND_MESSAGE: {
+        declaration_t* declaration = &self->declarations[field_type->declaration_index];
+        if (base_path) {
+            str_builder__fappend(out, "%sif (netformat_reader__read(reader, 1) != 0) {\n", indent);
+            str_builder__fappend(out, "%s    %s__read_delta_bits(reader, &%s, &%s);\n", indent, declaration->name, path, base_path);
+            str_builder__fappend(out, "%s} else {\n", indent);
+            str_builder__fappend(out, "%s    %s = %s;\n", indent, path, base_path);
+            str_builder__fappend(out, "%s}\n", indent);
+        } else {
+            str_builder__fappend(out, "%s%s__read_bits(reader, &%s);\n", indent, declaration->name, path);
+        }
+    } break ;
+    default: assert(false);
+    }
+}
+
+static uint32_t bits__required(uint64_t value) {
+    return value == 0 ? 0 : 64 - (uint32_t) __builtin_clzll(value);
+}
+
+static const char* field_type__c_type(compiler_t* compiler, field_type_t* self, char* buffer, uint32_t buffer_size) {
+    switch (self->kind) {
+    case FIELD_TYPE_KIND_BOOL: {
+        snprintf(buffer, buffer_size, "bool");
+    } break ;
+    case FIELD_TYPE_KIND_INT: {
+        if (self->int_min >= 0) {
+            snprintf(buffer, buffer_size, "%s", self->int_max <= UINT8_MAX ? "uint8_t" : self->int_max <= UINT16_MAX ? "uint16_t" : "uint32_t");
+        } else if (self->int_min >= INT8_MIN && self->int_max <= INT8_MAX) {
+            snprintf(buffer, buffer_size, "int8_t");
+        } else if (self->int_min >= INT16_MIN && self->int_max <= INT16_MAX) {
+            snprintf(buffer, buffer_size, "int16_t");
+        } else {
+            snprintf(buffer, buffer_size, "int32_t");
+        }
+    } break ;
+    case FIELD_TYPE_KIND_FLOAT: {
+        snprintf(buffer, buffer_size, "float");
+    } break ;
+    case FIELD_TYPE_KIND_ENUM:
+    case FIELD_TYPE_KIND_MESSAGE: {
+        snprintf(buffer, buffer_size, "%s_t", compiler->declarations[self->declaration_index].name);
+    } break ;
+    default: assert(false);
+    }
+
+    return buffer;
+}
+
+static const char* field_type__float_scale_literal(field_type_t* self, char* buffer, uint32_t buffer_size) {
+    const double range = self->float_max - self->float_min;
+
+    return float__to_literal(range > 0.0 ? (double) self->float_steps / range : 0.0, buffer, buffer_size);
+}
+
+static const char* float__to_literal(double value, char* buffer, uint32_t buffer_size) {
+    // note: 9 significant digits round trip a float
+    char digits[32];
+    snprintf(digits, sizeof(digits), "%.9g", (double) (float) value);
+    const char* fraction = strpbrk(digits, ".e") ? "" : ".0";
+    if (digits[0] == '-') {
+        // note: parenthesized, so it can follow a binary minus
+        snprintf(buffer, buffer_size, "(%s%sf)", digits, fraction);
+    } else {
+        snprintf(buffer, buffer_size, "%s%sf", digits, fraction);
+    }
+
+    return buffer;
+}
+
+static void name__to_upper(const char* name, char* buffer, uint32_t buffer_size) {
+    uint32_t len = 0;
+    while (name[len] && len + 1 < buffer_size) {
+        const char c = name[len];
+        buffer[len] = c >= 'a' && c <= 'z' ? c - 'a' + 'A' : c;
+        ++len;
+    }
+    buffer[len] = '\0';
+}
+
+static bool name__is_c_keyword(const char* name) {
+    static const char* c_keywords[] = {
+        "auto", "bool", "break", "case", "char", "const", "continue", "default", "do", "double", "else", "enum",
+        "extern", "false", "float", "for", "goto", "if", "inline", "int", "long", "register", "restrict", "return",
+        "short", "signed", "sizeof", "static", "struct", "switch", "true", "typedef", "union", "unsigned", "void",
+        "volatile", "while"
+    };
+    for (uint32_t keyword_index = 0; keyword_index < ARRAY_SIZE(c_keywords); ++keyword_index) {
+        if (strcmp(c_keywords[keyword_index], name) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
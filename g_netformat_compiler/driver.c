@@ -0,0 +1,94 @@
+#include "compiler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+
+#include "file.h"
+#include "str_builder.h"
+#include "helper_macros.h"
+#include "memory.h"
+
+static int write_file(const char* path, str_builder_t* str);
+static int compile_file(const char* dst_path, const char* src_path);
+
+static int write_file(const char* path, str_builder_t* str) {
+    file_t file;
+    if (!file__open(&file, path, FILE_ACCESS_MODE_WRITE, FILE_CREATION_MODE_CREATE)) {
+        fprintf(stderr, "failed to open '%s' for writing\n", path);
+        return 1;
+    }
+
+    file__write(&file, str_builder__str(str), str_builder__len(str), 0);
+    file__close(&file);
+
+    return 0;
+}
+
+static int compile_file(const char* dst_path, const char* src_path) {
+    size_t src_file_size = 0;
+    if (!file__size(src_path, &src_file_size)) {
+        return 1;
+    }
+
+    file_t src_file;
+    if (!file__open(&src_file, src_path, FILE_ACCESS_MODE_READ, FILE_CREATION_MODE_OPEN)) {
+        return 1;
+    }
+
+    char* src_buffer = memory__malloc(DEBUG_MODULE_APP, src_file_size + 1);
+    size_t bytes_read = 0;
+    if (!file__read(&src_file, src_buffer, src_file_size, &bytes_read)) {
+        file__close(&src_file);
+        memory__free(DEBUG_MODULE_APP, src_buffer);
+        return 1;
+    }
+    assert(bytes_read <= src_file_size);
+    src_buffer[bytes_read] = '\0';
+    file__close(&src_file);
+
+    // note: the name of the generated files is the last component of the destination path
+    const char* name = strrchr(dst_path, '/');
+    name = name ? name + 1 : dst_path;
+
+    str_builder_t header;
+    str_builder_t implementation;
+    str_builder__create(&header);
+    str_builder__create(&implementation);
+
+    int result = compile(src_buffer, bytes_read, name, &header, &implementation);
+    if (!result) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s.h", dst_path);
+        result = write_file(path, &header);
+        if (!result) {
+            snprintf(path, sizeof(path), "%s.c", dst_path);
+            result = write_file(path, &implementation);
+        }
+    }
+
+    str_builder__destroy(&header);
+    str_builder__destroy(&implementation);
+    memory__free(DEBUG_MODULE_APP, src_buffer);
+
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: bin <dst_path_without_extension> <src_file>\n");
+        fprintf(stderr, "  generates <dst_path_without_extension>.h and <dst_path_without_extension>.c\n");
+        return 1;
+    }
+
+    const char* dst_path = argv[1];
+    const char* src_path = argv[2];
+    const int result = compile_file(dst_path, src_path);
+
+    if (!result) {
+        fprintf(stdout, "success\n");
+    }
+
+    return result;
+}
@@ -0,0 +1,115 @@
+#include "scan.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+
+#include "scan_impl.c"
+
+void scanner__create(scanner_t* self, const char* source, size_t source_len) {
+    self->source_start = source;
+    self->source_end   = source + source_len;
+    self->start        = source;
+    self->cur          = source;
+    self->line_s       = 1;
+    self->line_e       = 1;
+    self->col_s        = 1;
+    self->col_e        = 1;
+}
+
+token_t scanner__next_token(scanner_t* self) {
+    scanner__skip_whitespaces(self);
+
+    self->start  = self->cur;
+    self->line_s = self->line_e;
+    self->col_s  = self->col_e;
+
+    if (scanner__is_at_end(self)) {
+        return scanner__make_token(self, TOKEN_EOF);
+    }
+
+    char c = scanner__eat(self);
+
+    if (scanner__is_alpha(c)) {
+        return scanner__make_identifier(self);
+    }
+
+    if (scanner__is_digit(c)) {
+        return scanner__make_number(self, false);
+    }
+
+    switch (c) {
+        case '(': return scanner__make_token(self, TOKEN_LEFT_PAREN);
+        case ')': return scanner__make_token(self, TOKEN_RIGHT_PAREN);
+        case '.': {
+            if (scanner__is_digit(scanner__peak(self))) {
+                return scanner__make_number(self, true);
+            }
+        } break ;
+        case '-': {
+            char next_c = scanner__peak(self);
+            if (next_c == '.') {
+                scanner__eat(self);
+                return scanner__make_number(self, true);
+            }
+            if (scanner__is_digit(next_c)) {
+                return scanner__make_number(self, false);
+            }
+        } break ;
+        case '/': {
+            switch (scanner__peak(self)) {
+                case '*':
+                case '/': return scanner__make_comment(self);
+            }
+        } break ;
+    }
+
+    return scanner__make_token(self, TOKEN_ERROR);
+}
+
+const char* token_type__to_str(token_type_t token_type) {
+    switch (token_type) {
+    case TOKEN_LEFT_PAREN: return "LEFT_PAREN";
+    case TOKEN_RIGHT_PAREN: return "RIGHT_PAREN";
+    case TOKEN_INTEGER: return "INTEGER";
+    case TOKEN_REAL: return "REAL";
+    case TOKEN_IDENTIFIER: return "IDENTIFIER";
+    case TOKEN_COMMENT: return "COMMENT";
+    case TOKEN_ERROR: return "ERROR";
+    case TOKEN_EOF: return "EOF";
+    default: assert(false);
+    }
+    return 0;
+}
+
+bool token__is(token_t* self, const char* lexeme) {
+    return (
+        self->type == TOKEN_IDENTIFIER &&
+        strlen(lexeme) == self->lexeme_len &&
+        strncmp(self->lexeme, lexeme, self->lexeme_len) == 0
+    );
+}
+
+int64_t token__to_s64(token_t* self) {
+    assert(self->type == TOKEN_INTEGER);
+
+    // note: lexemes are not null-terminated
+    char buffer[32];
+    const uint32_t len = self->lexeme_len < sizeof(buffer) - 1 ? self->lexeme_len : sizeof(buffer) - 1;
+    memcpy(buffer, self->lexeme, len);
+    buffer[len] = '\0';
+
+    return strtoll(buffer, 0, 10);
+}
+
+double token__to_r64(token_t* self) {
+    assert(self->type == TOKEN_INTEGER || self->type == TOKEN_REAL);
+
+    char buffer[64];
+    const uint32_t len = self->lexeme_len < sizeof(buffer) - 1 ? self->lexeme_len : sizeof(buffer) - 1;
+    memcpy(buffer, self->lexeme, len);
+    buffer[len] = '\0';
+
+    return strtod(buffer, 0);
+}
@@ -0,0 +1,61 @@
+#ifndef SCAN_H
+# define SCAN_H
+
+# include <stdint.h>
+# include <stddef.h>
+# include <stdbool.h>
+
+struct         scanner;
+enum           token_type;
+struct         token;
+typedef struct scanner    scanner_t;
+typedef enum   token_type token_type_t;
+typedef struct token      token_t;
+
+struct scanner {
+    const char*  source_start;
+    const char*  source_end;
+    const char*  start;
+    const char*  cur;
+    uint32_t     line_s;
+    uint32_t     line_e;
+    uint32_t     col_s;
+    uint32_t     col_e;
+};
+
+enum token_type {
+    TOKEN_LEFT_PAREN,
+    TOKEN_RIGHT_PAREN,
+
+    TOKEN_INTEGER, /* 2 -2 */
+    TOKEN_REAL,    /* -2.  2.2  .3 */
+    //! @note Keywords are identifiers too, they are only keywords in the position the compiler expects them
+    TOKEN_IDENTIFIER,
+
+    TOKEN_COMMENT,
+
+    TOKEN_ERROR,
+    TOKEN_EOF
+};
+
+struct token {
+    const char*  lexeme; // not null-terminated
+    uint32_t     lexeme_len;
+    token_type_t type;
+    uint32_t     line_s;
+    uint32_t     line_e;
+    uint32_t     col_s;
+    uint32_t     col_e;
+};
+
+void scanner__create(scanner_t* self, const char* source, size_t source_len);
+token_t scanner__next_token(scanner_t* self);
+
+const char* token_type__to_str(token_type_t token_type);
+
+bool    token__is(token_t* self, const char* lexeme);
+//! @note Integers are read as 64-bit, so unsigned 32-bit ranges can be expressed
+int64_t token__to_s64(token_t* self);
+double  token__to_r64(token_t* self);
+
+#endif // SCAN_H
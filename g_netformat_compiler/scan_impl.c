@@ -0,0 +1,130 @@
+static bool         scanner__is_at_end(scanner_t* self);
+static token_t      scanner__make_token(scanner_t* self, token_type_t type);
+static char         scanner__peak(scanner_t* self);
+static char         scanner__eat(scanner_t* self);
+static bool         scanner__eat_if(scanner_t* self, char expected);
+static void         scanner__skip_whitespaces(scanner_t* self);
+static token_t      scanner__make_comment(scanner_t* self);
+static token_t      scanner__make_number(scanner_t* self, bool seen_dot);
+static token_t      scanner__make_identifier(scanner_t* self);
+
+static bool scanner__is_digit(char c);
+static bool scanner__is_alpha(char c);
+
+static bool scanner__is_at_end(scanner_t* self) {
+    return self->cur == self->source_end || scanner__peak(self) == '\0';
+}
+
+static token_t scanner__make_token(scanner_t* self, token_type_t type) {
+    token_t result = {
+        .lexeme     = self->start,
+        .lexeme_len = (uint32_t) (self->cur - self->start),
+        .type       = type,
+        .line_s     = self->line_s,
+        .line_e     = self->line_e,
+        .col_s      = self->col_s,
+        .col_e      = self->col_e
+    };
+
+    return result;
+}
+
+static char scanner__peak(scanner_t* self) {
+    return *self->cur;
+}
+
+static char scanner__eat(scanner_t* self) {
+    ++self->col_e;
+    return *self->cur++;
+}
+
+static bool scanner__eat_if(scanner_t* self, char expected) {
+    if (scanner__is_at_end(self) || scanner__peak(self) != expected) {
+        return false;
+    }
+
+    scanner__eat(self);
+
+    return true;
+}
+
+static token_t scanner__make_comment(scanner_t* self) {
+    switch (scanner__peak(self)) {
+        case '/': {
+            do {
+                scanner__eat(self);
+            } while (!scanner__is_at_end(self) && scanner__peak(self) != '\n');
+            return scanner__make_token(self, TOKEN_COMMENT);
+        } break ;
+        case '*': {
+            scanner__eat(self);
+            while (!scanner__is_at_end(self)) {
+                char c = scanner__eat(self);
+
+                if (c == '*' && scanner__eat_if(self, '/')) {
+                    return scanner__make_token(self, TOKEN_COMMENT);
+                } else if (c == '\n') {
+                    ++self->line_e;
+                    self->col_e = 1;
+                }
+            }
+        } break ;
+        default: assert(false);
+    }
+
+    return scanner__make_token(self, TOKEN_ERROR);
+}
+
+static void scanner__skip_whitespaces(scanner_t* self) {
+    while (!scanner__is_at_end(self)) {
+        switch (scanner__peak(self)) {
+            case ' ':
+            case '\t':
+            case '\r': {
+                scanner__eat(self);
+            } break ;
+            case '\n': {
+                scanner__eat(self);
+                ++self->line_e;
+                self->col_e = 1;
+            } break ;
+            default: return;
+        }
+    }
+}
+
+static token_t scanner__make_number(scanner_t* self, bool seen_dot) {
+    while (!scanner__is_at_end(self) && scanner__is_digit(scanner__peak(self))) {
+        scanner__eat(self);
+    }
+
+    if (!seen_dot && scanner__eat_if(self, '.')) {
+        seen_dot = true;
+    }
+
+    while (!scanner__is_at_end(self) && scanner__is_digit(scanner__peak(self))) {
+        scanner__eat(self);
+    }
+
+    if (seen_dot) {
+        return scanner__make_token(self, TOKEN_REAL);
+    } else {
+        return scanner__make_token(self, TOKEN_INTEGER);
+    }
+}
+
+static token_t scanner__make_identifier(scanner_t* self) {
+    while (!scanner__is_at_end(self) && (scanner__is_alpha(scanner__peak(self)) || scanner__is_digit(scanner__peak(self)))) {
+        scanner__eat(self);
+    }
+
+    return scanner__make_token(self, TOKEN_IDENTIFIER);
+}
+
+static bool scanner__is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static bool scanner__is_alpha(char c) {
+    return (c >= 'a'&& c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
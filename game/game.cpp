@@ -4,8 +4,10 @@
 #include "helper_macros.h"
 #include "system.h"
 #include "file.h"
+#include "memory.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include "third_party/glm/glm/glm.hpp"
@@ -16,6 +18,9 @@
 #include "third_party/glm/glm/gtx/rotate_vector.hpp"
 
 #define STB_IMAGE_IMPLEMENTATION
+#define STBI_MALLOC(size)            memory__malloc(DEBUG_MODULE_GAME, size)
+#define STBI_REALLOC(p, new_size)    memory__realloc(DEBUG_MODULE_GAME, p, new_size)
+#define STBI_FREE(p)                 memory__free(DEBUG_MODULE_GAME, p)
 #include "third_party/stb/stb_image.h"
 
 //! TODO: use gfx.h API instead of this, but currently experimenting with opengl, and idk what the API could look like for vulkan
@@ -27,7 +32,7 @@ game_t game__create(window_t window) {
     debug__set_message_type_availability(DEBUG_MODULE_GFX, DEBUG_INFO, false);
     debug__set_message_type_availability(DEBUG_MODULE_GAME_CLIENT, DEBUG_INFO, false);
 
-    game_t result = (game_t) calloc(1, sizeof(*result));
+    game_t result = (game_t) memory__calloc(DEBUG_MODULE_GAME, 1, sizeof(*result));
     if (!result) {
         return 0;
     }
@@ -93,7 +98,7 @@ void game__destroy(game_t self) {
         cursor__destroy(self->cursor);
     }
 
-    free(self);
+    memory__free(DEBUG_MODULE_GAME, self);
 }
 
 void game__frame_start(game_t self) {
@@ -115,9 +120,6 @@ void game__update(game_t self, double s) {
     self->time += s;
 
     // todo: because of fixed time update, this is always the same, so can be cached
-    const float move_speed_per_second = 5.0f;
-    const float move_speed = move_speed_per_second * s;
-
     glm::vec3 side = glm::normalize(glm::cross(self->up, self->orientation));
     glm::vec3 up = glm::normalize(glm::cross(self->orientation, side));
 
@@ -130,19 +132,7 @@ void game__update(game_t self, double s) {
 
     if (controller__is_connected(self->controller)) {
         controller_t controller = self->controller;
-        if (controller__button_is_down(controller, BUTTON_GAMEPAD_AXIS_RIGHT_TRIGGER)) {
-            self->position += controller__button_value(controller, BUTTON_GAMEPAD_AXIS_RIGHT_TRIGGER) * move_speed * self->up;
-        }
-        if (controller__button_is_down(controller, BUTTON_GAMEPAD_AXIS_LEFT_TRIGGER)) {
-            self->position -= controller__button_value(controller, BUTTON_GAMEPAD_AXIS_LEFT_TRIGGER) * move_speed * self->up;
-        }
-        if (controller__button_is_down(controller, BUTTON_GAMEPAD_AXIS_LEFT_Y)) {
-            self->position -= controller__button_value(controller, BUTTON_GAMEPAD_AXIS_LEFT_Y) * move_speed * self->orientation;
-        }
-        if (controller__button_is_down(controller, BUTTON_GAMEPAD_AXIS_LEFT_X)) {
-            self->position -= controller__button_value(controller, BUTTON_GAMEPAD_AXIS_LEFT_X) * move_speed * side;
-        }
-
+        // note: moving is predicted by the client, see game__set_position
         if (controller__button_is_down(controller, BUTTON_GAMEPAD_AXIS_RIGHT_Y)) {
             const float pitch_per_second = (float) controller__button_value(controller, BUTTON_GAMEPAD_AXIS_RIGHT_Y);
             const float pitch = 2.5f * pitch_per_second * s;
@@ -168,24 +158,6 @@ void game__update(game_t self, double s) {
 
     if (controller__is_connected(window__get_controller(self->window))) {
         controller_t controller = window__get_controller(self->window);
-        if (controller__button_is_down(controller, BUTTON_SPACE)) {
-            self->position += move_speed * self->up;
-        }
-        if (controller__button_is_down(controller, BUTTON_LCTRL)) {
-            self->position -= move_speed * self->up;
-        }
-        if (controller__button_is_down(controller, BUTTON_A)) {
-            self->position += move_speed * side;
-        }
-        if (controller__button_is_down(controller, BUTTON_D)) {
-            self->position -= move_speed * side;
-        }
-        if (controller__button_is_down(controller, BUTTON_S)) {
-            self->position -= move_speed * self->orientation;
-        }
-        if (controller__button_is_down(controller, BUTTON_W)) {
-            self->position += move_speed * self->orientation;
-        }
 
         int32_t dpcursorx = self->p_cur_cursorx - self->p_prev_cursorx;
         int32_t dpcursory = self->p_cur_cursory - self->p_prev_cursory;
@@ -219,7 +191,21 @@ void game__update(game_t self, double s) {
     system__usleep(100);
 }
 
+void game__set_position(game_t self, float x, float y, float z) {
+    self->position = glm::vec3(x, y, z);
+}
+
+float game__yaw(game_t self) {
+    return atan2f(-self->orientation.x, -self->orientation.z);
+}
+
+void game__set_objects(game_t self, const game_object_t* objects, uint32_t objects_fill) {
+    self->objects_fill = objects_fill < GAME_OBJECTS_SIZE ? objects_fill : GAME_OBJECTS_SIZE;
+    memcpy(self->objects, objects, self->objects_fill * sizeof(*self->objects));
+}
+
 void game__render(game_t self, double factor) {
+    self->draw_mvp = self->player_vp;
     geometry_object__draw(
         &self->geometry,
         &self->shader,
@@ -231,5 +217,26 @@ void game__render(game_t self, double factor) {
         ),
         self
     );
+
+    for (uint32_t object_index = 0; object_index < self->objects_fill; ++object_index) {
+        const game_object_t* object = &self->objects[object_index];
+        const glm::mat4 model = glm::rotate(
+            glm::translate(glm::mat4(1.0f), glm::vec3(object->x, object->y, object->z)),
+            object->yaw, glm::vec3(0.0f, 1.0f, 0.0f)
+        );
+        self->draw_mvp = self->player_vp * model;
+        geometry_object__draw(
+            &self->geometry,
+            &self->shader,
+            vertex_stream_specification(
+                PRIMITIVE_TYPE_TRIANGLE,
+                3, 0,
+                5, 0
+            ),
+            self
+        );
+    }
+
+    // note: remote objects are interpolated by the client at the time of the frame, the local state is only updated in fixed steps
     (void) factor;
 }
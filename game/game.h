@@ -2,12 +2,24 @@
 # define GAME_H
 
 # include <stdbool.h>
+# include <stdint.h>
 
 # include "gfx.h"
 # include "helper_macros.h"
 
 typedef struct game* game_t;
 
+//! @note Objects the game draws at most
+# define GAME_OBJECTS_SIZE 512
+
+//! @brief Remote object, as the client shows it
+typedef struct game_object {
+    float x;
+    float y;
+    float z;
+    float yaw;
+} game_object_t;
+
 /**
  * @brief Creates and initializes the game state
  * @brief Set window options for the game, ex. cursor, icon, size, position
@@ -30,6 +42,21 @@ PUBLIC_API double game__update_upper_bound(game_t self);
 */
 PUBLIC_API void game__update(game_t self, double s);
 
+/**
+ * @brief Moves the camera to the player, it's moved by the client, see prediction_t, the camera only turns by itself
+*/
+PUBLIC_API void game__set_position(game_t self, float x, float y, float z);
+/**
+ * @returns Heading of the camera around the up axis, 0 looking down -z, positive turning left
+*/
+PUBLIC_API float game__yaw(game_t self);
+
+/**
+ * @brief Replaces the objects drawn from the next game__render on, the client interpolates them, see snapshot_buffer_t
+ * @note Only the first GAME_OBJECTS_SIZE are kept
+*/
+PUBLIC_API void game__set_objects(game_t self, const game_object_t* objects, uint32_t objects_fill);
+
 /**
  * @param render_interpolation_factor [0, 1] value that can be used for interpolation during rendering, it is a result of the fixed time step update
 */
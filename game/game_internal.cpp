@@ -23,6 +23,11 @@ struct game {
     int32_t p_cur_cursory;
 
     glm::mat4 player_vp;
+    //! @note Uploaded by the vertex shader predraw callback, set before every draw
+    glm::mat4 draw_mvp;
+
+    game_object_t objects[GAME_OBJECTS_SIZE];
+    uint32_t      objects_fill;
 
     geometry_object_t         geometry;
     shader_program_t          vs_program;
@@ -305,7 +310,7 @@ static bool shader__create_from_file(shader_object_t* self, const char* path, sh
     if (!file__open(&file, path, FILE_ACCESS_MODE_READ, FILE_CREATION_MODE_OPEN)) {
         return false;
     }
-    char* buffer = (char*) malloc(file_size + 1);
+    char* buffer = (char*) memory__malloc(DEBUG_MODULE_GAME, file_size + 1);
     if (!buffer) {
         file__close(&file);
         return false;
@@ -313,7 +318,7 @@ static bool shader__create_from_file(shader_object_t* self, const char* path, sh
     size_t read_bytes = 0;
     if (!file__read(&file, buffer, file_size, &read_bytes)) {
         file__close(&file);
-        free(buffer);
+        memory__free(DEBUG_MODULE_GAME, buffer);
         return false;
     }
     ASSERT(read_bytes == file_size);
@@ -326,7 +331,7 @@ static bool shader__create_from_file(shader_object_t* self, const char* path, sh
         buffer
     );
 
-    free(buffer);
+    memory__free(DEBUG_MODULE_GAME, buffer);
 
     return result;
 }
@@ -366,7 +371,7 @@ static void shader_program__vs_predraw_callback(shader_program_t* self, void* da
     for (uint32_t row = 0; row < 4; ++row) {
         uint32_t offset = vs_common_member_offsets[1] + row * vs_common_member_matrix_strides[1];
         for (uint32_t col = 0; col < 4; ++col) {
-            *((float*) (vs_common_data + offset)) = game->player_vp[col][row];
+            *((float*) (vs_common_data + offset)) = game->draw_mvp[col][row];
             offset += sizeof(float);
         }
     }
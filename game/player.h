@@ -0,0 +1,57 @@
+#ifndef PLAYER_H
+# define PLAYER_H
+
+# include "packet_format.h"
+
+# include <math.h>
+# include <string.h>
+
+/**
+ * Movement of the players, the server and the client both step them by it, so it's only in a header they both include
+ * The client predicts its own player with it, see prediction_t, the server moves every player by the inputs it receives
+*/
+//! @note Per second
+# define PLAYER_SPEED 5.0f
+
+typedef enum player_button {
+    PLAYER_BUTTON_FORWARD  = 1 << 0,
+    PLAYER_BUTTON_BACKWARD = 1 << 1,
+    PLAYER_BUTTON_LEFT     = 1 << 2,
+    PLAYER_BUTTON_RIGHT    = 1 << 3,
+    PLAYER_BUTTON_UP       = 1 << 4,
+    PLAYER_BUTTON_DOWN     = 1 << 5
+} player_button_t;
+
+//! @brief Where players start, on both ends
+static inline void player__spawn(object_state_t* self) {
+    memset(self, 0, sizeof(*self));
+    self->position.z = 3.0f;
+}
+
+/**
+ * @brief Moves 'self' by the buttons held and the yaw of 'input' for 's' seconds
+ * @note See prediction_simulate_t, it's stepped through prediction__simulate
+*/
+static inline void player__simulate(object_state_t* self, const game_data_t* input, float s) {
+    const float distance = PLAYER_SPEED * s;
+    // note: yaw 0 looks down -z, as the camera does before it's turned
+    const float forward_x = -sinf(input->yaw);
+    const float forward_z = -cosf(input->yaw);
+
+    float forward = 0.0f;
+    float right   = 0.0f;
+    float up      = 0.0f;
+    if (input->buttons & PLAYER_BUTTON_FORWARD)  forward += distance;
+    if (input->buttons & PLAYER_BUTTON_BACKWARD) forward -= distance;
+    if (input->buttons & PLAYER_BUTTON_RIGHT)    right   += distance;
+    if (input->buttons & PLAYER_BUTTON_LEFT)     right   -= distance;
+    if (input->buttons & PLAYER_BUTTON_UP)       up      += distance;
+    if (input->buttons & PLAYER_BUTTON_DOWN)     up      -= distance;
+
+    self->position.x += forward * forward_x - right * forward_z;
+    self->position.y += up;
+    self->position.z += forward * forward_z + right * forward_x;
+    self->yaw         = input->yaw;
+}
+
+#endif // PLAYER_H
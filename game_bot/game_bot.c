@@ -0,0 +1,190 @@
+#include "game_bot.h"
+
+#include "tp.h"
+#include "system.h"
+#include "helper_macros.h"
+#include "debug.h"
+#include "packet.h"
+#include "frame.h"
+#include "channel.h"
+#include "send_rate.h"
+#include "histogram.h"
+#include "memory.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+
+#include "game_bot_impl.c"
+
+game_bot_t game_bot__create(game_bot_config_t config, const char* server_ip, uint16_t server_port) {
+    if (config.bots_size == 0) {
+        config.bots_size = GAME_BOT_DEFAULT_BOTS_SIZE;
+    }
+    if (config.tick_rate <= 0.0) {
+        config.tick_rate = GAME_BOT_DEFAULT_TICK_RATE;
+    }
+    if (config.ack_window_size == 0) {
+        config.ack_window_size = ACK_WINDOW_SIZE_DEFAULT;
+    }
+    if (
+        config.ack_window_size > ACK_WINDOW_SIZE_MAX ||
+        (config.message_size == 0 && config.message_interval > 0.0) ||
+        config.message_size > CHANNEL_MESSAGE_SIZE_MAX
+    ) {
+        return 0;
+    }
+
+    // note: a socket per bot
+    struct rlimit files_limit;
+    if (getrlimit(RLIMIT_NOFILE, &files_limit) != 0) {
+        perror("getrlimit");
+        return 0;
+    }
+    const rlim_t files_needed = (rlim_t) config.bots_size + GAME_BOT_FILES_RESERVED;
+    if (files_limit.rlim_cur < files_needed) {
+        files_limit.rlim_cur = files_limit.rlim_max < files_needed ? files_limit.rlim_max : files_needed;
+        if (setrlimit(RLIMIT_NOFILE, &files_limit) != 0 || files_limit.rlim_cur < files_needed) {
+            debug__write_and_flush(
+                DEBUG_MODULE_GAME_BOT, DEBUG_ERROR,
+                "%u bots need %llu open files, the limit is %llu", config.bots_size, (unsigned long long) files_needed, (unsigned long long) files_limit.rlim_cur
+            );
+            return 0;
+        }
+    }
+
+    game_bot_t result = memory__calloc(DEBUG_MODULE_GAME_BOT, 1, sizeof(*result));
+    if (!result) {
+        return 0;
+    }
+    memcpy(&result->config, &config, sizeof(result->config));
+    result->bots_size = config.bots_size;
+    result->epoll_fd = -1;
+
+    if (!network_addr__create(&result->server_addr, server_ip, server_port)) {
+        goto err;
+    }
+
+    if (!game_bot__parse_input_script(result, config.input_script)) {
+        debug__write_and_flush(
+            DEBUG_MODULE_GAME_BOT, DEBUG_ERROR,
+            "malformed input script: %s", config.input_script
+        );
+        goto err;
+    }
+
+    result->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (result->epoll_fd == -1) {
+        perror("epoll_create1");
+        goto err;
+    }
+
+    result->bots = memory__calloc(DEBUG_MODULE_GAME_BOT, result->bots_size, sizeof(*result->bots));
+    if (!result->bots) {
+        goto err;
+    }
+    result->frame_reassembler_memory_size = frame_reassembler__memory_size(GAME_BOT_FRAME_REASSEMBLIES_SIZE, PACKET_MESSAGE_SIZE_MAX);
+    result->frame_reassemblers_memory = memory__malloc(DEBUG_MODULE_GAME_BOT, result->bots_size * result->frame_reassembler_memory_size);
+    if (!result->frame_reassemblers_memory) {
+        goto err;
+    }
+
+    frame_packer__create(&result->frame_packer, &result->send_datagram, result->send_buffer, 1, sizeof(result->send_buffer));
+    histogram__create(&result->time_to_connect_histogram);
+    histogram__create(&result->stats_total.rtt_histogram);
+    histogram__create(&result->stats_interval.rtt_histogram);
+    result->time_first_refused = -1.0;
+
+    return result;
+
+err:
+    game_bot__destroy(result);
+
+    return 0;
+}
+
+void game_bot__destroy(game_bot_t self) {
+    if (self->bots) {
+        for (uint32_t bot_index = 0; bot_index < self->bots_started; ++bot_index) {
+            bot_t* bot = &self->bots[bot_index];
+            if (bot->state == BOT_STATE_CONNECTING || bot->state == BOT_STATE_CONNECTED) {
+                tp_socket__destroy(&bot->tp_socket);
+            }
+            memory__free(DEBUG_MODULE_GAME_BOT, bot->channels);
+        }
+    }
+    if (self->epoll_fd != -1) {
+        close(self->epoll_fd);
+    }
+
+    memory__free(DEBUG_MODULE_GAME_BOT, self->frame_reassemblers_memory);
+    memory__free(DEBUG_MODULE_GAME_BOT, self->bots);
+    memory__free(DEBUG_MODULE_GAME_BOT, self);
+}
+
+void game_bot__run(game_bot_t self, double duration) {
+    debug__write_and_flush(
+        DEBUG_MODULE_GAME_BOT, DEBUG_INFO,
+        "%u bots, %.1lf started per second, %.1lf packets per second each, for %.1lfs",
+        self->bots_size, self->config.bots_per_second, self->config.tick_rate, duration
+    );
+
+    debug__set_message_type_availability(_DEBUG_MODULE_SIZE, DEBUG_NET, false);
+
+    system__init();
+    const double time_tick = 1.0 / self->config.tick_rate;
+    self->time_start       = system__get_time();
+    self->time_tick_next   = self->time_start;
+    self->time_report_prev = self->time_start;
+    const double time_end  = self->time_start + duration;
+
+    struct epoll_event events[GAME_BOT_EPOLL_EVENTS_SIZE];
+    while (true) {
+        double time = system__get_time();
+        if (time_end <= time) {
+            break ;
+        }
+
+        game_bot__start_bots(self, time);
+
+        if (self->time_tick_next <= time) {
+            if (self->time_tick_next + time_tick <= time) {
+                // note: a whole tick behind, the missed ones are dropped instead of being sent in a burst
+                ++self->ticks_late;
+                self->time_tick_next = time;
+            }
+            self->time_tick_next += time_tick;
+            game_bot__tick(self, time);
+        }
+
+        if (self->config.report_interval > 0.0 && self->time_report_prev + self->config.report_interval <= time) {
+            game_bot__write_progress(self, time);
+            game_bot_stats__add(&self->stats_total, &self->stats_interval);
+            game_bot_stats__clear(&self->stats_interval);
+            self->time_report_prev = time;
+        }
+
+        double time_wake = self->time_tick_next < time_end ? self->time_tick_next : time_end;
+        if (self->config.bots_per_second > 0.0 && self->bots_started < self->bots_size) {
+            const double time_bot_next = self->time_start + (double) self->bots_started / self->config.bots_per_second;
+            time_wake = time_bot_next < time_wake ? time_bot_next : time_wake;
+        }
+        time = system__get_time();
+        // note: rounded up, so it doesn't spin for the last fraction of a millisecond
+        const int32_t timeout = time < time_wake ? (int32_t) ((time_wake - time) * 1000.0) + 1 : 0;
+        const int32_t events_fill = epoll_wait(self->epoll_fd, events, ARRAY_SIZE(events), timeout);
+        for (int32_t event_index = 0; event_index < events_fill; ++event_index) {
+            bot_t* bot = &self->bots[events[event_index].data.u32];
+            if (bot->state == BOT_STATE_CONNECTING || bot->state == BOT_STATE_CONNECTED) {
+                game_bot__receive_packets(self, bot);
+            }
+        }
+    }
+
+    game_bot__write_report(self, system__get_time());
+}
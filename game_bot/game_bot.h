@@ -0,0 +1,69 @@
+#ifndef GAME_BOT_H
+# define GAME_BOT_H
+
+# include <stdint.h>
+# include <stdbool.h>
+
+struct         game_bot;
+struct         game_bot_config;
+typedef struct game_bot*       game_bot_t;
+typedef struct game_bot_config game_bot_config_t;
+
+/**
+ * Headless load generator, simulates many clients of the game server from a single process
+ * Every bot has its own udp socket, so the server sees a separate connection for each, they share a single epoll
+ * Bots speak the same protocol as game_client, but don't decode the snapshots, they acknowledge every packet that arrives
+*/
+# define GAME_BOT_DEFAULT_BOTS_SIZE  100
+# define GAME_BOT_DEFAULT_TICK_RATE  60.0
+//! @note Steps of the input script at most
+# define GAME_BOT_INPUT_SCRIPT_SIZE  32
+
+struct game_bot_config {
+    /**
+     * Number of simulated clients, GAME_BOT_DEFAULT_BOTS_SIZE if 0
+    */
+    uint32_t bots_size;
+    /**
+     * Bots started per second, all of them at once if 0
+     * Ramping up shows the number of connections the server starts to refuse or fall behind at
+    */
+    double   bots_per_second;
+    /**
+     * Packets sent per second by each bot, GAME_BOT_DEFAULT_TICK_RATE if 0
+    */
+    double   tick_rate;
+    /**
+     * Time after a bot gives up on the server if no packet arrived from it, whether it connected before or not
+    */
+    double   max_time_for_disconnect;
+    /**
+     * Number of sequence ids before the newest one received that are acknowledged, ACK_WINDOW_SIZE_DEFAULT if 0, at most ACK_WINDOW_SIZE_MAX
+    */
+    uint32_t ack_window_size;
+    /**
+     * Buttons the bots hold, a comma separated list of buttons:seconds that loops, for example "1:0.5,0x5:0.25,0:1"
+     * Every bot starts at a different point of it, no buttons are held if 0
+    */
+    const char* input_script;
+    /**
+     * Every bot sends a reliable message of 'message_size' bytes this often, in seconds, no messages are sent if 0
+     * Bots only have reliable channels then, they cost about 35 KiB each
+    */
+    double   message_interval;
+    uint32_t message_size;
+    /**
+     * Seconds between the progress lines, none if 0
+    */
+    double   report_interval;
+};
+
+game_bot_t game_bot__create(game_bot_config_t config, const char* server_ip, uint16_t server_port);
+void game_bot__destroy(game_bot_t self);
+
+/**
+ * @brief Runs the bots for 'duration' seconds, then writes a summary of how the server held up
+*/
+void game_bot__run(game_bot_t self, double duration);
+
+#endif // GAME_BOT_H
@@ -0,0 +1,53 @@
+#include "game_bot.h"
+
+#include "debug.h"
+#include "metrics.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * game_bot [bots] [bots per second] [seconds] [server ip] [server port]
+ * Starts the bots at the given rate and runs for the given time, the summary report is written at the end
+*/
+int main(int argc, char** argv) {
+    if (argc > 6) {
+        fprintf(stderr, "usage: %s [bots] [bots per second] [seconds] [server ip] [server port]\n", argv[0]);
+        return 1;
+    }
+
+    if (!debug__init_module()) {
+        return 1;
+    }
+
+    if (!metrics__init_module()) {
+        return 1;
+    }
+
+    game_bot_config_t game_bot_config = {
+        .bots_size               = argc > 1 ? (uint32_t) strtoul(argv[1], 0, 10) : 1000,
+        .bots_per_second         = argc > 2 ? strtod(argv[2], 0) : 100.0,
+        .tick_rate               = 60.0,
+        .max_time_for_disconnect = 2.0,
+        .input_script            = "0:0.5,1:0.25,3:0.25,2:0.5",
+        .report_interval         = 1.0
+    };
+
+    const double duration = argc > 3 ? strtod(argv[3], 0) : 30.0;
+    const char* game_server_ip = argc > 4 ? argv[4] : "127.0.0.1";
+    const uint32_t game_server_port = argc > 5 ? (uint32_t) strtoul(argv[5], 0, 10) : 3300;
+    game_bot_t game_bot = game_bot__create(game_bot_config, game_server_ip, game_server_port);
+    if (!game_bot) {
+        return 2;
+    }
+
+    game_bot__run(game_bot, duration);
+
+    game_bot__destroy(game_bot);
+
+    metrics__deinit_module();
+
+    debug__deinit_module();
+
+    return 0;
+}
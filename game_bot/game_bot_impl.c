@@ -0,0 +1,621 @@
+struct         bot;
+struct         input_step;
+struct         game_bot_stats;
+enum           bot_state;
+typedef struct bot            bot_t;
+typedef struct input_step     input_step_t;
+typedef struct game_bot_stats game_bot_stats_t;
+typedef enum   bot_state      bot_state_t;
+
+//! @note Raw rtt samples are taken against the send times of the last this many sequence ids
+# define GAME_BOT_SENT_TIMES_SIZE          64
+//! @note Snapshots reassembled at the same time by a bot, the older one is evicted as its fragments get lost
+# define GAME_BOT_FRAME_REASSEMBLIES_SIZE  2
+# define GAME_BOT_EPOLL_EVENTS_SIZE        256
+//! @note Open files kept on top of the sockets of the bots
+# define GAME_BOT_FILES_RESERVED           64
+
+enum bot_state {
+    // not started yet
+    BOT_STATE_IDLE,
+    // sending, nothing arrived from the server yet
+    BOT_STATE_CONNECTING,
+    BOT_STATE_CONNECTED,
+    // nothing arrived for max_time_for_disconnect since it started, the server is full or overwhelmed
+    BOT_STATE_REFUSED,
+    // nothing arrived for max_time_for_disconnect since the last packet
+    BOT_STATE_TIMED_OUT
+};
+
+struct input_step {
+    uint32_t buttons;
+    double   duration;
+};
+
+struct bot {
+    tp_socket_t    tp_socket;
+    bot_state_t    state;
+    //! @note The server's side of the connection, as seen by the bot
+    connection_t   connection;
+    seq_id_t       sequence_id;
+    //! @note Inputs sent before 'sequence_id', newest first, resent with every packet, see input_history_t
+    input_history_t input_history;
+    //! @note Number of our sequence ids sent so far, acks are only trusted within it
+    uint32_t       packets_sent;
+    //! @note Only its estimators are used, the rtt and the loss of what we send, bots send every tick
+    send_rate_t    send_rate;
+    double         sent_times[GAME_BOT_SENT_TIMES_SIZE];
+    //! @note Newest ack that was sampled for the rtt, every ack is sampled once
+    seq_id_t       ack_sampled;
+    bool           is_ack_sampled;
+    double         time_started;
+    double         time_message_next;
+    //! @note Where in the input script the bot started, so they don't press the same buttons at the same time
+    double         input_offset;
+    uint64_t       packets_received;
+    frame_reassembler_t frame_reassembler;
+    //! @note Allocated only if the bots send messages
+    channel_set_t* channels;
+};
+
+//! @brief Counters that are kept for the whole run and for the time since the last progress line
+struct game_bot_stats {
+    uint64_t    datagrams_sent;
+    uint64_t    bytes_sent;
+    uint64_t    datagrams_received;
+    uint64_t    bytes_received;
+    uint64_t    packets_received;
+    //! @note Packets of the server that left the ack window unreceived
+    uint64_t    packets_lost;
+    uint64_t    packets_malformed;
+    //! @note Sequence ids the server didn't send as it lowered the send rate, see send_rate_t
+    uint64_t    sequence_ids_skipped;
+    uint64_t    messages_sent;
+    //! @note Messages that weren't queued, too many were unacknowledged
+    uint64_t    messages_refused;
+    //! @note Raw round trips, they include the wait for the next tick of the server
+    histogram_t rtt_histogram;
+};
+
+struct game_bot {
+    game_bot_config_t config;
+    network_addr_t    server_addr;
+    int32_t           epoll_fd;
+
+    uint32_t          bots_size;
+    uint32_t          bots_started;
+    bot_t*            bots;
+    void*             frame_reassemblers_memory;
+    uint64_t          frame_reassembler_memory_size;
+
+    input_step_t      input_script[GAME_BOT_INPUT_SCRIPT_SIZE];
+    uint32_t          input_script_size;
+    double            input_script_duration;
+
+    tp_message_t      receive_messages[TP_BATCH_SIZE];
+    uint8_t           receive_buffers[TP_BATCH_SIZE][FRAME_MTU_MAX];
+    frame_packer_t    frame_packer;
+    tp_message_t      send_datagram;
+    uint8_t           send_buffer[FRAME_MTU_DEFAULT];
+    uint8_t           send_message[CHANNEL_MESSAGE_SIZE_MAX];
+
+    double            time_start;
+    double            time_tick_next;
+    double            time_report_prev;
+    uint64_t          ticks;
+    //! @note Ticks that started a whole tick late, past a handful of them the numbers are limited by the bots and not the server
+    uint64_t          ticks_late;
+
+    uint32_t          bots_connected;
+    uint32_t          bots_connected_max;
+    double            time_connected_max;
+    uint32_t          bots_refused;
+    uint32_t          bots_timed_out;
+    //! @note Negative if none was refused
+    double            time_first_refused;
+    uint32_t          bots_connected_at_first_refused;
+    histogram_t       time_to_connect_histogram;
+
+    game_bot_stats_t  stats_total;
+    game_bot_stats_t  stats_interval;
+};
+
+//! @returns false if 'script' is malformed or has more than GAME_BOT_INPUT_SCRIPT_SIZE steps
+static bool game_bot__parse_input_script(game_bot_t self, const char* script);
+static uint32_t game_bot__input_buttons(game_bot_t self, bot_t* bot, double time);
+
+//! @brief Starts the bots that are due by 'time' according to the ramp up
+static void game_bot__start_bots(game_bot_t self, double time);
+static bool game_bot__start_bot(game_bot_t self, uint32_t bot_index, double time);
+static void game_bot__stop_bot(game_bot_t self, bot_t* bot, bot_state_t state, double time);
+
+static void game_bot__tick(game_bot_t self, double time);
+static void game_bot__send_packet(game_bot_t self, bot_t* bot, double time);
+static void game_bot__receive_packets(game_bot_t self, bot_t* bot);
+static void game_bot__receive_message(game_bot_t self, bot_t* bot, const uint8_t* data, uint32_t data_len, double time);
+static void game_bot__sample_rtt(game_bot_t self, bot_t* bot, seq_id_t ack, double time);
+
+static void game_bot__write_progress(game_bot_t self, double time);
+static void game_bot__write_report(game_bot_t self, double time);
+//! @param scale value a histogram unit is divided by for it to be written
+static void game_bot__write_histogram(const char* name, const histogram_t* histogram, double scale);
+
+static void game_bot_stats__add(game_bot_stats_t* self, const game_bot_stats_t* other);
+static void game_bot_stats__clear(game_bot_stats_t* self);
+
+static bool game_bot__parse_input_script(game_bot_t self, const char* script) {
+    self->input_script_size = 0;
+    self->input_script_duration = 0.0;
+    if (!script) {
+        return true;
+    }
+
+    const char* cur = script;
+    while (*cur) {
+        if (self->input_script_size == GAME_BOT_INPUT_SCRIPT_SIZE) {
+            return false;
+        }
+
+        char* end = 0;
+        const unsigned long buttons = strtoul(cur, &end, 0);
+        if (end == cur || *end != ':' || buttons > UINT32_MAX) {
+            return false;
+        }
+        cur = end + 1;
+        const double duration = strtod(cur, &end);
+        if (end == cur || !(duration > 0.0)) {
+            return false;
+        }
+        cur = end;
+        if (*cur == ',') {
+            ++cur;
+        } else if (*cur) {
+            return false;
+        }
+
+        input_step_t* input_step = &self->input_script[self->input_script_size++];
+        input_step->buttons  = (uint32_t) buttons;
+        input_step->duration = duration;
+        self->input_script_duration += duration;
+    }
+
+    return true;
+}
+
+static uint32_t game_bot__input_buttons(game_bot_t self, bot_t* bot, double time) {
+    if (self->input_script_size == 0) {
+        return 0;
+    }
+
+    const double time_script = time - bot->time_started + bot->input_offset;
+    double time_step = time_script - (double) (uint64_t) (time_script / self->input_script_duration) * self->input_script_duration;
+    for (uint32_t step_index = 0; step_index < self->input_script_size; ++step_index) {
+        if (time_step < self->input_script[step_index].duration) {
+            return self->input_script[step_index].buttons;
+        }
+        time_step -= self->input_script[step_index].duration;
+    }
+
+    // note: rounding at the very end of the loop
+    return self->input_script[self->input_script_size - 1].buttons;
+}
+
+static void game_bot__start_bots(game_bot_t self, double time) {
+    uint32_t bots_due = self->bots_size;
+    if (self->config.bots_per_second > 0.0) {
+        const double bots_due_ramp = (time - self->time_start) * self->config.bots_per_second + 1.0;
+        if (bots_due_ramp < (double) self->bots_size) {
+            bots_due = (uint32_t) bots_due_ramp;
+        }
+    }
+
+    while (self->bots_started < bots_due) {
+        const uint32_t bot_index = self->bots_started++;
+        if (!game_bot__start_bot(self, bot_index, time)) {
+            // note: most likely out of ephemeral ports or memory, the server is not to blame
+            debug__write_and_flush(
+                DEBUG_MODULE_GAME_BOT, DEBUG_ERROR,
+                "bot %u failed to start", bot_index
+            );
+        }
+    }
+}
+
+static bool game_bot__start_bot(game_bot_t self, uint32_t bot_index, double time) {
+    bot_t* bot = &self->bots[bot_index];
+    if (self->config.message_interval > 0.0) {
+        bot->channels = memory__malloc(DEBUG_MODULE_GAME_BOT, sizeof(*bot->channels));
+        if (!bot->channels) {
+            return false;
+        }
+        channel_set__create(bot->channels);
+    }
+
+    void* frame_reassembler_memory = (uint8_t*) self->frame_reassemblers_memory + (uint64_t) bot_index * self->frame_reassembler_memory_size;
+    if (!frame_reassembler__create(
+        &bot->frame_reassembler, frame_reassembler_memory, self->frame_reassembler_memory_size,
+        GAME_BOT_FRAME_REASSEMBLIES_SIZE, PACKET_MESSAGE_SIZE_MAX
+    )) {
+        return false;
+    }
+
+    // note: an ephemeral port, every bot is a separate connection for the server
+    if (!tp_socket__create(&bot->tp_socket, SOCKET_TYPE_UDP, 0)) {
+        return false;
+    }
+    if (!tp_socket__connect(&bot->tp_socket, self->server_addr)) {
+        tp_socket__destroy(&bot->tp_socket);
+        return false;
+    }
+    struct epoll_event event = {
+        .events = EPOLLIN,
+        .data.u32 = bot_index
+    };
+    if (epoll_ctl(self->epoll_fd, EPOLL_CTL_ADD, bot->tp_socket.socket, &event) == -1) {
+        perror("epoll_ctl");
+        tp_socket__destroy(&bot->tp_socket);
+        return false;
+    }
+
+    bot->connection.addr = self->server_addr;
+    // note: sent before the connection is accepted too
+    ack_window__create(&bot->connection.ack_window, self->config.ack_window_size);
+    send_rate__create(&bot->send_rate, time);
+    bot->time_started      = time;
+    bot->time_message_next = time + self->config.message_interval;
+    bot->input_offset      = self->input_script_duration * (double) bot_index / (double) self->bots_size;
+    bot->state             = BOT_STATE_CONNECTING;
+
+    return true;
+}
+
+static void game_bot__stop_bot(game_bot_t self, bot_t* bot, bot_state_t state, double time) {
+    ASSERT(state == BOT_STATE_REFUSED || state == BOT_STATE_TIMED_OUT);
+
+    if (bot->state == BOT_STATE_CONNECTED) {
+        --self->bots_connected;
+    }
+    if (state == BOT_STATE_REFUSED) {
+        if (self->time_first_refused < 0.0) {
+            self->time_first_refused = time - self->time_start;
+            self->bots_connected_at_first_refused = self->bots_connected;
+        }
+        ++self->bots_refused;
+    } else {
+        ++self->bots_timed_out;
+    }
+    bot->state = state;
+
+    // note: closing it removes it from the epoll too
+    tp_socket__destroy(&bot->tp_socket);
+}
+
+static void game_bot__tick(game_bot_t self, double time) {
+    ++self->ticks;
+    for (uint32_t bot_index = 0; bot_index < self->bots_started; ++bot_index) {
+        bot_t* bot = &self->bots[bot_index];
+        if (bot->state == BOT_STATE_CONNECTING) {
+            if (bot->time_started + self->config.max_time_for_disconnect < time) {
+                game_bot__stop_bot(self, bot, BOT_STATE_REFUSED, time);
+                continue ;
+            }
+        } else if (bot->state == BOT_STATE_CONNECTED) {
+            if (bot->connection.time_last_seen + self->config.max_time_for_disconnect < time) {
+                game_bot__stop_bot(self, bot, BOT_STATE_TIMED_OUT, time);
+                continue ;
+            }
+        } else {
+            continue ;
+        }
+
+        game_bot__send_packet(self, bot, time);
+    }
+}
+
+static void game_bot__send_packet(game_bot_t self, bot_t* bot, double time) {
+    packet_t packet = {
+        .sequence_id = bot->sequence_id,
+        .ack = bot->connection.sequence_id,
+        .game_data.buttons = game_bot__input_buttons(self, bot, time)
+    };
+
+    uint8_t buffer[PACKET_SIZE_MAX + ACK_WINDOW_ENCODING_SIZE_MAX + INPUT_HISTORY_DELTA_SIZE_MAX + CHANNEL_SET_WRITE_SIZE_MAX];
+    uint32_t buffer_len = 0;
+    uint32_t acks_size = 0;
+    uint32_t input_history_size = 0;
+    if (
+        !packet__write(&packet, buffer, sizeof(buffer), &buffer_len) ||
+        !ack_window__write(&bot->connection.ack_window, buffer + buffer_len, sizeof(buffer) - buffer_len, &acks_size) ||
+        !input_history__write_after(&bot->input_history, &packet, buffer + buffer_len + acks_size, sizeof(buffer) - buffer_len - acks_size, &input_history_size)
+    ) {
+        // note: every field is full range
+        ASSERT(false);
+        return ;
+    }
+    buffer_len += acks_size + input_history_size;
+
+    // note: a full history, the bots don't track which of their inputs the server has
+    input_history_t* input_history = &bot->input_history;
+    const uint32_t inputs_kept = input_history->inputs_fill < INPUT_HISTORY_INPUTS_SIZE ? input_history->inputs_fill : INPUT_HISTORY_INPUTS_SIZE - 1;
+    memmove(&input_history->inputs[1], &input_history->inputs[0], inputs_kept * sizeof(*input_history->inputs));
+    input_history->inputs[0]   = packet.game_data;
+    input_history->inputs_fill = inputs_kept + 1;
+
+    if (bot->channels) {
+        if (bot->time_message_next <= time) {
+            bot->time_message_next += self->config.message_interval;
+            memset(self->send_message, (int) (bot - self->bots), self->config.message_size);
+            if (channel_set__push(bot->channels, CHANNEL_TYPE_RELIABLE_ORDERED, self->send_message, self->config.message_size)) {
+                ++self->stats_interval.messages_sent;
+            } else {
+                ++self->stats_interval.messages_refused;
+            }
+        }
+        // note: the server doesn't reassemble, so the messages are limited to what fits next to the packet in a datagram
+        const uint32_t channels_size_max = FRAME_MTU_DEFAULT - FRAME_HEADER_SIZE - buffer_len;
+        uint32_t channels_size = 0;
+        channel_set__write(
+            bot->channels, packet.sequence_id, buffer + buffer_len,
+            channels_size_max < sizeof(buffer) - buffer_len ? channels_size_max : sizeof(buffer) - buffer_len, &channels_size
+        );
+        buffer_len += channels_size;
+    } else {
+        // note: an empty channel set, see channel_set_t
+        buffer[buffer_len++] = 0;
+    }
+
+    if (!frame_packer__push(&self->frame_packer, buffer, buffer_len, self->server_addr)) {
+        // note: the packet always fits into a datagram
+        ASSERT(false);
+        return ;
+    }
+    for (uint32_t datagram_index = 0; datagram_index < self->frame_packer.datagrams_fill; ++datagram_index) {
+        tp_message_t* datagram = &self->frame_packer.datagrams[datagram_index];
+        if (tp_socket__send_data(&bot->tp_socket, datagram->data, datagram->data_size)) {
+            ++self->stats_interval.datagrams_sent;
+            self->stats_interval.bytes_sent += datagram->data_size;
+        }
+    }
+    frame_packer__clear(&self->frame_packer);
+
+    send_rate__on_sent(&bot->send_rate, packet.sequence_id, time);
+    bot->sent_times[packet.sequence_id % GAME_BOT_SENT_TIMES_SIZE] = time;
+    ++bot->packets_sent;
+    ++bot->sequence_id;
+}
+
+static void game_bot__receive_packets(game_bot_t self, bot_t* bot) {
+    uint32_t messages_received = 0;
+    do {
+        for (uint32_t message_index = 0; message_index < TP_BATCH_SIZE; ++message_index) {
+            self->receive_messages[message_index].data      = self->receive_buffers[message_index];
+            self->receive_messages[message_index].data_size = sizeof(self->receive_buffers[message_index]);
+        }
+        messages_received = tp_socket__get_data_batch(&bot->tp_socket, self->receive_messages, TP_BATCH_SIZE);
+        for (uint32_t message_index = 0; message_index < messages_received; ++message_index) {
+            tp_message_t* datagram = &self->receive_messages[message_index];
+            ++self->stats_interval.datagrams_received;
+            self->stats_interval.bytes_received += datagram->data_len;
+
+            // note: the socket is connected, everything that arrives is from the server
+            frame_unpacker_t frame_unpacker;
+            frame_unpacker__create(&frame_unpacker, datagram->data, datagram->data_len);
+            const void* message = 0;
+            uint32_t message_size = 0;
+            while (frame_unpacker__next(&frame_unpacker, &bot->frame_reassembler, &message, &message_size)) {
+                game_bot__receive_message(self, bot, message, message_size, datagram->time_arrival);
+            }
+            if (frame_unpacker.error) {
+                ++self->stats_interval.packets_malformed;
+            }
+        }
+    } while (messages_received == TP_BATCH_SIZE);
+}
+
+static void game_bot__receive_message(game_bot_t self, bot_t* bot, const uint8_t* data, uint32_t data_len, double time) {
+    packet_t packet;
+    uint32_t packet_size = 0;
+    ack_window_t acks;
+    uint32_t acks_size = 0;
+    if (
+        !packet__read(&packet, data, data_len, &packet_size) ||
+        !ack_window__read(&acks, data + packet_size, data_len - packet_size, &acks_size)
+    ) {
+        ++self->stats_interval.packets_malformed;
+        return ;
+    }
+    packet_size += acks_size;
+
+    if (bot->channels) {
+        uint32_t channels_size = 0;
+        if (!channel_set__read(bot->channels, data + packet_size, data_len - packet_size, &channels_size)) {
+            ++self->stats_interval.packets_malformed;
+            return ;
+        }
+        for (uint32_t type = 0; type < _CHANNEL_TYPE_SIZE; ++type) {
+            const void* message = 0;
+            uint32_t message_size = 0;
+            while (channel_set__pop(bot->channels, (channel_type_t) type, &message, &message_size)) {
+            }
+        }
+    }
+    // note: the snapshot is not decoded, it's what the server spends its time on, not the bots
+
+    if (bot->state == BOT_STATE_CONNECTING) {
+        connection__accept(&bot->connection, self->server_addr, &packet, time);
+        bot->state = BOT_STATE_CONNECTED;
+        histogram__record_time(&self->time_to_connect_histogram, time - bot->time_started);
+        ++self->bots_connected;
+        if (self->bots_connected_max < self->bots_connected) {
+            self->bots_connected_max = self->bots_connected;
+            self->time_connected_max = time - self->time_start;
+        }
+    }
+    self->stats_interval.packets_lost += connection__receive_packet(&bot->connection, &packet, time);
+    self->stats_interval.sequence_ids_skipped += packet.sequence_id_skipped;
+    ++self->stats_interval.packets_received;
+    ++bot->packets_received;
+
+    // note: the server only acks sequence ids it received from us, unless it's misbehaving
+    if (sequence_id__delta(sequence_id__sub(bot->sequence_id, 1), packet.ack) < bot->packets_sent) {
+        if (bot->channels) {
+            channel_set__ack(bot->channels, packet.ack, &acks);
+        }
+        send_rate__on_ack(&bot->send_rate, packet.ack, &acks, time);
+        game_bot__sample_rtt(self, bot, packet.ack, time);
+    }
+}
+
+static void game_bot__sample_rtt(game_bot_t self, bot_t* bot, seq_id_t ack, double time) {
+    if (bot->is_ack_sampled && !sequence_id__is_more_recent(ack, bot->ack_sampled)) {
+        return ;
+    }
+    if (sequence_id__delta(sequence_id__sub(bot->sequence_id, 1), ack) >= GAME_BOT_SENT_TIMES_SIZE) {
+        // note: its send time is overwritten already
+        return ;
+    }
+
+    bot->ack_sampled    = ack;
+    bot->is_ack_sampled = true;
+    histogram__record_time(&self->stats_interval.rtt_histogram, time - bot->sent_times[ack % GAME_BOT_SENT_TIMES_SIZE]);
+}
+
+static void game_bot__write_progress(game_bot_t self, double time) {
+    game_bot_stats_t* stats = &self->stats_interval;
+    const double elapsed_time = time - self->time_report_prev;
+    const uint64_t packets_expected = stats->packets_received + stats->packets_lost;
+    // note: what the server acknowledged of ours, a server that can't keep up drops them before it even reads them
+    double loss_out = 0.0;
+    for (uint32_t bot_index = 0; bot_index < self->bots_started; ++bot_index) {
+        if (self->bots[bot_index].state == BOT_STATE_CONNECTED) {
+            loss_out += self->bots[bot_index].send_rate.loss;
+        }
+    }
+    loss_out = self->bots_connected ? loss_out / (double) self->bots_connected : 0.0;
+    debug__write_and_flush(
+        DEBUG_MODULE_GAME_BOT, DEBUG_INFO,
+        "%7.1lfs bots: %u started, %u connected, %u refused, %u timed out | "
+        "in: %.0lf datagrams/s, %.1lf KiB/s, loss %.2lf%%, skipped %.0lf/s | out: %.0lf datagrams/s, loss %.2lf%% | "
+        "rtt p50 %.1lfms, p99 %.1lfms | late ticks: %llu",
+        time - self->time_start, self->bots_started, self->bots_connected, self->bots_refused, self->bots_timed_out,
+        (double) stats->datagrams_received / elapsed_time, (double) stats->bytes_received / 1024.0 / elapsed_time,
+        packets_expected ? 100.0 * (double) stats->packets_lost / (double) packets_expected : 0.0,
+        (double) stats->sequence_ids_skipped / elapsed_time, (double) stats->datagrams_sent / elapsed_time, 100.0 * loss_out,
+        histogram__percentile(&stats->rtt_histogram, 50.0) / 1000000.0, histogram__percentile(&stats->rtt_histogram, 99.0) / 1000000.0,
+        (unsigned long long) self->ticks_late
+    );
+}
+
+static void game_bot__write_report(game_bot_t self, double time) {
+    game_bot_stats__add(&self->stats_total, &self->stats_interval);
+    game_bot_stats__clear(&self->stats_interval);
+
+    // note: the state of the bots that are still connected, one sample per bot
+    histogram_t* rtt_smoothed_histogram = memory__malloc(DEBUG_MODULE_GAME_BOT, 3 * sizeof(*rtt_smoothed_histogram));
+    if (!rtt_smoothed_histogram) {
+        return ;
+    }
+    histogram_t* loss_out_histogram = rtt_smoothed_histogram + 1;
+    histogram_t* loss_in_histogram  = rtt_smoothed_histogram + 2;
+    histogram__create(rtt_smoothed_histogram);
+    histogram__create(loss_out_histogram);
+    histogram__create(loss_in_histogram);
+    uint32_t bots_degraded = 0;
+    for (uint32_t bot_index = 0; bot_index < self->bots_started; ++bot_index) {
+        bot_t* bot = &self->bots[bot_index];
+        if (bot->state != BOT_STATE_CONNECTED) {
+            continue ;
+        }
+        if (bot->send_rate.has_rtt) {
+            histogram__record_time(rtt_smoothed_histogram, bot->send_rate.rtt_smoothed);
+        }
+        // note: in basis points
+        histogram__record(loss_out_histogram, (uint64_t) (bot->send_rate.loss * 10000.0));
+        const uint64_t packets_expected = bot->packets_received + bot->connection.packets_dropped;
+        histogram__record(loss_in_histogram, packets_expected ? bot->connection.packets_dropped * 10000 / packets_expected : 0);
+        if (send_rate__is_degraded(&bot->send_rate)) {
+            ++bots_degraded;
+        }
+    }
+
+    game_bot_stats_t* stats = &self->stats_total;
+    const double elapsed_time = time - self->time_start;
+    const uint64_t packets_expected = stats->packets_received + stats->packets_lost;
+
+    debug__lock();
+
+    debug__writeln("Game bot report after %.1lfs, %u bots at %.1lf packets/s each", elapsed_time, self->bots_size, self->config.tick_rate);
+    debug__writeln("  Capacity:");
+    debug__writeln("    Started:               %u", self->bots_started);
+    debug__writeln("    Connected:             %u now, %u at most at %.1lfs", self->bots_connected, self->bots_connected_max, self->time_connected_max);
+    if (self->time_first_refused < 0.0) {
+        debug__writeln("    Refused:               none");
+    } else {
+        debug__writeln("    Refused:               %u, the first at %.1lfs with %u connected", self->bots_refused, self->time_first_refused, self->bots_connected_at_first_refused);
+    }
+    debug__writeln("    Timed out:             %u", self->bots_timed_out);
+    debug__writeln("    Degraded:              %u of the bots, their loss or rtt is past the thresholds of send_rate_t", bots_degraded);
+    debug__writeln(
+        "    Skipped by the server: %llu sequence ids, %.2lf%% of the ones sent to us",
+        (unsigned long long) stats->sequence_ids_skipped,
+        stats->packets_received + stats->sequence_ids_skipped ? 100.0 * (double) stats->sequence_ids_skipped / (double) (stats->packets_received + stats->sequence_ids_skipped) : 0.0
+    );
+    debug__writeln("  Traffic:");
+    debug__writeln("    Sent:                  %llu datagrams, %.1lf/s, %.1lf KiB/s", (unsigned long long) stats->datagrams_sent, (double) stats->datagrams_sent / elapsed_time, (double) stats->bytes_sent / 1024.0 / elapsed_time);
+    debug__writeln("    Received:              %llu datagrams, %.1lf/s, %.1lf KiB/s", (unsigned long long) stats->datagrams_received, (double) stats->datagrams_received / elapsed_time, (double) stats->bytes_received / 1024.0 / elapsed_time);
+    debug__writeln("    Packets received:      %llu, %llu lost, %.2lf%%", (unsigned long long) stats->packets_received, (unsigned long long) stats->packets_lost, packets_expected ? 100.0 * (double) stats->packets_lost / (double) packets_expected : 0.0);
+    debug__writeln("    Malformed:             %llu", (unsigned long long) stats->packets_malformed);
+    if (self->config.message_interval > 0.0) {
+        debug__writeln("    Messages:              %llu sent, %llu refused as too many were unacknowledged", (unsigned long long) stats->messages_sent, (unsigned long long) stats->messages_refused);
+    }
+    debug__writeln("  Percentiles:             %10s %10s %10s %10s %10s", "p50", "p90", "p99", "p99.9", "max");
+    game_bot__write_histogram("Time to connect (ms)", &self->time_to_connect_histogram, 1000000.0);
+    game_bot__write_histogram("Rtt (ms)", &stats->rtt_histogram, 1000000.0);
+    game_bot__write_histogram("Rtt smoothed (ms)", rtt_smoothed_histogram, 1000000.0);
+    game_bot__write_histogram("Loss sent (%)", loss_out_histogram, 100.0);
+    game_bot__write_histogram("Loss received (%)", loss_in_histogram, 100.0);
+    debug__writeln("  Bots:");
+    debug__writeln("    Ticks:                 %llu, %llu late", (unsigned long long) self->ticks, (unsigned long long) self->ticks_late);
+    if (self->ticks_late * 100 > self->ticks) {
+        debug__writeln("    The bots fell behind their tick rate, the numbers above are limited by this process and not by the server");
+    }
+    debug__writeln("  Memory:");
+    debug__write_memory_stats(elapsed_time);
+    debug__flush(DEBUG_MODULE_GAME_BOT, DEBUG_INFO);
+
+    debug__unlock();
+
+    memory__free(DEBUG_MODULE_GAME_BOT, rtt_smoothed_histogram);
+}
+
+static void game_bot__write_histogram(const char* name, const histogram_t* histogram, double scale) {
+    debug__writeln(
+        "    %-21s %10.2lf %10.2lf %10.2lf %10.2lf %10.2lf",
+        name,
+        histogram__percentile(histogram, 50.0) / scale,
+        histogram__percentile(histogram, 90.0) / scale,
+        histogram__percentile(histogram, 99.0) / scale,
+        histogram__percentile(histogram, 99.9) / scale,
+        histogram__max(histogram) / scale
+    );
+}
+
+static void game_bot_stats__add(game_bot_stats_t* self, const game_bot_stats_t* other) {
+    self->datagrams_sent       += other->datagrams_sent;
+    self->bytes_sent           += other->bytes_sent;
+    self->datagrams_received   += other->datagrams_received;
+    self->bytes_received       += other->bytes_received;
+    self->packets_received     += other->packets_received;
+    self->packets_lost         += other->packets_lost;
+    self->packets_malformed    += other->packets_malformed;
+    self->sequence_ids_skipped += other->sequence_ids_skipped;
+    self->messages_sent        += other->messages_sent;
+    self->messages_refused     += other->messages_refused;
+    histogram__merge(&self->rtt_histogram, &other->rtt_histogram);
+}
+
+static void game_bot_stats__clear(game_bot_stats_t* self) {
+    histogram_t* rtt_histogram = &self->rtt_histogram;
+    memset(self, 0, offsetof(game_bot_stats_t, rtt_histogram));
+    histogram__clear(rtt_histogram);
+}
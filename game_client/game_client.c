@@ -6,7 +6,16 @@
 #include "debug.h"
 #include "game.h"
 #include "packet.h"
+#include "prediction.h"
+#include "player.h"
+#include "snapshot_buffer.h"
+#include "frame.h"
+#include "channel.h"
+#include "link_conditioner.h"
 #include "gfx.h"
+#include "histogram.h"
+#include "metrics.h"
+#include "memory.h"
 
 #include <stdlib.h>
 #include <stdbool.h>
@@ -28,6 +37,31 @@ game_client_t game_client__create(game_client_config_t config, uint16_t client_p
         "created udp socket on port %u", client_port
     );
 
+    const char* link_conditioner = config.link_conditioner ? config.link_conditioner : getenv(LINK_CONDITIONER_ENV);
+    if (link_conditioner) {
+        link_conditioner_config_t link_conditioner_config;
+        if (
+            !link_conditioner_config__parse(&link_conditioner_config, link_conditioner) ||
+            !tp_socket__set_link_conditioner(&tp_socket, &link_conditioner_config)
+        ) {
+            tp_socket__destroy(&tp_socket);
+            return 0;
+        }
+        debug__write_and_flush(
+            DEBUG_MODULE_GAME_CLIENT, DEBUG_INFO,
+            "link conditioner: %s", link_conditioner
+        );
+    }
+
+    if (config.shm) {
+        // note: not fatal, it stays on UDP
+        const bool is_shm_enabled = tp_socket__enable_shm(&tp_socket);
+        debug__write_and_flush(
+            DEBUG_MODULE_GAME_CLIENT, DEBUG_INFO,
+            "shared memory transport: %s", is_shm_enabled ? "enabled" : "failed to enable"
+        );
+    }
+
     network_addr_t server_addr;
     if (!network_addr__create(&server_addr, server_ip, server_port)) {
         return false;
@@ -39,7 +73,7 @@ game_client_t game_client__create(game_client_config_t config, uint16_t client_p
     }
 
     const uint32_t sent_packets_queue_size = config.max_time_after_packet_is_lost * config.max_target_fps * 1.5;
-    sent_packet_t* sent_packets_queue = calloc(1, sent_packets_queue_size * sizeof(*sent_packets_queue));
+    sent_packet_t* sent_packets_queue = memory__calloc(DEBUG_MODULE_GAME_CLIENT, 1, sent_packets_queue_size * sizeof(*sent_packets_queue));
     if (!sent_packets_queue) {
         return 0;
     }
@@ -57,34 +91,67 @@ game_client_t game_client__create(game_client_config_t config, uint16_t client_p
         return 0;
     }
 
-    game_client_t result = calloc(1, sizeof(*result));
+    game_client_t result = memory__calloc(DEBUG_MODULE_GAME_CLIENT, 1, sizeof(*result));
     if (!result) {
         tp_socket__destroy(&tp_socket);
         return 0;
     }
 
     result->game_state = game_state;
+    object_state_t player;
+    player__spawn(&player);
+    prediction__create(&result->prediction, &player, &player__simulate);
+    snapshot_buffer__create(&result->snapshot_buffer);
 
     memcpy(&result->config, &config, sizeof(result->config));
 
     result->tp_socket = tp_socket;
     memcpy(&result->connection.addr, &server_addr, sizeof(result->connection.addr));
+    const uint32_t ack_window_size = config.ack_window_size ? config.ack_window_size : ACK_WINDOW_SIZE_DEFAULT;
+    if (ack_window_size > ACK_WINDOW_SIZE_MAX) {
+        return 0;
+    }
+    // note: sent before the connection is accepted too
+    ack_window__create(&result->connection.ack_window, ack_window_size);
     
-    result->frame_info_sample_size = 128;
-    result->frame_info_sample = malloc(result->frame_info_sample_size * sizeof(*result->frame_info_sample));
+    histogram__create(&result->time_update_histogram);
+    histogram__create(&result->time_render_histogram);
+    histogram__create(&result->time_frame_histogram);
+
+    if (!game_client__register_metrics(result)) {
+        return 0;
+    }
 
     result->sent_packets_queue_size = sent_packets_queue_size;
     result->sent_packets_queue = sent_packets_queue;
 
+    result->snapshots = memory__calloc(DEBUG_MODULE_GAME_CLIENT, SNAPSHOT_HISTORY_SIZE, sizeof(*result->snapshots));
+    if (!result->snapshots) {
+        return 0;
+    }
+
+    // note: a couple of snapshots in flight at once, older ones are evicted as their fragments get lost
+    const uint32_t frame_reassemblies_size = 4;
+    const uint64_t frame_reassembler_memory_size = frame_reassembler__memory_size(frame_reassemblies_size, PACKET_MESSAGE_SIZE_MAX);
+    result->frame_reassembler_memory = memory__malloc(DEBUG_MODULE_GAME_CLIENT, frame_reassembler_memory_size);
+    if (!result->frame_reassembler_memory) {
+        return 0;
+    }
+    if (!frame_reassembler__create(&result->frame_reassembler, result->frame_reassembler_memory, frame_reassembler_memory_size, frame_reassemblies_size, PACKET_MESSAGE_SIZE_MAX)) {
+        return 0;
+    }
+    channel_set__create(&result->channels);
+    frame_packer__create(&result->frame_packer, &result->send_datagram, result->send_buffer, 1, sizeof(result->send_buffer));
+
     result->window = window;
 
-    game_client__push_stage(result, &loop_stage__collect_previous_frame_info);
+    game_client__push_stage(result, "Stage collect info", &loop_stage__collect_previous_frame_info);
     // todo: hot reload stage
-    // game_client__push_stage(result, &loop_stage__reload_game_dll);
-    game_client__push_stage(result, &loop_stage__poll_inputs);
-    game_client__push_stage(result, &loop_stage__update_loop);
-    game_client__push_stage(result, &loop_stage__render);
-    game_client__push_stage(result, &loop_stage__sleep_till_end_of_frame);
+    // game_client__push_stage(result, "Stage reload game", &loop_stage__reload_game_dll);
+    game_client__push_stage(result, "Stage poll inputs", &loop_stage__poll_inputs);
+    game_client__push_stage(result, "Stage update loop", &loop_stage__update_loop);
+    game_client__push_stage(result, "Stage render", &loop_stage__render);
+    game_client__push_stage(result, "Stage sleep", &loop_stage__sleep_till_end_of_frame);
 
     return result;
 }
@@ -96,7 +163,9 @@ void game_client__destroy(game_client_t self) {
 
     gfx__deinit();
 
-    free(self);
+    memory__free(DEBUG_MODULE_GAME_CLIENT, self->frame_reassembler_memory);
+    memory__free(DEBUG_MODULE_GAME_CLIENT, self->snapshots);
+    memory__free(DEBUG_MODULE_GAME_CLIENT, self);
 }
 
 void game_client__run(game_client_t self, double target_fps) {
@@ -118,7 +187,9 @@ void game_client__run(game_client_t self, double target_fps) {
             const double loop_stage_time_start = system__get_time();
             loop_stage->time_start = loop_stage_time_start;
             if (stage_id > 0) {
-                self->loop_stages[stage_id - 1].time_elapsed = loop_stage_time_start - self->loop_stages[stage_id - 1].time_start;
+                loop_stage_t* prev_loop_stage = &self->loop_stages[stage_id - 1];
+                prev_loop_stage->time_elapsed = loop_stage_time_start - prev_loop_stage->time_start;
+                histogram__record_time(&prev_loop_stage->time_elapsed_histogram, prev_loop_stage->time_elapsed);
             }
             loop_stage = &self->loop_stages[stage_id];
             if (!loop_stage->loop_stage__execute(loop_stage, self)) {
@@ -127,6 +198,7 @@ void game_client__run(game_client_t self, double target_fps) {
             }
         }
         loop_stage->time_elapsed = system__get_time() - loop_stage->time_start;
+        histogram__record_time(&loop_stage->time_elapsed_histogram, loop_stage->time_elapsed);
     }
 }
 
@@ -134,3 +206,7 @@ double game_client__time(game_client_t self) {
     (void) self;
     return system__get_time();
 }
+
+bool game_client__send_message(game_client_t self, const void* data, uint32_t data_size, bool is_ordered) {
+    return channel_set__push(&self->channels, is_ordered ? CHANNEL_TYPE_RELIABLE_ORDERED : CHANNEL_TYPE_RELIABLE_UNORDERED, data, data_size);
+}
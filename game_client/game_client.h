@@ -2,6 +2,7 @@
 # define GAME_CLIENT_H
 
 # include <stdint.h>
+# include <stdbool.h>
 
 struct         game_client;
 struct         game_client_config;
@@ -11,6 +12,25 @@ typedef struct game_client_config game_client_config_t;
 struct game_client_config {
     const double max_time_after_packet_is_lost;
     const double max_target_fps;
+    /**
+     * Number of sequence ids before the newest one received that are acknowledged, ACK_WINDOW_SIZE_DEFAULT if 0, at most ACK_WINDOW_SIZE_MAX
+    */
+    const uint32_t ack_window_size;
+    /**
+     * Impairs the datagrams sent to the server, see link_conditioner_t for the syntax
+     * The LINK_CONDITIONER_ENV environment variable is used if 0, the link is left alone if neither is set
+    */
+    const char* const link_conditioner;
+    /**
+     * Exchanges datagrams through shared memory instead of UDP if the server is on the same host and enabled it too, see tp_shm_t
+    */
+    const bool shm;
+    /**
+     * Called with 'message_receive_data' for every reliable message received from the server, in the order of its channel, they are dropped if 0
+     * 'data' is only valid during the call
+    */
+    void (*const message_receive)(const void* data, uint32_t data_size, bool is_ordered, void* user_data);
+    void* const message_receive_data;
 };
 
 game_client_t game_client__create(game_client_config_t config, uint16_t client_port, const char* server_ip, uint16_t server_port);
@@ -23,4 +43,11 @@ void game_client__run(game_client_t self, double target_fps);
 */
 double game_client__time(game_client_t self);
 
+/**
+ * @brief Queues a reliable message to the server, it goes out with the next packets
+ * @param is_ordered if true, they are handed out in the order they were queued, otherwise as soon as they arrive
+ * @returns false if it's too large or too many messages are unacknowledged
+*/
+bool game_client__send_message(game_client_t self, const void* data, uint32_t data_size, bool is_ordered);
+
 #endif // GAME_CLIENT_H
@@ -1,15 +1,21 @@
 #include "game_client.h"
 
 #include "debug.h"
+#include "metrics.h"
 
 int main() {
     if (!debug__init_module()) {
         return 1;
     }
 
+    if (!metrics__init_module()) {
+        return 1;
+    }
+
     game_client_config_t game_client_config = {
         .max_target_fps = 60,
-        .max_time_after_packet_is_lost = 1.0
+        .max_time_after_packet_is_lost = 1.0,
+        .shm = true
     };
 
     const uint32_t game_client_port = 3100;
@@ -28,6 +34,8 @@ int main() {
 
     game_client__destroy(game_client);
 
+    metrics__deinit_module();
+
     debug__deinit_module();
 
     return 0;
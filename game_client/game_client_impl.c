@@ -15,9 +15,11 @@ struct frame_info {
 };
 
 struct loop_stage {
-    double   time_start;
-    double   time_elapsed;
-    bool     (*loop_stage__execute)(struct loop_stage* self, game_client_t game_client);
+    const char*  name;
+    double       time_start;
+    double       time_elapsed;
+    histogram_t  time_elapsed_histogram;
+    bool         (*loop_stage__execute)(struct loop_stage* self, game_client_t game_client);
 };
 
 struct sent_packet {
@@ -39,7 +41,29 @@ struct game_client {
     uint32_t       sent_packets_queue_size;
     sent_packet_t* sent_packets_queue;
 
+    /**
+     * Snapshots received, indexed by sequence id modulo SNAPSHOT_HISTORY_SIZE, they are the bases of the deltas
+     * Only packets whose snapshot could be decoded are acknowledged, so the server never deltas against one we don't have
+    */
+    snapshot_t*    snapshots;
+    seq_id_t       snapshots_sequence_id[SNAPSHOT_HISTORY_SIZE];
+    bool           snapshots_is_valid[SNAPSHOT_HISTORY_SIZE];
+    //! @note Times the snapshots as they arrive, the objects are shown a jitter buffer behind them
+    snapshot_buffer_t snapshot_buffer;
+    snapshot_t        snapshot_shown;
+
+    channel_set_t  channels;
+
+    //! @note Snapshots larger than the mtu arrive in fragments
+    frame_reassembler_t frame_reassembler;
+    void*               frame_reassembler_memory;
+    frame_packer_t      frame_packer;
+    tp_message_t        send_datagram;
+    uint8_t             send_buffer[FRAME_MTU_DEFAULT];
+
     game_t         game_state;
+    //! @note Position of the camera, the game only turns it
+    prediction_t   prediction;
 
     uint32_t       current_frame;
     double         time_lost;
@@ -51,10 +75,19 @@ struct game_client {
     uint32_t       loop_stages_size;
     loop_stage_t*  loop_stages;
     frame_info_t   previous_frame_info;
-    uint32_t       frame_info_sample_index_tail;
-    uint32_t       frame_info_sample_index_head;
-    uint32_t       frame_info_sample_size;
-    frame_info_t*  frame_info_sample;
+    uint32_t       frames_missed_deadline;
+    uint32_t       frames_missed_deadline_total;
+    histogram_t    time_update_histogram;
+    histogram_t    time_render_histogram;
+    histogram_t    time_frame_histogram;
+
+    metric_t       metric_packets_received;
+    metric_t       metric_packets_sent;
+    metric_t       metric_packets_dropped;
+    metric_t       metric_rtt;
+    metric_t       metric_time_lost;
+    metric_t       metric_frames_lost;
+    metric_t       metric_time_frame;
 };
 
 static bool loop_stage__collect_previous_frame_info(loop_stage_t* self, game_client_t game_client);
@@ -63,21 +96,31 @@ static bool loop_stage__update_loop(loop_stage_t* self, game_client_t game_clien
 static bool loop_stage__render(loop_stage_t* self, game_client_t game_client);
 static bool loop_stage__sleep_till_end_of_frame(loop_stage_t* self, game_client_t game_client);
 
+static bool game_client__register_metrics(game_client_t self);
 static void game_client__sample_prev_frame(game_client_t self);
-static void game_client__push_stage(game_client_t self, bool (*stage_fn)(struct loop_stage* self, game_client_t game_client));
-static void game_client__ack_packet(game_client_t self, connection_t* connection, packet_t* packet, double time);
+static void game_client__write_histogram(const char* name, histogram_t* histogram);
+static void game_client__push_stage(game_client_t self, const char* name, bool (*stage_fn)(struct loop_stage* self, game_client_t game_client));
+static void game_client__ack_packet(game_client_t self, connection_t* connection, packet_t* packet, const ack_window_t* acks, double time);
 static void game_client__connection_accept(
     game_client_t self, connection_t* connection, network_addr_t sender_addr,
     packet_t* packet, double time
 );
-static void game_client__accept_packet(game_client_t self, connection_t* connection, packet_t* packet, double time);
+static void game_client__accept_packet(game_client_t self, connection_t* connection, packet_t* packet, const ack_window_t* acks, double time);
 static void game_client__receive_packets(game_client_t self, double time);
+static void game_client__receive_message(game_client_t self, const uint8_t* data, uint32_t data_len, network_addr_t sender_addr, double time);
+static void game_client__receive_channel_messages(game_client_t self);
+//! @returns false if the snapshot can't be decoded, it's malformed, stale or its base is missing
+static bool game_client__receive_snapshot(game_client_t self, packet_t* packet, const uint8_t* data, uint32_t data_len);
+//! @brief Hands the objects of the snapshots, as of 'time', to the game
+static void game_client__show_snapshots(game_client_t self, double time);
 static void game_client__send_packet(game_client_t self, double time);
+//! @returns Buttons held for moving, see player_button_t
+static uint32_t game_client__sample_buttons(game_client_t self);
+//! @brief The inputs sent before 'sequence_id' that the server hasn't acknowledged yet, newest first
+static void game_client__fill_input_history(game_client_t self, seq_id_t sequence_id, input_history_t* input_history);
 
 static bool sent_packet__is_acked(sent_packet_t* self);
 
-static void connection__check_for_lost_packets(connection_t* connection, uint32_t left_shift);
-
 static bool loop_stage__collect_previous_frame_info(loop_stage_t* self, game_client_t game_client) {
     game_client->previous_frame_info.time_start         = game_client->previous_frame_info.time_end;
     game_client->previous_frame_info.time_end           = self->time_start;
@@ -88,6 +131,8 @@ static bool loop_stage__collect_previous_frame_info(loop_stage_t* self, game_cli
     game_client->time_lost              += expected_time_lost_this_frame;
     game_client->frames_lost            += expected_time_lost_this_frame / game_client->time_frame_expected;
     game_client->time_update_to_process += game_client->previous_frame_info.elapsed_time;
+    metric__set(game_client->metric_time_lost, game_client->time_lost);
+    metric__set(game_client->metric_frames_lost, game_client->frames_lost);
 
     game_client__sample_prev_frame(game_client);
 
@@ -96,47 +141,33 @@ static bool loop_stage__collect_previous_frame_info(loop_stage_t* self, game_cli
     // (void) seconds_last_info_printed;
     if (seconds_since_loop_start > seconds_last_info_printed) {
     // if (0) {
+        const double time_since_info_printed = (double) (seconds_since_loop_start - seconds_last_info_printed);
         seconds_last_info_printed = seconds_since_loop_start;
-        double time_frame_actual_avg             = 0.0;
-        double time_update_actual_avg            = 0.0;
-        double time_render_actual_avg            = 0.0;
-        double number_of_updates_avg             = 0.0;
-        int32_t sample_index = (int32_t) game_client->frame_info_sample_index_tail;
-        uint32_t frame_samples_count = 0;
-        while (sample_index != (int32_t) game_client->frame_info_sample_index_head) {
-            frame_info_t* frame_info = &game_client->frame_info_sample[sample_index];
-            time_frame_actual_avg    += frame_info->elapsed_time;
-            time_update_actual_avg   += frame_info->time_update_actual;
-            time_render_actual_avg   += frame_info->time_render_actual;
-            number_of_updates_avg    += frame_info->number_of_updates;
-            if (sample_index == (int32_t) game_client->frame_info_sample_size - 1) {
-                sample_index = 0;
-            } else {
-                ++sample_index;
-            }
-            ++frame_samples_count;
-        }
+        const uint64_t frame_samples_count = histogram__count(&game_client->time_frame_histogram);
         if (frame_samples_count > 0) {
-            time_frame_actual_avg    /= frame_samples_count;
-            time_update_actual_avg   /= frame_samples_count;
-            time_render_actual_avg   /= frame_samples_count;
-            number_of_updates_avg    /= frame_samples_count;
-
             debug__lock();
 
             debug__writeln("Frame #%u", game_client->current_frame);
             debug__writeln("Time lost:   %lf", game_client->time_lost);
             debug__writeln("Frames lost: %lf", game_client->frames_lost);
-            debug__writeln("Frame avg info across %u frames", frame_samples_count);
-            debug__writeln("  Game updates:            %lf", number_of_updates_avg);
+            debug__writeln("Frame info across %llu frames", (unsigned long long) frame_samples_count);
+            debug__writeln("  Missed deadline:         %u, total: %u", game_client->frames_missed_deadline, game_client->frames_missed_deadline_total);
             debug__writeln("  Time:");
             debug__writeln("    Total:                 %lfs", game_client->previous_frame_info.time_end);
-            debug__writeln("    Game update actual:    %lfus", time_update_actual_avg * 1000000.0);
             debug__writeln("    Game update fixed:     %lfus", game_client->time_game_update_fixed * 1000000.0);
-            debug__writeln("    Render actual:         %lfus", time_render_actual_avg * 1000000.0);
-            debug__writeln("    Frame actual:          %lfms, %lffps", time_frame_actual_avg * 1000.0, 1.0 / time_frame_actual_avg);
             debug__writeln("    Frame expected:        %lfms, %lffps", game_client->time_frame_expected * 1000.0, 1.0 / game_client->time_frame_expected);
             debug__writeln("    Left to process:       %lfms", (game_client->time_update_to_process - game_client->previous_frame_info.elapsed_time) * 1000.0);
+            debug__writeln("  Latency (us):            %10s %10s %10s %10s %10s", "p50", "p90", "p99", "p99.9", "max");
+            game_client__write_histogram("Game update actual", &game_client->time_update_histogram);
+            game_client__write_histogram("Render actual", &game_client->time_render_histogram);
+            game_client__write_histogram("Frame actual", &game_client->time_frame_histogram);
+            for (uint32_t stage_id = 0; stage_id < game_client->loop_stages_top; ++stage_id) {
+                loop_stage_t* loop_stage = &game_client->loop_stages[stage_id];
+                game_client__write_histogram(loop_stage->name, &loop_stage->time_elapsed_histogram);
+                histogram__clear(&loop_stage->time_elapsed_histogram);
+            }
+            debug__writeln("  Memory:");
+            debug__write_memory_stats(time_since_info_printed);
             connection_t* connection = &game_client->connection;
             if (connection->connected) {
                 debug__writeln("  Connection:");
@@ -144,15 +175,26 @@ static bool loop_stage__collect_previous_frame_info(loop_stage_t* self, game_cli
                 debug__writeln("    Connected at:          %lf", connection->time_connected);
                 debug__writeln("    Time last seen:        %lf", connection->time_last_seen);
                 debug__writeln("    Seq id:                %u", connection->sequence_id);
-                debug__writeln("    Ack bitfield: ");
-                debug__write_ack_bitfield_raw(connection->ack_bitfield);
+                debug__writeln("    Ack window: ");
+                debug__write_ack_window_raw(&connection->ack_window);
                 debug__write_raw("\n");
                 debug__writeln("    Packets dropped:       %u", connection->packets_dropped);
                 debug__writeln("    RTT:                   %lfms", connection->rtt * 1000.0);
+                debug__writeln("    Reconciles:            %u, corrected: %u", game_client->prediction.reconciles, game_client->prediction.reconciles_corrected);
+                debug__writeln(
+                    "    Snapshot delay:        %lfms, target: %lfms, jitter: %lfms",
+                    game_client->snapshot_buffer.delay * 1000.0, snapshot_buffer__delay_target(&game_client->snapshot_buffer) * 1000.0,
+                    game_client->snapshot_buffer.jitter * 1000.0
+                );
             }
             debug__flush(DEBUG_MODULE_GAME_CLIENT, DEBUG_INFO);
 
             debug__unlock();
+
+            histogram__clear(&game_client->time_update_histogram);
+            histogram__clear(&game_client->time_render_histogram);
+            histogram__clear(&game_client->time_frame_histogram);
+            game_client->frames_missed_deadline = 0;
         }
     }
 
@@ -175,6 +217,11 @@ static bool loop_stage__poll_inputs(loop_stage_t* self, game_client_t game_clien
 static bool loop_stage__update_loop(loop_stage_t* self, game_client_t game_client) {
     game_client->previous_frame_info.time_update_actual = 0.0;
     game_client->previous_frame_info.number_of_updates  = 0;
+
+    object_state_t player;
+    prediction__smooth(&game_client->prediction, game_client->previous_frame_info.elapsed_time, &player);
+    game__set_position(game_client->game_state, player.position.x, player.position.y, player.position.z);
+
     if (game_client->time_update_to_process == 0) {
         return true;
     }
@@ -194,6 +241,7 @@ static bool loop_stage__render(loop_stage_t* self, game_client_t game_client) {
     ASSERT(game_client->time_update_to_process < game_client->time_frame_expected);
     const double render_interpolation_factor = 1.0 - game_client->time_update_to_process / game_client->time_frame_expected;
     ASSERT(render_interpolation_factor >= 0.0 && render_interpolation_factor <= 1.0);
+    game_client__show_snapshots(game_client, self->time_start);
     game__render(game_client->game_state, render_interpolation_factor);
     window__swap_buffers(game_client->window);
 
@@ -214,29 +262,61 @@ static bool loop_stage__sleep_till_end_of_frame(loop_stage_t* self, game_client_
     return true;
 }
 
+static bool game_client__register_metrics(game_client_t self) {
+    return (
+        metrics__register(&self->metric_packets_received, "game_client_packets_received", METRIC_TYPE_COUNTER) &&
+        metrics__register(&self->metric_packets_sent, "game_client_packets_sent", METRIC_TYPE_COUNTER) &&
+        metrics__register(&self->metric_packets_dropped, "game_client_packets_dropped", METRIC_TYPE_COUNTER) &&
+        metrics__register(&self->metric_rtt, "game_client_rtt_seconds", METRIC_TYPE_GAUGE) &&
+        metrics__register(&self->metric_time_lost, "game_client_time_lost_seconds", METRIC_TYPE_GAUGE) &&
+        metrics__register(&self->metric_frames_lost, "game_client_frames_lost", METRIC_TYPE_GAUGE) &&
+        metrics__register(&self->metric_time_frame, "game_client_frame_time_ns", METRIC_TYPE_HISTOGRAM)
+    );
+}
+
 static void game_client__sample_prev_frame(game_client_t self) {
-    ASSERT(self->frame_info_sample_index_head < self->frame_info_sample_size);
-    frame_info_t* frame_info_sample = &self->frame_info_sample[self->frame_info_sample_index_head++];
-    memcpy(frame_info_sample, &self->previous_frame_info, sizeof(self->previous_frame_info));
-    if (self->frame_info_sample_index_head == self->frame_info_sample_size) {
-        self->frame_info_sample_index_head = 0;
+    if (self->current_frame == 0) {
+        // note: there is no previous frame to sample
+        return ;
     }
-    if (self->frame_info_sample_index_head == self->frame_info_sample_index_tail) {
-        ++self->frame_info_sample_index_tail;
-        if (self->frame_info_sample_index_tail == self->frame_info_sample_size) {
-            self->frame_info_sample_index_tail = 0;
-        }
+
+    histogram__record_time(&self->time_frame_histogram, self->previous_frame_info.elapsed_time);
+    metric__record_time(self->metric_time_frame, self->previous_frame_info.elapsed_time);
+    histogram__record_time(&self->time_render_histogram, self->previous_frame_info.time_render_actual);
+    if (self->previous_frame_info.number_of_updates > 0) {
+        histogram__record_time(&self->time_update_histogram, self->previous_frame_info.time_update_actual);
     }
-    ASSERT(self->frame_info_sample_index_tail != self->frame_info_sample_index_head);
+    if (self->previous_frame_info.elapsed_time > self->time_frame_expected) {
+        ++self->frames_missed_deadline;
+        ++self->frames_missed_deadline_total;
+    }
+}
+
+static void game_client__write_histogram(const char* name, histogram_t* histogram) {
+    debug__writeln(
+        "    %-21s %10.1lf %10.1lf %10.1lf %10.1lf %10.1lf",
+        name,
+        histogram__percentile(histogram, 50.0) / 1000.0,
+        histogram__percentile(histogram, 90.0) / 1000.0,
+        histogram__percentile(histogram, 99.0) / 1000.0,
+        histogram__percentile(histogram, 99.9) / 1000.0,
+        histogram__max(histogram) / 1000.0
+    );
 }
 
-static void game_client__push_stage(game_client_t self, bool (*stage_fn)(struct loop_stage* self, game_client_t game_client)) {
+static void game_client__push_stage(game_client_t self, const char* name, bool (*stage_fn)(struct loop_stage* self, game_client_t game_client)) {
     ARRAY_ENSURE_TOP(self->loop_stages, self->loop_stages_top, self->loop_stages_size);
-    self->loop_stages[self->loop_stages_top].loop_stage__execute = stage_fn;
+    loop_stage_t* loop_stage = &self->loop_stages[self->loop_stages_top];
+    loop_stage->name = name;
+    loop_stage->loop_stage__execute = stage_fn;
+    histogram__create(&loop_stage->time_elapsed_histogram);
     ++self->loop_stages_top;
 }
 
-static void game_client__ack_packet(game_client_t self, connection_t* connection, packet_t* packet, double time) {
+static void game_client__ack_packet(game_client_t self, connection_t* connection, packet_t* packet, const ack_window_t* acks, double time) {
+    // note: the server only acks sequence ids it received from us
+    channel_set__ack(&self->channels, packet->ack, acks);
+
     const uint32_t local_seq_id_delta = sequence_id__delta(self->sequence_id, packet->ack);
     if (local_seq_id_delta < self->sent_packets_queue_size) {
         const uint32_t packet_index_to_ack = (self->sent_packets_queue_head + self->sent_packets_queue_size - local_seq_id_delta) % self->sent_packets_queue_size;
@@ -251,6 +331,7 @@ static void game_client__ack_packet(game_client_t self, connection_t* connection
                 const double percentage_to_move = 0.1;
                 connection->rtt = (1.0 - percentage_to_move) * connection->rtt + percentage_to_move * rtt;
             }
+            metric__set(self->metric_rtt, connection->rtt);
             // debug__write_and_flush(DEBUG_MODULE_GAME_CLIENT, DEBUG_NET, "RTT: %lfms", self->rtt * 1000.0);
 
             // todo: discard packet
@@ -268,14 +349,7 @@ static void game_client__connection_accept(
 ) {
     ASSERT(!self->connection.connected);
 
-    connection->addr            = sender_addr;
-    connection->time_last_seen  = time;
-    connection->sequence_id     = packet->sequence_id;
-    connection->ack_bitfield    = -1;
-    connection->time_connected  = time;
-    connection->rtt             = 0.0;
-    connection->packets_dropped = 0;
-    connection->connected       = true;
+    connection__accept(connection, sender_addr, packet, time);
 
     debug__lock();
 
@@ -285,29 +359,19 @@ static void game_client__connection_accept(
     debug__unlock();
 }
 
-static void game_client__accept_packet(game_client_t self, connection_t* connection, packet_t* packet, double time) {
-    connection->time_last_seen = time;
-
-    if (sequence_id__is_more_recent(packet->sequence_id, connection->sequence_id)) {
-        const uint32_t connection_seq_id_delta = sequence_id__delta(packet->sequence_id, connection->sequence_id);
-        connection__check_for_lost_packets(connection, connection_seq_id_delta);
-        uint32_t new_ack_bitfield = 0;
-        if (connection_seq_id_delta <= (sizeof(connection->ack_bitfield) << 3)) {
-            ASSERT(connection_seq_id_delta > 0);
-            new_ack_bitfield |= (connection->ack_bitfield << connection_seq_id_delta);
-            new_ack_bitfield |= (1 << (connection_seq_id_delta - 1));
-        }
-
-        connection->ack_bitfield = new_ack_bitfield;
-        connection->sequence_id = packet->sequence_id;
-    } else if (connection->sequence_id != packet->sequence_id) {
-        const uint32_t connection_seq_id_delta = sequence_id__delta(connection->sequence_id, packet->sequence_id);
-        if (connection_seq_id_delta <= (sizeof(connection->ack_bitfield) << 3)) {
-            connection->ack_bitfield |= (1 << (connection_seq_id_delta - 1));
-        }
+static void game_client__accept_packet(game_client_t self, connection_t* connection, packet_t* packet, const ack_window_t* acks, double time) {
+    const uint32_t packets_lost = connection__receive_packet(connection, packet, time);
+    if (packets_lost > 0) {
+        metric__add(self->metric_packets_dropped, packets_lost);
+        debug__write_and_flush(
+            DEBUG_MODULE_GAME_CLIENT, DEBUG_NET,
+            "LOST PACKETS: %u, newest received: %u",
+            packets_lost, connection->sequence_id
+        );
     }
 
-    game_client__ack_packet(self, connection, packet, time);
+    game_client__ack_packet(self, connection, packet, acks, time);
+    prediction__reconcile(&self->prediction, packet->ack, &packet->player);
 
     debug__lock();
 
@@ -319,42 +383,202 @@ static void game_client__accept_packet(game_client_t self, connection_t* connect
 }
 
 static void game_client__receive_packets(game_client_t self, double time) {
-    packet_t packet;
+    uint8_t buffer[FRAME_MTU_MAX];
     uint32_t received_data_len = 0;
     network_addr_t sender_addr;
     // todo: process a limited amount
-    while (tp_socket__get_data(&self->tp_socket, &packet, sizeof(packet), &received_data_len, &sender_addr)) {
-        if (received_data_len == sizeof(packet)) {
-            if (network_addr__is_same(&sender_addr, &self->connection.addr)) {
-                if (!self->connection.connected) {
-                    game_client__connection_accept(self, &self->connection, sender_addr, &packet, time);
-                }
-                game_client__accept_packet(self, &self->connection, &packet, time);
-            } else {
-                // packet is not from server -> discard packet
-                debug__write_and_flush(
-                    DEBUG_MODULE_GAME_CLIENT, DEBUG_NET,
-                    "discarded packet as it is not from the server, received from: <todo with inet_ntop>"
-                );
-            }
-        } else {
+    while (tp_socket__get_data(&self->tp_socket, buffer, sizeof(buffer), &received_data_len, &sender_addr)) {
+        metric__add(self->metric_packets_received, 1);
+        if (!network_addr__is_same(&sender_addr, &self->connection.addr)) {
+            // note: checked before reassembly, so others can't evict the fragments of the server
+            debug__write_and_flush(
+                DEBUG_MODULE_GAME_CLIENT, DEBUG_NET,
+                "discarded packet as it is not from the server, received from: <todo with inet_ntop>"
+            );
+            continue ;
+        }
+
+        frame_unpacker_t frame_unpacker;
+        frame_unpacker__create(&frame_unpacker, buffer, received_data_len);
+        const void* message = 0;
+        uint32_t message_size = 0;
+        while (frame_unpacker__next(&frame_unpacker, &self->frame_reassembler, &message, &message_size)) {
+            game_client__receive_message(self, message, message_size, sender_addr, time);
+        }
+        if (frame_unpacker.error) {
+            debug__write_and_flush(
+                DEBUG_MODULE_GAME_CLIENT, DEBUG_NET,
+                "malformed datagram received, size: %u",
+                received_data_len
+            );
+        }
+    }
+}
+
+static void game_client__receive_message(game_client_t self, const uint8_t* data, uint32_t data_len, network_addr_t sender_addr, double time) {
+    packet_t packet;
+    uint32_t packet_size = 0;
+    ack_window_t acks;
+    uint32_t acks_size = 0;
+    if (
+        !packet__read(&packet, data, data_len, &packet_size) ||
+        !ack_window__read(&acks, data + packet_size, data_len - packet_size, &acks_size)
+    ) {
+        debug__write_and_flush(
+            DEBUG_MODULE_GAME_CLIENT, DEBUG_NET,
+            "malformed packet received, size: %u",
+            data_len
+        );
+        return ;
+    }
+    packet_size += acks_size;
+
+    uint32_t channels_size = 0;
+    if (!channel_set__read(&self->channels, data + packet_size, data_len - packet_size, &channels_size)) {
+        debug__write_and_flush(
+            DEBUG_MODULE_GAME_CLIENT, DEBUG_NET,
+            "malformed messages received, size: %u",
+            data_len
+        );
+        return ;
+    }
+    game_client__receive_channel_messages(self);
+
+    const uint32_t snapshot_offset = packet_size + channels_size;
+    if (!game_client__receive_snapshot(self, &packet, data + snapshot_offset, data_len - snapshot_offset)) {
+        // note: not acknowledged, so the server falls back to an older base or a full snapshot
+        debug__write_and_flush(
+            DEBUG_MODULE_GAME_CLIENT, DEBUG_NET,
+            "discarded packet %u as its snapshot can't be decoded, base age: %u",
+            packet.sequence_id, packet.snapshot_base_age
+        );
+        return ;
+    }
+    snapshot_buffer__push(&self->snapshot_buffer, packet.sequence_id, packet.tick_interval, time);
+    if (!self->connection.connected) {
+        game_client__connection_accept(self, &self->connection, sender_addr, &packet, time);
+    }
+    game_client__accept_packet(self, &self->connection, &packet, &acks, time);
+}
+
+static void game_client__receive_channel_messages(game_client_t self) {
+    for (uint32_t type = 0; type < _CHANNEL_TYPE_SIZE; ++type) {
+        const void* data = 0;
+        uint32_t data_size = 0;
+        while (channel_set__pop(&self->channels, (channel_type_t) type, &data, &data_size)) {
             debug__write_and_flush(
                 DEBUG_MODULE_GAME_CLIENT, DEBUG_NET,
-                "unknown packet size received: %u, expected: %u",
-                received_data_len, sizeof(packet)
+                "RECV MESSAGE: channel %u, size %u",
+                type, data_size
             );
+            if (self->config.message_receive) {
+                self->config.message_receive(data, data_size, type == CHANNEL_TYPE_RELIABLE_ORDERED, self->config.message_receive_data);
+            }
         }
     }
 }
 
+static bool game_client__receive_snapshot(game_client_t self, packet_t* packet, const uint8_t* data, uint32_t data_len) {
+    const uint32_t snapshot_index = packet->sequence_id % SNAPSHOT_HISTORY_SIZE;
+    if (
+        self->snapshots_is_valid[snapshot_index] &&
+        !sequence_id__is_more_recent(packet->sequence_id, self->snapshots_sequence_id[snapshot_index])
+    ) {
+        // note: duplicate, or so late that its slot holds a newer one
+        return false;
+    }
+
+    const snapshot_t* snapshot_base = 0;
+    if (packet->snapshot_base_age > 0) {
+        if (packet->snapshot_base_age >= SNAPSHOT_HISTORY_SIZE) {
+            return false;
+        }
+        const seq_id_t base_sequence_id = sequence_id__sub(packet->sequence_id, packet->snapshot_base_age);
+        const uint32_t base_index = base_sequence_id % SNAPSHOT_HISTORY_SIZE;
+        if (!self->snapshots_is_valid[base_index] || self->snapshots_sequence_id[base_index] != base_sequence_id) {
+            return false;
+        }
+        snapshot_base = &self->snapshots[base_index];
+    }
+
+    // note: the slot is overwritten, its content is unspecified if decoding fails
+    snapshot_t* snapshot = &self->snapshots[snapshot_index];
+    self->snapshots_is_valid[snapshot_index] = false;
+    uint32_t snapshot_size = 0;
+    const bool decoded = (
+        snapshot_base ?
+        snapshot__read_delta(snapshot, snapshot_base, data, data_len, &snapshot_size) :
+        snapshot__read(snapshot, data, data_len, &snapshot_size)
+    );
+    if (!decoded || snapshot_size != data_len) {
+        return false;
+    }
+    self->snapshots_sequence_id[snapshot_index] = packet->sequence_id;
+    self->snapshots_is_valid[snapshot_index]    = true;
+
+    return true;
+}
+
+static void game_client__show_snapshots(game_client_t self, double time) {
+    if (!snapshot_buffer__sample(
+        &self->snapshot_buffer, time,
+        self->snapshots, self->snapshots_sequence_id, self->snapshots_is_valid,
+        &self->snapshot_shown
+    )) {
+        return ;
+    }
+
+    game_object_t objects[GAME_OBJECTS_SIZE];
+    const uint32_t objects_fill = self->snapshot_shown.objects_fill < GAME_OBJECTS_SIZE ? self->snapshot_shown.objects_fill : GAME_OBJECTS_SIZE;
+    for (uint32_t object_index = 0; object_index < objects_fill; ++object_index) {
+        const object_state_t* object_state = &self->snapshot_shown.objects[object_index];
+        objects[object_index].x   = object_state->position.x;
+        objects[object_index].y   = object_state->position.y;
+        objects[object_index].z   = object_state->position.z;
+        objects[object_index].yaw = object_state->yaw;
+    }
+    game__set_objects(self->game_state, objects, objects_fill);
+}
+
 static void game_client__send_packet(game_client_t self, double time) {
     packet_t packet = {
         .sequence_id = self->sequence_id,
         .ack = self->connection.sequence_id,
-        .ack_bitfield = self->connection.ack_bitfield
+        .game_data = {
+            .buttons = game_client__sample_buttons(self),
+            .yaw     = game__yaw(self->game_state)
+        }
     };
-
-    ASSERT(self->sent_packets_queue_head < self->frame_info_sample_size);
+    // note: moves right away, before the server even received it
+    prediction__push_input(&self->prediction, packet.sequence_id, &packet.game_data);
+
+    input_history_t input_history;
+    game_client__fill_input_history(self, packet.sequence_id, &input_history);
+
+    uint8_t buffer[PACKET_SIZE_MAX + ACK_WINDOW_ENCODING_SIZE_MAX + INPUT_HISTORY_DELTA_SIZE_MAX + CHANNEL_SET_WRITE_SIZE_MAX];
+    uint32_t buffer_len = 0;
+    uint32_t acks_size = 0;
+    uint32_t input_history_size = 0;
+    if (
+        !packet__write(&packet, buffer, sizeof(buffer), &buffer_len) ||
+        !ack_window__write(&self->connection.ack_window, buffer + buffer_len, sizeof(buffer) - buffer_len, &acks_size) ||
+        !input_history__write_after(&input_history, &packet, buffer + buffer_len + acks_size, sizeof(buffer) - buffer_len - acks_size, &input_history_size)
+    ) {
+        // note: every field is full range
+        ASSERT(false);
+        return ;
+    }
+    buffer_len += acks_size + input_history_size;
+    // note: the server doesn't reassemble, so the messages are limited to what fits next to the packet in a datagram
+    const uint32_t channels_size_max = FRAME_MTU_DEFAULT - FRAME_HEADER_SIZE - buffer_len;
+    uint32_t channels_size = 0;
+    channel_set__write(
+        &self->channels, packet.sequence_id, buffer + buffer_len,
+        channels_size_max < sizeof(buffer) - buffer_len ? channels_size_max : sizeof(buffer) - buffer_len, &channels_size
+    );
+    buffer_len += channels_size;
+
+    ASSERT(self->sent_packets_queue_head < self->sent_packets_queue_size);
     sent_packet_t* sent_packet = &self->sent_packets_queue[self->sent_packets_queue_head++];
     sent_packet->sequence_id = packet.sequence_id;
     sent_packet->time = time;
@@ -369,7 +593,17 @@ static void game_client__send_packet(game_client_t self, double time) {
         }
     }
 
-    tp_socket__send_data(&self->tp_socket, &packet, sizeof(packet));
+    if (!frame_packer__push(&self->frame_packer, buffer, buffer_len, self->connection.addr)) {
+        // note: the packet always fits into a datagram
+        ASSERT(false);
+        return ;
+    }
+    for (uint32_t datagram_index = 0; datagram_index < self->frame_packer.datagrams_fill; ++datagram_index) {
+        tp_message_t* datagram = &self->frame_packer.datagrams[datagram_index];
+        tp_socket__send_data(&self->tp_socket, datagram->data, datagram->data_size);
+        metric__add(self->metric_packets_sent, 1);
+    }
+    frame_packer__clear(&self->frame_packer);
 
     debug__lock();
 
@@ -382,30 +616,59 @@ static void game_client__send_packet(game_client_t self, double time) {
     ++self->sequence_id;
 }
 
-static bool sent_packet__is_acked(sent_packet_t* self) {
-    return self->time == 0.0;
+static void game_client__fill_input_history(game_client_t self, seq_id_t sequence_id, input_history_t* input_history) {
+    input_history->inputs_fill = 0;
+    while (input_history->inputs_fill < INPUT_HISTORY_INPUTS_SIZE) {
+        const seq_id_t input_sequence_id = sequence_id__sub(sequence_id, input_history->inputs_fill + 1);
+        if (
+            self->prediction.is_reconciled &&
+            !sequence_id__is_more_recent(input_sequence_id, self->prediction.sequence_id_reconciled)
+        ) {
+            // note: the server has simulated it already
+            break ;
+        }
+        const prediction_input_t* prediction_input = &self->prediction.inputs[input_sequence_id % PREDICTION_INPUTS_SIZE];
+        if (prediction_input->sequence_id != input_sequence_id) {
+            break ;
+        }
+        input_history->inputs[input_history->inputs_fill++] = prediction_input->input;
+    }
 }
 
-static void connection__check_for_lost_packets(connection_t* connection, uint32_t left_shift) {
-    // todo: early exit if connection hasn't been alive for long enough to determine if packets have been lost
-
-    if (connection->ack_bitfield != 0) {
-        uint32_t bit_index_end = 0;
-        if (left_shift > (sizeof(connection->ack_bitfield) << 3)) {
-            bit_index_end = sizeof(connection->ack_bitfield) << 3;
-            ++connection->packets_dropped;
-            debug__write_and_flush(DEBUG_MODULE_GAME_CLIENT, DEBUG_NET, "LOST PACKET: %u", connection->sequence_id);
-        } else {
-            bit_index_end = left_shift;
-        }
+static uint32_t game_client__sample_buttons(game_client_t self) {
+    uint32_t result = 0;
+
+    controller_t keyboard = window__get_controller(self->window);
+    if (controller__is_connected(keyboard)) {
+        if (controller__button_is_down(keyboard, BUTTON_W))     result |= PLAYER_BUTTON_FORWARD;
+        if (controller__button_is_down(keyboard, BUTTON_S))     result |= PLAYER_BUTTON_BACKWARD;
+        if (controller__button_is_down(keyboard, BUTTON_A))     result |= PLAYER_BUTTON_LEFT;
+        if (controller__button_is_down(keyboard, BUTTON_D))     result |= PLAYER_BUTTON_RIGHT;
+        if (controller__button_is_down(keyboard, BUTTON_SPACE)) result |= PLAYER_BUTTON_UP;
+        if (controller__button_is_down(keyboard, BUTTON_LCTRL)) result |= PLAYER_BUTTON_DOWN;
+    }
 
-        for (uint32_t bit_index = 0; bit_index < bit_index_end; ++bit_index) {
-            const uint32_t bit_mask_index = ((sizeof(connection->ack_bitfield) << 3) - 1 - bit_index);
-            const uint32_t bit_mask = 1 << bit_mask_index;
-            if ((connection->ack_bitfield & bit_mask) == 0) {
-                ++connection->packets_dropped;
-                debug__write_and_flush(DEBUG_MODULE_GAME_CLIENT, DEBUG_NET, "LOST PACKET: %u", sequence_id__sub(connection->sequence_id, bit_mask_index + 1));
-            }
+    // note: the sticks are digital, the server can't tell how far they are pushed
+    uint32_t controllers_size = 0;
+    controller_t* controllers = gfx__get_controllers(&controllers_size);
+    for (uint32_t controller_index = 0; controller_index < controllers_size; ++controller_index) {
+        controller_t gamepad = controllers[controller_index];
+        if (!controller__is_connected(gamepad)) {
+            continue ;
         }
+        const float left_y = controller__button_value(gamepad, BUTTON_GAMEPAD_AXIS_LEFT_Y);
+        const float left_x = controller__button_value(gamepad, BUTTON_GAMEPAD_AXIS_LEFT_X);
+        if (left_y < -0.5f) result |= PLAYER_BUTTON_FORWARD;
+        if (left_y >  0.5f) result |= PLAYER_BUTTON_BACKWARD;
+        if (left_x < -0.5f) result |= PLAYER_BUTTON_LEFT;
+        if (left_x >  0.5f) result |= PLAYER_BUTTON_RIGHT;
+        if (controller__button_is_down(gamepad, BUTTON_GAMEPAD_AXIS_RIGHT_TRIGGER)) result |= PLAYER_BUTTON_UP;
+        if (controller__button_is_down(gamepad, BUTTON_GAMEPAD_AXIS_LEFT_TRIGGER))  result |= PLAYER_BUTTON_DOWN;
     }
+
+    return result;
+}
+
+static bool sent_packet__is_acked(sent_packet_t* self) {
+    return self->time == 0.0;
 }
@@ -6,15 +6,43 @@
 #include "debug.h"
 #include "game.h"
 #include "packet.h"
+#include "prediction.h"
+#include "player.h"
+#include "priority_accumulator.h"
+#include "interest_grid.h"
+#include "tp_capture.h"
+#include "frame.h"
+#include "packet_pool.h"
+#include "channel.h"
+#include "send_rate.h"
+#include "link_conditioner.h"
+#include "event_loop.h"
+#include "histogram.h"
+#include "metrics.h"
+#include "memory.h"
+#include "hash_map.h"
+#include "timer_wheel.h"
+#include "spsc_queue.h"
+#include "thread.h"
 
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
 #include <stdio.h>
+#include <math.h>
 
 #include "game_server_impl.c"
 
 game_server_t game_server__create(game_server_config_t config, uint16_t port) {
+    const uint32_t shards_size = config.shards_size ? config.shards_size : 1;
+    if (
+        shards_size > GAME_SERVER_SHARDS_MAX ||
+        ((config.shm || config.capture_path || config.replay_path) && shards_size > 1)
+    ) {
+        return 0;
+    }
+
+    game_server_t result = 0;
     game_t game_state = game__create();
     
     debug__lock();
@@ -24,31 +52,20 @@ game_server_t game_server__create(game_server_config_t config, uint16_t port) {
 
     debug__writeln("game state created");
 
-    tp_socket_t tp_socket;
-    if (!tp_socket__create(&tp_socket, SOCKET_TYPE_UDP, port)) goto err;
-
-    debug__writeln("udp socket created on port %u", port);
-
-    const uint32_t connections_size = 4;
-    connection_t* connections = calloc(1, connections_size * sizeof(*connections));
-    if (!connections) goto err;
-
-    debug__writeln("available connections left: %u", connections_size);
-
-    game_server_t result = calloc(1, sizeof(*result));
+    result = game_server__create_shard(config, port, shards_size > 1);
     if (!result) goto err;
+    result->game_state = game_state;
+    game_state         = 0;
 
-    memcpy(&result->config, &config, sizeof(result->config));
-    result->tp_socket = tp_socket;
-    result->connections_size = connections_size;
-    result->connections = connections;
-    result->frame_info_sample_size = 128;
-    result->frame_info_sample = malloc(result->frame_info_sample_size * sizeof(*result->frame_info_sample));
+    if (shards_size > 1 && !game_server__create_shards(result, shards_size, port)) goto err;
 
-    game_server__push_stage(result, &loop_stage__collect_previous_frame_info);
-    game_server__push_stage(result, &loop_stage__poll_inputs);
-    game_server__push_stage(result, &loop_stage__update_loop);
-    game_server__push_stage(result, &loop_stage__sleep_till_end_of_frame);
+    if (config.metrics_unix_path) {
+        if (!metrics__serve_unix(config.metrics_unix_path)) goto err;
+        debug__writeln("metrics served on unix socket %s", config.metrics_unix_path);
+    } else if (config.metrics_tcp_port) {
+        if (!metrics__serve_tcp(config.metrics_tcp_port)) goto err;
+        debug__writeln("metrics served on tcp port %u", config.metrics_tcp_port);
+    }
 
     debug__flush(DEBUG_MODULE_GAME_SERVER, DEBUG_INFO);
     debug__unlock();
@@ -58,49 +75,104 @@ game_server_t game_server__create(game_server_config_t config, uint16_t port) {
 err:
     debug__flush(DEBUG_MODULE_GAME_SERVER, DEBUG_INFO);
     debug__unlock();
+    if (result) {
+        game_server__destroy(result);
+    }
+    if (game_state) {
+        game__destroy(game_state);
+    }
     
     return 0;
 }
 
 void game_server__destroy(game_server_t self) {
-    tp_socket__destroy(&self->tp_socket);
-
-    if (self->connections) {
-        free(self->connections);
+    if (self->shards) {
+        game_server__destroy_shards(self);
+    }
+    if (self->game_state) {
+        game__destroy(self->game_state);
     }
 
-    free(self);
+    game_server__destroy_shard(self);
 }
 
 void game_server__run(game_server_t self, double target_fps) {
     debug__write_and_flush(DEBUG_MODULE_GAME_SERVER, DEBUG_INFO, "target fps: %lf", target_fps);
 
-    self->previous_frame_info.time_frame_expected = 1.0 / target_fps;
-    self->time_game_update_fixed                  = game__update_upper_bound(self->game_state);
     system__init();
+    const double time_game_update_fixed = game__update_upper_bound(self->game_state);
+    if (!self->shards) {
+        self->previous_frame_info.time_frame_expected = 1.0 / target_fps;
+        self->time_game_update_fixed                  = time_game_update_fixed;
+        game_server__run_stages(self);
+        return ;
+    }
 
-    ASSERT(self->loop_stages_top > 0);
-    bool stage_failed = false;
-    while (!stage_failed) {
-        loop_stage_t* loop_stage = 0;
-        for (uint32_t stage_id = 0; stage_id < self->loop_stages_top; ++stage_id) {
-            loop_stage = &self->loop_stages[stage_id];
-            const double loop_stage_time_start = system__get_time();
-            loop_stage->time_start = loop_stage_time_start;
-            if (stage_id > 0) {
-                self->loop_stages[stage_id - 1].time_elapsed = loop_stage_time_start - self->loop_stages[stage_id - 1].time_start;
-            }
-            loop_stage = &self->loop_stages[stage_id];
-            if (!loop_stage->loop_stage__execute(loop_stage, self)) {
-                stage_failed = true;
-                break ;
-            }
+    game_server_shards_t* shards = self->shards;
+    for (uint32_t shard_index = 0; shard_index < shards->shards_size; ++shard_index) {
+        game_server_t shard = shards->shards[shard_index];
+        shard->previous_frame_info.time_frame_expected = 1.0 / target_fps;
+        shard->time_game_update_fixed                  = time_game_update_fixed;
+    }
+    __atomic_store_n(&shards->is_stopping, false, __ATOMIC_RELEASE);
+
+    bool threads_created = true;
+    for (uint32_t shard_index = 1; shard_index < shards->shards_size; ++shard_index) {
+        shards->threads[shard_index] = thread__create(&game_server__shard__run, shards->shards[shard_index]);
+        if (!shards->threads[shard_index]) {
+            threads_created = false;
+            break ;
+        }
+        thread__start_execution(shards->threads[shard_index]);
+    }
+
+    if (threads_created) {
+        game_server__shard__run(self);
+    } else {
+        debug__write_and_flush(DEBUG_MODULE_GAME_SERVER, DEBUG_ERROR, "failed to create the threads of the shards");
+    }
+
+    __atomic_store_n(&shards->is_stopping, true, __ATOMIC_RELEASE);
+    for (uint32_t shard_index = 1; shard_index < shards->shards_size; ++shard_index) {
+        if (shards->threads[shard_index]) {
+            thread__destroy(shards->threads[shard_index]);
+            shards->threads[shard_index] = 0;
         }
-        loop_stage->time_elapsed = system__get_time() - loop_stage->time_start;
     }
 }
 
 double game_server__time(game_server_t self) {
-    (void) self;
-    return system__get_time();
+    return self->replay ? self->replay_time : system__get_time();
+}
+
+bool game_server__broadcast_message(game_server_t self, const void* data, uint32_t data_size, bool is_ordered) {
+    bool result = game_server__broadcast_message_local(self, data, data_size, is_ordered);
+    if (!self->shards) {
+        return result;
+    }
+    if (data_size > CHANNEL_MESSAGE_SIZE_MAX) {
+        // note: too large for a channel, so it failed locally already
+        return false;
+    }
+
+    game_server_shards_t* shards = self->shards;
+    for (uint32_t shard_index = 0; shard_index < shards->shards_size; ++shard_index) {
+        if (shard_index == self->shard_index) {
+            continue ;
+        }
+
+        spsc_queue_t* queue = &shards->queues[self->shard_index * shards->shards_size + shard_index];
+        shard_message_t* message = spsc_queue__reserve(queue);
+        if (!message) {
+            result = false;
+            continue ;
+        }
+        message->type                 = SHARD_MESSAGE_TYPE_BROADCAST;
+        message->broadcast.is_ordered = is_ordered;
+        message->broadcast.data_size  = data_size;
+        memcpy(message->broadcast.data, data, data_size);
+        spsc_queue__push(queue);
+    }
+
+    return result;
 }
@@ -2,17 +2,116 @@
 # define GAME_SERVER_H
 
 # include <stdint.h>
+# include <stdbool.h>
 
 struct         game_server;
 struct         game_server_config; 
 typedef struct game_server*       game_server_t;
 typedef struct game_server_config game_server_config_t;
+struct         object_state;
+
+/**
+ * Moves the objects [objects_begin, objects_end) of the 'objects_fill' of the scene to where they are 'time' seconds after it was created
+ * Shards call it concurrently for their own parts of the scene, so it only writes those
+*/
+typedef void (*game_server_scene_update_t)(struct object_state* objects, uint32_t objects_begin, uint32_t objects_end, uint32_t objects_fill, double time, void* user_data);
+/**
+ * Hands a reliable message a client sent to the game, in the order of its channel, 'data' is only valid during the call
+ * 'client_id' is unique among the connected clients, it's reused for another client once this one disconnects
+ * Shards call it concurrently for their own clients, from the thread that runs game_server__run
+*/
+typedef void (*game_server_message_receive_t)(uint32_t client_id, const void* data, uint32_t data_size, bool is_ordered, void* user_data);
+
+# define GAME_SERVER_DEFAULT_MAX_CONNECTIONS 4
+# define GAME_SERVER_SHARDS_MAX              32
 
 struct game_server_config {
     /**
      * Time after clients are disconnected if we haven't seen a package from them
     */
     double max_time_for_disconnect;
+    /**
+     * Max number of concurrently connected clients, GAME_SERVER_DEFAULT_MAX_CONNECTIONS if 0, per shard
+    */
+    uint32_t max_connections;
+    /**
+     * Metrics exporter, served on the unix domain socket if set, otherwise on the local tcp port if non-zero
+    */
+    const char* metrics_unix_path;
+    uint16_t    metrics_tcp_port;
+    /**
+     * Receive with io_uring multishot recvmsg instead of epoll + recvmmsg, falls back to epoll if unsupported
+    */
+    bool        event_loop_io_uring;
+    /**
+     * Number of moving objects in the scene replicated to the clients, at most SNAPSHOT_OBJECTS_SIZE
+     * The game doesn't put objects into the scene, they are only there for load generators and benchmarks, it's empty without 'scene_update'
+    */
+    uint32_t    scene_objects_size;
+    //! @note Called every game update with 'scene_update_data', see game_server_scene_update_t
+    game_server_scene_update_t scene_update;
+    void*       scene_update_data;
+    //! @note Called with 'message_receive_data' for every message received, they are dropped if 0, see game_server_message_receive_t
+    game_server_message_receive_t message_receive;
+    void*       message_receive_data;
+    /**
+     * Largest datagram sent, FRAME_MTU_DEFAULT if 0, at most FRAME_MTU_MAX and large enough to fragment a full snapshot
+    */
+    uint32_t    mtu;
+    /**
+     * Number of sequence ids before the newest one received that are acknowledged, ACK_WINDOW_SIZE_DEFAULT if 0, at most ACK_WINDOW_SIZE_MAX
+     * Packets are only counted as lost once they leave it
+    */
+    uint32_t    ack_window_size;
+    /**
+     * Impairs the datagrams sent to the clients, see link_conditioner_t for the syntax
+     * The LINK_CONDITIONER_ENV environment variable is used if 0, the link is left alone if neither is set
+    */
+    const char* link_conditioner;
+    /**
+     * Number of threads the server runs on, 1 if 0, at most GAME_SERVER_SHARDS_MAX
+     * Each shard is pinned to a core and has its own SO_REUSEPORT socket on the port, its own connections and its own part of the scene,
+     * it replicates the parts of the other shards to its clients from what they publish to it every frame
+     * The kernel keeps the datagrams of a client on the same shard, by a hash of the addresses or by core, see 'shards_steer_by_cpu'
+    */
+    uint32_t    shards_size;
+    /**
+     * Datagrams go to the shard pinned to the core that received them instead of by a hash of the addresses, see tp_socket__steer_reuseport_by_cpu
+     * Best with as many shards as receive queues of the NIC, each queue interrupting a different core
+    */
+    bool        shards_steer_by_cpu;
+    /**
+     * Clients on the same host that enable it too exchange datagrams with the server through shared memory instead of UDP, see tp_shm_t
+     * Only without shards, they can't share the name the clients look the server up by
+    */
+    bool        shm;
+    /**
+     * Bytes a packet to a client is kept within, snapshots are sent whole if 0
+     * Only the objects with the most priority for the client are updated in its snapshot then, see priority_accumulator_t,
+     * it costs a history of SNAPSHOT_HISTORY_SIZE snapshots per connection, the ones sent to it
+     * Full snapshots are still sent whole, when nothing the client acknowledged is in the history
+    */
+    uint32_t    snapshot_budget;
+    /**
+     * In units on the ground plane, every object is relevant to every client if 0
+     * Only the objects within it around a client are updated in its snapshot then, see interest_grid_t,
+     * the others keep the state they had when they were last sent, it costs the same history per connection as snapshot_budget
+    */
+    float       interest_radius;
+    /**
+     * Every datagram received is recorded with its arrival time and sender to the capture file at this path if set, see tp_capture_t
+     * Only without shards
+    */
+    const char* capture_path;
+    /**
+     * The datagrams of the capture file at this path are received instead of the ones of a socket if set, none is created, see tp_capture_t
+     * What is sent is dropped, the server runs on the time of the capture, so a capture replays the same way every time
+     * The server stops after the frame of the last datagram
+     * Only without shards
+    */
+    const char* replay_path;
+    //! @note Replays the frames back to back instead of at the speed they were recorded at
+    bool        replay_is_fast;
 };
 
 game_server_t game_server__create(game_server_config_t config, uint16_t port);
@@ -22,7 +121,16 @@ void game_server__run(game_server_t self, double target_fps);
 
 /**
  * @brief Get server time in seconds since it has been running
+ * @note The time of the capture when replaying one, see game_server_config_t::replay_path
 */
 double game_server__time(game_server_t self);
 
+/**
+ * @brief Queues a reliable message to every connected client, it goes out with the next packets
+ * @param is_ordered if true, they are handed out in the order they were queued, otherwise as soon as they arrive
+ * @returns false if it's too large or a client has too many unacknowledged messages, it's queued to the others either way
+ * @note With shards, call it from the thread that runs game_server__run, the other shards queue it on their next frame
+*/
+bool game_server__broadcast_message(game_server_t self, const void* data, uint32_t data_size, bool is_ordered);
+
 #endif // GAME_SERVER_H
@@ -1,15 +1,97 @@
 #include "game_server.h"
 
 #include "debug.h"
+#include "metrics.h"
+#include "packet.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+//! @note Objects of the load scene walk in circles for LOAD_SCENE_WALK_DURATION out of every LOAD_SCENE_PERIOD seconds
+# define LOAD_SCENE_PERIOD        8.0
+# define LOAD_SCENE_WALK_DURATION 2.0
+# define LOAD_SCENE_WALK_SPEED    2.0
+
+//! @brief Load generator, see game_server_scene_update_t, objects are laid out on a grid and walk a circle around their cell, deterministic in 'time'
+static void load_scene__update(object_state_t* objects, uint32_t objects_begin, uint32_t objects_end, uint32_t objects_fill, double time, void* user_data);
+
+static void load_scene__update(object_state_t* objects, uint32_t objects_begin, uint32_t objects_end, uint32_t objects_fill, double time, void* user_data) {
+    (void) user_data;
+
+    const uint32_t grid_size = 23;
+    const float    cell_size = 40.0f;
+    for (uint32_t object_index = objects_begin; object_index < objects_end; ++object_index) {
+        object_state_t* object = &objects[object_index];
+        const double phase       = LOAD_SCENE_PERIOD * (double) object_index / (double) objects_fill;
+        const double time_object = time + phase;
+        const double time_period = fmod(time_object, LOAD_SCENE_PERIOD);
+        const double time_walked = floor(time_object / LOAD_SCENE_PERIOD) * LOAD_SCENE_WALK_DURATION + (time_period < LOAD_SCENE_WALK_DURATION ? time_period : LOAD_SCENE_WALK_DURATION);
+        const double radius      = 4.0 + (double) (object_index % 8);
+        const double angle       = fmod(time_walked * LOAD_SCENE_WALK_SPEED / radius, 2.0 * M_PI);
+
+        object->position.x = ((float) (object_index % grid_size) - (float) (grid_size / 2)) * cell_size + (float) (radius * cos(angle));
+        object->position.y = 0.0f;
+        object->position.z = ((float) (object_index / grid_size) - (float) (grid_size / 2)) * cell_size + (float) (radius * sin(angle));
+        object->yaw        = (float) remainder(angle + M_PI / 2.0, 2.0 * M_PI);
+    }
+}
+
+/**
+ * game_server [load <objects>] [capture <path> | replay <path> | replay_fast <path>]
+ * load fills the scene with moving objects for benchmarks, at most SNAPSHOT_OBJECTS_SIZE
+ * capture records the datagrams received to the capture at 'path', replay replays one instead of opening the port, see game_server_config_t::replay_path
+*/
+int main(int argc, char** argv) {
+    uint32_t    load_objects = 0;
+    const char* mode         = 0;
+    const char* mode_path    = 0;
+    bool        is_usage     = argc % 2 == 0;
+    for (int arg_index = 1; !is_usage && arg_index + 1 < argc; arg_index += 2) {
+        const char* option = argv[arg_index];
+        if (strcmp(option, "load") == 0 && !load_objects) {
+            char* end = 0;
+            const unsigned long objects = strtoul(argv[arg_index + 1], &end, 10);
+            is_usage     = *end != '\0' || objects == 0 || objects > SNAPSHOT_OBJECTS_SIZE;
+            load_objects = (uint32_t) objects;
+        } else if (!mode && (strcmp(option, "capture") == 0 || strcmp(option, "replay") == 0 || strcmp(option, "replay_fast") == 0)) {
+            mode      = option;
+            mode_path = argv[arg_index + 1];
+        } else {
+            is_usage = true;
+        }
+    }
+    if (is_usage) {
+        fprintf(stderr, "usage: %s [load <objects>] [capture <path> | replay <path> | replay_fast <path>]\n", argv[0]);
+        return 1;
+    }
 
-int main() {
     if (!debug__init_module()) {
         return 1;
     }
 
+    if (!metrics__init_module()) {
+        return 1;
+    }
+
     game_server_config_t game_server_config = {
-        .max_time_for_disconnect = 1.0
+        .max_time_for_disconnect = 1.0,
+        .max_connections         = 10000,
+        .metrics_unix_path       = "game_server/metrics.sock",
+        .shm                     = true,
+        .snapshot_budget         = 1200
     };
+    if (load_objects) {
+        game_server_config.scene_objects_size = load_objects;
+        game_server_config.scene_update       = &load_scene__update;
+    }
+    if (mode && strcmp(mode, "capture") == 0) {
+        game_server_config.capture_path = mode_path;
+    } else if (mode) {
+        game_server_config.replay_path    = mode_path;
+        game_server_config.replay_is_fast = strcmp(mode, "replay_fast") == 0;
+    }
 
     const uint32_t game_server_port = 3300;
     game_server_t game_server = game_server__create(game_server_config, game_server_port);
@@ -22,6 +104,8 @@ int main() {
 
     game_server__destroy(game_server);
 
+    metrics__deinit_module();
+
     debug__deinit_module();
 
     return 0;
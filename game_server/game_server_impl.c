@@ -1,9 +1,27 @@
 struct         loop_stage;
 struct         frame_info;
 struct         network_packet;
-typedef struct frame_info     frame_info_t;
-typedef struct loop_stage     loop_stage_t;
-typedef struct network_packet network_packet_t;
+struct         connection_hot;
+struct         connection_cold;
+struct         shard_message;
+struct         game_server_shards;
+typedef struct frame_info      frame_info_t;
+typedef struct loop_stage      loop_stage_t;
+typedef struct network_packet  network_packet_t;
+typedef struct connection_hot  connection_hot_t;
+typedef struct connection_cold connection_cold_t;
+typedef struct shard_message   shard_message_t;
+typedef struct game_server_shards game_server_shards_t;
+
+# define CONNECTION_SLOT_NONE ((uint32_t) -1)
+//! @note Datagrams received into the pool at once plus the ones that can be kept past their batch
+# define GAME_SERVER_RECEIVE_BUFFERS_SIZE      (2 * TP_BATCH_SIZE)
+//! @note Resolution of the timeouts of the connections
+# define GAME_SERVER_TIMER_WHEEL_TICK_DURATION 0.001
+//! @note Messages in flight from a shard to another at most
+# define GAME_SERVER_SHARD_QUEUE_SIZE           256
+//! @note Objects carried by a single shard message at most
+# define GAME_SERVER_SHARD_MESSAGE_OBJECTS_SIZE 16
 
 struct frame_info {
     double   elapsed_time;
@@ -16,24 +34,175 @@ struct frame_info {
 };
 
 struct loop_stage {
-    double   time_start;
-    double   time_elapsed;
-    bool     (*loop_stage__execute)(struct loop_stage* self, game_server_t game_server);
+    const char*  name;
+    double       time_start;
+    double       time_elapsed;
+    histogram_t  time_elapsed_histogram;
+    bool         (*loop_stage__execute)(struct loop_stage* self, game_server_t game_server);
+};
+
+/**
+ * @brief Snapshots as a client was sent them, kept when they are budgeted or filtered by interest,
+ * see game_server_config_t::snapshot_budget and game_server_config_t::interest_radius
+*/
+typedef struct connection_views {
+    /**
+     * Indexed by sequence id modulo SNAPSHOT_HISTORY_SIZE, they are the bases of the deltas, as for the scene otherwise
+     * The objects that didn't fit keep their state from the previous one sent, so every one is what the client decodes
+    */
+    snapshot_t             views[SNAPSHOT_HISTORY_SIZE];
+    seq_id_t               sequence_id_sent;
+    bool                   is_sent;
+    priority_accumulator_t priority_accumulator;
+    //! @note Objects around the client as of the last snapshot sent to it, if they are filtered by interest
+    interest_set_t         interest_set;
+} connection_views_t;
+
+//! @brief Connection state that is touched for every packet received or sent
+struct connection_hot {
+    network_addr_t addr;
+    seq_id_t       sequence_id;
+    ack_window_t   ack_window;
+    //! @note Index into active_slots of game_server
+    uint32_t       active_index;
+    double         time_last_seen;
+    //! @note Number of our sequence ids since the first packet sent to them, acks are only trusted within it
+    uint32_t       packets_sent;
+    //! @note Newest of our sequence ids they acknowledged, snapshots are delta encoded against it
+    seq_id_t       snapshot_sequence_id_acked;
+    bool           snapshot_is_acked;
+    //! @note Allocated on connect, so the reliable messages only cost memory for the connected ones
+    channel_set_t* channels;
+    send_rate_t    send_rate;
+    //! @note Moved by their inputs as they arrive, sent back to them with every packet, see prediction_t
+    object_state_t player;
+    //! @note Allocated on connect if the snapshots are budgeted or filtered by interest
+    connection_views_t* views;
+};
+
+//! @brief Connection state that is touched rarely, like on connect, disconnect or loss
+struct connection_cold {
+    //! @note First member, so the slot can be recovered from the timer in the expire callback
+    timer_wheel_timer_t timer_disconnect;
+    uint32_t packets_dropped;
+    double   time_connected;
+};
+
+typedef enum shard_message_type {
+    //! part of the scene of the sender, as of its last update
+    SHARD_MESSAGE_TYPE_OBJECTS,
+    //! reliable message to the clients of the receiver, see game_server__broadcast_message
+    SHARD_MESSAGE_TYPE_BROADCAST
+} shard_message_type_t;
+
+struct shard_message {
+    shard_message_type_t type;
+    union {
+        struct {
+            uint32_t       offset;
+            uint32_t       fill;
+            object_state_t objects[GAME_SERVER_SHARD_MESSAGE_OBJECTS_SIZE];
+        } objects;
+        struct {
+            bool           is_ordered;
+            uint32_t       data_size;
+            uint8_t        data[CHANNEL_MESSAGE_SIZE_MAX];
+        } broadcast;
+    };
+};
+
+/**
+ * State of a sharded server that is shared by the shards, owned by shard 0, which is the game_server_t returned by create
+ * Shards run on their own thread and only talk to each other through the queues,
+ * queues[from * shards_size + to] has a single producer and a single consumer, so they are lock-free
+*/
+struct game_server_shards {
+    uint32_t       shards_size;
+    game_server_t  shards[GAME_SERVER_SHARDS_MAX];
+    //! @note Shard 0 runs on the thread that called game_server__run
+    thread_t       threads[GAME_SERVER_SHARDS_MAX];
+    spsc_queue_t*  queues;
+    //! @note Set once shard 0 stops, the others stop at the end of their frame
+    bool           is_stopping;
+    //! @note Values of the gauges that are summed over the shards, by shard
+    uint32_t       connections_fill[GAME_SERVER_SHARDS_MAX];
+    uint32_t       connections_degraded[GAME_SERVER_SHARDS_MAX];
 };
 
 struct game_server {
     game_server_config_t config;
+    //! @note Neither is created when replaying
     tp_socket_t          tp_socket;
+    event_loop_t         event_loop;
+    //! @note Datagrams received are recorded to it if set, see game_server_config_t::capture_path
+    tp_capture_t*        capture;
+    /**
+     * Datagrams are received from it instead of the socket if set, see game_server_config_t::replay_path
+     * The server runs on 'replay_time' then, frames are time_frame_expected long in it, whatever they take
+    */
+    tp_capture_t*        replay;
+    double               replay_time;
+    double               replay_time_frame_start;
 
     seq_id_t             sequence_id;
 
-    // todo: better lookup into connections based on network addr
-    uint32_t       connections_size;
-    uint32_t       connections_fill;
-    connection_t*  connections;
+    /**
+     * Connections are stored in slots, [0, connections_size), split by access frequency
+     * active_slots is a permutation of the slots, the first connections_fill are connected, the rest are free
+     * Timeouts are timers on timer_wheel, they are not moved for every packet received, but rescheduled
+     * lazily from time_last_seen when they expire, so an idle frame costs nothing per connection
+    */
+    uint32_t           connections_size;
+    uint32_t           connections_fill;
+    connection_hot_t*  connections_hot;
+    connection_cold_t* connections_cold;
+    uint32_t*          active_slots;
+    timer_wheel_t      timer_wheel;
+    //! network_addr_t -> slot
+    hash_map_t         connections_by_addr;
+    void*              connections_by_addr_memory;
+
+    //! @note 0 if not sharded
+    game_server_shards_t* shards;
+    uint32_t              shard_index;
 
+    //! @note Only shard 0 has one, the game is not partitioned
     game_t         game_state;
 
+    snapshot_t     scene;
+    double         scene_time;
+    /**
+     * Objects of the scene this shard updates, [scene_objects_begin, scene_objects_end)
+     * The rest of the scene is updated by the other shards, it's at most a frame behind them
+    */
+    uint32_t       scene_objects_begin;
+    uint32_t       scene_objects_end;
+    /**
+     * Snapshots of the scene as sent, indexed by sequence id modulo SNAPSHOT_HISTORY_SIZE
+     * Shared by the connections, as every packet of a frame has the same sequence id
+     * A frame encodes the snapshot once per base age in use, the connections with the same base share the encoding,
+     * their datagrams reference it instead of copying it, see frame_packer__push_shared
+    */
+    snapshot_t*      snapshot_history;
+    packet_pool_t    snapshot_pool;
+    //! @note Indexed by base age, 0 if not encoded yet this frame
+    packet_buffer_t* snapshot_encodings[SNAPSHOT_HISTORY_SIZE];
+    //! @note Cells of the scene, updated once per frame, if the snapshots are filtered by interest
+    interest_grid_t  interest_grid;
+
+    //! @note recvmmsg writes straight into the buffers, a buffer retained past its batch is swapped for a new one
+    packet_pool_t    receive_pool;
+    tp_message_t     receive_messages[TP_BATCH_SIZE];
+    packet_buffer_t* receive_buffers[TP_BATCH_SIZE];
+    //! @note The messages of a frame are packed into send_datagrams, which are flushed whenever they run out
+    frame_packer_t   frame_packer;
+    tp_message_t     send_datagrams[TP_BATCH_SIZE];
+    uint8_t          send_buffer[TP_BATCH_SIZE * FRAME_MTU_MAX];
+    struct iovec     send_iovs[TP_BATCH_SIZE * TP_MESSAGE_IOVS_MAX];
+    packet_buffer_t* send_shared[TP_BATCH_SIZE];
+    //! @note Everything of a message but the snapshot, which is shared
+    uint8_t          send_message[PACKET_MESSAGE_SIZE_MAX];
+
     uint32_t      current_frame;
     double        time_lost;
     double        frames_lost;
@@ -43,10 +212,27 @@ struct game_server {
     uint32_t      loop_stages_size;
     loop_stage_t* loop_stages;
     frame_info_t  previous_frame_info;
-    uint32_t      frame_info_sample_index_tail;
-    uint32_t      frame_info_sample_index_head;
-    uint32_t      frame_info_sample_size;
-    frame_info_t* frame_info_sample;
+    uint32_t      frames_missed_deadline;
+    uint32_t      frames_missed_deadline_total;
+    //! @note Whole seconds since the loop started when the frame info was last written, per shard
+    int64_t       seconds_last_info_printed;
+    histogram_t   time_update_histogram;
+    histogram_t   time_frame_histogram;
+
+    metric_t      metric_packets_received;
+    metric_t      metric_packets_sent;
+    //! @note Packets the kernel refused to send, see tp_socket_t::messages_send_failed
+    metric_t      metric_packets_send_failed;
+    metric_t      metric_packets_dropped;
+    //! @note Inputs of packets that didn't arrive, simulated from the input history of a later one
+    metric_t      metric_inputs_recovered;
+    //! @note Objects that changed but didn't fit into the snapshot budget of a client, per packet, see game_server_config_t::snapshot_budget
+    metric_t      metric_objects_deferred;
+    metric_t      metric_connections_fill;
+    metric_t      metric_connections_degraded;
+    metric_t      metric_time_lost;
+    metric_t      metric_frames_lost;
+    metric_t      metric_time_frame;
 };
 
 static bool loop_stage__collect_previous_frame_info(loop_stage_t* self, game_server_t game_server);
@@ -54,22 +240,102 @@ static bool loop_stage__poll_inputs(loop_stage_t* self, game_server_t game_serve
 static bool loop_stage__update_loop(loop_stage_t* self, game_server_t game_server);
 static bool loop_stage__sleep_till_end_of_frame(loop_stage_t* self, game_server_t game_server);
 
+//! @param is_reuseport if true, the socket shares 'port' with the other shards
+static game_server_t game_server__create_shard(game_server_config_t config, uint16_t port, bool is_reuseport);
+//! @brief Creates the socket of a shard, with the link conditioner and shared memory of 'config'
+static bool game_server__create_socket(tp_socket_t* tp_socket, const game_server_config_t* config, uint16_t port, bool is_reuseport);
+//! @param is_reading replayed if true, recorded otherwise
+static tp_capture_t* game_server__create_capture(const char* path, bool is_reading);
+static void game_server__destroy_capture(tp_capture_t* capture);
+//! @brief Stops capturing after the capture failed to be written
+static void game_server__stop_capture(game_server_t self);
+//! @note Destroys what was created of a shard that failed to be created too
+static void game_server__destroy_shard(game_server_t self);
+//! @brief Makes 'self' shard 0 of 'shards_size' shards, creates the others and splits the scene between them
+static bool game_server__create_shards(game_server_t self, uint32_t shards_size, uint16_t port);
+static void game_server__destroy_shards(game_server_t self);
+//! @brief Runs the loop stages until one fails or the shards are stopping
+static void game_server__run_stages(game_server_t self);
+//! @param user_data game_server_t of the shard
+static void game_server__shard__run(void* user_data);
+static bool game_server__is_stopping(game_server_t self);
+//! @brief Sends the part of the scene this shard updates to every other shard
+static void game_server__publish_scene(game_server_t self);
+static void game_server__receive_shard_messages(game_server_t self);
+static bool game_server__broadcast_message_local(game_server_t self, const void* data, uint32_t data_size, bool is_ordered);
+//! @brief Sets a gauge that is summed over the shards, 'value' is the one of this shard, 'values' the ones by shard
+static void game_server__set_shards_gauge(game_server_t self, metric_t metric, uint32_t* values, uint32_t value);
+//! @note The debug lock is shared by the shards, so the per packet messages only take it if they are written
+static bool game_server__is_net_traced();
+static bool game_server__register_metrics(game_server_t self);
 static void game_server__sample_prev_frame(game_server_t self);
-static void game_server__push_stage(game_server_t self, bool (*stage_fn)(struct loop_stage* self, game_server_t game_server));
+static void game_server__write_histogram(const char* name, histogram_t* histogram);
+static void game_server__push_stage(game_server_t self, const char* name, bool (*stage_fn)(struct loop_stage* self, game_server_t game_server));
 static void game_server__receive_packets(game_server_t self, double time);
+//! @brief Receives the datagrams of the replay that arrived until 'time'
+static void game_server__replay_packets(game_server_t self, double time);
+/**
+ * @brief Receives the datagrams of the replay that arrive until the end of the frame, each at its time, sleeps between them if not replaying fast
+ * @returns false once the replay is over
+*/
+static bool game_server__replay_till_end_of_frame(game_server_t self);
+//! @returns Number of messages that have a buffer to receive into
+static uint32_t game_server__prepare_receive_messages(game_server_t self);
+static void game_server__receive_messages(game_server_t self, uint32_t messages_received);
+static void game_server__receive_datagram(game_server_t self, const void* data, uint32_t data_len, network_addr_t sender_addr, double time);
+static void game_server__receive_packet(game_server_t self, const uint8_t* data, uint32_t data_len, network_addr_t sender_addr, double time);
+static void game_server__receive_channel_messages(game_server_t self, uint32_t slot);
 static void game_server__send_packets(game_server_t self);
-static void game_server__disconnect_connection(game_server_t self, connection_t* connection);
-static void game_server__connection__accept(
-    game_server_t self, connection_t* connection, network_addr_t sender_addr,
+//! @returns Encoding of the current snapshot against the one 'base_age' packets ago, a full one if 'base_age' is 0, it's released on the next frame
+static packet_buffer_t* game_server__encode_snapshot(game_server_t self, uint32_t base_age);
+/**
+ * @brief Encodes the snapshot of 'connection' against its view 'base_age' packets ago,
+ * the relevant objects to it with the most priority are updated in it
+ * @param budget bytes it's kept within, besides an object that may not fit, unlimited if 0
+*/
+static bool game_server__write_client_snapshot(
+    game_server_t self, connection_hot_t* connection, uint32_t base_age, uint32_t budget,
+    uint8_t* buffer, uint32_t buffer_size, uint32_t* bytes_written
+);
+//! @brief Records that 'connection' is sent the full snapshot of this frame
+static void game_server__record_full_snapshot(game_server_t self, connection_hot_t* connection);
+static void game_server__flush_send_packets(game_server_t self);
+//! @param interest_radius the scene is kept in an interest grid too if not 0
+static bool game_server__create_scene(game_server_t self, uint32_t objects_size, float interest_radius);
+static void game_server__destroy_scene(game_server_t self);
+static void game_server__update_scene(game_server_t self, double time_delta);
+static bool game_server__create_connections(game_server_t self, uint32_t connections_size, double time);
+static void game_server__destroy_connections(game_server_t self);
+static uint32_t game_server__find_connection(game_server_t self, network_addr_t* addr);
+//! @brief Clears the tombstones out of the address index by reinserting the connected slots
+static void game_server__rebuild_connections_by_addr(game_server_t self);
+static void game_server__disconnect_connection(game_server_t self, uint32_t active_index);
+static connection_views_t* connection_views__create(game_server_t self);
+static void connection_views__destroy(connection_views_t* self);
+//! @returns The slot of the new connection, CONNECTION_SLOT_NONE if it couldn't be accepted
+static uint32_t game_server__connection__accept(
+    game_server_t self, network_addr_t sender_addr,
     packet_t* packet, double time
 );
-static void game_server__accept_packet(game_server_t self, connection_t* connection, packet_t* packet, double time);
+//! @param acks the ack window that came with the packet
+/**
+ * @param input_history inputs of the sequence ids before 'packet', the ones that didn't arrive are simulated from it
+*/
+static void game_server__accept_packet(
+    game_server_t self, uint32_t slot, packet_t* packet, const ack_window_t* acks, const input_history_t* input_history, double time
+);
+//! @param user_data game_server_t
+static void game_server__connection_timer_disconnect__expire(timer_wheel_timer_t* timer, void* user_data);
 
-static void connection__check_for_lost_packets(connection_t* connection, uint32_t left_shift);
+/**
+ * @brief Moves the ack window to a sequence id 'delta' newer than the newest one received so far
+ * @returns Number of packets that were found to be lost
+*/
+static uint32_t connection__advance_ack_window(connection_hot_t* connection_hot, connection_cold_t* connection_cold, uint32_t delta);
 
 static bool loop_stage__collect_previous_frame_info(loop_stage_t* self, game_server_t game_server) {
     game_server->previous_frame_info.time_start         = game_server->previous_frame_info.time_end;
-    game_server->previous_frame_info.time_end           = self->time_start;
+    game_server->previous_frame_info.time_end           = game_server->replay ? game_server->replay_time : self->time_start;
     game_server->previous_frame_info.elapsed_time       = game_server->previous_frame_info.time_end - game_server->previous_frame_info.time_start;
     game_server->previous_frame_info.time_render_actual = game_server->previous_frame_info.time_render_actual;
 
@@ -77,60 +343,46 @@ static bool loop_stage__collect_previous_frame_info(loop_stage_t* self, game_ser
     game_server->time_lost              += expected_time_lost_this_frame;
     game_server->frames_lost            += expected_time_lost_this_frame / game_server->previous_frame_info.time_frame_expected;
     game_server->time_update_to_process += game_server->previous_frame_info.elapsed_time;
+    metric__set(game_server->metric_time_lost, game_server->time_lost);
+    metric__set(game_server->metric_frames_lost, game_server->frames_lost);
 
     game_server__sample_prev_frame(game_server);
 
     int64_t seconds_since_loop_start = (int64_t) game_server->previous_frame_info.time_end;
-    static int64_t seconds_last_info_printed;
-    (void) seconds_last_info_printed;
-    // if (seconds_since_loop_start > seconds_last_info_printed) {
-    if (0) {
-        seconds_last_info_printed = seconds_since_loop_start;
-        double time_frame_actual_avg    = 0.0;
-        double time_frame_expected_avg  = 0.0;
-        double time_update_actual_avg   = 0.0;
-        double time_render_actual_avg   = 0.0;
-        double number_of_updates_avg    = 0.0;
-        int32_t sample_index = (int32_t) game_server->frame_info_sample_index_tail;
-        uint32_t frame_samples_count = 0;
-        while (sample_index != (int32_t) game_server->frame_info_sample_index_head) {
-            time_frame_actual_avg    += game_server->frame_info_sample[sample_index].elapsed_time;
-            time_frame_expected_avg  += game_server->frame_info_sample[sample_index].time_frame_expected;
-            time_update_actual_avg   += game_server->frame_info_sample[sample_index].time_update_actual;
-            time_render_actual_avg   += game_server->frame_info_sample[sample_index].time_render_actual;
-            number_of_updates_avg    += game_server->frame_info_sample[sample_index].number_of_updates;
-            if (sample_index == (int32_t) game_server->frame_info_sample_size - 1) {
-                sample_index = 0;
-            } else {
-                ++sample_index;
-            }
-            ++frame_samples_count;
-        }
+    if (seconds_since_loop_start > game_server->seconds_last_info_printed) {
+        const double time_since_info_printed = (double) (seconds_since_loop_start - game_server->seconds_last_info_printed);
+        game_server->seconds_last_info_printed = seconds_since_loop_start;
+        const uint64_t frame_samples_count = histogram__count(&game_server->time_frame_histogram);
         if (frame_samples_count > 0) {
-            time_frame_actual_avg    /= frame_samples_count;
-            time_frame_expected_avg  /= frame_samples_count;
-            time_update_actual_avg   /= frame_samples_count;
-            time_render_actual_avg   /= frame_samples_count;
-            number_of_updates_avg    /= frame_samples_count;
-
             debug__lock();
 
             debug__writeln("Frame #%u", game_server->current_frame);
             debug__writeln("Time lost:   %lf", game_server->time_lost);
             debug__writeln("Frames lost: %lf", game_server->frames_lost);
-            debug__writeln("Frame avg info across %u frames", frame_samples_count);
-            debug__writeln("  Game updates:            %lf", number_of_updates_avg);
+            debug__writeln("Frame info across %llu frames", (unsigned long long) frame_samples_count);
+            debug__writeln("  Missed deadline:         %u, total: %u", game_server->frames_missed_deadline, game_server->frames_missed_deadline_total);
             debug__writeln("  Time:");
             debug__writeln("    Total:                 %lfs", game_server->previous_frame_info.time_end);
-            debug__writeln("    Game update actual:    %lfus", time_update_actual_avg * 1000000);
             debug__writeln("    Game update fixed:     %lfus", game_server->time_game_update_fixed * 1000000);
-            debug__writeln("    Render actual:         %lfus", time_render_actual_avg * 1000000);
-            debug__writeln("    Frame actual:          %lfms, %lffps", time_frame_actual_avg * 1000.0, 1.0 / time_frame_actual_avg);
-            debug__writeln("    Frame expected:        %lfms, %lffps", time_frame_expected_avg * 1000.0, 1.0 / time_frame_expected_avg);
+            debug__writeln("    Frame expected:        %lfms, %lffps", game_server->previous_frame_info.time_frame_expected * 1000.0, 1.0 / game_server->previous_frame_info.time_frame_expected);
             debug__writeln("    Left to process:       %lfms", (game_server->time_update_to_process - game_server->previous_frame_info.elapsed_time) * 1000.0);
+            debug__writeln("  Latency (us):            %10s %10s %10s %10s %10s", "p50", "p90", "p99", "p99.9", "max");
+            game_server__write_histogram("Game update actual", &game_server->time_update_histogram);
+            game_server__write_histogram("Frame actual", &game_server->time_frame_histogram);
+            for (uint32_t stage_id = 0; stage_id < game_server->loop_stages_top; ++stage_id) {
+                loop_stage_t* loop_stage = &game_server->loop_stages[stage_id];
+                game_server__write_histogram(loop_stage->name, &loop_stage->time_elapsed_histogram);
+                histogram__clear(&loop_stage->time_elapsed_histogram);
+            }
+            debug__writeln("  Memory:");
+            debug__write_memory_stats(time_since_info_printed);
             debug__flush(DEBUG_MODULE_GAME_SERVER, DEBUG_INFO);
 
             debug__unlock();
+
+            histogram__clear(&game_server->time_update_histogram);
+            histogram__clear(&game_server->time_frame_histogram);
+            game_server->frames_missed_deadline = 0;
         }
     }
 
@@ -140,7 +392,10 @@ static bool loop_stage__collect_previous_frame_info(loop_stage_t* self, game_ser
 static bool loop_stage__poll_inputs(loop_stage_t* self, game_server_t game_server) {
     (void) self;
 
-    game_server__receive_packets(game_server, self->time_start);
+    game_server__receive_packets(game_server, game_server->replay ? game_server->replay_time : self->time_start);
+    if (game_server->shards) {
+        game_server__receive_shard_messages(game_server);
+    }
     game_server__send_packets(game_server);
 
     return true;
@@ -156,7 +411,13 @@ static bool loop_stage__update_loop(loop_stage_t* self, game_server_t game_serve
     game_server->previous_frame_info.number_of_updates = game_server->time_update_to_process / game_server->time_game_update_fixed;
     game_server->time_update_to_process -= game_server->previous_frame_info.number_of_updates * game_server->time_game_update_fixed;
     for (uint32_t game_updates_count = 0; game_updates_count < game_server->previous_frame_info.number_of_updates; ++game_updates_count) {
-        game__update(game_server->game_state, game_server->time_game_update_fixed);
+        if (game_server->game_state) {
+            game__update(game_server->game_state, game_server->time_game_update_fixed);
+        }
+        game_server__update_scene(game_server, game_server->time_game_update_fixed);
+    }
+    if (game_server->shards && game_server->previous_frame_info.number_of_updates > 0) {
+        game_server__publish_scene(game_server);
     }
     double time_end = system__get_time();
     game_server->previous_frame_info.time_update_actual = (time_end - self->time_start) / game_server->previous_frame_info.number_of_updates;
@@ -165,70 +426,658 @@ static bool loop_stage__update_loop(loop_stage_t* self, game_server_t game_serve
 }
 
 static bool loop_stage__sleep_till_end_of_frame(loop_stage_t* self, game_server_t game_server) {
-    const double time_mark_end_frame     = game_server->loop_stages[0].time_start + game_server->previous_frame_info.time_frame_expected;
-    const double time_till_end_of_frame  = time_mark_end_frame - self->time_start;
-    if (time_till_end_of_frame > 0.0) {
-        system__sleep(time_till_end_of_frame);
+    (void) self;
+
+    if (game_server->replay) {
+        return game_server__replay_till_end_of_frame(game_server);
     }
+    // note: once a frame while there is time left, so a server that is killed loses its last frame of the capture at most
+    if (game_server->capture && !tp_capture__flush(game_server->capture)) {
+        game_server__stop_capture(game_server);
+    }
+
+    const double time_mark_end_frame = game_server->loop_stages[0].time_start + game_server->previous_frame_info.time_frame_expected;
+    if (!event_loop__set_deadline(&game_server->event_loop, time_mark_end_frame)) {
+        return false;
+    }
+
+    // note: inputs are processed as they arrive instead of waiting for the next frame's poll stage
+    uint32_t events = 0;
+    do {
+        const uint32_t messages_size = game_server__prepare_receive_messages(game_server);
+        uint32_t messages_received = 0;
+        events = event_loop__wait(&game_server->event_loop, game_server->receive_messages, messages_size, &messages_received);
+        if (events == 0) {
+            return false;
+        }
+        game_server__receive_messages(game_server, messages_received);
+    } while (!(events & EVENT_LOOP_EVENT_DEADLINE));
 
     ++game_server->current_frame;
 
     return true;
 }
 
-static void game_server__sample_prev_frame(game_server_t self) {
-    ASSERT(self->frame_info_sample_index_head < self->frame_info_sample_size);
-    frame_info_t* frame_info_sample = &self->frame_info_sample[self->frame_info_sample_index_head++];
-    memcpy(frame_info_sample, &self->previous_frame_info, sizeof(self->previous_frame_info));
-    if (self->frame_info_sample_index_head == self->frame_info_sample_size) {
-        self->frame_info_sample_index_head = 0;
+static bool game_server__create_socket(tp_socket_t* tp_socket, const game_server_config_t* config, uint16_t port, bool is_reuseport) {
+    if (is_reuseport) {
+        if (!tp_socket__create_reuseport(tp_socket, port)) return false;
+    } else if (!tp_socket__create(tp_socket, SOCKET_TYPE_UDP, port)) {
+        return false;
+    }
+
+    debug__writeln("udp socket created on port %u", port);
+
+    const char* link_conditioner = config->link_conditioner ? config->link_conditioner : getenv(LINK_CONDITIONER_ENV);
+    if (link_conditioner) {
+        link_conditioner_config_t link_conditioner_config;
+        if (!link_conditioner_config__parse(&link_conditioner_config, link_conditioner)) return false;
+        if (!tp_socket__set_link_conditioner(tp_socket, &link_conditioner_config)) return false;
+
+        debug__writeln("link conditioner: %s", link_conditioner);
+    }
+
+    if (config->shm) {
+        // note: not fatal, local clients stay on UDP
+        debug__writeln("shared memory transport: %s", tp_socket__enable_shm(tp_socket) ? "enabled" : "failed to enable");
+    }
+
+    return true;
+}
+
+static tp_capture_t* game_server__create_capture(const char* path, bool is_reading) {
+    tp_capture_t* result = memory__malloc(DEBUG_MODULE_GAME_SERVER, sizeof(*result));
+    if (!result) {
+        return 0;
+    }
+    if (!(is_reading ? tp_capture__create_reader(result, path) : tp_capture__create_writer(result, path))) {
+        memory__free(DEBUG_MODULE_GAME_SERVER, result);
+        return 0;
+    }
+
+    return result;
+}
+
+static void game_server__destroy_capture(tp_capture_t* capture) {
+    if (!capture) {
+        return ;
+    }
+
+    tp_capture__destroy(capture);
+    memory__free(DEBUG_MODULE_GAME_SERVER, capture);
+}
+
+static void game_server__stop_capture(game_server_t self) {
+    debug__write_and_flush(DEBUG_MODULE_GAME_SERVER, DEBUG_ERROR, "failed to write the capture, it's stopped");
+    game_server__destroy_capture(self->capture);
+    self->capture = 0;
+}
+
+static game_server_t game_server__create_shard(game_server_config_t config, uint16_t port, bool is_reuseport) {
+    game_server_t result = memory__calloc(DEBUG_MODULE_GAME_SERVER, 1, sizeof(*result));
+    if (!result) return 0;
+    // note: so game_server__destroy_shard can tell what was created
+    result->tp_socket.socket     = -1;
+    result->event_loop.epoll_fd  = -1;
+    result->event_loop.timer_fd  = -1;
+
+    if (!config.replay_path && !game_server__create_socket(&result->tp_socket, &config, port, is_reuseport)) goto err;
+
+    if (!(config.interest_radius >= 0.0f)) goto err;
+    const uint32_t scene_objects_size = config.scene_update ? config.scene_objects_size : 0;
+    if (!game_server__create_scene(result, scene_objects_size, config.interest_radius)) goto err;
+
+    debug__writeln("scene created with %u objects", scene_objects_size);
+
+    const uint32_t mtu = config.mtu ? config.mtu : FRAME_MTU_DEFAULT;
+    if (mtu < FRAME_MTU_MIN || mtu > FRAME_MTU_MAX || FRAME_MESSAGE_SIZE_MAX(mtu) < PACKET_MESSAGE_SIZE_MAX) goto err;
+    frame_packer__create(&result->frame_packer, result->send_datagrams, result->send_buffer, TP_BATCH_SIZE, mtu);
+    frame_packer__set_shared_memory(&result->frame_packer, result->send_iovs, result->send_shared);
+    if (!packet_pool__create(&result->receive_pool, GAME_SERVER_RECEIVE_BUFFERS_SIZE, FRAME_MTU_MAX)) goto err;
+    if (!packet_pool__create(&result->snapshot_pool, SNAPSHOT_HISTORY_SIZE, SNAPSHOT_DELTA_SIZE_MAX)) goto err;
+
+    debug__writeln("mtu: %u", mtu);
+
+    const uint32_t ack_window_size = config.ack_window_size ? config.ack_window_size : ACK_WINDOW_SIZE_DEFAULT;
+    if (ack_window_size > ACK_WINDOW_SIZE_MAX) goto err;
+
+    memcpy(&result->config, &config, sizeof(result->config));
+    result->config.ack_window_size = ack_window_size;
+    // note: places the objects, every shard starts with the whole scene
+    game_server__update_scene(result, 0.0);
+    if (config.replay_path) {
+        result->replay = game_server__create_capture(config.replay_path, true);
+        if (!result->replay) goto err;
+        debug__writeln("replaying %s %s, no socket created", config.replay_path, config.replay_is_fast ? "as fast as possible" : "at the speed it was recorded at");
+    } else {
+        if (!event_loop__create(&result->event_loop, &result->tp_socket, config.event_loop_io_uring ? EVENT_LOOP_BACKEND_IO_URING : EVENT_LOOP_BACKEND_EPOLL)) goto err;
+        debug__writeln("event loop created, backend: %s", result->event_loop.backend == EVENT_LOOP_BACKEND_IO_URING ? "io_uring" : "epoll");
+    }
+    if (config.capture_path) {
+        result->capture = game_server__create_capture(config.capture_path, false);
+        if (!result->capture) goto err;
+        debug__writeln("capturing the datagrams received to %s", config.capture_path);
+    }
+    // note: after the replay, its timers start on the time of the capture
+    const uint32_t connections_size = config.max_connections ? config.max_connections : GAME_SERVER_DEFAULT_MAX_CONNECTIONS;
+    if (!game_server__create_connections(result, connections_size, game_server__time(result))) goto err;
+
+    debug__writeln("available connections left: %u", connections_size);
+    histogram__create(&result->time_update_histogram);
+    histogram__create(&result->time_frame_histogram);
+
+    if (!game_server__register_metrics(result)) goto err;
+
+    game_server__push_stage(result, "Stage collect info", &loop_stage__collect_previous_frame_info);
+    game_server__push_stage(result, "Stage poll inputs", &loop_stage__poll_inputs);
+    game_server__push_stage(result, "Stage update loop", &loop_stage__update_loop);
+    game_server__push_stage(result, "Stage sleep", &loop_stage__sleep_till_end_of_frame);
+
+    return result;
+
+err:
+    game_server__destroy_shard(result);
+
+    return 0;
+}
+
+static void game_server__destroy_shard(game_server_t self) {
+    game_server__destroy_capture(self->replay);
+    event_loop__destroy(&self->event_loop);
+    if (self->tp_socket.socket != -1) {
+        tp_socket__destroy(&self->tp_socket);
+    }
+    game_server__destroy_capture(self->capture);
+
+    frame_packer__clear(&self->frame_packer);
+    for (uint32_t message_index = 0; message_index < TP_BATCH_SIZE; ++message_index) {
+        if (self->receive_buffers[message_index]) {
+            packet_buffer__release(self->receive_buffers[message_index]);
+        }
+    }
+    for (uint32_t base_age = 0; base_age < SNAPSHOT_HISTORY_SIZE; ++base_age) {
+        if (self->snapshot_encodings[base_age]) {
+            packet_buffer__release(self->snapshot_encodings[base_age]);
+        }
+    }
+    packet_pool__destroy(&self->receive_pool);
+    packet_pool__destroy(&self->snapshot_pool);
+
+    game_server__destroy_connections(self);
+    game_server__destroy_scene(self);
+
+    // note: grown by ARRAY_ENSURE_TOP
+    free(self->loop_stages);
+    memory__free(DEBUG_MODULE_GAME_SERVER, self);
+}
+
+static bool game_server__create_shards(game_server_t self, uint32_t shards_size, uint16_t port) {
+    ASSERT(1 < shards_size && shards_size <= GAME_SERVER_SHARDS_MAX);
+    game_server_shards_t* shards = memory__calloc(DEBUG_MODULE_GAME_SERVER, 1, sizeof(*shards));
+    if (!shards) {
+        return false;
+    }
+    shards->shards_size = shards_size;
+    shards->shards[0]   = self;
+    self->shards        = shards;
+    self->shard_index   = 0;
+
+    // note: on failure the shards created so far are left to game_server__destroy_shards
+
+    for (uint32_t shard_index = 1; shard_index < shards_size; ++shard_index) {
+        game_server_t shard = game_server__create_shard(self->config, port, true);
+        if (!shard) {
+            return false;
+        }
+        shard->shards      = shards;
+        shard->shard_index = shard_index;
+        shards->shards[shard_index] = shard;
     }
-    if (self->frame_info_sample_index_head == self->frame_info_sample_index_tail) {
-        ++self->frame_info_sample_index_tail;
-        if (self->frame_info_sample_index_tail == self->frame_info_sample_size) {
-            self->frame_info_sample_index_tail = 0;
+
+    if (self->config.shards_steer_by_cpu) {
+        if (!tp_socket__steer_reuseport_by_cpu(&self->tp_socket, shards_size)) {
+            return false;
+        }
+        debug__writeln("datagrams are steered to the shard of the core that received them");
+    }
+
+    shards->queues = memory__calloc(DEBUG_MODULE_GAME_SERVER, shards_size * shards_size, sizeof(*shards->queues));
+    if (!shards->queues) {
+        return false;
+    }
+    for (uint32_t shard_index_from = 0; shard_index_from < shards_size; ++shard_index_from) {
+        for (uint32_t shard_index_to = 0; shard_index_to < shards_size; ++shard_index_to) {
+            if (
+                shard_index_from != shard_index_to &&
+                !spsc_queue__create(&shards->queues[shard_index_from * shards_size + shard_index_to], sizeof(shard_message_t), GAME_SERVER_SHARD_QUEUE_SIZE)
+            ) {
+                return false;
+            }
+        }
+    }
+
+    // note: every shard starts with the whole scene, then only updates its own part of it
+    const uint32_t objects_size = self->scene.objects_fill;
+    for (uint32_t shard_index = 0; shard_index < shards_size; ++shard_index) {
+        game_server_t shard = shards->shards[shard_index];
+        shard->scene_objects_begin = (uint32_t) ((uint64_t) objects_size * shard_index / shards_size);
+        shard->scene_objects_end   = (uint32_t) ((uint64_t) objects_size * (shard_index + 1) / shards_size);
+    }
+
+    debug__writeln("%u shards, about %u objects of the scene each", shards_size, objects_size / shards_size);
+
+    return true;
+}
+
+static void game_server__destroy_shards(game_server_t self) {
+    game_server_shards_t* shards = self->shards;
+    for (uint32_t shard_index = 1; shard_index < shards->shards_size; ++shard_index) {
+        if (shards->shards[shard_index]) {
+            game_server__destroy_shard(shards->shards[shard_index]);
+        }
+    }
+    if (shards->queues) {
+        for (uint32_t queue_index = 0; queue_index < shards->shards_size * shards->shards_size; ++queue_index) {
+            spsc_queue__destroy(&shards->queues[queue_index]);
+        }
+    }
+
+    memory__free(DEBUG_MODULE_GAME_SERVER, shards->queues);
+    memory__free(DEBUG_MODULE_GAME_SERVER, shards);
+    self->shards = 0;
+}
+
+static void game_server__run_stages(game_server_t self) {
+    ASSERT(self->loop_stages_top > 0);
+    bool stage_failed = false;
+    while (!stage_failed && !game_server__is_stopping(self)) {
+        loop_stage_t* loop_stage = 0;
+        for (uint32_t stage_id = 0; stage_id < self->loop_stages_top; ++stage_id) {
+            loop_stage = &self->loop_stages[stage_id];
+            const double loop_stage_time_start = system__get_time();
+            loop_stage->time_start = loop_stage_time_start;
+            if (stage_id > 0) {
+                loop_stage_t* prev_loop_stage = &self->loop_stages[stage_id - 1];
+                prev_loop_stage->time_elapsed = loop_stage_time_start - prev_loop_stage->time_start;
+                histogram__record_time(&prev_loop_stage->time_elapsed_histogram, prev_loop_stage->time_elapsed);
+            }
+            loop_stage = &self->loop_stages[stage_id];
+            if (!loop_stage->loop_stage__execute(loop_stage, self)) {
+                stage_failed = true;
+                break ;
+            }
+        }
+        loop_stage->time_elapsed = system__get_time() - loop_stage->time_start;
+        histogram__record_time(&loop_stage->time_elapsed_histogram, loop_stage->time_elapsed);
+    }
+}
+
+static void game_server__shard__run(void* user_data) {
+    game_server_t self = (game_server_t) user_data;
+    if (!thread__pin_current(self->shard_index)) {
+        debug__write_and_flush(
+            DEBUG_MODULE_GAME_SERVER, DEBUG_WARN,
+            "shard %u could not be pinned to a core",
+            self->shard_index
+        );
+    }
+
+    game_server__run_stages(self);
+}
+
+static bool game_server__is_stopping(game_server_t self) {
+    return self->shards && __atomic_load_n(&self->shards->is_stopping, __ATOMIC_ACQUIRE);
+}
+
+static void game_server__publish_scene(game_server_t self) {
+    game_server_shards_t* shards = self->shards;
+    for (uint32_t shard_index = 0; shard_index < shards->shards_size; ++shard_index) {
+        if (shard_index == self->shard_index) {
+            continue ;
+        }
+
+        spsc_queue_t* queue = &shards->queues[self->shard_index * shards->shards_size + shard_index];
+        for (uint32_t offset = self->scene_objects_begin; offset < self->scene_objects_end; offset += GAME_SERVER_SHARD_MESSAGE_OBJECTS_SIZE) {
+            shard_message_t* message = spsc_queue__reserve(queue);
+            if (!message) {
+                // note: they fell behind, the whole part is sent again with the next update
+                break ;
+            }
+            const uint32_t objects_left = self->scene_objects_end - offset;
+            message->type           = SHARD_MESSAGE_TYPE_OBJECTS;
+            message->objects.offset = offset;
+            message->objects.fill   = objects_left < GAME_SERVER_SHARD_MESSAGE_OBJECTS_SIZE ? objects_left : GAME_SERVER_SHARD_MESSAGE_OBJECTS_SIZE;
+            memcpy(message->objects.objects, &self->scene.objects[offset], message->objects.fill * sizeof(*message->objects.objects));
+            spsc_queue__push(queue);
+        }
+    }
+}
+
+static void game_server__receive_shard_messages(game_server_t self) {
+    game_server_shards_t* shards = self->shards;
+    for (uint32_t shard_index = 0; shard_index < shards->shards_size; ++shard_index) {
+        if (shard_index == self->shard_index) {
+            continue ;
+        }
+
+        spsc_queue_t* queue = &shards->queues[shard_index * shards->shards_size + self->shard_index];
+        shard_message_t* message = 0;
+        while ((message = spsc_queue__front(queue))) {
+            switch (message->type) {
+                case SHARD_MESSAGE_TYPE_OBJECTS: {
+                    ASSERT(message->objects.offset + message->objects.fill <= self->scene.objects_fill);
+                    memcpy(&self->scene.objects[message->objects.offset], message->objects.objects, message->objects.fill * sizeof(*message->objects.objects));
+                } break ;
+                case SHARD_MESSAGE_TYPE_BROADCAST: {
+                    game_server__broadcast_message_local(self, message->broadcast.data, message->broadcast.data_size, message->broadcast.is_ordered);
+                } break ;
+                default: ASSERT(false);
+            }
+            spsc_queue__pop(queue);
         }
     }
-    ASSERT(self->frame_info_sample_index_tail != self->frame_info_sample_index_head);
 }
 
-static void game_server__push_stage(game_server_t self, bool (*stage_fn)(struct loop_stage* self, game_server_t game_server)) {
+static bool game_server__broadcast_message_local(game_server_t self, const void* data, uint32_t data_size, bool is_ordered) {
+    const channel_type_t type = is_ordered ? CHANNEL_TYPE_RELIABLE_ORDERED : CHANNEL_TYPE_RELIABLE_UNORDERED;
+    bool result = true;
+    for (uint32_t active_index = 0; active_index < self->connections_fill; ++active_index) {
+        connection_hot_t* connection = &self->connections_hot[self->active_slots[active_index]];
+        if (!channel_set__push(connection->channels, type, data, data_size)) {
+            result = false;
+        }
+    }
+
+    return result;
+}
+
+static void game_server__set_shards_gauge(game_server_t self, metric_t metric, uint32_t* values, uint32_t value) {
+    if (!values) {
+        metric__set(metric, value);
+        return ;
+    }
+
+    // note: shards race to set the sum, a stale one is corrected by the next shard that changes its value
+    __atomic_store_n(&values[self->shard_index], value, __ATOMIC_RELAXED);
+    uint64_t sum = 0;
+    for (uint32_t shard_index = 0; shard_index < self->shards->shards_size; ++shard_index) {
+        sum += __atomic_load_n(&values[shard_index], __ATOMIC_RELAXED);
+    }
+    metric__set(metric, (double) sum);
+}
+
+static bool game_server__is_net_traced() {
+    return (
+        debug__get_message_module_availability(DEBUG_MODULE_GAME_SERVER) &&
+        debug__get_message_type_availability(DEBUG_MODULE_GAME_SERVER, DEBUG_NET)
+    );
+}
+
+static bool game_server__register_metrics(game_server_t self) {
+    return (
+        metrics__register(&self->metric_packets_received, "game_server_packets_received", METRIC_TYPE_COUNTER) &&
+        metrics__register(&self->metric_packets_sent, "game_server_packets_sent", METRIC_TYPE_COUNTER) &&
+        metrics__register(&self->metric_packets_send_failed, "game_server_packets_send_failed", METRIC_TYPE_COUNTER) &&
+        metrics__register(&self->metric_packets_dropped, "game_server_packets_dropped", METRIC_TYPE_COUNTER) &&
+        metrics__register(&self->metric_inputs_recovered, "game_server_inputs_recovered", METRIC_TYPE_COUNTER) &&
+        metrics__register(&self->metric_objects_deferred, "game_server_objects_deferred", METRIC_TYPE_COUNTER) &&
+        metrics__register(&self->metric_connections_fill, "game_server_connections_fill", METRIC_TYPE_GAUGE) &&
+        metrics__register(&self->metric_connections_degraded, "game_server_connections_degraded", METRIC_TYPE_GAUGE) &&
+        metrics__register(&self->metric_time_lost, "game_server_time_lost_seconds", METRIC_TYPE_GAUGE) &&
+        metrics__register(&self->metric_frames_lost, "game_server_frames_lost", METRIC_TYPE_GAUGE) &&
+        metrics__register(&self->metric_time_frame, "game_server_frame_time_ns", METRIC_TYPE_HISTOGRAM)
+    );
+}
+
+static void game_server__sample_prev_frame(game_server_t self) {
+    if (self->current_frame == 0) {
+        // note: there is no previous frame to sample
+        return ;
+    }
+
+    histogram__record_time(&self->time_frame_histogram, self->previous_frame_info.elapsed_time);
+    metric__record_time(self->metric_time_frame, self->previous_frame_info.elapsed_time);
+    if (self->previous_frame_info.number_of_updates > 0) {
+        histogram__record_time(&self->time_update_histogram, self->previous_frame_info.time_update_actual);
+    }
+    if (self->previous_frame_info.elapsed_time > self->previous_frame_info.time_frame_expected) {
+        ++self->frames_missed_deadline;
+        ++self->frames_missed_deadline_total;
+    }
+}
+
+static void game_server__write_histogram(const char* name, histogram_t* histogram) {
+    debug__writeln(
+        "    %-21s %10.1lf %10.1lf %10.1lf %10.1lf %10.1lf",
+        name,
+        histogram__percentile(histogram, 50.0) / 1000.0,
+        histogram__percentile(histogram, 90.0) / 1000.0,
+        histogram__percentile(histogram, 99.0) / 1000.0,
+        histogram__percentile(histogram, 99.9) / 1000.0,
+        histogram__max(histogram) / 1000.0
+    );
+}
+
+static void game_server__push_stage(game_server_t self, const char* name, bool (*stage_fn)(struct loop_stage* self, game_server_t game_server)) {
     ARRAY_ENSURE_TOP(self->loop_stages, self->loop_stages_top, self->loop_stages_size);
-    self->loop_stages[self->loop_stages_top].loop_stage__execute = stage_fn;
+    loop_stage_t* loop_stage = &self->loop_stages[self->loop_stages_top];
+    loop_stage->name = name;
+    loop_stage->loop_stage__execute = stage_fn;
+    histogram__create(&loop_stage->time_elapsed_histogram);
     ++self->loop_stages_top;
 }
 
-static void game_server__disconnect_connection(game_server_t self, connection_t* connection) {
+static bool game_server__create_scene(game_server_t self, uint32_t objects_size, float interest_radius) {
+    if (objects_size > SNAPSHOT_OBJECTS_SIZE) {
+        return false;
+    }
+
+    self->snapshot_history = memory__calloc(DEBUG_MODULE_GAME_SERVER, SNAPSHOT_HISTORY_SIZE, sizeof(*self->snapshot_history));
+    if (!self->snapshot_history) {
+        return false;
+    }
+    // note: a query spans 3 by 3 cells with cells as large as the radius
+    if (interest_radius > 0.0f && !interest_grid__create(&self->interest_grid, interest_radius, SNAPSHOT_OBJECTS_SIZE)) {
+        memory__free(DEBUG_MODULE_GAME_SERVER, self->snapshot_history);
+        self->snapshot_history = 0;
+        return false;
+    }
+
+    self->scene.objects_fill        = objects_size;
+    self->scene_time                = 0.0;
+    self->scene_objects_begin       = 0;
+    self->scene_objects_end         = objects_size;
+
+    return true;
+}
+
+static void game_server__destroy_scene(game_server_t self) {
+    memory__free(DEBUG_MODULE_GAME_SERVER, self->snapshot_history);
+    interest_grid__destroy(&self->interest_grid);
+}
+
+static void game_server__update_scene(game_server_t self, double time_delta) {
+    self->scene_time += time_delta;
+
+    if (self->config.scene_update && self->scene_objects_begin < self->scene_objects_end) {
+        self->config.scene_update(
+            self->scene.objects, self->scene_objects_begin, self->scene_objects_end, self->scene.objects_fill,
+            self->scene_time, self->config.scene_update_data
+        );
+    }
+}
+
+static bool game_server__create_connections(game_server_t self, uint32_t connections_size, double time) {
+    self->connections_size = connections_size;
+    self->connections_fill = 0;
+
+    self->connections_hot        = memory__calloc(DEBUG_MODULE_GAME_SERVER, connections_size, sizeof(*self->connections_hot));
+    self->connections_cold       = memory__calloc(DEBUG_MODULE_GAME_SERVER, connections_size, sizeof(*self->connections_cold));
+    self->active_slots           = memory__calloc(DEBUG_MODULE_GAME_SERVER, connections_size, sizeof(*self->active_slots));
+    // note: keep the load factor at or below 1/2 so probe sequences stay short
+    const uint64_t connections_by_addr_memory_size = 2 * (uint64_t) connections_size * hash_map__entry_size(sizeof(network_addr_t), sizeof(uint32_t));
+    self->connections_by_addr_memory = memory__malloc(DEBUG_MODULE_GAME_SERVER, connections_by_addr_memory_size);
+    if (
+        !self->connections_hot || !self->connections_cold || !self->active_slots ||
+        !self->connections_by_addr_memory
+    ) {
+        return false;
+    }
+
+    if (!hash_map__create(
+        &self->connections_by_addr, self->connections_by_addr_memory, connections_by_addr_memory_size,
+        sizeof(network_addr_t), sizeof(uint32_t), &hash_fn__network_addr, &eq_fn__network_addr
+    )) {
+        return false;
+    }
+
+    timer_wheel__create(&self->timer_wheel, time, GAME_SERVER_TIMER_WHEEL_TICK_DURATION);
+    for (uint32_t slot = 0; slot < connections_size; ++slot) {
+        self->active_slots[slot] = slot;
+        timer_wheel_timer__create(&self->connections_cold[slot].timer_disconnect, &game_server__connection_timer_disconnect__expire);
+    }
+
+    return true;
+}
+
+static void game_server__destroy_connections(game_server_t self) {
+    for (uint32_t active_index = 0; active_index < self->connections_fill; ++active_index) {
+        memory__free(DEBUG_MODULE_GAME_SERVER, self->connections_hot[self->active_slots[active_index]].channels);
+        connection_views__destroy(self->connections_hot[self->active_slots[active_index]].views);
+    }
+    memory__free(DEBUG_MODULE_GAME_SERVER, self->connections_hot);
+    memory__free(DEBUG_MODULE_GAME_SERVER, self->connections_cold);
+    memory__free(DEBUG_MODULE_GAME_SERVER, self->active_slots);
+    memory__free(DEBUG_MODULE_GAME_SERVER, self->connections_by_addr_memory);
+}
+
+static uint32_t game_server__find_connection(game_server_t self, network_addr_t* addr) {
+    uint32_t* slot = hash_map__find(&self->connections_by_addr, addr);
+
+    return slot ? *slot : CONNECTION_SLOT_NONE;
+}
+
+static void game_server__rebuild_connections_by_addr(game_server_t self) {
+    hash_map__clear(&self->connections_by_addr);
+    for (uint32_t active_index = 0; active_index < self->connections_fill; ++active_index) {
+        const uint32_t slot = self->active_slots[active_index];
+        hash_map__insert(&self->connections_by_addr, &self->connections_hot[slot].addr, &slot);
+    }
+}
+
+static void game_server__disconnect_connection(game_server_t self, uint32_t active_index) {
     ASSERT(self->connections_fill > 0);
-    --self->connections_fill;
+    ASSERT(active_index < self->connections_fill);
+    const uint32_t slot = self->active_slots[active_index];
+    connection_hot_t* connection_hot = &self->connections_hot[slot];
 
-    connection->connected = false;
+    timer_wheel__cancel(&self->timer_wheel, &self->connections_cold[slot].timer_disconnect);
+    hash_map__remove(&self->connections_by_addr, &connection_hot->addr);
+    memory__free(DEBUG_MODULE_GAME_SERVER, connection_hot->channels);
+    connection_hot->channels = 0;
+    connection_views__destroy(connection_hot->views);
+    connection_hot->views = 0;
+    if (hash_map__tombstones(&self->connections_by_addr) > (hash_map__capacity(&self->connections_by_addr) >> 2)) {
+        game_server__rebuild_connections_by_addr(self);
+    }
+
+    // note: swap with the last connected one, the freed slot becomes the first free one
+    const uint32_t last_active_index = self->connections_fill - 1;
+    const uint32_t last_slot = self->active_slots[last_active_index];
+    self->active_slots[active_index]              = last_slot;
+    self->connections_hot[last_slot].active_index = active_index;
+    self->active_slots[last_active_index]         = slot;
+    --self->connections_fill;
+    game_server__set_shards_gauge(self, self->metric_connections_fill, self->shards ? self->shards->connections_fill : 0, self->connections_fill);
 
     debug__lock();
 
-    debug__writeln("client disconnected from the server: %u:%u", connection->addr.addr, connection->addr.port);
-    debug__writeln("last known packet from them: %u, local sequence id: %u", connection->sequence_id, self->sequence_id);
+    debug__writeln("client disconnected from the server: %u:%u", connection_hot->addr.addr, connection_hot->addr.port);
+    debug__writeln("last known packet from them: %u, local sequence id: %u", connection_hot->sequence_id, self->sequence_id);
     debug__writeln("available connections: %u", self->connections_size - self->connections_fill);
     debug__flush(DEBUG_MODULE_GAME_SERVER, DEBUG_NET);
 
     debug__unlock();
 }
 
-static void game_server__connection__accept(
-    game_server_t self, connection_t* connection, network_addr_t sender_addr,
+static connection_views_t* connection_views__create(game_server_t self) {
+    connection_views_t* result = memory__malloc(DEBUG_MODULE_GAME_SERVER, sizeof(*result));
+    if (!result) {
+        return 0;
+    }
+    if (!priority_accumulator__create(&result->priority_accumulator, SNAPSHOT_OBJECTS_SIZE)) {
+        memory__free(DEBUG_MODULE_GAME_SERVER, result);
+        return 0;
+    }
+    memset(&result->interest_set, 0, sizeof(result->interest_set));
+    if (self->config.interest_radius > 0.0f && !interest_set__create(&result->interest_set, SNAPSHOT_OBJECTS_SIZE)) {
+        priority_accumulator__destroy(&result->priority_accumulator);
+        memory__free(DEBUG_MODULE_GAME_SERVER, result);
+        return 0;
+    }
+    result->is_sent = false;
+
+    return result;
+}
+
+static void connection_views__destroy(connection_views_t* self) {
+    if (!self) {
+        return ;
+    }
+
+    priority_accumulator__destroy(&self->priority_accumulator);
+    interest_set__destroy(&self->interest_set);
+    memory__free(DEBUG_MODULE_GAME_SERVER, self);
+}
+
+static uint32_t game_server__connection__accept(
+    game_server_t self, network_addr_t sender_addr,
     packet_t* packet, double time
 ) {
     ASSERT(self->connections_fill < self->connections_size);
+    const uint32_t active_index = self->connections_fill;
+    const uint32_t slot = self->active_slots[active_index];
+    channel_set_t* channels = memory__malloc(DEBUG_MODULE_GAME_SERVER, sizeof(*channels));
+    if (!channels) {
+        return CONNECTION_SLOT_NONE;
+    }
+    connection_views_t* views = 0;
+    if (self->config.snapshot_budget || self->config.interest_radius > 0.0f) {
+        views = connection_views__create(self);
+        if (!views) {
+            memory__free(DEBUG_MODULE_GAME_SERVER, channels);
+            return CONNECTION_SLOT_NONE;
+        }
+    }
+    if (!hash_map__insert(&self->connections_by_addr, &sender_addr, &slot)) {
+        // note: can't happen as long as the index has more capacity than there are slots
+        ASSERT(false);
+        memory__free(DEBUG_MODULE_GAME_SERVER, channels);
+        connection_views__destroy(views);
+        return CONNECTION_SLOT_NONE;
+    }
     ++self->connections_fill;
+    game_server__set_shards_gauge(self, self->metric_connections_fill, self->shards ? self->shards->connections_fill : 0, self->connections_fill);
+
+    connection_hot_t* connection_hot = &self->connections_hot[slot];
+    connection_hot->addr         = sender_addr;
+    connection_hot->sequence_id  = packet->sequence_id;
+    ack_window__create(&connection_hot->ack_window, self->config.ack_window_size);
+    connection_hot->active_index   = active_index;
+    connection_hot->time_last_seen = time;
+    connection_hot->packets_sent      = 0;
+    connection_hot->snapshot_is_acked = false;
+    connection_hot->channels          = channels;
+    connection_hot->views             = views;
+    channel_set__create(channels);
+    send_rate__create(&connection_hot->send_rate, time);
+    player__spawn(&connection_hot->player);
+    // note: the first packet is acknowledged, so its input must be simulated too
+    prediction__simulate(&player__simulate, &connection_hot->player, &packet->game_data);
 
-    connection->addr            = sender_addr;
-    connection->time_last_seen  = time;
-    connection->sequence_id     = packet->sequence_id;
-    connection->ack_bitfield    = -1;
-    connection->packets_dropped = 0;
-    connection->rtt             = 0.0;
-    connection->time_connected  = time;
-    connection->connected       = true;
+    connection_cold_t* connection_cold = &self->connections_cold[slot];
+    connection_cold->packets_dropped = 0;
+    connection_cold->time_connected  = time;
+    timer_wheel__schedule(&self->timer_wheel, &connection_cold->timer_disconnect, time + self->config.max_time_for_disconnect);
 
     debug__lock();
 
@@ -237,130 +1086,555 @@ static void game_server__connection__accept(
     debug__flush(DEBUG_MODULE_GAME_SERVER, DEBUG_NET);
 
     debug__unlock();
-}
 
-static void game_server__accept_packet(game_server_t self, connection_t* connection, packet_t* packet, double time) {
-    (void) self;
+    return slot;
+}
 
-    connection->time_last_seen = time;
+static void game_server__accept_packet(
+    game_server_t self, uint32_t slot, packet_t* packet, const ack_window_t* acks, const input_history_t* input_history, double time
+) {
+    connection_hot_t* connection = &self->connections_hot[slot];
+    // note: packets of a batch can be processed out of arrival order
+    if (connection->time_last_seen < time) {
+        connection->time_last_seen = time;
+    }
 
     if (sequence_id__is_more_recent(packet->sequence_id, connection->sequence_id)) {
         const uint32_t connection_seq_id_delta = sequence_id__delta(packet->sequence_id, connection->sequence_id);
-        connection__check_for_lost_packets(connection, connection_seq_id_delta);
-        uint32_t new_ack_bitfield = 0;
-        if (connection_seq_id_delta <= (sizeof(connection->ack_bitfield) << 3)) {
-            ASSERT(connection_seq_id_delta > 0);
-            new_ack_bitfield |= (connection->ack_bitfield << connection_seq_id_delta);
-            new_ack_bitfield |= (1 << (connection_seq_id_delta - 1));
-        }
-
-        connection->ack_bitfield = new_ack_bitfield;
+        metric__add(self->metric_packets_dropped, connection__advance_ack_window(connection, &self->connections_cold[slot], connection_seq_id_delta));
         connection->sequence_id = packet->sequence_id;
+        // note: only the newest inputs are simulated, so the state sent back is the one after the input of 'ack'
+        // the ones between the previous newest and this one were lost or are late, they are simulated from the history, oldest first
+        const uint32_t inputs_missed = connection_seq_id_delta - 1;
+        uint32_t input_age = inputs_missed < input_history->inputs_fill ? inputs_missed : input_history->inputs_fill;
+        metric__add(self->metric_inputs_recovered, input_age);
+        for (; input_age > 0; --input_age) {
+            prediction__simulate(&player__simulate, &connection->player, &input_history->inputs[input_age - 1]);
+        }
+        prediction__simulate(&player__simulate, &connection->player, &packet->game_data);
     } else if (connection->sequence_id != packet->sequence_id) {
-        const uint32_t connection_seq_id_delta = sequence_id__delta(connection->sequence_id, packet->sequence_id);
-        if (connection_seq_id_delta <= (sizeof(connection->ack_bitfield) << 3)) {
-            connection->ack_bitfield |= (1 << (connection_seq_id_delta - 1));
+        ack_window__set(&connection->ack_window, sequence_id__delta(connection->sequence_id, packet->sequence_id));
+    }
+
+    // note: 'ack' is the newest of ours they received, it's only useful as a base while it's still in the history
+    const uint32_t ack_age = sequence_id__delta(self->sequence_id, packet->ack);
+    if (ack_age > 0 && ack_age <= connection->packets_sent) {
+        channel_set__ack(connection->channels, packet->ack, acks);
+        send_rate__on_ack(&connection->send_rate, packet->ack, acks, time);
+    }
+    if (
+        ack_age > 0 && ack_age <= connection->packets_sent && ack_age < SNAPSHOT_HISTORY_SIZE &&
+        (!connection->snapshot_is_acked || ack_age < sequence_id__delta(self->sequence_id, connection->snapshot_sequence_id_acked))
+    ) {
+        connection->snapshot_sequence_id_acked = packet->ack;
+        connection->snapshot_is_acked          = true;
+    }
+
+    if (game_server__is_net_traced()) {
+        debug__lock();
+
+        debug__write_raw("RECV PACKET: ");
+        debug__write_packet_raw(packet);
+        debug__flush(DEBUG_MODULE_GAME_SERVER, DEBUG_NET);
+
+        debug__unlock();
+    }
+}
+
+static uint32_t game_server__prepare_receive_messages(game_server_t self) {
+    uint32_t message_index = 0;
+    for (; message_index < TP_BATCH_SIZE; ++message_index) {
+        packet_buffer_t* buffer = self->receive_buffers[message_index];
+        if (buffer && buffer->refs > 1) {
+            // note: kept past its batch, it's left to whoever holds on to it
+            packet_buffer__release(buffer);
+            buffer = 0;
+        }
+        if (!buffer) {
+            buffer = packet_pool__acquire(&self->receive_pool);
+            self->receive_buffers[message_index] = buffer;
+            if (!buffer) {
+                break ;
+            }
         }
+
+        tp_message_t* message = &self->receive_messages[message_index];
+        message->data      = buffer->data;
+        message->data_size = buffer->data_size;
     }
+    ASSERT(message_index > 0);
 
-    debug__lock();
-    
-    debug__write_raw("RECV PACKET: ");
-    debug__write_packet_raw(packet);
-    debug__flush(DEBUG_MODULE_GAME_SERVER, DEBUG_NET);
+    return message_index;
+}
 
-    debug__unlock();
+static void game_server__receive_messages(game_server_t self, uint32_t messages_received) {
+    metric__add(self->metric_packets_received, messages_received);
+    for (uint32_t message_index = 0; message_index < messages_received; ++message_index) {
+        tp_message_t* message = &self->receive_messages[message_index];
+        const uint8_t* data = message->data;
+        self->receive_buffers[message_index]->data_len = message->data_len;
+        // note: datagrams coalesced by GRO are unpacked one by one
+        const uint32_t segment_size = message->segment_size ? message->segment_size : message->data_len;
+        for (uint32_t segment_offset = 0; segment_offset < message->data_len; segment_offset += segment_size) {
+            const uint32_t datagram_len = message->data_len - segment_offset < segment_size ? message->data_len - segment_offset : segment_size;
+            if (self->capture && !tp_capture__write(self->capture, data + segment_offset, datagram_len, message->addr, message->time_arrival) && self->capture->error) {
+                game_server__stop_capture(self);
+            }
+            game_server__receive_datagram(self, data + segment_offset, datagram_len, message->addr, message->time_arrival);
+        }
+    }
+}
+
+static void game_server__receive_datagram(game_server_t self, const void* data, uint32_t data_len, network_addr_t sender_addr, double time) {
+    frame_unpacker_t frame_unpacker;
+    frame_unpacker__create(&frame_unpacker, data, data_len);
+    const void* message = 0;
+    uint32_t message_size = 0;
+    // note: clients only send messages that fit in a datagram, so there is nothing to reassemble
+    while (frame_unpacker__next(&frame_unpacker, 0, &message, &message_size)) {
+        game_server__receive_packet(self, message, message_size, sender_addr, time);
+    }
+    if (frame_unpacker.error) {
+        debug__write_and_flush(
+            DEBUG_MODULE_GAME_SERVER, DEBUG_NET,
+            "malformed datagram received, size: %u",
+            data_len
+        );
+    }
 }
 
 static void game_server__receive_packets(game_server_t self, double time) {
-    packet_t packet;
-    uint32_t received_data_len = 0;
-    network_addr_t sender_addr;
+    if (self->replay) {
+        game_server__replay_packets(self, time);
+        timer_wheel__advance(&self->timer_wheel, time, self);
+        return ;
+    }
+
     // todo: process a limited amount
-    while (tp_socket__get_data(&self->tp_socket, &packet, sizeof(packet), &received_data_len, &sender_addr)) {
-        if (received_data_len == sizeof(packet)) {
-            bool package_accepted = false;
-            connection_t* free_connection = 0;
-            for (uint32_t connection_index = 0; connection_index < self->connections_size; ++connection_index) {
-                connection_t* connection = &self->connections[connection_index];
-                if (connection->connected) {
-                    if (network_addr__is_same(&sender_addr, &connection->addr)) {
-                        game_server__accept_packet(self, connection, &packet, time);
-                        package_accepted = true;
-                        break ;
-                    }
-                } else {
-                    free_connection = connection;
-                }
-            }
+    while (true) {
+        const uint32_t messages_size = game_server__prepare_receive_messages(self);
+        const uint32_t messages_received = event_loop__poll(&self->event_loop, self->receive_messages, messages_size);
+        if (messages_received == 0) {
+            break ;
+        }
+        game_server__receive_messages(self, messages_received);
 
-            if (!package_accepted && free_connection) {
-                game_server__connection__accept(self, free_connection, sender_addr, &packet, time);
-            }
-        } else {
-            debug__write_and_flush(
-                DEBUG_MODULE_GAME_SERVER, DEBUG_NET,
-                "unknown packet size received: %u, expected: %u",
-                received_data_len, sizeof(packet)
-            );
+        if (messages_received < messages_size) {
+            break ;
         }
+    }
 
-        // system__usleep(2000);
+    timer_wheel__advance(&self->timer_wheel, time, self);
+}
+
+static void game_server__replay_packets(game_server_t self, double time) {
+    while (true) {
+        const uint32_t messages_size = game_server__prepare_receive_messages(self);
+        const uint32_t messages_received = tp_capture__read_batch(self->replay, self->receive_messages, messages_size, time);
+        game_server__receive_messages(self, messages_received);
+
+        if (messages_received < messages_size) {
+            break ;
+        }
+    }
+}
+
+static bool game_server__replay_till_end_of_frame(game_server_t self) {
+    const double time_frame_end = self->replay_time_frame_start + self->previous_frame_info.time_frame_expected;
+    double time_arrival = 0.0;
+    bool is_replaying = tp_capture__peek(self->replay, &time_arrival);
+    while (is_replaying && time_arrival < time_frame_end) {
+        if (!self->config.replay_is_fast && time_arrival > system__get_time()) {
+            system__sleep(time_arrival - system__get_time());
+        }
+        // note: the datagrams of the previous frame that arrived before it ended are received at its end
+        if (time_arrival > self->replay_time) {
+            self->replay_time = time_arrival;
+        }
+        game_server__replay_packets(self, self->replay_time);
+        timer_wheel__advance(&self->timer_wheel, self->replay_time, self);
+        is_replaying = tp_capture__peek(self->replay, &time_arrival);
     }
+    if (!self->config.replay_is_fast && time_frame_end > system__get_time()) {
+        system__sleep(time_frame_end - system__get_time());
+    }
+    self->replay_time             = time_frame_end;
+    self->replay_time_frame_start = time_frame_end;
+
+    ++self->current_frame;
 
-    for (uint32_t connection_index = 0; connection_index < self->connections_size; ++connection_index) {
-        connection_t* connection = &self->connections[connection_index];
-        if (connection->connected) {
-            if (connection->time_last_seen + self->config.max_time_for_disconnect < time) {
-                game_server__disconnect_connection(self, connection);
+    if (!is_replaying) {
+        debug__write_and_flush(
+            DEBUG_MODULE_GAME_SERVER, DEBUG_INFO,
+            "replay of %llu datagrams over %u frames is over%s",
+            (unsigned long long) self->replay->records, self->current_frame, self->replay->error ? ", the capture is malformed" : ""
+        );
+    }
+
+    return is_replaying;
+}
+
+static void game_server__connection_timer_disconnect__expire(timer_wheel_timer_t* timer, void* user_data) {
+    game_server_t self = (game_server_t) user_data;
+    const uint32_t slot = (uint32_t) ((connection_cold_t*) timer - self->connections_cold);
+    ASSERT(slot < self->connections_size);
+    connection_hot_t* connection_hot = &self->connections_hot[slot];
+
+    const double time_disconnect = connection_hot->time_last_seen + self->config.max_time_for_disconnect;
+    if (timer_wheel__time(&self->timer_wheel) < time_disconnect) {
+        // note: heard from them since it was scheduled
+        timer_wheel__schedule(&self->timer_wheel, timer, time_disconnect);
+    } else {
+        game_server__disconnect_connection(self, connection_hot->active_index);
+    }
+}
+
+static void game_server__receive_packet(game_server_t self, const uint8_t* data, uint32_t data_len, network_addr_t sender_addr, double time) {
+    packet_t packet_storage;
+    packet_t* packet = &packet_storage;
+    uint32_t packet_size = 0;
+    ack_window_t acks;
+    uint32_t acks_size = 0;
+    if (
+        !packet__read(packet, data, data_len, &packet_size) ||
+        !ack_window__read(&acks, data + packet_size, data_len - packet_size, &acks_size)
+    ) {
+        debug__write_and_flush(
+            DEBUG_MODULE_GAME_SERVER, DEBUG_NET,
+            "malformed packet received, size: %u",
+            data_len
+        );
+        return ;
+    }
+    packet_size += acks_size;
+    input_history_t input_history;
+    uint32_t input_history_size = 0;
+    if (!input_history__read_after(&input_history, packet, data + packet_size, data_len - packet_size, &input_history_size)) {
+        debug__write_and_flush(
+            DEBUG_MODULE_GAME_SERVER, DEBUG_NET,
+            "malformed input history received, size: %u",
+            data_len
+        );
+        return ;
+    }
+    packet_size += input_history_size;
+    // note: the whole datagram is checked before a connection is accepted for it
+    uint32_t channels_size = 0;
+    if (!channel_set__validate(data + packet_size, data_len - packet_size, &channels_size) || packet_size + channels_size != data_len) {
+        // note: not acknowledged, the messages in it are resent
+        debug__write_and_flush(
+            DEBUG_MODULE_GAME_SERVER, DEBUG_NET,
+            "malformed messages received, size: %u",
+            data_len
+        );
+        return ;
+    }
+
+    uint32_t slot = game_server__find_connection(self, &sender_addr);
+    const bool is_new = slot == CONNECTION_SLOT_NONE;
+    if (is_new) {
+        if (self->connections_fill == self->connections_size) {
+            return ;
+        }
+        slot = game_server__connection__accept(self, sender_addr, packet, time);
+        if (slot == CONNECTION_SLOT_NONE) {
+            return ;
+        }
+    }
+
+    connection_hot_t* connection = &self->connections_hot[slot];
+    // note: validated above, it can't fail
+    channel_set__read(connection->channels, data + packet_size, channels_size, &channels_size);
+    if (!is_new) {
+        game_server__accept_packet(self, slot, packet, &acks, &input_history, time);
+    }
+    game_server__receive_channel_messages(self, slot);
+}
+
+static void game_server__receive_channel_messages(game_server_t self, uint32_t slot) {
+    connection_hot_t* connection = &self->connections_hot[slot];
+    for (uint32_t type = 0; type < _CHANNEL_TYPE_SIZE; ++type) {
+        const void* data = 0;
+        uint32_t data_size = 0;
+        while (channel_set__pop(connection->channels, (channel_type_t) type, &data, &data_size)) {
+            debug__write_and_flush(
+                DEBUG_MODULE_GAME_SERVER, DEBUG_NET,
+                "RECV MESSAGE: channel %u, size %u, from: %u:%u",
+                type, data_size, connection->addr.addr, connection->addr.port
+            );
+            if (self->config.message_receive) {
+                self->config.message_receive(
+                    self->shard_index * self->connections_size + slot, data, data_size,
+                    type == CHANNEL_TYPE_RELIABLE_ORDERED, self->config.message_receive_data
+                );
             }
         }
     }
 }
 
 static void game_server__send_packets(game_server_t self) {
-    debug__lock();
-    for (uint32_t connection_index = 0; connection_index < self->connections_size; ++connection_index) {
-        connection_t* connection = &self->connections[connection_index];
-        if (connection->connected) {
-            packet_t packet = {
-                .sequence_id = self->sequence_id,
-                .ack = connection->sequence_id,
-                .ack_bitfield = connection->ack_bitfield
-            };
+    self->snapshot_history[self->sequence_id % SNAPSHOT_HISTORY_SIZE] = self->scene;
+    if (self->config.interest_radius > 0.0f) {
+        interest_grid__update(&self->interest_grid, self->scene.objects, self->scene.objects_fill);
+    }
+    for (uint32_t base_age = 0; base_age < SNAPSHOT_HISTORY_SIZE; ++base_age) {
+        if (self->snapshot_encodings[base_age]) {
+            packet_buffer__release(self->snapshot_encodings[base_age]);
+            self->snapshot_encodings[base_age] = 0;
+        }
+    }
 
-            // if (self->sequence_id % 7 != 0) {
-                tp_socket__send_data_to(&self->tp_socket, &packet, sizeof(packet), connection->addr);
-                
-                debug__write_raw("SENT PACKET: ");
-                debug__write_packet_raw(&packet);
-                debug__flush(DEBUG_MODULE_GAME_SERVER, DEBUG_NET);
+    const double time = game_server__time(self);
+    uint32_t connections_degraded = 0;
+    const bool is_net_traced = game_server__is_net_traced();
+    if (is_net_traced) {
+        debug__lock();
+    }
+    for (uint32_t active_index = 0; active_index < self->connections_fill; ++active_index) {
+        connection_hot_t* connection = &self->connections_hot[self->active_slots[active_index]];
+        connections_degraded += send_rate__is_degraded(&connection->send_rate);
+        if (!send_rate__tick(&connection->send_rate)) {
+            if (connection->packets_sent > 0) {
+                ++connection->packets_sent;
+            }
+            continue ;
+        }
+
+        packet_t packet = { 0 };
+        packet.sequence_id  = self->sequence_id;
+        packet.ack          = connection->sequence_id;
+        packet.sequence_id_skipped = send_rate__skipped(&connection->send_rate, self->sequence_id);
+        packet.player       = connection->player;
+        // note: the range of the field, slower servers are shown later than they could be
+        packet.tick_interval = self->previous_frame_info.time_frame_expected < 4.0f ? (float) self->previous_frame_info.time_frame_expected : 4.0f;
+        if (connection->snapshot_is_acked) {
+            // note: falls back to a full snapshot once the acked one is out of the history, for example after a burst of loss
+            const uint32_t base_age = sequence_id__delta(self->sequence_id, connection->snapshot_sequence_id_acked);
+            packet.snapshot_base_age = base_age < SNAPSHOT_HISTORY_SIZE ? base_age : 0;
+        }
+
+        // note: full snapshots are shared by everyone, budgeted or not
+        const bool is_per_client = connection->views && packet.snapshot_base_age > 0;
+        packet_buffer_t* snapshot = 0;
+        if (!is_per_client) {
+            snapshot = game_server__encode_snapshot(self, packet.snapshot_base_age);
+            if (!snapshot) {
+                continue ;
+            }
+        }
+
+        uint32_t packet_size = 0;
+        if (!packet__write(&packet, self->send_message, sizeof(self->send_message), &packet_size)) {
+            // note: every field is in range
+            ASSERT(false);
+            continue ;
+        }
+        uint32_t message_size = packet_size;
+        uint32_t acks_size = 0;
+        if (!ack_window__write(&connection->ack_window, self->send_message + message_size, ACK_WINDOW_ENCODING_SIZE_MAX, &acks_size)) {
+            ASSERT(false);
+            continue ;
+        }
+        message_size += acks_size;
+        uint32_t channels_size = 0;
+        channel_set__write(connection->channels, self->sequence_id, self->send_message + message_size, CHANNEL_SET_WRITE_SIZE_MAX, &channels_size);
+        message_size += channels_size;
+        if (is_per_client) {
+            uint32_t snapshot_size = 0;
+            uint32_t snapshot_budget = 0;
+            if (self->config.snapshot_budget) {
+                // note: at least a byte, as 0 is unlimited
+                snapshot_budget = self->config.snapshot_budget > message_size ? self->config.snapshot_budget - message_size : 1;
+            }
+            if (!game_server__write_client_snapshot(
+                self, connection, packet.snapshot_base_age, snapshot_budget,
+                self->send_message + message_size, sizeof(self->send_message) - message_size, &snapshot_size
+            )) {
+                // note: the views are kept in range of the format, as the scene
+                ASSERT(false);
+                continue ;
+            }
+            message_size += snapshot_size;
+            if (!frame_packer__push(&self->frame_packer, self->send_message, message_size, connection->addr)) {
+                game_server__flush_send_packets(self);
+                if (!frame_packer__push(&self->frame_packer, self->send_message, message_size, connection->addr)) {
+                    ASSERT(false);
+                    continue ;
+                }
+            }
+        } else {
+            if (!frame_packer__push_shared(&self->frame_packer, self->send_message, message_size, snapshot, connection->addr)) {
+                game_server__flush_send_packets(self);
+                if (!frame_packer__push_shared(&self->frame_packer, self->send_message, message_size, snapshot, connection->addr)) {
+                    // note: the mtu is checked on create to fit the largest message into the datagrams
+                    ASSERT(false);
+                    continue ;
+                }
+            }
+            if (connection->views) {
+                game_server__record_full_snapshot(self, connection);
+            }
+        }
+        ++connection->packets_sent;
+        send_rate__on_sent(&connection->send_rate, self->sequence_id, time);
 
-            // }
+        if (is_net_traced) {
+            debug__write_raw("SENT PACKET: ");
+            debug__write_packet_raw(&packet);
+            debug__flush(DEBUG_MODULE_GAME_SERVER, DEBUG_NET);
         }
     }
-    debug__unlock();
+    game_server__flush_send_packets(self);
+    if (is_net_traced) {
+        debug__unlock();
+    }
+    game_server__set_shards_gauge(self, self->metric_connections_degraded, self->shards ? self->shards->connections_degraded : 0, connections_degraded);
     ++self->sequence_id;
 }
 
-static void connection__check_for_lost_packets(connection_t* connection, uint32_t left_shift) {
-    if (connection->ack_bitfield != 0) {
-        uint32_t bit_index_end = 0;
-        if (left_shift > (sizeof(connection->ack_bitfield) << 3)) {
-            bit_index_end = sizeof(connection->ack_bitfield) << 3;
-            ++connection->packets_dropped;
-            debug__write_and_flush(DEBUG_MODULE_GAME_CLIENT, DEBUG_NET, "LOST PACKET: %u", connection->sequence_id);
-        } else {
-            bit_index_end = left_shift;
+static packet_buffer_t* game_server__encode_snapshot(game_server_t self, uint32_t base_age) {
+    ASSERT(base_age < SNAPSHOT_HISTORY_SIZE);
+    if (self->snapshot_encodings[base_age]) {
+        return self->snapshot_encodings[base_age];
+    }
+
+    packet_buffer_t* encoding = packet_pool__acquire(&self->snapshot_pool);
+    if (!encoding) {
+        // note: there is a buffer for every base age, the datagrams release theirs as they are flushed
+        ASSERT(false);
+        return 0;
+    }
+
+    const snapshot_t* snapshot = &self->snapshot_history[self->sequence_id % SNAPSHOT_HISTORY_SIZE];
+    bool encoded = false;
+    if (base_age == 0) {
+        encoded = snapshot__write(snapshot, encoding->data, encoding->data_size, &encoding->data_len);
+    } else {
+        const snapshot_t* snapshot_base = &self->snapshot_history[sequence_id__sub(self->sequence_id, base_age) % SNAPSHOT_HISTORY_SIZE];
+        encoded = snapshot__write_delta(snapshot, snapshot_base, encoding->data, encoding->data_size, &encoding->data_len);
+    }
+    if (!encoded) {
+        // note: the scene is kept in range of the format
+        ASSERT(false);
+        packet_buffer__release(encoding);
+        return 0;
+    }
+    self->snapshot_encodings[base_age] = encoding;
+
+    return encoding;
+}
+
+static bool game_server__write_client_snapshot(
+    game_server_t self, connection_hot_t* connection, uint32_t base_age, uint32_t budget,
+    uint8_t* buffer, uint32_t buffer_size, uint32_t* bytes_written
+) {
+    connection_views_t* views = connection->views;
+    ASSERT(views->is_sent && 0 < base_age && base_age < SNAPSHOT_HISTORY_SIZE);
+    const snapshot_t* base  = &views->views[sequence_id__sub(self->sequence_id, base_age) % SNAPSHOT_HISTORY_SIZE];
+    snapshot_t*       view  = &views->views[self->sequence_id % SNAPSHOT_HISTORY_SIZE];
+    const snapshot_t* scene = &self->scene;
+
+    // note: starts from the newest one sent, the objects that were sent since the base keep their state, even if it's not acked yet
+    if (views->sequence_id_sent != self->sequence_id) {
+        *view = views->views[views->sequence_id_sent % SNAPSHOT_HISTORY_SIZE];
+    }
+    // note: new objects are always sent whole
+    if (view->objects_fill < scene->objects_fill) {
+        memcpy(&view->objects[view->objects_fill], &scene->objects[view->objects_fill], (scene->objects_fill - view->objects_fill) * sizeof(*view->objects));
+    }
+    view->objects_fill = scene->objects_fill;
+
+    const bool is_filtered = self->config.interest_radius > 0.0f;
+    if (is_filtered) {
+        uint32_t left[SNAPSHOT_OBJECTS_SIZE];
+        uint32_t left_fill = 0;
+        interest_grid__query(&self->interest_grid, &views->interest_set, &connection->player.position, self->config.interest_radius, 0, 0, left, &left_fill);
+        // note: objects that left keep the state they were last sent with, until they are relevant again
+        for (uint32_t left_index = 0; left_index < left_fill; ++left_index) {
+            priority_accumulator__reset(&views->priority_accumulator, left[left_index]);
         }
+    }
 
-        for (uint32_t bit_index = 0; bit_index < bit_index_end; ++bit_index) {
-            const uint32_t bit_mask_index = ((sizeof(connection->ack_bitfield) << 3) - 1 - bit_index);
-            const uint32_t bit_mask = 1 << bit_mask_index;
-            if ((connection->ack_bitfield & bit_mask) == 0) {
-                ++connection->packets_dropped;
-                debug__write_and_flush(DEBUG_MODULE_GAME_CLIENT, DEBUG_NET, "LOST PACKET: %u", sequence_id__sub(connection->sequence_id, bit_mask_index + 1));
-            }
+    // note: in bits, what is sent without any object updated, the fill and a flag per object common with the base
+    const uint32_t common_fill = view->objects_fill < base->objects_fill ? view->objects_fill : base->objects_fill;
+    uint32_t cost = 10 + common_fill + (view->objects_fill - common_fill) * OBJECT_STATE_BITS_MAX;
+    uint32_t objects_outdated = 0;
+    for (uint32_t object_index = 0; object_index < view->objects_fill; ++object_index) {
+        if (object_index < common_fill && object_state__is_changed(&view->objects[object_index], &base->objects[object_index])) {
+            cost += OBJECT_STATE_DELTA_BITS_MAX;
+        }
+        if (is_filtered && !interest_set__is_relevant(&views->interest_set, object_index)) {
+            continue ;
+        }
+        if (object_state__is_changed(&scene->objects[object_index], &view->objects[object_index])) {
+            ++objects_outdated;
+            priority_accumulator__add(
+                &views->priority_accumulator, object_index,
+                priority_accumulator__object_priority(&scene->objects[object_index], &view->objects[object_index], &connection->player)
+            );
         }
     }
+
+    uint32_t selected_size = SNAPSHOT_OBJECTS_SIZE;
+    if (budget) {
+        const uint32_t budget_bits = budget << 3;
+        selected_size = budget_bits > cost ? (budget_bits - cost) / OBJECT_STATE_DELTA_BITS_MAX : 0;
+    }
+    uint32_t selected[SNAPSHOT_OBJECTS_SIZE];
+    const uint32_t selected_fill = priority_accumulator__pop(&views->priority_accumulator, selected, selected_size);
+    // note: objects keep the priority they accrued while they were outdated, so the ones selected aren't necessarily outdated now
+    uint32_t objects_updated = 0;
+    for (uint32_t selected_index = 0; selected_index < selected_fill; ++selected_index) {
+        const uint32_t object_index = selected[selected_index];
+        if (
+            (!is_filtered || interest_set__is_relevant(&views->interest_set, object_index)) &&
+            object_state__is_changed(&scene->objects[object_index], &view->objects[object_index])
+        ) {
+            ++objects_updated;
+        }
+        view->objects[object_index] = scene->objects[object_index];
+    }
+    metric__add(self->metric_objects_deferred, objects_outdated - objects_updated);
+
+    if (!snapshot__write_delta(view, base, buffer, buffer_size, bytes_written)) {
+        return false;
+    }
+    views->sequence_id_sent = self->sequence_id;
+
+    return true;
+}
+
+static void game_server__record_full_snapshot(game_server_t self, connection_hot_t* connection) {
+    connection_views_t* views = connection->views;
+    views->views[self->sequence_id % SNAPSHOT_HISTORY_SIZE] = self->scene;
+    views->sequence_id_sent = self->sequence_id;
+    views->is_sent          = true;
+    priority_accumulator__clear(&views->priority_accumulator);
+}
+
+static void game_server__flush_send_packets(game_server_t self) {
+    if (self->frame_packer.datagrams_fill == 0) {
+        return ;
+    }
+
+    // note: a replay has nowhere to send to, it only costs the encoding
+    const uint64_t packets_send_failed = self->tp_socket.messages_send_failed;
+    const uint32_t packets_sent = self->replay ? self->frame_packer.datagrams_fill : tp_socket__send_data_batch(&self->tp_socket, self->frame_packer.datagrams, self->frame_packer.datagrams_fill);
+    metric__add(self->metric_packets_sent, packets_sent);
+    metric__add(self->metric_packets_send_failed, self->tp_socket.messages_send_failed - packets_send_failed);
+    frame_packer__clear(&self->frame_packer);
+}
+
+static uint32_t connection__advance_ack_window(connection_hot_t* connection_hot, connection_cold_t* connection_cold, uint32_t delta) {
+    const uint32_t packets_lost = ack_window__advance(&connection_hot->ack_window, delta);
+    if (packets_lost > 0) {
+        connection_cold->packets_dropped += packets_lost;
+        debug__write_and_flush(
+            DEBUG_MODULE_GAME_SERVER, DEBUG_NET,
+            "LOST PACKETS: %u, newest received: %u",
+            packets_lost, connection_hot->sequence_id
+        );
+    }
+
+    return packets_lost;
 }
@@ -2,6 +2,7 @@
 
 #include "debug.h"
 #include "helper_macros.h"
+#include "memory.h"
 
 # include <stdlib.h>
 # include <string.h>
@@ -56,9 +57,9 @@ bool gfx__init() {
     }
 
     gfx.controllers_size = 16;
-    gfx.controllers = calloc(1, gfx.controllers_size * sizeof(*gfx.controllers));
+    gfx.controllers = memory__calloc(DEBUG_MODULE_GFX, 1, gfx.controllers_size * sizeof(*gfx.controllers));
     for (uint32_t controller_index = 0; controller_index < gfx.controllers_size; ++controller_index) {
-        gfx.controllers[controller_index] = calloc(1, sizeof(*gfx.controllers[controller_index]));
+        gfx.controllers[controller_index] = memory__calloc(DEBUG_MODULE_GFX, 1, sizeof(*gfx.controllers[controller_index]));
     }
 
     glfwSetMonitorCallback(&gfx__monitor_callback);
@@ -68,11 +69,11 @@ bool gfx__init() {
     GLFWmonitor** glfw_monitors = glfwGetMonitors((int32_t*) &number_of_monitors);
     gfx.monitors_size = number_of_monitors;
     gfx.monitors_top = number_of_monitors;
-    gfx.monitors = malloc(gfx.monitors_size * sizeof(*gfx.monitors));
+    gfx.monitors = memory__malloc(DEBUG_MODULE_GFX, gfx.monitors_size * sizeof(*gfx.monitors));
     debug__writeln("number of connected monitors: %u", number_of_monitors);
     // todo: turn this into column-based format
     for (uint32_t monitor_index = 0; monitor_index < number_of_monitors; ++monitor_index) {
-        gfx.monitors[monitor_index] = calloc(1, sizeof(*gfx.monitors[monitor_index]));
+        gfx.monitors[monitor_index] = memory__calloc(DEBUG_MODULE_GFX, 1, sizeof(*gfx.monitors[monitor_index]));
         monitor_t monitor = gfx.monitors[monitor_index];
         monitor->glfw_monitor = glfw_monitors[monitor_index];
         int32_t width_mm;
@@ -142,18 +143,18 @@ window_t window__create(monitor_t monitor, const char* title, uint32_t width, ui
         uint32_t windows_prev_size = gfx.windows_size;
         if (gfx.windows_size == 0) {
             gfx.windows_size = 4;
-            gfx.windows = calloc(1, gfx.windows_size * sizeof(*gfx.windows));
+            gfx.windows = memory__calloc(DEBUG_MODULE_GFX, 1, gfx.windows_size * sizeof(*gfx.windows));
         } else {
             gfx.windows_size <<= 1;
-            gfx.windows = realloc(gfx.windows, gfx.windows_size * sizeof(*gfx.windows));
+            gfx.windows = memory__realloc(DEBUG_MODULE_GFX, gfx.windows, gfx.windows_size * sizeof(*gfx.windows));
         }
         for (uint32_t window_index = windows_prev_size; window_index < gfx.windows_size; ++window_index) {
-            gfx.windows[window_index] = calloc(1, sizeof(*gfx.windows[window_index]));
+            gfx.windows[window_index] = memory__calloc(DEBUG_MODULE_GFX, 1, sizeof(*gfx.windows[window_index]));
         }
     }
     window_t result = gfx.windows[gfx.windows_top++];
     if (!result->controller) {
-        result->controller = calloc(1, sizeof(*result->controller));
+        result->controller = memory__calloc(DEBUG_MODULE_GFX, 1, sizeof(*result->controller));
     }
 
     result->title                   = title;
@@ -542,7 +543,7 @@ cursor_t cursor__create(uint8_t* pixels, uint32_t w, uint32_t h) {
         return 0;
     }
 
-    cursor_t result = calloc(1, sizeof(*result));
+    cursor_t result = memory__calloc(DEBUG_MODULE_GFX, 1, sizeof(*result));
 
     result->glfw_cursor = glfw_cursor;
 
@@ -552,7 +553,7 @@ cursor_t cursor__create(uint8_t* pixels, uint32_t w, uint32_t h) {
 void cursor__destroy(cursor_t cursor) {
     glfwDestroyCursor(cursor->glfw_cursor);
 
-    free(cursor);
+    memory__free(DEBUG_MODULE_GFX, cursor);
 }
 
 void window__set_cursor(window_t self, cursor_t cursor) {
@@ -379,13 +379,13 @@ static void gfx__monitor_callback(GLFWmonitor* glfw_monitor, int event) {
             uint32_t monitors_prev_size = gfx.monitors_size;
             if (gfx.monitors_size == 0) {
                 gfx.monitors_size = 4;
-                gfx.monitors = malloc(gfx.monitors_size * sizeof(*gfx.monitors));
+                gfx.monitors = memory__malloc(DEBUG_MODULE_GFX, gfx.monitors_size * sizeof(*gfx.monitors));
             } else {
                 gfx.monitors_size <<= 1;
-                gfx.monitors = realloc(gfx.monitors, gfx.monitors_size * sizeof(*gfx.monitors));
+                gfx.monitors = memory__realloc(DEBUG_MODULE_GFX, gfx.monitors, gfx.monitors_size * sizeof(*gfx.monitors));
             }
             for (uint32_t monitor_index = monitors_prev_size; monitor_index < gfx.monitors_size; ++monitor_index) {
-                gfx.monitors[monitor_index] = malloc(sizeof(*gfx.monitors[monitor_index]));
+                gfx.monitors[monitor_index] = memory__malloc(DEBUG_MODULE_GFX, sizeof(*gfx.monitors[monitor_index]));
             }
         }
         ASSERT(gfx.monitors_top < gfx.monitors_size);
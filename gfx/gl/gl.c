@@ -419,7 +419,7 @@ void shader_program_pipeline__bind(shader_program_pipeline_t* self) {
 
 bool shader_program_binary__create(shader_program_binary_t* self, shader_program_t* linked_shader_program) {
     glGetProgramiv(linked_shader_program->id, GL_PROGRAM_BINARY_LENGTH, (GLint*) &self->binary_size);
-    self->binary = malloc(self->binary_size);
+    self->binary = memory__malloc(DEBUG_MODULE_GL, self->binary_size);
     if (!self->binary) {
         return false;
     }
@@ -429,7 +429,7 @@ bool shader_program_binary__create(shader_program_binary_t* self, shader_program
 }
 
 void shader_program_binary__destroy(shader_program_binary_t* self) {
-    free(self->binary);
+    memory__free(DEBUG_MODULE_GL, self->binary);
 }
 
 vertex_stream_specification_t vertex_stream_specification(
@@ -662,11 +662,11 @@ bool geometry_object__create_from_file(geometry_object_t* self, const char* file
         return false;
     }
 
-    char* buffer = malloc(file_size);
+    char* buffer = memory__malloc(DEBUG_MODULE_GL, file_size);
     size_t bytes_read = 0;
     if (!file__read(&file, buffer, file_size, &bytes_read)) {
         file__close(&file);
-        free(buffer);
+        memory__free(DEBUG_MODULE_GL, buffer);
         return false;
     }
 
@@ -674,7 +674,7 @@ bool geometry_object__create_from_file(geometry_object_t* self, const char* file
     bool result = geometry_object__load_from_g_modelformat(self, buffer, file_size);
 
     file__close(&file);
-    free(buffer);
+    memory__free(DEBUG_MODULE_GL, buffer);
 
     return result;
 }
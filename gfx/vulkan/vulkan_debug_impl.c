@@ -24,7 +24,7 @@ static bool vk__setup_debug_messenger_create_info(VkDebugUtilsMessengerCreateInf
 static bool vk__check_if_validation_layer_is_available(const char* validation_layer_name) {
     uint32_t vk_layer_properties_count = 0;
     vkEnumerateInstanceLayerProperties(&vk_layer_properties_count, 0);
-    VkLayerProperties* vk_layer_properties = malloc(vk_layer_properties_count * sizeof(*vk_layer_properties));
+    VkLayerProperties* vk_layer_properties = memory__malloc(DEBUG_MODULE_VULKAN, vk_layer_properties_count * sizeof(*vk_layer_properties));
     vkEnumerateInstanceLayerProperties(&vk_layer_properties_count, vk_layer_properties);
     bool layer_found = false;
     debug__lock();
@@ -37,7 +37,7 @@ static bool vk__check_if_validation_layer_is_available(const char* validation_la
             break ;
         }
     }
-    free(vk_layer_properties);
+    memory__free(DEBUG_MODULE_VULKAN, vk_layer_properties);
     debug__flush(DEBUG_MODULE_VULKAN, DEBUG_WARN);
 
     debug__unlock();
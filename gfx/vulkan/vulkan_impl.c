@@ -221,19 +221,19 @@ void vk__deinit() {
     vkDestroyInstance(vk.instance, 0);
 
     if (vk.required_extensions) {
-        free(vk.required_extensions);
+        memory__free(DEBUG_MODULE_VULKAN, vk.required_extensions);
     }
 
     if (vk.sc.images) {
-        free(vk.sc.images);
+        memory__free(DEBUG_MODULE_VULKAN, vk.sc.images);
     }
 
     if (vk.image_views) {
-        free(vk.image_views);
+        memory__free(DEBUG_MODULE_VULKAN, vk.image_views);
     }
 
     if (vk.framebuffers) {
-        free(vk.framebuffers);
+        memory__free(DEBUG_MODULE_VULKAN, vk.framebuffers);
     }
 }
 
@@ -372,7 +372,7 @@ static bool vk__get_required_extensions() {
     // check which Vulkan extensions are not supported by GLFW
     uint32_t supported_vk_extension_count = 0;
     vkEnumerateInstanceExtensionProperties(0, &supported_vk_extension_count, 0);
-    VkExtensionProperties* supported_vk_extensions = malloc(supported_vk_extension_count * sizeof(*supported_vk_extensions));
+    VkExtensionProperties* supported_vk_extensions = memory__malloc(DEBUG_MODULE_VULKAN, supported_vk_extension_count * sizeof(*supported_vk_extensions));
     vkEnumerateInstanceExtensionProperties(0, &supported_vk_extension_count, supported_vk_extensions);
 
     debug__lock();
@@ -399,7 +399,7 @@ static bool vk__get_required_extensions() {
 
     debug__unlock();
     
-    free(supported_vk_extensions);
+    memory__free(DEBUG_MODULE_VULKAN, supported_vk_extensions);
 #endif
 
     return true;
@@ -420,7 +420,7 @@ static bool vk__pick_physical_device() {
 
     uint32_t physical_device_count = 0;
     vkEnumeratePhysicalDevices(vk.instance, &physical_device_count, 0);
-    VkPhysicalDevice* physical_devices = malloc(physical_device_count * sizeof(*physical_devices));
+    VkPhysicalDevice* physical_devices = memory__malloc(DEBUG_MODULE_VULKAN, physical_device_count * sizeof(*physical_devices));
     vkEnumeratePhysicalDevices(vk.instance, &physical_device_count, physical_devices);
     for (uint32_t physical_device_index = 0; physical_device_index < physical_device_count; ++physical_device_index) {
         if (vk__is_physical_device_suitable(physical_devices[physical_device_index])) {
@@ -428,7 +428,7 @@ static bool vk__pick_physical_device() {
             break ;
         }
     }
-    free(physical_devices);
+    memory__free(DEBUG_MODULE_VULKAN, physical_devices);
 
     if (vk.physical_device == VK_NULL_HANDLE) {
         debug__write_and_flush(DEBUG_MODULE_VULKAN, DEBUG_ERROR, "failed to find a suitable GPU");
@@ -486,7 +486,7 @@ static queue_families_t vk__find_queue_families(VkPhysicalDevice device) {
 
     uint32_t queue_family_properties_count = 0;
     vkGetPhysicalDeviceQueueFamilyProperties(device, &queue_family_properties_count, 0);
-    VkQueueFamilyProperties* queue_family_properties = malloc(queue_family_properties_count * sizeof(*queue_family_properties));
+    VkQueueFamilyProperties* queue_family_properties = memory__malloc(DEBUG_MODULE_VULKAN, queue_family_properties_count * sizeof(*queue_family_properties));
     vkGetPhysicalDeviceQueueFamilyProperties(device, &queue_family_properties_count, queue_family_properties);
 
     for (uint32_t queue_family_properties_index = 0; queue_family_properties_index < queue_family_properties_count; ++queue_family_properties_index) {
@@ -511,7 +511,7 @@ static queue_families_t vk__find_queue_families(VkPhysicalDevice device) {
 
     }
 
-    free(queue_family_properties);
+    memory__free(DEBUG_MODULE_VULKAN, queue_family_properties);
 
     return result;
 }
@@ -519,7 +519,7 @@ static queue_families_t vk__find_queue_families(VkPhysicalDevice device) {
 static bool vk__check_device_required_extensions(VkPhysicalDevice device) {
     uint32_t device_extensions_count = 0;
     vkEnumerateDeviceExtensionProperties(device, 0, &device_extensions_count, 0);
-    VkExtensionProperties* device_extension_properties = malloc(device_extensions_count * sizeof(*device_extension_properties));
+    VkExtensionProperties* device_extension_properties = memory__malloc(DEBUG_MODULE_VULKAN, device_extensions_count * sizeof(*device_extension_properties));
     vkEnumerateDeviceExtensionProperties(device, 0, &device_extensions_count, device_extension_properties);
     bool found_all = true;
     for (uint32_t required_device_extension_index = 0; required_device_extension_index < ARRAY_SIZE(vk_required_logical_device_extensions); ++required_device_extension_index) {
@@ -535,7 +535,7 @@ static bool vk__check_device_required_extensions(VkPhysicalDevice device) {
             break ;
         }
     }
-    free(device_extension_properties);
+    memory__free(DEBUG_MODULE_VULKAN, device_extension_properties);
 
     return found_all;
 }
@@ -618,11 +618,11 @@ static swapchain_support_details_t swapchain_support_details__create(VkPhysicalD
     vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physical_device, vk.surface, &result.capabilities);
 
     vkGetPhysicalDeviceSurfaceFormatsKHR(physical_device, vk.surface, &result.formats_size, 0);
-    result.formats = malloc(result.formats_size * sizeof(*result.formats));
+    result.formats = memory__malloc(DEBUG_MODULE_VULKAN, result.formats_size * sizeof(*result.formats));
     vkGetPhysicalDeviceSurfaceFormatsKHR(physical_device, vk.surface, &result.formats_size, result.formats);
 
     vkGetPhysicalDeviceSurfacePresentModesKHR(physical_device, vk.surface, &result.present_modes_size, 0);
-    result.present_modes = malloc(result.present_modes_size * sizeof(*result.present_modes));
+    result.present_modes = memory__malloc(DEBUG_MODULE_VULKAN, result.present_modes_size * sizeof(*result.present_modes));
     vkGetPhysicalDeviceSurfacePresentModesKHR(physical_device, vk.surface, &result.present_modes_size, result.present_modes);
 
     return result;
@@ -630,10 +630,10 @@ static swapchain_support_details_t swapchain_support_details__create(VkPhysicalD
 
 static void swapchain_support_details__destroy(swapchain_support_details_t* self) {
     if (self->formats) {
-        free(self->formats);
+        memory__free(DEBUG_MODULE_VULKAN, self->formats);
     }
     if (self->present_modes) {
-        free(self->present_modes);
+        memory__free(DEBUG_MODULE_VULKAN, self->present_modes);
     }
 }
 
@@ -753,7 +753,7 @@ static bool vk__create_swapchain(GLFWwindow* glfw_window) {
 
         // note: retrieve sc image handles
         vkGetSwapchainImagesKHR(vk.logical_device, vk.sc._, &vk.sc.images_size, 0);
-        vk.sc.images = malloc(vk.sc.images_size * sizeof(*vk.sc.images));
+        vk.sc.images = memory__malloc(DEBUG_MODULE_VULKAN, vk.sc.images_size * sizeof(*vk.sc.images));
         vkGetSwapchainImagesKHR(vk.logical_device, vk.sc._, &vk.sc.images_size, vk.sc.images);
         vk.sc.format = sc_surface_format.format;
         vk.sc.extent = sc_extent;
@@ -766,7 +766,7 @@ static bool vk__create_swapchain(GLFWwindow* glfw_window) {
 
 static bool vk__create_image_views() {
     vk.image_views_size = vk.sc.images_size;
-    vk.image_views = malloc(vk.image_views_size * sizeof(*vk.image_views));
+    vk.image_views = memory__malloc(DEBUG_MODULE_VULKAN, vk.image_views_size * sizeof(*vk.image_views));
 
     for (uint32_t swap_chain_image_index = 0; swap_chain_image_index < vk.sc.images_size; ++swap_chain_image_index) {
         VkImage sc_image = vk.sc.images[swap_chain_image_index];
@@ -1159,7 +1159,7 @@ static bool shader_code__create_from_file(shader_code_t* self, const char* shade
         return false;
     }
 
-    self->code = malloc(self->code_size);
+    self->code = memory__malloc(DEBUG_MODULE_VULKAN, self->code_size);
     if (!self->code) {
         fclose(fp);
         return false;
@@ -1179,7 +1179,7 @@ static bool shader_code__create_from_file(shader_code_t* self, const char* shade
 
 static void shader_code__destroy(shader_code_t* self) {
     if (self->code) {
-        free(self->code);
+        memory__free(DEBUG_MODULE_VULKAN, self->code);
     }
 }
 
@@ -1220,7 +1220,7 @@ static void shader_module__destroy(shader_module_t* self) {
 
 static bool vk__create_framebuffers() {
     vk.framebuffers_size = vk.image_views_size;
-    vk.framebuffers = malloc(vk.framebuffers_size * sizeof(*vk.framebuffers));
+    vk.framebuffers = memory__malloc(DEBUG_MODULE_VULKAN, vk.framebuffers_size * sizeof(*vk.framebuffers));
     uint32_t created_framebuffers = 0;
     for (uint32_t framebuffer_index = 0; framebuffer_index < vk.framebuffers_size; ++framebuffer_index, ++created_framebuffers) {
         VkImageView attachments[] = {
@@ -0,0 +1,164 @@
+#include "ack_window.h"
+
+#include <assert.h>
+#include <string.h>
+
+//! @returns Mask of the bits of 'word_index' that are in [bit_from, bit_to)
+static uint64_t ack_window__range_mask(uint32_t word_index, uint32_t bit_from, uint32_t bit_to);
+static void ack_window__set_range(ack_window_t* self, uint32_t bit_from, uint32_t bit_to);
+static uint32_t ack_window__count_range(const ack_window_t* self, uint32_t bit_from, uint32_t bit_to);
+//! @returns First bit at or after 'bit_from' that isn't 'value', 'size' if there is none
+static uint32_t ack_window__find_other(const ack_window_t* self, uint32_t bit_from, bool value);
+static void ack_window__shift(ack_window_t* self, uint32_t shift);
+
+static uint64_t ack_window__range_mask(uint32_t word_index, uint32_t bit_from, uint32_t bit_to) {
+    const uint32_t word_from = word_index << 6;
+    const uint32_t word_to   = word_from + 64;
+    if (bit_to <= word_from || word_to <= bit_from) {
+        return 0;
+    }
+
+    const uint64_t mask_from = bit_from <= word_from ? ~(uint64_t) 0 : ~(uint64_t) 0 << (bit_from - word_from);
+    const uint64_t mask_to   = word_to <= bit_to ? ~(uint64_t) 0 : ~(uint64_t) 0 >> (word_to - bit_to);
+
+    return mask_from & mask_to;
+}
+
+static void ack_window__set_range(ack_window_t* self, uint32_t bit_from, uint32_t bit_to) {
+    for (uint32_t word_index = 0; word_index < ACK_WINDOW_WORDS; ++word_index) {
+        self->words[word_index] |= ack_window__range_mask(word_index, bit_from, bit_to);
+    }
+}
+
+static uint32_t ack_window__count_range(const ack_window_t* self, uint32_t bit_from, uint32_t bit_to) {
+    uint32_t result = 0;
+    for (uint32_t word_index = 0; word_index < ACK_WINDOW_WORDS; ++word_index) {
+        result += __builtin_popcountll(self->words[word_index] & ack_window__range_mask(word_index, bit_from, bit_to));
+    }
+
+    return result;
+}
+
+static uint32_t ack_window__find_other(const ack_window_t* self, uint32_t bit_from, bool value) {
+    for (uint32_t word_index = bit_from >> 6; word_index < ACK_WINDOW_WORDS; ++word_index) {
+        const uint64_t word = value ? ~self->words[word_index] : self->words[word_index];
+        const uint64_t others = word & ack_window__range_mask(word_index, bit_from, self->size);
+        if (others) {
+            return (word_index << 6) + __builtin_ctzll(others);
+        }
+    }
+
+    return self->size;
+}
+
+static void ack_window__shift(ack_window_t* self, uint32_t shift) {
+    if (shift >= ACK_WINDOW_SIZE_MAX) {
+        memset(self->words, 0, sizeof(self->words));
+        return ;
+    }
+
+    const uint32_t word_shift = shift >> 6;
+    const uint32_t bit_shift  = shift & 63;
+    for (uint32_t word_index = ACK_WINDOW_WORDS; word_index-- > 0;) {
+        uint64_t word = 0;
+        if (word_index >= word_shift) {
+            word = self->words[word_index - word_shift] << bit_shift;
+            if (bit_shift && word_index > word_shift) {
+                word |= self->words[word_index - word_shift - 1] >> (64 - bit_shift);
+            }
+        }
+        self->words[word_index] = word & ack_window__range_mask(word_index, 0, self->size);
+    }
+}
+
+void ack_window__create(ack_window_t* self, uint32_t size) {
+    assert(size > 0 && size <= ACK_WINDOW_SIZE_MAX);
+    memset(self, 0, sizeof(*self));
+    self->size = size;
+    ack_window__set_range(self, 0, size);
+}
+
+uint32_t ack_window__advance(ack_window_t* self, uint32_t delta) {
+    assert(delta > 0);
+    const uint32_t bits_leaving = delta < self->size ? delta : self->size;
+    uint32_t result = bits_leaving - ack_window__count_range(self, self->size - bits_leaving, self->size);
+    if (delta > self->size) {
+        // note: the ones between the window and the previous newest one never made it into the window
+        result += delta - 1 - self->size;
+    }
+
+    ack_window__shift(self, delta);
+    ack_window__set(self, delta);
+
+    return result;
+}
+
+void ack_window__set(ack_window_t* self, uint32_t delta) {
+    if (delta == 0 || delta > self->size) {
+        return ;
+    }
+
+    self->words[(delta - 1) >> 6] |= (uint64_t) 1 << ((delta - 1) & 63);
+}
+
+bool ack_window__is_set(const ack_window_t* self, uint32_t delta) {
+    if (delta == 0 || delta > self->size) {
+        return false;
+    }
+
+    return (self->words[(delta - 1) >> 6] >> ((delta - 1) & 63)) & 1;
+}
+
+bool ack_window__write(const ack_window_t* self, uint8_t* buffer, uint32_t buffer_size, uint32_t* bytes_written) {
+    if (buffer_size < 1) {
+        return false;
+    }
+
+    uint8_t* cur = buffer;
+    const uint8_t* end = buffer + buffer_size;
+    *cur++ = (uint8_t) (self->size - 1);
+    uint32_t bit = 0;
+    while (bit < self->size) {
+        const bool value = (self->words[bit >> 6] >> (bit & 63)) & 1;
+        const uint32_t run_end = ack_window__find_other(self, bit, value);
+        while (bit < run_end) {
+            if (cur == end) {
+                return false;
+            }
+            const uint32_t run_size = run_end - bit < ACK_WINDOW_RUN_SIZE_MAX ? run_end - bit : ACK_WINDOW_RUN_SIZE_MAX;
+            *cur++ = (uint8_t) ((value << 7) | (run_size - 1));
+            bit += run_size;
+        }
+    }
+    *bytes_written = (uint32_t) (cur - buffer);
+
+    return true;
+}
+
+bool ack_window__read(ack_window_t* self, const uint8_t* buffer, uint32_t buffer_size, uint32_t* bytes_read) {
+    if (buffer_size < 1) {
+        return false;
+    }
+
+    memset(self, 0, sizeof(*self));
+    self->size = (uint32_t) buffer[0] + 1;
+    uint32_t offset = 1;
+    uint32_t bit = 0;
+    while (bit < self->size) {
+        if (offset == buffer_size) {
+            return false;
+        }
+        const uint8_t run = buffer[offset++];
+        const uint32_t run_size = (uint32_t) (run & 0x7f) + 1;
+        if (run_size > self->size - bit) {
+            return false;
+        }
+        if (run >> 7) {
+            ack_window__set_range(self, bit, bit + run_size);
+        }
+        bit += run_size;
+    }
+    *bytes_read = offset;
+
+    return true;
+}
@@ -0,0 +1,49 @@
+#ifndef ACK_WINDOW_H
+# define ACK_WINDOW_H
+
+# include <stdint.h>
+# include <stdbool.h>
+
+struct         ack_window;
+typedef struct ack_window ack_window_t;
+
+/**
+ * Which of the sequence ids before the newest one received were received too
+ * Bit i stands for the sequence id i + 1 older than the newest one, so a new packet shifts the bits towards the older end
+ *
+ * Written after the packet header, run-length encoded:
+ *   uint8_t size - 1, then runs until 'size' bits are covered
+ *   each run is a uint8_t, bit 7: value of the bits, bits 0-6: length of the run - 1
+ * Without loss it's 1 byte for the size and 1 byte for every 128 bits
+*/
+# define ACK_WINDOW_SIZE_MAX          256
+# define ACK_WINDOW_SIZE_DEFAULT      ACK_WINDOW_SIZE_MAX
+# define ACK_WINDOW_WORDS             (ACK_WINDOW_SIZE_MAX / 64)
+# define ACK_WINDOW_RUN_SIZE_MAX      128
+//! @note Alternating bits, a run for each
+# define ACK_WINDOW_ENCODING_SIZE_MAX (1 + ACK_WINDOW_SIZE_MAX)
+
+struct ack_window {
+    uint64_t words[ACK_WINDOW_WORDS];
+    //! @note Number of bits in use, in [1, ACK_WINDOW_SIZE_MAX], the ones past it are always clear
+    uint32_t size;
+};
+
+//! @brief Every sequence id of the window is marked as received, so a new connection doesn't count the ones before it as lost
+void ack_window__create(ack_window_t* self, uint32_t size);
+
+/**
+ * @brief A sequence id 'delta' newer than the newest one was received, the newest one so far becomes bit delta - 1
+ * @returns Number of sequence ids that left the window without being received
+*/
+uint32_t ack_window__advance(ack_window_t* self, uint32_t delta);
+//! @brief The sequence id 'delta' older than the newest one was received, ignored if it's past the window
+void ack_window__set(ack_window_t* self, uint32_t delta);
+//! @returns true if the sequence id 'delta' older than the newest one was received, false if it's past the window
+bool ack_window__is_set(const ack_window_t* self, uint32_t delta);
+
+bool ack_window__write(const ack_window_t* self, uint8_t* buffer, uint32_t buffer_size, uint32_t* bytes_written);
+//! @returns false if the encoding is malformed, 'self' is unspecified then
+bool ack_window__read(ack_window_t* self, const uint8_t* buffer, uint32_t buffer_size, uint32_t* bytes_read);
+
+#endif // ACK_WINDOW_H
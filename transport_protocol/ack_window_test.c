@@ -0,0 +1,96 @@
+#include "ack_window.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main() {
+    uint32_t errors = 0;
+
+    srand(1);
+    for (uint32_t window_index = 0; window_index < 4000; ++window_index) {
+        // the expected state, indexed by delta - 1
+        bool is_received[ACK_WINDOW_SIZE_MAX];
+        const uint32_t size = 1 + (uint32_t) rand() % ACK_WINDOW_SIZE_MAX;
+        ack_window_t ack_window;
+        ack_window__create(&ack_window, size);
+        for (uint32_t bit = 0; bit < ACK_WINDOW_SIZE_MAX; ++bit) {
+            is_received[bit] = bit < size;
+        }
+
+        for (uint32_t step = 0; step < 200; ++step) {
+            if (rand() % 2) {
+                const uint32_t delta = 1 + (uint32_t) (rand() % 8 == 0 ? rand() % (2 * ACK_WINDOW_SIZE_MAX) : rand() % 4);
+                const uint32_t lost = ack_window__advance(&ack_window, delta);
+
+                bool is_received_shifted[ACK_WINDOW_SIZE_MAX] = { 0 };
+                uint32_t lost_expected = 0;
+                for (uint32_t bit = 0; bit < size; ++bit) {
+                    if (bit + delta < size) {
+                        is_received_shifted[bit + delta] = is_received[bit];
+                    } else if (!is_received[bit]) {
+                        ++lost_expected;
+                    }
+                }
+                // the previous newest one lands at delta - 1, the ones skipped before it were never received
+                if (delta - 1 < size) {
+                    is_received_shifted[delta - 1] = true;
+                } else {
+                    lost_expected += delta - 1 - size;
+                }
+                memcpy(is_received, is_received_shifted, sizeof(is_received));
+                if (lost != lost_expected) {
+                    printf("size %u, advance %u: lost %u, expected %u\n", size, delta, lost, lost_expected);
+                    ++errors;
+                }
+            } else {
+                const uint32_t delta = 1 + (uint32_t) rand() % (ACK_WINDOW_SIZE_MAX + 40);
+                ack_window__set(&ack_window, delta);
+                if (delta <= size) {
+                    is_received[delta - 1] = true;
+                }
+            }
+
+            for (uint32_t delta = 1; delta <= ACK_WINDOW_SIZE_MAX + 8; ++delta) {
+                if (ack_window__is_set(&ack_window, delta) != (delta <= size && is_received[delta - 1])) {
+                    printf("size %u, step %u: wrong bit at delta %u\n", size, step, delta);
+                    ++errors;
+                }
+            }
+
+            uint8_t buffer[ACK_WINDOW_ENCODING_SIZE_MAX];
+            uint32_t bytes_written = 0;
+            uint32_t bytes_read    = 0;
+            ack_window_t ack_window_read;
+            if (
+                !ack_window__write(&ack_window, buffer, sizeof(buffer), &bytes_written) ||
+                !ack_window__read(&ack_window_read, buffer, bytes_written, &bytes_read) ||
+                bytes_read != bytes_written ||
+                memcmp(&ack_window_read, &ack_window, sizeof(ack_window)) != 0
+            ) {
+                printf("size %u, step %u: differs after a write and a read of %u bytes\n", size, step, bytes_written);
+                ++errors;
+            }
+        }
+    }
+
+    // garbage must either be rejected or decode within the buffer
+    for (uint32_t read_index = 0; read_index < 1000000; ++read_index) {
+        uint8_t buffer[40];
+        const uint32_t buffer_size = (uint32_t) rand() % sizeof(buffer);
+        for (uint32_t byte_index = 0; byte_index < buffer_size; ++byte_index) {
+            buffer[byte_index] = (uint8_t) rand();
+        }
+        ack_window_t ack_window;
+        uint32_t bytes_read = 0;
+        if (ack_window__read(&ack_window, buffer, buffer_size, &bytes_read) && (bytes_read > buffer_size || ack_window.size == 0)) {
+            printf("read %u bytes out of %u, size %u\n", bytes_read, buffer_size, ack_window.size);
+            ++errors;
+        }
+    }
+
+    printf("errors: %u\n", errors);
+
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,234 @@
+#include "channel.h"
+
+#include "packet.h"
+
+#include <assert.h>
+#include <string.h>
+
+static void channel__advance_send(channel_t* self);
+static void channel__advance_receive(channel_t* self);
+static void channel_set__resolve_sent_packet(channel_set_t* self, channel_sent_packet_t* sent_packet, bool is_acked);
+
+static void channel__advance_send(channel_t* self) {
+    while (
+        self->send_message_id_oldest != self->send_message_id &&
+        !self->send_messages[self->send_message_id_oldest % CHANNEL_WINDOW_SIZE].is_used
+    ) {
+        ++self->send_message_id_oldest;
+    }
+}
+
+static void channel__advance_receive(channel_t* self) {
+    while (true) {
+        channel_message_t* message = &self->receive_messages[self->receive_message_id % CHANNEL_WINDOW_SIZE];
+        if (!message->is_used || message->is_pending) {
+            break ;
+        }
+        message->is_used = false;
+        ++self->receive_message_id;
+    }
+}
+
+static void channel_set__resolve_sent_packet(channel_set_t* self, channel_sent_packet_t* sent_packet, bool is_acked) {
+    for (uint32_t message_index = 0; message_index < sent_packet->messages_fill; ++message_index) {
+        channel_t* channel = &self->channels[sent_packet->channel_types[message_index]];
+        const uint16_t message_id = sent_packet->message_ids[message_index];
+        channel_message_t* message = &channel->send_messages[message_id % CHANNEL_WINDOW_SIZE];
+        if (!message->is_used || message->message_id != message_id) {
+            // note: acknowledged with another packet that carried it
+            continue ;
+        }
+
+        if (is_acked) {
+            message->is_used = false;
+        } else if (!message->is_pending) {
+            message->is_pending = true;
+            ++self->messages_resent;
+        }
+    }
+    sent_packet->is_used = false;
+
+    if (is_acked) {
+        for (uint32_t type = 0; type < _CHANNEL_TYPE_SIZE; ++type) {
+            channel__advance_send(&self->channels[type]);
+        }
+    }
+}
+
+void channel_set__create(channel_set_t* self) {
+    memset(self, 0, sizeof(*self));
+    for (uint32_t type = 0; type < _CHANNEL_TYPE_SIZE; ++type) {
+        self->channels[type].type = (channel_type_t) type;
+    }
+}
+
+bool channel_set__push(channel_set_t* self, channel_type_t type, const void* data, uint32_t data_size) {
+    assert(type < _CHANNEL_TYPE_SIZE);
+    channel_t* channel = &self->channels[type];
+    if (
+        data_size > CHANNEL_MESSAGE_SIZE_MAX ||
+        (uint16_t) (channel->send_message_id - channel->send_message_id_oldest) >= CHANNEL_WINDOW_SIZE
+    ) {
+        return false;
+    }
+
+    channel_message_t* message = &channel->send_messages[channel->send_message_id % CHANNEL_WINDOW_SIZE];
+    memcpy(message->data, data, data_size);
+    message->size       = (uint8_t) data_size;
+    message->message_id = channel->send_message_id;
+    message->is_used    = true;
+    message->is_pending = true;
+    ++channel->send_message_id;
+
+    return true;
+}
+
+bool channel_set__pop(channel_set_t* self, channel_type_t type, const void** data, uint32_t* data_size) {
+    assert(type < _CHANNEL_TYPE_SIZE);
+    channel_t* channel = &self->channels[type];
+    for (uint32_t message_offset = 0; message_offset < CHANNEL_WINDOW_SIZE; ++message_offset) {
+        const uint16_t message_id = channel->receive_message_id + message_offset;
+        channel_message_t* message = &channel->receive_messages[message_id % CHANNEL_WINDOW_SIZE];
+        if (!message->is_used) {
+            if (channel->type == CHANNEL_TYPE_RELIABLE_ORDERED) {
+                // note: the ones after a gap wait for it to be filled
+                return false;
+            }
+            continue ;
+        }
+        if (!message->is_pending) {
+            continue ;
+        }
+
+        message->is_pending = false;
+        *data      = message->data;
+        *data_size = message->size;
+        // note: the slot is only reused by a message read later, so 'data' stays intact till then
+        channel__advance_receive(channel);
+
+        return true;
+    }
+
+    return false;
+}
+
+bool channel_set__write(channel_set_t* self, uint16_t sequence_id, uint8_t* buffer, uint32_t buffer_size, uint32_t* bytes_written) {
+    if (buffer_size < 1) {
+        return false;
+    }
+
+    channel_sent_packet_t* sent_packet = &self->sent_packets[sequence_id % CHANNEL_SENT_PACKETS_SIZE];
+    if (sent_packet->is_used) {
+        // note: unresolved for a whole round of the sent packets, it's as good as lost
+        channel_set__resolve_sent_packet(self, sent_packet, false);
+    }
+    sent_packet->sequence_id   = sequence_id;
+    sent_packet->messages_fill = 0;
+
+    uint8_t* cur = buffer + 1;
+    const uint8_t* end = buffer + buffer_size;
+    for (uint32_t type = 0; self->is_acked && type < _CHANNEL_TYPE_SIZE; ++type) {
+        channel_t* channel = &self->channels[type];
+        for (
+            uint16_t message_id = channel->send_message_id_oldest;
+            message_id != channel->send_message_id && sent_packet->messages_fill < CHANNEL_PACKET_MESSAGES_MAX;
+            ++message_id
+        ) {
+            channel_message_t* message = &channel->send_messages[message_id % CHANNEL_WINDOW_SIZE];
+            if (!message->is_used || !message->is_pending || (uint64_t) (end - cur) < (uint64_t) CHANNEL_MESSAGE_HEADER_SIZE + message->size) {
+                // note: a smaller one might still fit
+                continue ;
+            }
+
+            *cur++ = (uint8_t) type;
+            *cur++ = (uint8_t) message_id;
+            *cur++ = (uint8_t) (message_id >> 8);
+            *cur++ = message->size;
+            memcpy(cur, message->data, message->size);
+            cur += message->size;
+            message->is_pending = false;
+
+            sent_packet->channel_types[sent_packet->messages_fill] = (uint8_t) type;
+            sent_packet->message_ids[sent_packet->messages_fill]   = message_id;
+            ++sent_packet->messages_fill;
+        }
+    }
+    buffer[0] = sent_packet->messages_fill;
+    sent_packet->is_used = sent_packet->messages_fill > 0;
+    *bytes_written = (uint32_t) (cur - buffer);
+
+    return true;
+}
+
+bool channel_set__validate(const uint8_t* buffer, uint32_t buffer_size, uint32_t* bytes_read) {
+    if (buffer_size < 1 || buffer[0] > CHANNEL_PACKET_MESSAGES_MAX) {
+        return false;
+    }
+
+    const uint32_t messages_fill = buffer[0];
+    uint32_t block_size = 1;
+    for (uint32_t message_index = 0; message_index < messages_fill; ++message_index) {
+        if (buffer_size - block_size < CHANNEL_MESSAGE_HEADER_SIZE || buffer[block_size] >= _CHANNEL_TYPE_SIZE) {
+            return false;
+        }
+        block_size += CHANNEL_MESSAGE_HEADER_SIZE + buffer[block_size + 3];
+        if (block_size > buffer_size) {
+            return false;
+        }
+    }
+    *bytes_read = block_size;
+
+    return true;
+}
+
+bool channel_set__read(channel_set_t* self, const uint8_t* buffer, uint32_t buffer_size, uint32_t* bytes_read) {
+    // note: validated in full before anything is stored
+    uint32_t block_size = 0;
+    if (!channel_set__validate(buffer, buffer_size, &block_size)) {
+        return false;
+    }
+
+    const uint32_t messages_fill = buffer[0];
+    const uint8_t* cur = buffer + 1;
+    for (uint32_t message_index = 0; message_index < messages_fill; ++message_index) {
+        channel_t* channel = &self->channels[cur[0]];
+        const uint16_t message_id = (uint16_t) (cur[1] | (cur[2] << 8));
+        const uint8_t size = cur[3];
+        const uint8_t* data = cur + CHANNEL_MESSAGE_HEADER_SIZE;
+        cur = data + size;
+
+        if ((uint16_t) (message_id - channel->receive_message_id) >= CHANNEL_WINDOW_SIZE) {
+            // note: handed out already
+            continue ;
+        }
+        channel_message_t* message = &channel->receive_messages[message_id % CHANNEL_WINDOW_SIZE];
+        if (message->is_used) {
+            // note: duplicate
+            continue ;
+        }
+        memcpy(message->data, data, size);
+        message->size       = size;
+        message->message_id = message_id;
+        message->is_used    = true;
+        message->is_pending = true;
+    }
+    *bytes_read = block_size;
+
+    return true;
+}
+
+void channel_set__ack(channel_set_t* self, uint16_t ack, const ack_window_t* ack_window) {
+    self->is_acked = true;
+    for (uint32_t sent_packet_index = 0; sent_packet_index < CHANNEL_SENT_PACKETS_SIZE; ++sent_packet_index) {
+        channel_sent_packet_t* sent_packet = &self->sent_packets[sent_packet_index];
+        if (!sent_packet->is_used || sequence_id__is_more_recent(sent_packet->sequence_id, ack)) {
+            continue ;
+        }
+
+        const uint32_t ack_delta = sequence_id__delta(ack, sent_packet->sequence_id);
+        const bool is_acked = ack_delta == 0 || ack_window__is_set(ack_window, ack_delta);
+        if (is_acked || ack_delta >= CHANNEL_LOSS_THRESHOLD) {
+            channel_set__resolve_sent_packet(self, sent_packet, is_acked);
+        }
+    }
+}
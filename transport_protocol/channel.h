@@ -0,0 +1,124 @@
+#ifndef CHANNEL_H
+# define CHANNEL_H
+
+# include "ack_window.h"
+
+# include <stdint.h>
+# include <stdbool.h>
+
+struct         channel_message;
+struct         channel;
+struct         channel_sent_packet;
+struct         channel_set;
+typedef struct channel_message     channel_message_t;
+typedef struct channel             channel_t;
+typedef struct channel_sent_packet channel_sent_packet_t;
+typedef struct channel_set         channel_set_t;
+
+typedef enum channel_type {
+    // delivered exactly once, in the order they were pushed
+    CHANNEL_TYPE_RELIABLE_ORDERED,
+    // delivered exactly once, as soon as they arrive
+    CHANNEL_TYPE_RELIABLE_UNORDERED,
+
+    _CHANNEL_TYPE_SIZE
+} channel_type_t;
+
+/**
+ * Reliable messages piggybacked on the packets, they have no timers of their own
+ * A message is resent only if a packet that carried it is inferred lost from the acks of the packets that followed it
+ *
+ * Written after the packet header as:
+ *   uint8_t messages_fill, then for each message
+ *   uint8_t channel_type, uint16_t message_id (little endian), uint8_t size, 'size' bytes of data
+*/
+# define CHANNEL_WINDOW_SIZE          32
+# define CHANNEL_MESSAGE_SIZE_MAX     255
+# define CHANNEL_MESSAGE_HEADER_SIZE  4
+# define CHANNEL_PACKET_MESSAGES_MAX  8
+//! @note Largest block written by channel_set__write
+# define CHANNEL_SET_WRITE_SIZE_MAX   (1 + CHANNEL_PACKET_MESSAGES_MAX * (CHANNEL_MESSAGE_HEADER_SIZE + CHANNEL_MESSAGE_SIZE_MAX))
+//! @note Packets in flight whose messages are tracked, indexed by sequence id modulo the size
+# define CHANNEL_SENT_PACKETS_SIZE    64
+//! @note A packet is inferred lost if it's unacknowledged while one at least this much newer is, tolerates some reordering
+# define CHANNEL_LOSS_THRESHOLD       3
+
+struct channel_message {
+    uint8_t  data[CHANNEL_MESSAGE_SIZE_MAX];
+    uint8_t  size;
+    uint16_t message_id;
+    bool     is_used;
+    //! @note Send side: waiting to go out with the next packet, receive side: waiting to be handed out
+    bool     is_pending;
+};
+
+/**
+ * Both sides are windows of CHANNEL_WINDOW_SIZE message ids indexed by message id modulo the size
+ * The sender doesn't push past its oldest unacknowledged message, so the receiver's window always covers what's in flight
+*/
+struct channel {
+    channel_type_t    type;
+    //! @note Id of the next message pushed
+    uint16_t          send_message_id;
+    uint16_t          send_message_id_oldest;
+    channel_message_t send_messages[CHANNEL_WINDOW_SIZE];
+    //! @note Oldest message id not handed out yet, older ones are duplicates
+    uint16_t          receive_message_id;
+    channel_message_t receive_messages[CHANNEL_WINDOW_SIZE];
+};
+
+struct channel_sent_packet {
+    //! @note seq_id_t of packet.h, which depends on this header for the size of the packets
+    uint16_t sequence_id;
+    bool     is_used;
+    uint8_t  messages_fill;
+    uint8_t  channel_types[CHANNEL_PACKET_MESSAGES_MAX];
+    uint16_t message_ids[CHANNEL_PACKET_MESSAGES_MAX];
+};
+
+struct channel_set {
+    channel_t             channels[_CHANNEL_TYPE_SIZE];
+    channel_sent_packet_t sent_packets[CHANNEL_SENT_PACKETS_SIZE];
+    /**
+     * Nothing is sent until the first ack, the ack window of a new connection starts out full,
+     * so only packets sent after one they acknowledged can be trusted to be acked for real
+    */
+    bool                  is_acked;
+    uint32_t              messages_resent;
+};
+
+void channel_set__create(channel_set_t* self);
+
+/**
+ * @returns false if the message is larger than CHANNEL_MESSAGE_SIZE_MAX or CHANNEL_WINDOW_SIZE messages are unacknowledged already
+*/
+bool channel_set__push(channel_set_t* self, channel_type_t type, const void* data, uint32_t data_size);
+/**
+ * @brief Hands out the next message received on 'type'
+ * @note 'data' is valid until the next call to channel_set__read
+*/
+bool channel_set__pop(channel_set_t* self, channel_type_t type, const void** data, uint32_t* data_size);
+
+/**
+ * @brief Writes the pending messages that fit into 'buffer', they are tracked as sent with 'sequence_id'
+ * @param buffer_size at least 1, the block is never larger than CHANNEL_SET_WRITE_SIZE_MAX
+*/
+bool channel_set__write(channel_set_t* self, uint16_t sequence_id, uint8_t* buffer, uint32_t buffer_size, uint32_t* bytes_written);
+/**
+ * @brief Checks that a received block is well formed, without storing anything
+ * @param bytes_read size of the block, the buffer can continue past it
+*/
+bool channel_set__validate(const uint8_t* buffer, uint32_t buffer_size, uint32_t* bytes_read);
+/**
+ * @brief Stores the messages of a received block that weren't received before
+ * @returns false if the block is malformed, nothing is stored then
+*/
+bool channel_set__read(channel_set_t* self, const uint8_t* buffer, uint32_t buffer_size, uint32_t* bytes_read);
+
+/**
+ * @brief Frees the messages of the packets acknowledged, and marks the ones of the packets inferred lost for resending
+ * @param ack newest of our sequence ids they received, only call with acks that were validated against what was sent
+*/
+void channel_set__ack(channel_set_t* self, uint16_t ack, const ack_window_t* ack_window);
+
+#endif // CHANNEL_H
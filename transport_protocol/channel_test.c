@@ -0,0 +1,294 @@
+#include "channel.h"
+
+#include "packet.h"
+#include "debug.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MESSAGES_MAX  100000
+#define IN_FLIGHT_MAX 1024
+
+typedef struct peer {
+    channel_set_t channels;
+    seq_id_t      sequence_id;
+    // what it received of the other peer's packets, for the acks it sends back
+    bool          is_receiving;
+    seq_id_t      sequence_id_received;
+    ack_window_t  ack_window;
+    uint32_t      messages_pushed[_CHANNEL_TYPE_SIZE];
+    // of the messages the other peer pushed
+    uint32_t      messages_popped[_CHANNEL_TYPE_SIZE];
+    uint8_t       times_popped[_CHANNEL_TYPE_SIZE][MESSAGES_MAX];
+} peer_t;
+
+typedef struct packet_in_flight {
+    uint32_t     to;
+    uint32_t     tick_due;
+    seq_id_t     sequence_id;
+    bool         has_ack;
+    seq_id_t     ack;
+    ack_window_t ack_window;
+    uint32_t     block_size;
+    uint8_t      block[CHANNEL_SET_WRITE_SIZE_MAX];
+} packet_in_flight_t;
+
+static peer_t             peers[2];
+static packet_in_flight_t in_flight[IN_FLIGHT_MAX];
+static uint32_t           in_flight_fill;
+static uint32_t           errors;
+
+// the channel type, its index on the channel, then filler derived from the index
+static uint32_t message__fill(uint8_t* message, channel_type_t type, uint32_t message_index) {
+    const uint32_t message_size = 5 + message_index % 40;
+    message[0] = (uint8_t) type;
+    memcpy(message + 1, &message_index, 4);
+    for (uint32_t byte_index = 5; byte_index < message_size; ++byte_index) {
+        message[byte_index] = (uint8_t) (message_index + byte_index);
+    }
+    return message_size;
+}
+
+static void peers__create() {
+    for (uint32_t peer_index = 0; peer_index < 2; ++peer_index) {
+        memset(&peers[peer_index], 0, sizeof(peers[peer_index]));
+        channel_set__create(&peers[peer_index].channels);
+        peers[peer_index].sequence_id = (seq_id_t) rand();
+    }
+    in_flight_fill = 0;
+}
+
+static void peer__push(peer_t* self) {
+    uint8_t message[CHANNEL_MESSAGE_SIZE_MAX];
+    const channel_type_t type = (channel_type_t) (rand() % _CHANNEL_TYPE_SIZE);
+    if (self->messages_pushed[type] == MESSAGES_MAX) {
+        return ;
+    }
+    const uint32_t message_size = message__fill(message, type, self->messages_pushed[type]);
+    // note: fails while the window is full, the same message is pushed again later
+    if (channel_set__push(&self->channels, type, message, message_size)) {
+        ++self->messages_pushed[type];
+    }
+}
+
+static void peer__send(uint32_t from, uint32_t tick, uint32_t delay_max, int loss_percent, int duplicate_percent) {
+    peer_t* self = &peers[from];
+    packet_in_flight_t packet;
+    packet.to          = 1 - from;
+    packet.sequence_id = ++self->sequence_id;
+    packet.has_ack     = self->is_receiving;
+    packet.ack         = self->sequence_id_received;
+    packet.ack_window  = self->ack_window;
+    channel_set__write(&self->channels, packet.sequence_id, packet.block, sizeof(packet.block), &packet.block_size);
+
+    for (int copies = rand() % 100 < duplicate_percent ? 2 : 1; copies > 0; --copies) {
+        if (rand() % 100 < loss_percent || in_flight_fill == IN_FLIGHT_MAX) {
+            continue ;
+        }
+        packet.tick_due = tick + (delay_max ? (uint32_t) rand() % (delay_max + 1) : 0);
+        in_flight[in_flight_fill++] = packet;
+    }
+}
+
+static void peer__receive(uint32_t to, const packet_in_flight_t* packet) {
+    peer_t* self = &peers[to];
+    if (!self->is_receiving) {
+        self->is_receiving         = true;
+        self->sequence_id_received = packet->sequence_id;
+        ack_window__create(&self->ack_window, ACK_WINDOW_SIZE_DEFAULT);
+    } else if (sequence_id__is_more_recent(packet->sequence_id, self->sequence_id_received)) {
+        ack_window__advance(&self->ack_window, sequence_id__delta(packet->sequence_id, self->sequence_id_received));
+        self->sequence_id_received = packet->sequence_id;
+    } else if (packet->sequence_id != self->sequence_id_received) {
+        ack_window__set(&self->ack_window, sequence_id__delta(self->sequence_id_received, packet->sequence_id));
+    }
+    if (packet->has_ack) {
+        channel_set__ack(&self->channels, packet->ack, &packet->ack_window);
+    }
+
+    uint32_t bytes_read = 0;
+    if (!channel_set__read(&self->channels, packet->block, packet->block_size, &bytes_read) || bytes_read != packet->block_size) {
+        printf("peer %u: a block of %u bytes didn't read back\n", to, packet->block_size);
+        ++errors;
+        return ;
+    }
+
+    for (uint32_t type = 0; type < _CHANNEL_TYPE_SIZE; ++type) {
+        const void* data;
+        uint32_t data_size;
+        while (channel_set__pop(&self->channels, (channel_type_t) type, &data, &data_size)) {
+            uint8_t  message[CHANNEL_MESSAGE_SIZE_MAX];
+            uint32_t message_index = MESSAGES_MAX;
+            if (data_size >= 5) {
+                memcpy(&message_index, (const uint8_t*) data + 1, 4);
+            }
+            if (
+                message_index >= peers[1 - to].messages_pushed[type] ||
+                data_size != message__fill(message, (channel_type_t) type, message_index) || memcmp(data, message, data_size) != 0
+            ) {
+                printf("peer %u: popped a message on channel %u that wasn't pushed\n", to, type);
+                ++errors;
+                continue ;
+            }
+            if (type == CHANNEL_TYPE_RELIABLE_ORDERED && message_index != self->messages_popped[type]) {
+                printf("peer %u: popped ordered message %u, expected %u\n", to, message_index, self->messages_popped[type]);
+                ++errors;
+            }
+            if (++self->times_popped[type][message_index] > 1) {
+                printf("peer %u: popped message %u on channel %u again\n", to, message_index, type);
+                ++errors;
+            }
+            ++self->messages_popped[type];
+        }
+    }
+}
+
+static void network__deliver(uint32_t tick) {
+    // note: in place, the ones not due yet keep their order
+    uint32_t kept = 0;
+    for (uint32_t packet_index = 0; packet_index < in_flight_fill; ++packet_index) {
+        if (in_flight[packet_index].tick_due > tick) {
+            in_flight[kept++] = in_flight[packet_index];
+            continue ;
+        }
+        peer__receive(in_flight[packet_index].to, &in_flight[packet_index]);
+    }
+    in_flight_fill = kept;
+}
+
+static void peers__check_all_popped(const char* what) {
+    for (uint32_t peer_index = 0; peer_index < 2; ++peer_index) {
+        for (uint32_t type = 0; type < _CHANNEL_TYPE_SIZE; ++type) {
+            if (peers[peer_index].messages_popped[type] != peers[1 - peer_index].messages_pushed[type]) {
+                printf(
+                    "%s: peer %u popped %u of %u messages on channel %u\n",
+                    what, peer_index, peers[peer_index].messages_popped[type], peers[1 - peer_index].messages_pushed[type], type
+                );
+                ++errors;
+            }
+        }
+    }
+}
+
+int main() {
+    if (!debug__init_module()) {
+        return 1;
+    }
+    srand(1);
+
+    // lossy, duplicating and reordering, then a clean link until everything in flight got through
+    for (uint32_t run = 0; run < 20; ++run) {
+        peers__create();
+        const int loss_percent = 5 + rand() % 30;
+        uint32_t tick = 0;
+        for (; tick < 4000; ++tick) {
+            for (uint32_t peer_index = 0; peer_index < 2; ++peer_index) {
+                for (int pushes = rand() % 3; pushes > 0; --pushes) {
+                    peer__push(&peers[peer_index]);
+                }
+                peer__send(peer_index, tick, 8, loss_percent, 3);
+            }
+            network__deliver(tick);
+        }
+        for (uint32_t tick_drain = tick + 200; tick < tick_drain; ++tick) {
+            peer__send(0, tick, 0, 0, 0);
+            peer__send(1, tick, 0, 0, 0);
+            network__deliver(tick);
+        }
+        peers__check_all_popped("lossy");
+    }
+
+    // reordered by less than CHANNEL_LOSS_THRESHOLD packets and nothing lost, so nothing is ever resent
+    peers__create();
+    for (uint32_t tick = 0; tick < 20000; ++tick) {
+        for (uint32_t peer_index = 0; peer_index < 2; ++peer_index) {
+            peer__push(&peers[peer_index]);
+            peer__send(peer_index, tick, CHANNEL_LOSS_THRESHOLD - 2, 0, 0);
+        }
+        network__deliver(tick);
+    }
+    network__deliver((uint32_t) -1);
+    peers__check_all_popped("reordered");
+    if (peers[0].channels.messages_resent != 0 || peers[1].channels.messages_resent != 0) {
+        printf("reordered: %u and %u messages resent without loss\n", peers[0].channels.messages_resent, peers[1].channels.messages_resent);
+        ++errors;
+    }
+
+    // a lost packet is resent once an ack CHANNEL_LOSS_THRESHOLD newer than it arrives, not before
+    channel_set_t channels;
+    channel_set__create(&channels);
+    ack_window_t ack_window;
+    ack_window__create(&ack_window, ACK_WINDOW_SIZE_DEFAULT);
+    channel_set__ack(&channels, 0, &ack_window);
+    uint8_t  block[CHANNEL_SET_WRITE_SIZE_MAX];
+    uint32_t block_size = 0;
+    channel_set__push(&channels, CHANNEL_TYPE_RELIABLE_UNORDERED, "lost", 4);
+    channel_set__write(&channels, 1, block, sizeof(block), &block_size);
+    for (seq_id_t ack = 2; ack <= 1 + CHANNEL_LOSS_THRESHOLD; ++ack) {
+        channel_set__write(&channels, ack, block, sizeof(block), &block_size);
+        if (block[0] != 0) {
+            printf("resent before packet %u was acked\n", ack);
+            ++errors;
+        }
+        // packet 1 never arrived
+        ack_window__advance(&ack_window, ack == 2 ? 2 : 1);
+        channel_set__ack(&channels, ack, &ack_window);
+        if (channels.messages_resent != (ack == 1 + CHANNEL_LOSS_THRESHOLD)) {
+            printf("ack %u: %u messages resent\n", ack, channels.messages_resent);
+            ++errors;
+        }
+    }
+    channel_set__write(&channels, 2 + CHANNEL_LOSS_THRESHOLD, block, sizeof(block), &block_size);
+    if (block[0] != 1) {
+        printf("not resent after the loss\n");
+        ++errors;
+    }
+
+    // the second message arrives first, the ordered channel holds it back until the first one arrives
+    for (uint32_t type = 0; type < _CHANNEL_TYPE_SIZE; ++type) {
+        channel_set_t sender;
+        channel_set_t receiver;
+        channel_set__create(&sender);
+        channel_set__create(&receiver);
+        channel_set__ack(&sender, 0, &ack_window);
+        uint8_t  blocks[2][CHANNEL_SET_WRITE_SIZE_MAX];
+        uint32_t blocks_size[2];
+        channel_set__push(&sender, (channel_type_t) type, "first", 5);
+        channel_set__push(&sender, (channel_type_t) type, "other", 5);
+        // note: room for a single message, so each goes in a packet of its own
+        channel_set__write(&sender, 1, blocks[0], 1 + CHANNEL_MESSAGE_HEADER_SIZE + 5, &blocks_size[0]);
+        channel_set__write(&sender, 2, blocks[1], 1 + CHANNEL_MESSAGE_HEADER_SIZE + 5, &blocks_size[1]);
+        const void* data;
+        uint32_t data_size;
+        uint32_t bytes_read;
+        channel_set__read(&receiver, blocks[1], blocks_size[1], &bytes_read);
+        const bool is_popped_early = channel_set__pop(&receiver, (channel_type_t) type, &data, &data_size);
+        if (is_popped_early != (type == CHANNEL_TYPE_RELIABLE_UNORDERED) || (is_popped_early && memcmp(data, "other", 5) != 0)) {
+            printf("channel %u: popped %d before the gap was filled\n", type, is_popped_early);
+            ++errors;
+        }
+        channel_set__read(&receiver, blocks[0], blocks_size[0], &bytes_read);
+        const char* expected[2] = { "first", "other" };
+        const uint32_t messages_left = is_popped_early ? 1 : 2;
+        for (uint32_t message_index = 0; message_index < messages_left; ++message_index) {
+            if (!channel_set__pop(&receiver, (channel_type_t) type, &data, &data_size) || memcmp(data, expected[message_index], 5) != 0) {
+                printf("channel %u: expected '%s'\n", type, expected[message_index]);
+                ++errors;
+            }
+        }
+        if (channel_set__pop(&receiver, (channel_type_t) type, &data, &data_size)) {
+            printf("channel %u: popped more than was sent\n", type);
+            ++errors;
+        }
+    }
+
+    uint32_t messages_popped = 0;
+    for (uint32_t type = 0; type < _CHANNEL_TYPE_SIZE; ++type) {
+        messages_popped += peers[0].messages_popped[type] + peers[1].messages_popped[type];
+    }
+    printf("messages popped in the last run: %u, errors: %u\n", messages_popped, errors);
+
+    return errors == 0 ? 0 : 1;
+}
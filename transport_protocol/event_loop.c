@@ -0,0 +1,235 @@
+#include "event_loop.h"
+#include "tp_shm.h"
+
+#include "system.h"
+#include "memory.h"
+#include "helper_macros.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <linux/io_uring.h>
+
+#include "event_loop_io_uring_impl.c"
+
+//! @note epoll data of the shared memory doorbell, it's reported as EVENT_LOOP_EVENT_RECEIVED
+#define EVENT_LOOP_EPOLL_SHM_WAKE (1u << 31)
+
+static bool event_loop__check_deadline(event_loop_t* self);
+static void event_loop__disarm_deadline(event_loop_t* self);
+
+static bool event_loop__check_deadline(event_loop_t* self) {
+    if (self->time_deadline < 0.0 || system__get_time() < self->time_deadline) {
+        return false;
+    }
+
+    event_loop__disarm_deadline(self);
+
+    return true;
+}
+
+static void event_loop__disarm_deadline(event_loop_t* self) {
+    const struct itimerspec timer_spec = { 0 };
+    timerfd_settime(self->timer_fd, 0, &timer_spec, 0);
+    uint64_t expirations;
+    // note: drain an expiration that might have fired before it was disarmed
+    if (read(self->timer_fd, &expirations, sizeof(expirations)) == -1) {
+        assert(errno == EAGAIN);
+    }
+    self->time_deadline = -1.0;
+}
+
+bool event_loop__create(event_loop_t* self, tp_socket_t* tp_socket, event_loop_backend_t backend) {
+    memset(self, 0, sizeof(*self));
+    self->tp_socket     = tp_socket;
+    self->backend       = EVENT_LOOP_BACKEND_EPOLL;
+    self->epoll_fd      = -1;
+    self->time_deadline = -1.0;
+
+    // note: not fatal, arrival time is sampled in userspace instead
+    tp_socket__enable_offload(tp_socket, TP_SOCKET_OFFLOAD_TIMESTAMP);
+
+    // note: relative deadlines are armed, so the clock doesn't have to match system__get_time's
+    self->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (self->timer_fd == -1) {
+        return false;
+    }
+
+    // note: the shared memory doorbell is only waited on with epoll
+    if (backend == EVENT_LOOP_BACKEND_IO_URING && !tp_socket->shm) {
+        self->io_uring = event_loop_io_uring__create(tp_socket->socket, self->timer_fd);
+        if (self->io_uring) {
+            self->backend = EVENT_LOOP_BACKEND_IO_URING;
+            return true;
+        }
+    }
+
+    self->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (self->epoll_fd == -1) {
+        event_loop__destroy(self);
+        return false;
+    }
+
+    struct epoll_event socket_event = { 0 };
+    socket_event.events   = EPOLLIN;
+    socket_event.data.u32 = EVENT_LOOP_EVENT_RECEIVED;
+    struct epoll_event timer_event = { 0 };
+    timer_event.events   = EPOLLIN;
+    timer_event.data.u32 = EVENT_LOOP_EVENT_DEADLINE;
+    if (
+        epoll_ctl(self->epoll_fd, EPOLL_CTL_ADD, tp_socket->socket, &socket_event) == -1 ||
+        epoll_ctl(self->epoll_fd, EPOLL_CTL_ADD, self->timer_fd, &timer_event) == -1
+    ) {
+        event_loop__destroy(self);
+        return false;
+    }
+
+    if (tp_socket->shm) {
+        struct epoll_event shm_wake_event = { 0 };
+        shm_wake_event.events   = EPOLLIN;
+        shm_wake_event.data.u32 = EVENT_LOOP_EPOLL_SHM_WAKE;
+        if (epoll_ctl(self->epoll_fd, EPOLL_CTL_ADD, tp_socket->shm->wake_fd, &shm_wake_event) == -1) {
+            event_loop__destroy(self);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void event_loop__destroy(event_loop_t* self) {
+    if (self->io_uring) {
+        event_loop_io_uring__destroy(self->io_uring);
+        self->io_uring = 0;
+    }
+
+    if (self->epoll_fd != -1) {
+        close(self->epoll_fd);
+        self->epoll_fd = -1;
+    }
+
+    if (self->timer_fd != -1) {
+        close(self->timer_fd);
+        self->timer_fd = -1;
+    }
+}
+
+bool event_loop__set_deadline(event_loop_t* self, double time_deadline) {
+    double time_left = time_deadline - system__get_time();
+    if (time_left <= 0.0) {
+        // note: an all zero timer spec would disarm it
+        time_left = 0.000000001;
+    }
+
+    struct itimerspec timer_spec = { 0 };
+    timer_spec.it_value.tv_sec  = (time_t) time_left;
+    timer_spec.it_value.tv_nsec = (long) ((time_left - (double) timer_spec.it_value.tv_sec) * 1000000000.0);
+    if (timer_spec.it_value.tv_sec == 0 && timer_spec.it_value.tv_nsec == 0) {
+        timer_spec.it_value.tv_nsec = 1;
+    }
+    if (timerfd_settime(self->timer_fd, 0, &timer_spec, 0) == -1) {
+        return false;
+    }
+    self->time_deadline = time_deadline;
+
+    return true;
+}
+
+uint32_t event_loop__poll(event_loop_t* self, tp_message_t* messages, uint32_t messages_size) {
+    switch (self->backend) {
+    case EVENT_LOOP_BACKEND_EPOLL: {
+        return tp_socket__get_data_batch(self->tp_socket, messages, messages_size);
+    } break ;
+    case EVENT_LOOP_BACKEND_IO_URING: {
+        uint32_t messages_received = 0;
+        const uint32_t events = event_loop_io_uring__reap(self->io_uring, messages, messages_size, &messages_received);
+        if (events & EVENT_LOOP_EVENT_DEADLINE) {
+            // note: not reported here, but it must not be lost for the next wait either
+            self->time_deadline = 0.0;
+        }
+        event_loop_io_uring__enter(self->io_uring, 0);
+        return messages_received;
+    } break ;
+    default: assert(false);
+    }
+
+    return 0;
+}
+
+uint32_t event_loop__wait(event_loop_t* self, tp_message_t* messages, uint32_t messages_size, uint32_t* messages_received) {
+    *messages_received = 0;
+    uint32_t events = 0;
+    while (events == 0) {
+        switch (self->backend) {
+        case EVENT_LOOP_BACKEND_EPOLL: {
+            *messages_received = tp_socket__get_data_batch(self->tp_socket, messages, messages_size);
+            if (*messages_received > 0) {
+                events |= EVENT_LOOP_EVENT_RECEIVED;
+            }
+            if (event_loop__check_deadline(self)) {
+                events |= EVENT_LOOP_EVENT_DEADLINE;
+            }
+            if (events) {
+                break ;
+            }
+
+            tp_shm_t* shm = self->tp_socket->shm;
+            if (shm && !tp_shm__prepare_wait(shm)) {
+                // note: datagrams were pushed to a ring after it was drained
+                continue ;
+            }
+
+            struct epoll_event epoll_events[3];
+            const int32_t epoll_events_size = epoll_wait(self->epoll_fd, epoll_events, ARRAY_SIZE(epoll_events), -1);
+            if (epoll_events_size == -1 && errno != EINTR) {
+                return 0;
+            }
+            bool is_shm_woken = false;
+            for (int32_t epoll_event_index = 0; epoll_event_index < epoll_events_size; ++epoll_event_index) {
+                if (epoll_events[epoll_event_index].data.u32 == EVENT_LOOP_EVENT_DEADLINE && self->time_deadline >= 0.0) {
+                    // note: the timer clock may run slightly ahead of system__get_time, the timer is authoritative
+                    event_loop__disarm_deadline(self);
+                    events |= EVENT_LOOP_EVENT_DEADLINE;
+                } else if (epoll_events[epoll_event_index].data.u32 == EVENT_LOOP_EPOLL_SHM_WAKE) {
+                    is_shm_woken = true;
+                }
+            }
+            if (shm) {
+                tp_shm__finish_wait(shm, is_shm_woken);
+            }
+        } break ;
+        case EVENT_LOOP_BACKEND_IO_URING: {
+            if (event_loop_io_uring__reap(self->io_uring, messages, messages_size, messages_received) & EVENT_LOOP_EVENT_DEADLINE) {
+                if (self->time_deadline >= 0.0) {
+                    self->time_deadline = -1.0;
+                    events |= EVENT_LOOP_EVENT_DEADLINE;
+                }
+            }
+            if (*messages_received > 0) {
+                events |= EVENT_LOOP_EVENT_RECEIVED;
+            }
+            if (event_loop__check_deadline(self)) {
+                events |= EVENT_LOOP_EVENT_DEADLINE;
+            }
+            if (events) {
+                event_loop_io_uring__enter(self->io_uring, 0);
+                break ;
+            }
+
+            if (!event_loop_io_uring__enter(self->io_uring, 1)) {
+                return 0;
+            }
+        } break ;
+        default: assert(false);
+        }
+    }
+
+    return events;
+}
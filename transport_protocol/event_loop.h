@@ -0,0 +1,65 @@
+#ifndef EVENT_LOOP_H
+# define EVENT_LOOP_H
+
+# include "tp.h"
+
+struct         event_loop;
+struct         event_loop_io_uring;
+enum           event_loop_backend;
+enum           event_loop_event;
+typedef struct event_loop          event_loop_t;
+typedef struct event_loop_io_uring event_loop_io_uring_t;
+typedef enum   event_loop_backend  event_loop_backend_t;
+typedef enum   event_loop_event    event_loop_event_t;
+
+enum event_loop_backend {
+    EVENT_LOOP_BACKEND_EPOLL,
+    //! multishot recvmsg into kernel provided buffers, falls back to epoll if the kernel doesn't support it
+    EVENT_LOOP_BACKEND_IO_URING
+};
+
+enum event_loop_event {
+    EVENT_LOOP_EVENT_RECEIVED = 1 << 0,
+    EVENT_LOOP_EVENT_DEADLINE = 1 << 1
+};
+
+/**
+ * Waits on a socket and a deadline at the same time, so datagrams can be processed as soon as they arrive
+ * and the thread sleeps otherwise instead of busy waiting until the deadline
+*/
+struct event_loop {
+    tp_socket_t*           tp_socket;
+    event_loop_backend_t   backend;
+    int32_t                epoll_fd;
+    int32_t                timer_fd;
+    //! @note System time, negative if not armed
+    double                 time_deadline;
+    event_loop_io_uring_t* io_uring;
+};
+
+/**
+ * @note Enables arrival timestamps on the socket
+ * @note Enable shared memory on the socket before, it needs the epoll backend so it's used even if io_uring is asked for
+*/
+bool event_loop__create(event_loop_t* self, tp_socket_t* tp_socket, event_loop_backend_t backend);
+void event_loop__destroy(event_loop_t* self);
+
+/**
+ * @brief Arms the deadline that event_loop__wait returns on, it fires once
+ * @param time_deadline system time
+*/
+bool event_loop__set_deadline(event_loop_t* self, double time_deadline);
+
+/**
+ * @brief Receives the datagrams that are already pending without blocking
+ * @returns Number of messages filled
+*/
+uint32_t event_loop__poll(event_loop_t* self, tp_message_t* messages, uint32_t messages_size);
+
+/**
+ * @brief Blocks until datagrams arrive or the deadline passes, whichever happens first
+ * @returns Mask of event_loop_event_t that happened, 0 on error
+*/
+uint32_t event_loop__wait(event_loop_t* self, tp_message_t* messages, uint32_t messages_size, uint32_t* messages_received);
+
+#endif // EVENT_LOOP_H
@@ -0,0 +1,341 @@
+# define EVENT_LOOP_IO_URING_ENTRIES      16
+//! @note Must be a power of 2
+# define EVENT_LOOP_IO_URING_BUFFERS_SIZE 256
+//! @note Holds the recvmsg header, name and control too, datagrams that don't fit in the rest are dropped
+# define EVENT_LOOP_IO_URING_BUFFER_SIZE  2048
+/**
+ * Every receive completion holds a buffer until it's reaped, so there are never more of them than buffers,
+ * a CQ of that size can't overflow while the completions wait for the next reap, TP_BATCH_SIZE at a time
+*/
+# define EVENT_LOOP_IO_URING_CQ_ENTRIES   (2 * EVENT_LOOP_IO_URING_BUFFERS_SIZE)
+# define EVENT_LOOP_IO_URING_BUFFER_GROUP 0
+
+enum event_loop_io_uring_user_data {
+    EVENT_LOOP_IO_URING_USER_DATA_RECV = 1,
+    EVENT_LOOP_IO_URING_USER_DATA_TIMER
+};
+
+struct event_loop_io_uring {
+    int32_t                   ring_fd;
+
+    void*                     sq_ring;
+    size_t                    sq_ring_size;
+    uint32_t*                 sq_head;
+    uint32_t*                 sq_tail;
+    uint32_t*                 sq_mask;
+    uint32_t*                 sq_array;
+    uint32_t                  sq_entries;
+    //! @note Published to the kernel on enter
+    uint32_t                  sq_tail_local;
+    uint32_t                  sq_to_submit;
+    struct io_uring_sqe*      sqes;
+    size_t                    sqes_size;
+
+    void*                     cq_ring;
+    size_t                    cq_ring_size;
+    uint32_t*                 cq_head;
+    uint32_t*                 cq_tail;
+    uint32_t*                 cq_mask;
+    struct io_uring_cqe*      cqes;
+
+    struct io_uring_buf_ring* buf_ring;
+    size_t                    buf_ring_size;
+    uint16_t                  buf_ring_tail;
+    uint8_t*                  buffers;
+
+    //! @note Template for the multishot recvmsg, only the name and control lengths are used by the kernel
+    struct msghdr             recv_msg;
+    int32_t                   socket_fd;
+    int32_t                   timer_fd;
+    bool                      recv_armed;
+    bool                      timer_armed;
+};
+
+static event_loop_io_uring_t* event_loop_io_uring__create(int32_t socket_fd, int32_t timer_fd);
+static void event_loop_io_uring__destroy(event_loop_io_uring_t* self);
+static struct io_uring_sqe* event_loop_io_uring__get_sqe(event_loop_io_uring_t* self);
+static void event_loop_io_uring__arm(event_loop_io_uring_t* self);
+static bool event_loop_io_uring__enter(event_loop_io_uring_t* self, uint32_t min_complete);
+static void event_loop_io_uring__add_buffer(event_loop_io_uring_t* self, uint16_t buffer_id);
+//! @returns false if the datagram was dropped, it was truncated or doesn't fit into 'message'
+static bool event_loop_io_uring__receive(event_loop_io_uring_t* self, struct io_uring_cqe* cqe, tp_message_t* message, double time_received);
+//! @returns Mask of event_loop_event_t that were reaped
+static uint32_t event_loop_io_uring__reap(event_loop_io_uring_t* self, tp_message_t* messages, uint32_t messages_size, uint32_t* messages_received);
+
+static event_loop_io_uring_t* event_loop_io_uring__create(int32_t socket_fd, int32_t timer_fd) {
+    event_loop_io_uring_t* result = memory__calloc(DEBUG_MODULE_TP, 1, sizeof(*result));
+    if (!result) {
+        return 0;
+    }
+    result->socket_fd = socket_fd;
+    result->timer_fd  = timer_fd;
+
+    struct io_uring_params params = { 0 };
+    params.flags      = IORING_SETUP_CQSIZE;
+    params.cq_entries = EVENT_LOOP_IO_URING_CQ_ENTRIES;
+    result->ring_fd = (int32_t) syscall(__NR_io_uring_setup, EVENT_LOOP_IO_URING_ENTRIES, &params);
+    if (result->ring_fd == -1) {
+        memory__free(DEBUG_MODULE_TP, result);
+        return 0;
+    }
+
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+        // note: only kernels that are recent enough for multishot recvmsg are supported
+        goto err;
+    }
+
+    result->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    result->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (result->cq_ring_size > result->sq_ring_size) {
+        result->sq_ring_size = result->cq_ring_size;
+    }
+    result->cq_ring_size = result->sq_ring_size;
+    result->sq_ring = mmap(0, result->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, result->ring_fd, IORING_OFF_SQ_RING);
+    if (result->sq_ring == MAP_FAILED) {
+        result->sq_ring = 0;
+        goto err;
+    }
+    result->cq_ring = result->sq_ring;
+
+    result->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    result->sqes = mmap(0, result->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, result->ring_fd, IORING_OFF_SQES);
+    if (result->sqes == MAP_FAILED) {
+        result->sqes = 0;
+        goto err;
+    }
+
+    uint8_t* sq_ring = result->sq_ring;
+    result->sq_head       = (uint32_t*) (sq_ring + params.sq_off.head);
+    result->sq_tail       = (uint32_t*) (sq_ring + params.sq_off.tail);
+    result->sq_mask       = (uint32_t*) (sq_ring + params.sq_off.ring_mask);
+    result->sq_array      = (uint32_t*) (sq_ring + params.sq_off.array);
+    result->sq_entries    = params.sq_entries;
+    result->sq_tail_local = *result->sq_tail;
+
+    uint8_t* cq_ring = result->cq_ring;
+    result->cq_head = (uint32_t*) (cq_ring + params.cq_off.head);
+    result->cq_tail = (uint32_t*) (cq_ring + params.cq_off.tail);
+    result->cq_mask = (uint32_t*) (cq_ring + params.cq_off.ring_mask);
+    result->cqes    = (struct io_uring_cqe*) (cq_ring + params.cq_off.cqes);
+
+    // note: the buffer ring must be page aligned
+    result->buf_ring_size = EVENT_LOOP_IO_URING_BUFFERS_SIZE * sizeof(struct io_uring_buf);
+    result->buf_ring = mmap(0, result->buf_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (result->buf_ring == MAP_FAILED) {
+        result->buf_ring = 0;
+        goto err;
+    }
+
+    struct io_uring_buf_reg buf_reg = { 0 };
+    buf_reg.ring_addr    = (uint64_t) (uintptr_t) result->buf_ring;
+    buf_reg.ring_entries = EVENT_LOOP_IO_URING_BUFFERS_SIZE;
+    buf_reg.bgid         = EVENT_LOOP_IO_URING_BUFFER_GROUP;
+    if (syscall(__NR_io_uring_register, result->ring_fd, IORING_REGISTER_PBUF_RING, &buf_reg, 1) == -1) {
+        goto err;
+    }
+
+    result->buffers = memory__malloc(DEBUG_MODULE_TP, EVENT_LOOP_IO_URING_BUFFERS_SIZE * EVENT_LOOP_IO_URING_BUFFER_SIZE);
+    if (!result->buffers) {
+        goto err;
+    }
+    for (uint32_t buffer_id = 0; buffer_id < EVENT_LOOP_IO_URING_BUFFERS_SIZE; ++buffer_id) {
+        event_loop_io_uring__add_buffer(result, (uint16_t) buffer_id);
+    }
+
+    result->recv_msg.msg_namelen    = sizeof(struct sockaddr_in);
+    result->recv_msg.msg_controllen = TP_RECEIVE_CONTROL_SIZE;
+
+    event_loop_io_uring__arm(result);
+    if (!event_loop_io_uring__enter(result, 0)) {
+        goto err;
+    }
+
+    return result;
+
+err:
+    event_loop_io_uring__destroy(result);
+
+    return 0;
+}
+
+static void event_loop_io_uring__destroy(event_loop_io_uring_t* self) {
+    if (self->buffers) {
+        memory__free(DEBUG_MODULE_TP, self->buffers);
+    }
+    if (self->sqes) {
+        munmap(self->sqes, self->sqes_size);
+    }
+    if (self->sq_ring) {
+        munmap(self->sq_ring, self->sq_ring_size);
+    }
+    // note: closing the ring cancels the pending requests and unregisters the buffer ring
+    close(self->ring_fd);
+    if (self->buf_ring) {
+        munmap(self->buf_ring, self->buf_ring_size);
+    }
+
+    memory__free(DEBUG_MODULE_TP, self);
+}
+
+static struct io_uring_sqe* event_loop_io_uring__get_sqe(event_loop_io_uring_t* self) {
+    const uint32_t sq_head = __atomic_load_n(self->sq_head, __ATOMIC_ACQUIRE);
+    if (self->sq_tail_local - sq_head >= self->sq_entries) {
+        return 0;
+    }
+
+    const uint32_t sqe_index = self->sq_tail_local & *self->sq_mask;
+    struct io_uring_sqe* sqe = &self->sqes[sqe_index];
+    memset(sqe, 0, sizeof(*sqe));
+    self->sq_array[sqe_index] = sqe_index;
+    ++self->sq_tail_local;
+    ++self->sq_to_submit;
+
+    return sqe;
+}
+
+static void event_loop_io_uring__arm(event_loop_io_uring_t* self) {
+    if (!self->recv_armed) {
+        struct io_uring_sqe* sqe = event_loop_io_uring__get_sqe(self);
+        if (sqe) {
+            sqe->opcode    = IORING_OP_RECVMSG;
+            sqe->fd        = self->socket_fd;
+            sqe->addr      = (uint64_t) (uintptr_t) &self->recv_msg;
+            sqe->len       = 1;
+            sqe->ioprio    = IORING_RECV_MULTISHOT;
+            sqe->flags     = IOSQE_BUFFER_SELECT;
+            sqe->buf_group = EVENT_LOOP_IO_URING_BUFFER_GROUP;
+            sqe->user_data = EVENT_LOOP_IO_URING_USER_DATA_RECV;
+            self->recv_armed = true;
+        }
+    }
+
+    if (!self->timer_armed) {
+        struct io_uring_sqe* sqe = event_loop_io_uring__get_sqe(self);
+        if (sqe) {
+            sqe->opcode        = IORING_OP_POLL_ADD;
+            sqe->fd            = self->timer_fd;
+            sqe->poll32_events = POLLIN;
+            sqe->len           = IORING_POLL_ADD_MULTI;
+            sqe->user_data     = EVENT_LOOP_IO_URING_USER_DATA_TIMER;
+            self->timer_armed = true;
+        }
+    }
+}
+
+static bool event_loop_io_uring__enter(event_loop_io_uring_t* self, uint32_t min_complete) {
+    __atomic_store_n(self->sq_tail, self->sq_tail_local, __ATOMIC_RELEASE);
+    if (self->sq_to_submit == 0 && min_complete == 0) {
+        return true;
+    }
+
+    const uint32_t flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0;
+    const long result = syscall(__NR_io_uring_enter, self->ring_fd, self->sq_to_submit, min_complete, flags, 0, 0);
+    if (result == -1) {
+        return errno == EINTR;
+    }
+    self->sq_to_submit -= (uint32_t) result;
+
+    return true;
+}
+
+static void event_loop_io_uring__add_buffer(event_loop_io_uring_t* self, uint16_t buffer_id) {
+    struct io_uring_buf* buf = &self->buf_ring->bufs[self->buf_ring_tail & (EVENT_LOOP_IO_URING_BUFFERS_SIZE - 1)];
+    buf->addr = (uint64_t) (uintptr_t) (self->buffers + buffer_id * EVENT_LOOP_IO_URING_BUFFER_SIZE);
+    buf->len  = EVENT_LOOP_IO_URING_BUFFER_SIZE;
+    buf->bid  = buffer_id;
+    ++self->buf_ring_tail;
+    __atomic_store_n(&self->buf_ring->tail, self->buf_ring_tail, __ATOMIC_RELEASE);
+}
+
+static bool event_loop_io_uring__receive(event_loop_io_uring_t* self, struct io_uring_cqe* cqe, tp_message_t* message, double time_received) {
+    if (!(cqe->flags & IORING_CQE_F_BUFFER)) {
+        return false;
+    }
+
+    // note: layout of the buffer is [io_uring_recvmsg_out][name][control][payload]
+    const uint16_t buffer_id = (uint16_t) (cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+    uint8_t* buffer = self->buffers + buffer_id * EVENT_LOOP_IO_URING_BUFFER_SIZE;
+    struct io_uring_recvmsg_out* recvmsg_out = (struct io_uring_recvmsg_out*) buffer;
+    uint8_t* name    = buffer + sizeof(*recvmsg_out);
+    uint8_t* control = name + self->recv_msg.msg_namelen;
+    uint8_t* payload = control + self->recv_msg.msg_controllen;
+
+    // note: 'payloadlen' is the length of the datagram before it was cut to the buffer, what is past it isn't there
+    const uint32_t payload_size = (uint32_t) (buffer + EVENT_LOOP_IO_URING_BUFFER_SIZE - payload);
+    if (
+        (recvmsg_out->flags & MSG_TRUNC) || recvmsg_out->payloadlen > payload_size ||
+        recvmsg_out->payloadlen > message->data_size
+    ) {
+        event_loop_io_uring__add_buffer(self, buffer_id);
+        return false;
+    }
+    const uint32_t payload_len = recvmsg_out->payloadlen;
+    memcpy(message->data, payload, payload_len);
+    message->data_len     = payload_len;
+    message->time_arrival = time_received;
+
+    struct msghdr msg = { 0 };
+    msg.msg_control    = control;
+    msg.msg_controllen = recvmsg_out->controllen;
+    tp_message__parse_control(message, &msg);
+
+    struct sockaddr_in src_addr;
+    memcpy(&src_addr, name, sizeof(src_addr));
+    if (recvmsg_out->namelen == sizeof(src_addr) && src_addr.sin_family == AF_INET) {
+        message->addr.addr = src_addr.sin_addr.s_addr;
+        message->addr.port = src_addr.sin_port;
+    } else {
+        memset(&message->addr, 0, sizeof(message->addr));
+    }
+
+    event_loop_io_uring__add_buffer(self, buffer_id);
+
+    return true;
+}
+
+static uint32_t event_loop_io_uring__reap(event_loop_io_uring_t* self, tp_message_t* messages, uint32_t messages_size, uint32_t* messages_received) {
+    uint32_t events = 0;
+    const double time_received = system__get_time();
+
+    uint32_t cq_head = *self->cq_head;
+    const uint32_t cq_tail = __atomic_load_n(self->cq_tail, __ATOMIC_ACQUIRE);
+    while (cq_head != cq_tail) {
+        struct io_uring_cqe* cqe = &self->cqes[cq_head & *self->cq_mask];
+        switch (cqe->user_data) {
+        case EVENT_LOOP_IO_URING_USER_DATA_RECV: {
+            if (cqe->res >= 0) {
+                if (*messages_received == messages_size) {
+                    // note: leave it in the queue for the next call
+                    goto out;
+                }
+                if (event_loop_io_uring__receive(self, cqe, &messages[*messages_received], time_received)) {
+                    ++*messages_received;
+                    events |= EVENT_LOOP_EVENT_RECEIVED;
+                }
+            }
+            // note: multishot terminates on errors, for example if it runs out of buffers
+            if (!(cqe->flags & IORING_CQE_F_MORE)) {
+                self->recv_armed = false;
+            }
+        } break ;
+        case EVENT_LOOP_IO_URING_USER_DATA_TIMER: {
+            uint64_t expirations;
+            if (read(self->timer_fd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+                events |= EVENT_LOOP_EVENT_DEADLINE;
+            }
+            if (!(cqe->flags & IORING_CQE_F_MORE)) {
+                self->timer_armed = false;
+            }
+        } break ;
+        default: assert(false);
+        }
+        ++cq_head;
+    }
+
+out:
+    __atomic_store_n(self->cq_head, cq_head, __ATOMIC_RELEASE);
+
+    event_loop_io_uring__arm(self);
+
+    return events;
+}
@@ -0,0 +1,347 @@
+#include "frame.h"
+
+#include <assert.h>
+#include <string.h>
+
+static tp_message_t* frame_packer__datagram_with_room(frame_packer_t* self, uint32_t frame_size, network_addr_t addr);
+static tp_message_t* frame_packer__datagram_new(frame_packer_t* self, network_addr_t addr);
+/**
+ * @brief Fills a new 'datagram' with 'frame_header' and the bytes [offset, offset + size) of the message 'header' followed by 'payload'
+ * The header is copied, so is the payload if 'is_payload_copied', otherwise it's gathered from its buffer
+*/
+static void frame_packer__write_shared(
+    frame_packer_t* self, tp_message_t* datagram, const uint8_t* frame_header, uint32_t frame_header_size,
+    const uint8_t* header, uint32_t header_size, packet_buffer_t* payload, bool is_payload_copied, uint32_t offset, uint32_t size
+);
+static uint8_t* frame__write_u16(uint8_t* cur, uint16_t value);
+static uint16_t frame__read_u16(const uint8_t* cur);
+
+static tp_message_t* frame_packer__datagram_with_room(frame_packer_t* self, uint32_t frame_size, network_addr_t addr) {
+    if (self->datagrams_fill > 0) {
+        tp_message_t* datagram = &self->datagrams[self->datagrams_fill - 1];
+        if (!datagram->iovs && datagram->data_size + frame_size <= self->mtu && network_addr__is_same(&datagram->addr, &addr)) {
+            return datagram;
+        }
+    }
+
+    return frame_packer__datagram_new(self, addr);
+}
+
+static tp_message_t* frame_packer__datagram_new(frame_packer_t* self, network_addr_t addr) {
+    if (self->datagrams_fill == self->datagrams_size) {
+        return 0;
+    }
+
+    tp_message_t* datagram = &self->datagrams[self->datagrams_fill];
+    memset(datagram, 0, sizeof(*datagram));
+    datagram->data = self->buffer + self->datagrams_fill * self->mtu;
+    datagram->addr = addr;
+    ++self->datagrams_fill;
+
+    return datagram;
+}
+
+static void frame_packer__write_shared(
+    frame_packer_t* self, tp_message_t* datagram, const uint8_t* frame_header, uint32_t frame_header_size,
+    const uint8_t* header, uint32_t header_size, packet_buffer_t* payload, bool is_payload_copied, uint32_t offset, uint32_t size
+) {
+    assert(datagram->data_size == 0);
+    uint8_t* cur = datagram->data;
+    memcpy(cur, frame_header, frame_header_size);
+    cur += frame_header_size;
+    if (offset < header_size) {
+        const uint32_t header_slice_size = header_size - offset < size ? header_size - offset : size;
+        memcpy(cur, header + offset, header_slice_size);
+        cur    += header_slice_size;
+        offset += header_slice_size;
+        size   -= header_slice_size;
+    }
+    const uint8_t* payload_slice = payload->data + (offset - header_size);
+    if (is_payload_copied) {
+        memcpy(cur, payload_slice, size);
+        cur += size;
+        size = 0;
+    }
+    datagram->data_size = (uint32_t) (cur - (uint8_t*) datagram->data);
+    if (size == 0) {
+        return ;
+    }
+
+    struct iovec* iovs = &self->iovs[(datagram - self->datagrams) * TP_MESSAGE_IOVS_MAX];
+    iovs[0].iov_base = datagram->data;
+    iovs[0].iov_len  = datagram->data_size;
+    iovs[1].iov_base = (void*) payload_slice;
+    iovs[1].iov_len  = size;
+    datagram->iovs       = iovs;
+    datagram->iovs_fill  = 2;
+    datagram->data_size += size;
+
+    packet_buffer__retain(payload);
+    self->shared[self->shared_fill++] = payload;
+}
+
+static uint8_t* frame__write_u16(uint8_t* cur, uint16_t value) {
+    cur[0] = (uint8_t) value;
+    cur[1] = (uint8_t) (value >> 8);
+
+    return cur + 2;
+}
+
+static uint16_t frame__read_u16(const uint8_t* cur) {
+    return (uint16_t) (cur[0] | (cur[1] << 8));
+}
+
+void frame_packer__create(frame_packer_t* self, tp_message_t* datagrams, uint8_t* buffer, uint32_t datagrams_size, uint32_t mtu) {
+    assert(mtu >= FRAME_MTU_MIN && mtu <= FRAME_MTU_MAX);
+    memset(self, 0, sizeof(*self));
+    self->datagrams      = datagrams;
+    self->buffer         = buffer;
+    self->datagrams_size = datagrams_size;
+    self->mtu            = mtu;
+}
+
+void frame_packer__set_shared_memory(frame_packer_t* self, struct iovec* iovs, packet_buffer_t** shared) {
+    self->iovs        = iovs;
+    self->shared      = shared;
+    self->shared_fill = 0;
+}
+
+bool frame_packer__push(frame_packer_t* self, const void* message, uint32_t message_size, network_addr_t addr) {
+    const uint32_t frame_size = FRAME_HEADER_SIZE + message_size;
+    if (frame_size <= self->mtu) {
+        tp_message_t* datagram = frame_packer__datagram_with_room(self, frame_size, addr);
+        if (!datagram) {
+            return false;
+        }
+
+        uint8_t* cur = (uint8_t*) datagram->data + datagram->data_size;
+        cur = frame__write_u16(cur, (uint16_t) (message_size << 1));
+        memcpy(cur, message, message_size);
+        datagram->data_size += frame_size;
+
+        return true;
+    }
+
+    const uint32_t fragment_size  = self->mtu - FRAME_FRAGMENT_HEADER_SIZE;
+    const uint32_t fragments_size = (message_size + fragment_size - 1) / fragment_size;
+    // note: all or nothing, a message with a fragment left out would be lost anyway
+    if (fragments_size > FRAME_FRAGMENTS_MAX || self->datagrams_fill + fragments_size > self->datagrams_size) {
+        return false;
+    }
+
+    const uint16_t message_id = self->message_id++;
+    const uint8_t* message_cur = message;
+    for (uint32_t fragment_index = 0; fragment_index < fragments_size; ++fragment_index) {
+        const uint32_t payload_size = fragment_index + 1 < fragments_size ? fragment_size : message_size - fragment_index * fragment_size;
+        // note: the fragments but the last fill a datagram, so they always start a new one
+        tp_message_t* datagram = frame_packer__datagram_with_room(self, FRAME_FRAGMENT_HEADER_SIZE + payload_size, addr);
+        assert(datagram);
+
+        uint8_t* cur = (uint8_t*) datagram->data + datagram->data_size;
+        cur = frame__write_u16(cur, (uint16_t) ((payload_size << 1) | 1));
+        cur = frame__write_u16(cur, message_id);
+        *cur++ = (uint8_t) fragment_index;
+        *cur++ = (uint8_t) fragments_size;
+        cur = frame__write_u16(cur, (uint16_t) fragment_size);
+        memcpy(cur, message_cur, payload_size);
+        message_cur += payload_size;
+        datagram->data_size += FRAME_FRAGMENT_HEADER_SIZE + payload_size;
+    }
+
+    return true;
+}
+
+bool frame_packer__push_shared(frame_packer_t* self, const void* header, uint32_t header_size, packet_buffer_t* payload, network_addr_t addr) {
+    assert(self->iovs && self->shared);
+    const uint32_t message_size      = header_size + payload->data_len;
+    const bool     is_payload_copied = payload->data_len < FRAME_SHARED_SIZE_MIN;
+    uint8_t        frame_header[FRAME_FRAGMENT_HEADER_SIZE];
+    if (FRAME_HEADER_SIZE + message_size <= self->mtu) {
+        tp_message_t* datagram = frame_packer__datagram_new(self, addr);
+        if (!datagram) {
+            return false;
+        }
+
+        frame__write_u16(frame_header, (uint16_t) (message_size << 1));
+        frame_packer__write_shared(self, datagram, frame_header, FRAME_HEADER_SIZE, header, header_size, payload, is_payload_copied, 0, message_size);
+
+        return true;
+    }
+
+    const uint32_t fragment_size  = self->mtu - FRAME_FRAGMENT_HEADER_SIZE;
+    const uint32_t fragments_size = (message_size + fragment_size - 1) / fragment_size;
+    if (fragments_size > FRAME_FRAGMENTS_MAX || self->datagrams_fill + fragments_size > self->datagrams_size) {
+        return false;
+    }
+
+    const uint16_t message_id = self->message_id++;
+    for (uint32_t fragment_index = 0; fragment_index < fragments_size; ++fragment_index) {
+        const uint32_t payload_size = fragment_index + 1 < fragments_size ? fragment_size : message_size - fragment_index * fragment_size;
+        tp_message_t* datagram = frame_packer__datagram_new(self, addr);
+        assert(datagram);
+
+        uint8_t* cur = frame_header;
+        cur = frame__write_u16(cur, (uint16_t) ((payload_size << 1) | 1));
+        cur = frame__write_u16(cur, message_id);
+        *cur++ = (uint8_t) fragment_index;
+        *cur++ = (uint8_t) fragments_size;
+        frame__write_u16(cur, (uint16_t) fragment_size);
+        frame_packer__write_shared(
+            self, datagram, frame_header, FRAME_FRAGMENT_HEADER_SIZE,
+            header, header_size, payload, is_payload_copied, fragment_index * fragment_size, payload_size
+        );
+    }
+
+    return true;
+}
+
+void frame_packer__clear(frame_packer_t* self) {
+    for (uint32_t shared_index = 0; shared_index < self->shared_fill; ++shared_index) {
+        packet_buffer__release(self->shared[shared_index]);
+    }
+    self->shared_fill    = 0;
+    self->datagrams_fill = 0;
+}
+
+void frame_unpacker__create(frame_unpacker_t* self, const void* datagram, uint32_t datagram_len) {
+    self->cur   = datagram;
+    self->end   = self->cur + datagram_len;
+    self->error = false;
+}
+
+bool frame_unpacker__next(frame_unpacker_t* self, frame_reassembler_t* reassembler, const void** message, uint32_t* message_size) {
+    while (self->cur < self->end) {
+        const uint64_t bytes_left = (uint64_t) (self->end - self->cur);
+        if (bytes_left < FRAME_HEADER_SIZE) {
+            self->error = true;
+            return false;
+        }
+
+        const uint16_t header       = frame__read_u16(self->cur);
+        const bool     is_fragment  = header & 1;
+        const uint32_t payload_size = header >> 1;
+        const uint32_t header_size  = is_fragment ? FRAME_FRAGMENT_HEADER_SIZE : FRAME_HEADER_SIZE;
+        if (bytes_left < header_size || bytes_left - header_size < payload_size) {
+            self->error = true;
+            return false;
+        }
+
+        const uint8_t* frame = self->cur;
+        const uint8_t* payload = frame + header_size;
+        self->cur = payload + payload_size;
+        if (!is_fragment) {
+            *message      = payload;
+            *message_size = payload_size;
+            return true;
+        }
+
+        if (
+            reassembler &&
+            frame_reassembler__add(
+                reassembler, frame__read_u16(frame + 2), frame[4], frame[5], frame__read_u16(frame + 6),
+                payload, payload_size, message, message_size
+            )
+        ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+uint64_t frame_reassembler__memory_size(uint32_t reassemblies_size, uint32_t message_size_max) {
+    return (uint64_t) reassemblies_size * (sizeof(frame_reassembly_t) + message_size_max);
+}
+
+bool frame_reassembler__create(frame_reassembler_t* self, void* memory, uint64_t memory_size, uint32_t reassemblies_size, uint32_t message_size_max) {
+    if (reassemblies_size == 0 || memory_size < frame_reassembler__memory_size(reassemblies_size, message_size_max)) {
+        return false;
+    }
+
+    memset(self, 0, sizeof(*self));
+    self->reassemblies      = memory;
+    self->reassemblies_size = reassemblies_size;
+    self->message_size_max  = message_size_max;
+    // note: the messages follow the reassemblies, so the reassemblies keep the alignment of 'memory'
+    uint8_t* messages = (uint8_t*) (self->reassemblies + reassemblies_size);
+    for (uint32_t reassembly_index = 0; reassembly_index < reassemblies_size; ++reassembly_index) {
+        frame_reassembly_t* reassembly = &self->reassemblies[reassembly_index];
+        memset(reassembly, 0, sizeof(*reassembly));
+        reassembly->message = messages + (uint64_t) reassembly_index * message_size_max;
+    }
+
+    return true;
+}
+
+bool frame_reassembler__add(
+    frame_reassembler_t* self, uint16_t message_id, uint8_t fragment_index, uint8_t fragments_size, uint16_t fragment_size,
+    const void* payload, uint32_t payload_size, const void** message, uint32_t* message_size
+) {
+    const bool is_last = fragment_index + 1 == fragments_size;
+    if (
+        fragments_size == 0 || fragments_size > FRAME_FRAGMENTS_MAX || fragment_index >= fragments_size || fragment_size == 0 ||
+        (is_last ? payload_size == 0 || payload_size > fragment_size : payload_size != fragment_size) ||
+        (uint64_t) fragment_index * fragment_size + payload_size > self->message_size_max
+    ) {
+        ++self->fragments_dropped;
+        return false;
+    }
+
+    frame_reassembly_t* reassembly = 0;
+    frame_reassembly_t* reassembly_oldest = 0;
+    frame_reassembly_t* reassembly_free = 0;
+    for (uint32_t reassembly_index = 0; reassembly_index < self->reassemblies_size; ++reassembly_index) {
+        frame_reassembly_t* cur = &self->reassemblies[reassembly_index];
+        if (!cur->is_used) {
+            reassembly_free = reassembly_free ? reassembly_free : cur;
+        } else if (cur->message_id == message_id) {
+            reassembly = cur;
+            break ;
+        } else if (!reassembly_oldest || cur->age < reassembly_oldest->age) {
+            reassembly_oldest = cur;
+        }
+    }
+
+    if (!reassembly) {
+        if (reassembly_free) {
+            reassembly = reassembly_free;
+        } else {
+            reassembly = reassembly_oldest;
+            ++self->messages_evicted;
+        }
+        reassembly->fragments_received = 0;
+        reassembly->age                = self->age++;
+        reassembly->message_size       = 0;
+        reassembly->fragment_size      = fragment_size;
+        reassembly->message_id         = message_id;
+        reassembly->fragments_size     = fragments_size;
+        reassembly->is_used            = true;
+    } else if (reassembly->fragments_size != fragments_size || reassembly->fragment_size != fragment_size) {
+        ++self->fragments_dropped;
+        return false;
+    }
+
+    const uint64_t fragment_bit = (uint64_t) 1 << fragment_index;
+    if (reassembly->fragments_received & fragment_bit) {
+        // note: duplicate
+        return false;
+    }
+    memcpy(reassembly->message + (uint32_t) fragment_index * fragment_size, payload, payload_size);
+    reassembly->fragments_received |= fragment_bit;
+    if (is_last) {
+        reassembly->message_size = (uint32_t) fragment_index * fragment_size + payload_size;
+    }
+
+    // note: shifting by the width of the type is undefined
+    const uint64_t fragments_all = fragments_size == 64 ? (uint64_t) -1 : ((uint64_t) 1 << fragments_size) - 1;
+    if (reassembly->fragments_received != fragments_all) {
+        return false;
+    }
+
+    // note: the message stays intact until the reassembly is reused, which is after the caller is done with it
+    reassembly->is_used = false;
+    *message      = reassembly->message;
+    *message_size = reassembly->message_size;
+
+    return true;
+}
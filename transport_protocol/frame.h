@@ -0,0 +1,153 @@
+#ifndef FRAME_H
+# define FRAME_H
+
+# include "tp.h"
+# include "packet_pool.h"
+
+# include <stdint.h>
+# include <stdbool.h>
+
+struct         frame_packer;
+struct         frame_unpacker;
+struct         frame_reassembly;
+struct         frame_reassembler;
+typedef struct frame_packer      frame_packer_t;
+typedef struct frame_unpacker    frame_unpacker_t;
+typedef struct frame_reassembly  frame_reassembly_t;
+typedef struct frame_reassembler frame_reassembler_t;
+
+/**
+ * Framing of messages into datagrams, several small messages share a datagram and large ones are split across datagrams
+ *
+ * A datagram is a sequence of frames, each starts with a little endian uint16_t:
+ *   bit 0:     1 if the payload is a fragment of a message, 0 if it's a whole message
+ *   bits 1-15: size of the payload
+ * A fragment continues with:
+ *   uint16_t message_id, uint8_t fragment_index, uint8_t fragments_size, uint16_t fragment_size
+ * Every fragment but the last has exactly 'fragment_size' bytes of payload, so its offset is fragment_index * fragment_size
+ * A message is lost if any of its fragments is lost
+*/
+# define FRAME_HEADER_SIZE          2
+# define FRAME_FRAGMENT_HEADER_SIZE (FRAME_HEADER_SIZE + 6)
+# define FRAME_FRAGMENTS_MAX        64
+//! @note Leaves room for the ip and udp headers, and some tunneling, on a 1500 bytes ethernet link
+# define FRAME_MTU_DEFAULT          1200
+//! @note 1500 bytes ethernet frame without the ipv4 and udp headers
+# define FRAME_MTU_MAX              1472
+# define FRAME_MTU_MIN              64
+//! @brief Largest message that can be sent with 'mtu'
+# define FRAME_MESSAGE_SIZE_MAX(mtu) (FRAME_FRAGMENTS_MAX * ((mtu) - FRAME_FRAGMENT_HEADER_SIZE))
+//! @note Shared payloads smaller than this are copied, an iovec costs the kernel about as much
+# define FRAME_SHARED_SIZE_MIN       128
+
+/**
+ * Packs messages into datagrams of at most 'mtu' bytes, ready to be sent with tp_socket__send_data_batch
+ * A message is appended to the last datagram if it's to the same destination and fits, otherwise it starts a new one
+ * Messages larger than a datagram are fragmented, each fragment but the last fills a whole datagram
+ * A shared payload is not copied, the datagrams gather it from its buffer, see frame_packer__push_shared
+*/
+struct frame_packer {
+    tp_message_t*     datagrams;
+    //! @note datagrams_size * mtu bytes, the datagrams are laid out at a stride of 'mtu'
+    uint8_t*          buffer;
+    uint32_t          datagrams_size;
+    uint32_t          datagrams_fill;
+    uint32_t          mtu;
+    uint16_t          message_id;
+    //! @note Set by frame_packer__set_shared_memory, datagrams_size * TP_MESSAGE_IOVS_MAX of them
+    struct iovec*     iovs;
+    //! @note A reference for every datagram that gathers a shared payload, released on clear, datagrams_size of them
+    packet_buffer_t** shared;
+    uint32_t          shared_fill;
+};
+
+//! @brief Walks the frames of a received datagram
+struct frame_unpacker {
+    const uint8_t* cur;
+    const uint8_t* end;
+    //! @note Set if the datagram is malformed, the messages before the malformed frame were returned already
+    bool           error;
+};
+
+struct frame_reassembly {
+    uint8_t* message;
+    //! @note A bit is set for each fragment received
+    uint64_t fragments_received;
+    //! @note Value of the reassembler's counter when it was started, the oldest one is evicted first
+    uint64_t age;
+    //! @note 0 until the last fragment is received
+    uint32_t message_size;
+    uint16_t fragment_size;
+    uint16_t message_id;
+    uint8_t  fragments_size;
+    bool     is_used;
+};
+
+/**
+ * Collects fragments until their message is complete, in a fixed amount of memory
+ * Once every reassembly is in use, starting a new one evicts the oldest, which is how messages with a lost fragment go away
+*/
+struct frame_reassembler {
+    frame_reassembly_t* reassemblies;
+    uint32_t            reassemblies_size;
+    uint32_t            message_size_max;
+    uint64_t            age;
+    //! @note Incomplete messages that were evicted
+    uint32_t            messages_evicted;
+    //! @note Fragments that were malformed, inconsistent with their message or too large
+    uint32_t            fragments_dropped;
+};
+
+/**
+ * @param datagrams at least 'datagrams_size' of them
+ * @param buffer at least datagrams_size * mtu bytes
+ * @param mtu in [FRAME_MTU_MIN, FRAME_MTU_MAX]
+*/
+void frame_packer__create(frame_packer_t* self, tp_message_t* datagrams, uint8_t* buffer, uint32_t datagrams_size, uint32_t mtu);
+/**
+ * @brief Memory that frame_packer__push_shared needs
+ * @param iovs at least datagrams_size * TP_MESSAGE_IOVS_MAX
+ * @param shared at least datagrams_size
+*/
+void frame_packer__set_shared_memory(frame_packer_t* self, struct iovec* iovs, packet_buffer_t** shared);
+/**
+ * @brief Appends 'message' to the datagrams going to 'addr'
+ * @returns false if there are not enough datagrams left for it or it's larger than FRAME_MESSAGE_SIZE_MAX(mtu), nothing is appended then
+*/
+bool frame_packer__push(frame_packer_t* self, const void* message, uint32_t message_size, network_addr_t addr);
+/**
+ * @brief Appends the message 'header' followed by the first 'data_len' bytes of 'payload' to the datagrams going to 'addr'
+ * 'header' is copied, 'payload' is referenced by every datagram that carries a part of it and retained until frame_packer__clear,
+ * so one payload, like a snapshot, can be encoded once and sent to many destinations without being copied
+ * @note Starts a new datagram, nothing is appended to it afterwards
+ * @returns false in the same cases as frame_packer__push, nothing is appended then
+*/
+bool frame_packer__push_shared(frame_packer_t* self, const void* header, uint32_t header_size, packet_buffer_t* payload, network_addr_t addr);
+//! @brief Drops the datagrams and their references to the shared payloads, call once they are sent
+void frame_packer__clear(frame_packer_t* self);
+
+void frame_unpacker__create(frame_unpacker_t* self, const void* datagram, uint32_t datagram_len);
+/**
+ * @brief Moves to the next whole message of the datagram, fragments are handed to 'reassembler' until their message is complete
+ * @param reassembler can be null, fragments are skipped then
+ * @note 'message' is valid until the next call
+ * @returns false once there are no more messages in the datagram
+*/
+bool frame_unpacker__next(frame_unpacker_t* self, frame_reassembler_t* reassembler, const void** message, uint32_t* message_size);
+
+//! @returns Memory needed by frame_reassembler__create
+uint64_t frame_reassembler__memory_size(uint32_t reassemblies_size, uint32_t message_size_max);
+/**
+ * @param reassemblies_size number of messages that can be reassembled at the same time
+ * @param message_size_max fragments past this are dropped
+*/
+bool frame_reassembler__create(frame_reassembler_t* self, void* memory, uint64_t memory_size, uint32_t reassemblies_size, uint32_t message_size_max);
+/**
+ * @returns true if the fragment completed its message, it's returned in 'message' and 'message_size' then
+*/
+bool frame_reassembler__add(
+    frame_reassembler_t* self, uint16_t message_id, uint8_t fragment_index, uint8_t fragments_size, uint16_t fragment_size,
+    const void* payload, uint32_t payload_size, const void** message, uint32_t* message_size
+);
+
+#endif // FRAME_H
@@ -0,0 +1,231 @@
+#include "frame.h"
+
+#include "debug.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MESSAGES          16
+#define DATAGRAMS         (MESSAGES * FRAME_FRAGMENTS_MAX)
+#define MESSAGE_SIZE_MAX  FRAME_MESSAGE_SIZE_MAX(FRAME_MTU_MAX)
+#define REASSEMBLIES_SIZE MESSAGES
+
+static tp_message_t datagrams[DATAGRAMS];
+static uint8_t      datagrams_buffer[DATAGRAMS * FRAME_MTU_MAX];
+static uint8_t      reassembler_memory[REASSEMBLIES_SIZE * (sizeof(frame_reassembly_t) + MESSAGE_SIZE_MAX)];
+static uint8_t      message[MESSAGE_SIZE_MAX];
+
+// the message is its index followed by bytes derived from it, so a message is recognized by its content
+static void message__fill(uint8_t* message, uint32_t message_size, uint32_t message_index) {
+    for (uint32_t byte_index = 0; byte_index < message_size; ++byte_index) {
+        message[byte_index] = byte_index < 4 ? (uint8_t) (message_index >> (8 * byte_index)) : (uint8_t) (message_index * 31 + byte_index * 7);
+    }
+}
+
+static uint32_t random_message_size(uint32_t mtu) {
+    const int kind = rand() % 8;
+    if (kind < 4) {
+        return 4 + (uint32_t) rand() % 60;
+    }
+    if (kind < 7) {
+        // around a datagram, the edges of fragmenting
+        return mtu - 16 + (uint32_t) rand() % 32;
+    }
+    return 4 + (uint32_t) rand() % (FRAME_MESSAGE_SIZE_MAX(mtu) - 3);
+}
+
+int main() {
+    if (!debug__init_module()) {
+        return 1;
+    }
+
+    network_addr_t addr;
+    memset(&addr, 0, sizeof(addr));
+    frame_reassembler_t reassembler;
+    uint32_t errors = 0;
+    uint32_t messages_received = 0;
+
+    srand(1);
+    for (uint32_t round = 0; round < 2000; ++round) {
+        const uint32_t mtu = rand() % 2 ? FRAME_MTU_DEFAULT : FRAME_MTU_MIN + (uint32_t) rand() % (FRAME_MTU_MAX - FRAME_MTU_MIN + 1);
+        frame_packer_t packer;
+        frame_packer__create(&packer, datagrams, datagrams_buffer, DATAGRAMS, mtu);
+        frame_reassembler__create(&reassembler, reassembler_memory, sizeof(reassembler_memory), REASSEMBLIES_SIZE, FRAME_MESSAGE_SIZE_MAX(mtu));
+
+        // the datagrams every message ended up in
+        uint32_t message_sizes[MESSAGES];
+        uint32_t message_first[MESSAGES];
+        uint32_t message_last[MESSAGES];
+        const uint32_t messages_size = 1 + (uint32_t) rand() % MESSAGES;
+        for (uint32_t message_index = 0; message_index < messages_size; ++message_index) {
+            const uint32_t datagrams_fill = packer.datagrams_fill;
+            message_sizes[message_index] = random_message_size(mtu);
+            message__fill(message, message_sizes[message_index], message_index);
+            if (!frame_packer__push(&packer, message, message_sizes[message_index], addr)) {
+                printf("round %u, mtu %u: failed to push %u bytes\n", round, mtu, message_sizes[message_index]);
+                ++errors;
+                message_sizes[message_index] = 0;
+                continue ;
+            }
+            message_first[message_index] = packer.datagrams_fill == datagrams_fill ? datagrams_fill - 1 : datagrams_fill;
+            message_last[message_index]  = packer.datagrams_fill - 1;
+        }
+
+        // drops some datagrams and shuffles the rest
+        bool     is_dropped[DATAGRAMS] = { 0 };
+        uint32_t order[DATAGRAMS];
+        const int drop_chance = rand() % 4 == 0 ? 0 : 1 + rand() % 20;
+        for (uint32_t datagram_index = 0; datagram_index < packer.datagrams_fill; ++datagram_index) {
+            if (packer.datagrams[datagram_index].data_size > mtu) {
+                printf("round %u: datagram of %u bytes, mtu %u\n", round, packer.datagrams[datagram_index].data_size, mtu);
+                ++errors;
+            }
+            is_dropped[datagram_index] = drop_chance && rand() % 100 < drop_chance;
+            order[datagram_index] = datagram_index;
+        }
+        for (uint32_t datagram_index = packer.datagrams_fill; datagram_index > 1; --datagram_index) {
+            const uint32_t swap_index = (uint32_t) rand() % datagram_index;
+            const uint32_t tmp = order[datagram_index - 1];
+            order[datagram_index - 1] = order[swap_index];
+            order[swap_index] = tmp;
+        }
+
+        uint32_t times_received[MESSAGES] = { 0 };
+        for (uint32_t order_index = 0; order_index < packer.datagrams_fill; ++order_index) {
+            if (is_dropped[order[order_index]]) {
+                continue ;
+            }
+            const tp_message_t* datagram = &packer.datagrams[order[order_index]];
+            frame_unpacker_t unpacker;
+            frame_unpacker__create(&unpacker, datagram->data, datagram->data_size);
+            const void* received;
+            uint32_t received_size;
+            while (frame_unpacker__next(&unpacker, &reassembler, &received, &received_size)) {
+                uint32_t message_index = MESSAGES;
+                if (received_size >= 4) {
+                    memcpy(&message_index, received, 4);
+                }
+                if (message_index >= messages_size || received_size != message_sizes[message_index]) {
+                    printf("round %u: received an unknown message of %u bytes\n", round, received_size);
+                    ++errors;
+                    continue ;
+                }
+                message__fill(message, received_size, message_index);
+                if (memcmp(received, message, received_size) != 0) {
+                    printf("round %u: message %u of %u bytes is corrupt\n", round, message_index, received_size);
+                    ++errors;
+                }
+                ++times_received[message_index];
+                ++messages_received;
+            }
+            if (unpacker.error) {
+                printf("round %u: datagram %u is malformed\n", round, order[order_index]);
+                ++errors;
+            }
+        }
+
+        for (uint32_t message_index = 0; message_index < messages_size; ++message_index) {
+            if (message_sizes[message_index] == 0) {
+                continue ;
+            }
+            bool is_complete = true;
+            for (uint32_t datagram_index = message_first[message_index]; datagram_index <= message_last[message_index]; ++datagram_index) {
+                is_complete = is_complete && !is_dropped[datagram_index];
+            }
+            if (times_received[message_index] != (uint32_t) is_complete) {
+                printf("round %u: message %u of %u bytes received %u times\n", round, message_index, message_sizes[message_index], times_received[message_index]);
+                ++errors;
+            }
+        }
+        if (reassembler.fragments_dropped != 0) {
+            printf("round %u: %u well formed fragments were dropped\n", round, reassembler.fragments_dropped);
+            ++errors;
+        }
+
+        // the same datagrams with bytes flipped and cut short, whatever comes out has to stay within its buffers
+        for (uint32_t datagram_index = 0; datagram_index < packer.datagrams_fill; ++datagram_index) {
+            const tp_message_t* datagram = &packer.datagrams[datagram_index];
+            uint32_t data_size = datagram->data_size;
+            if (rand() % 4 == 0) {
+                data_size = (uint32_t) rand() % (data_size + 1);
+            }
+            // note: a buffer of its own, so reading past it is caught by a sanitizer
+            uint8_t* data = malloc(data_size + 1);
+            memcpy(data, datagram->data, data_size);
+            for (int flips = rand() % 4; flips > 0 && data_size > 0; --flips) {
+                data[(uint32_t) rand() % (data_size < 16 ? data_size : 16)] ^= (uint8_t) (1 << (rand() % 8));
+            }
+            frame_unpacker_t unpacker;
+            frame_unpacker__create(&unpacker, data, data_size);
+            const void* received;
+            uint32_t received_size;
+            uint32_t messages_unpacked = 0;
+            while (frame_unpacker__next(&unpacker, &reassembler, &received, &received_size)) {
+                const uint8_t* received_begin = received;
+                const bool is_in_datagram = received_begin >= data && received_begin + received_size <= data + data_size;
+                const bool is_in_reassembler =
+                    received_begin >= reassembler_memory && received_begin + received_size <= reassembler_memory + sizeof(reassembler_memory) &&
+                    received_size <= reassembler.message_size_max;
+                if (!is_in_datagram && !is_in_reassembler) {
+                    printf("round %u: a malformed datagram gave a message outside of its buffers\n", round);
+                    ++errors;
+                }
+                if (++messages_unpacked > data_size) {
+                    printf("round %u: a malformed datagram of %u bytes doesn't end\n", round, data_size);
+                    ++errors;
+                    break ;
+                }
+            }
+            free(data);
+        }
+    }
+
+    // fragments that contradict themselves or their message are dropped
+    frame_reassembler__create(&reassembler, reassembler_memory, sizeof(reassembler_memory), REASSEMBLIES_SIZE, 1000);
+    const struct {
+        uint8_t  fragment_index;
+        uint8_t  fragments_size;
+        uint16_t fragment_size;
+        uint32_t payload_size;
+    } fragments_malformed[] = {
+        { 0, 0, 100, 100 },
+        { 0, FRAME_FRAGMENTS_MAX + 1, 10, 10 },
+        { 3, 3, 100, 50 },
+        { 0, 2, 0, 0 },
+        { 0, 2, 100, 99 },
+        { 1, 2, 100, 0 },
+        { 1, 2, 100, 101 },
+        { 10, 11, 100, 100 },
+        { 250, 255, 4, 4 }
+    };
+    const uint32_t fragments_malformed_size = sizeof(fragments_malformed) / sizeof(fragments_malformed[0]);
+    memset(message, 0, sizeof(message));
+    for (uint32_t fragment_index = 0; fragment_index < fragments_malformed_size; ++fragment_index) {
+        const void* received;
+        uint32_t received_size;
+        if (
+            frame_reassembler__add(
+                &reassembler, (uint16_t) fragment_index, fragments_malformed[fragment_index].fragment_index, fragments_malformed[fragment_index].fragments_size,
+                fragments_malformed[fragment_index].fragment_size, message, fragments_malformed[fragment_index].payload_size, &received, &received_size
+            ) ||
+            reassembler.fragments_dropped != fragment_index + 1
+        ) {
+            printf("malformed fragment %u was accepted\n", fragment_index);
+            ++errors;
+        }
+    }
+    // a fragment size that differs from the one the message started with
+    const void* received;
+    uint32_t received_size;
+    frame_reassembler__add(&reassembler, 1000, 0, 3, 100, message, 100, &received, &received_size);
+    if (frame_reassembler__add(&reassembler, 1000, 1, 3, 90, message, 90, &received, &received_size) || reassembler.fragments_dropped != fragments_malformed_size + 1) {
+        printf("a fragment inconsistent with its message was accepted\n");
+        ++errors;
+    }
+
+    printf("messages received: %u, errors: %u\n", messages_received, errors);
+
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+#include "interest_grid.h"
+
+#include "memory.h"
+#include "debug.h"
+
+#include <math.h>
+#include <string.h>
+
+static int32_t interest_grid__cell(const interest_grid_t* self, float coordinate);
+static uint32_t interest_grid__bucket(const interest_grid_t* self, int32_t cell_x, int32_t cell_z);
+static void interest_grid__link(interest_grid_t* self, uint32_t object_index, uint32_t bucket);
+static void interest_grid__unlink(interest_grid_t* self, uint32_t object_index);
+
+static int32_t interest_grid__cell(const interest_grid_t* self, float coordinate) {
+    return (int32_t) floorf(coordinate / self->cell_size);
+}
+
+static uint32_t interest_grid__bucket(const interest_grid_t* self, int32_t cell_x, int32_t cell_z) {
+    return (((uint32_t) cell_x * 73856093u) ^ ((uint32_t) cell_z * 19349663u)) & (self->buckets_size - 1);
+}
+
+static void interest_grid__link(interest_grid_t* self, uint32_t object_index, uint32_t bucket) {
+    const uint32_t first = self->bucket_first[bucket];
+    self->object_bucket[object_index] = bucket;
+    self->object_prev[object_index]   = INTEREST_GRID_NONE;
+    self->object_next[object_index]   = first;
+    if (first != INTEREST_GRID_NONE) {
+        self->object_prev[first] = object_index;
+    }
+    self->bucket_first[bucket] = object_index;
+}
+
+static void interest_grid__unlink(interest_grid_t* self, uint32_t object_index) {
+    const uint32_t prev = self->object_prev[object_index];
+    const uint32_t next = self->object_next[object_index];
+    if (prev != INTEREST_GRID_NONE) {
+        self->object_next[prev] = next;
+    } else {
+        self->bucket_first[self->object_bucket[object_index]] = next;
+    }
+    if (next != INTEREST_GRID_NONE) {
+        self->object_prev[next] = prev;
+    }
+    self->object_bucket[object_index] = INTEREST_GRID_NONE;
+}
+
+bool interest_grid__create(interest_grid_t* self, float cell_size, uint32_t objects_size) {
+    memset(self, 0, sizeof(*self));
+
+    if (!(cell_size > 0.0f)) {
+        return false;
+    }
+    self->cell_size = cell_size;
+    // note: twice the objects, so most of them have a bucket of their own
+    self->buckets_size = 16;
+    while (self->buckets_size < 2 * objects_size) {
+        self->buckets_size <<= 1;
+    }
+
+    self->bucket_first  = memory__malloc(DEBUG_MODULE_TP, self->buckets_size * sizeof(*self->bucket_first));
+    self->object_bucket = memory__malloc(DEBUG_MODULE_TP, objects_size * sizeof(*self->object_bucket));
+    self->object_next   = memory__malloc(DEBUG_MODULE_TP, objects_size * sizeof(*self->object_next));
+    self->object_prev   = memory__malloc(DEBUG_MODULE_TP, objects_size * sizeof(*self->object_prev));
+    self->object_x      = memory__malloc(DEBUG_MODULE_TP, objects_size * sizeof(*self->object_x));
+    self->object_z      = memory__malloc(DEBUG_MODULE_TP, objects_size * sizeof(*self->object_z));
+    if (
+        !self->bucket_first || !self->object_bucket || !self->object_next ||
+        !self->object_prev || !self->object_x || !self->object_z
+    ) {
+        interest_grid__destroy(self);
+        return false;
+    }
+    self->objects_size = objects_size;
+    for (uint32_t bucket = 0; bucket < self->buckets_size; ++bucket) {
+        self->bucket_first[bucket] = INTEREST_GRID_NONE;
+    }
+    for (uint32_t object_index = 0; object_index < objects_size; ++object_index) {
+        self->object_bucket[object_index] = INTEREST_GRID_NONE;
+    }
+
+    return true;
+}
+
+void interest_grid__destroy(interest_grid_t* self) {
+    memory__free(DEBUG_MODULE_TP, self->bucket_first);
+    memory__free(DEBUG_MODULE_TP, self->object_bucket);
+    memory__free(DEBUG_MODULE_TP, self->object_next);
+    memory__free(DEBUG_MODULE_TP, self->object_prev);
+    memory__free(DEBUG_MODULE_TP, self->object_x);
+    memory__free(DEBUG_MODULE_TP, self->object_z);
+    memset(self, 0, sizeof(*self));
+}
+
+void interest_grid__update(interest_grid_t* self, const object_state_t* objects, uint32_t objects_fill) {
+    ASSERT(objects_fill <= self->objects_size);
+
+    for (uint32_t object_index = 0; object_index < objects_fill; ++object_index) {
+        const float x = objects[object_index].position.x;
+        const float z = objects[object_index].position.z;
+        self->object_x[object_index] = x;
+        self->object_z[object_index] = z;
+        // note: most objects stay in their cell between updates
+        const uint32_t bucket = interest_grid__bucket(self, interest_grid__cell(self, x), interest_grid__cell(self, z));
+        if (bucket == self->object_bucket[object_index]) {
+            continue ;
+        }
+        if (self->object_bucket[object_index] != INTEREST_GRID_NONE) {
+            interest_grid__unlink(self, object_index);
+        }
+        interest_grid__link(self, object_index, bucket);
+    }
+    for (uint32_t object_index = objects_fill; object_index < self->objects_fill; ++object_index) {
+        interest_grid__unlink(self, object_index);
+    }
+    self->objects_fill = objects_fill;
+}
+
+bool interest_set__create(interest_set_t* self, uint32_t objects_size) {
+    memset(self, 0, sizeof(*self));
+
+    self->words_size       = (objects_size + 63) / 64;
+    self->is_relevant      = memory__calloc(DEBUG_MODULE_TP, self->words_size, sizeof(*self->is_relevant));
+    self->is_relevant_next = memory__calloc(DEBUG_MODULE_TP, self->words_size, sizeof(*self->is_relevant_next));
+    if (!self->is_relevant || !self->is_relevant_next) {
+        interest_set__destroy(self);
+        return false;
+    }
+
+    return true;
+}
+
+void interest_set__destroy(interest_set_t* self) {
+    memory__free(DEBUG_MODULE_TP, self->is_relevant);
+    memory__free(DEBUG_MODULE_TP, self->is_relevant_next);
+    memset(self, 0, sizeof(*self));
+}
+
+void interest_grid__query(
+    const interest_grid_t* self, interest_set_t* set, const vec3_t* position, float radius,
+    uint32_t* entered, uint32_t* entered_fill, uint32_t* left, uint32_t* left_fill
+) {
+    ASSERT(set->words_size * 64 >= self->objects_fill);
+
+    uint64_t* is_relevant = set->is_relevant_next;
+    memset(is_relevant, 0, set->words_size * sizeof(*is_relevant));
+
+    const float    radius_squared = radius * radius;
+    const int32_t  cell_x_min = interest_grid__cell(self, position->x - radius);
+    const int32_t  cell_x_max = interest_grid__cell(self, position->x + radius);
+    const int32_t  cell_z_min = interest_grid__cell(self, position->z - radius);
+    const int32_t  cell_z_max = interest_grid__cell(self, position->z + radius);
+    const uint64_t cells_size = (uint64_t) (cell_x_max - cell_x_min + 1) * (uint64_t) (cell_z_max - cell_z_min + 1);
+    if (cells_size >= self->buckets_size) {
+        // note: the area covers every bucket anyway
+        for (uint32_t object_index = 0; object_index < self->objects_fill; ++object_index) {
+            const float x = self->object_x[object_index] - position->x;
+            const float z = self->object_z[object_index] - position->z;
+            if (x * x + z * z <= radius_squared) {
+                is_relevant[object_index >> 6] |= (uint64_t) 1 << (object_index & 63);
+            }
+        }
+    } else {
+        // note: cells that share a bucket are walked twice, setting a bit is idempotent
+        for (int32_t cell_z = cell_z_min; cell_z <= cell_z_max; ++cell_z) {
+            for (int32_t cell_x = cell_x_min; cell_x <= cell_x_max; ++cell_x) {
+                uint32_t object_index = self->bucket_first[interest_grid__bucket(self, cell_x, cell_z)];
+                for (; object_index != INTEREST_GRID_NONE; object_index = self->object_next[object_index]) {
+                    const float x = self->object_x[object_index] - position->x;
+                    const float z = self->object_z[object_index] - position->z;
+                    if (x * x + z * z <= radius_squared) {
+                        is_relevant[object_index >> 6] |= (uint64_t) 1 << (object_index & 63);
+                    }
+                }
+            }
+        }
+    }
+
+    if (entered_fill) {
+        *entered_fill = 0;
+    }
+    if (left_fill) {
+        *left_fill = 0;
+    }
+    for (uint32_t word_index = 0; word_index < set->words_size; ++word_index) {
+        uint64_t entered_bits = is_relevant[word_index] & ~set->is_relevant[word_index];
+        uint64_t left_bits    = set->is_relevant[word_index] & ~is_relevant[word_index];
+        for (; entered && entered_bits; entered_bits &= entered_bits - 1) {
+            entered[(*entered_fill)++] = word_index * 64 + (uint32_t) __builtin_ctzll(entered_bits);
+        }
+        for (; left && left_bits; left_bits &= left_bits - 1) {
+            left[(*left_fill)++] = word_index * 64 + (uint32_t) __builtin_ctzll(left_bits);
+        }
+    }
+
+    set->is_relevant_next = set->is_relevant;
+    set->is_relevant      = is_relevant;
+}
@@ -0,0 +1,80 @@
+#ifndef INTEREST_GRID_H
+# define INTEREST_GRID_H
+
+# include "packet.h"
+
+# include <stdint.h>
+# include <stdbool.h>
+
+struct         interest_grid;
+typedef struct interest_grid interest_grid_t;
+struct         interest_set;
+typedef struct interest_set interest_set_t;
+
+/**
+ * Spatial hash of the objects on the ground plane, x and z, for the objects a client is interested in, the ones around it
+ * Cells are square, hashed into a fixed number of buckets, so the world is unbounded and the memory is set on create
+ * Every bucket is an intrusive list of objects, kept as arrays indexed by object, an object that moves to another cell is relinked in O(1)
+ * Nothing is allocated after create, buckets shared by distant cells only cost time, the distance is checked on query
+*/
+//! @note Sentinel of the lists, no object
+# define INTEREST_GRID_NONE ((uint32_t) -1)
+
+struct interest_grid {
+    float     cell_size;
+    //! @note Power of 2
+    uint32_t  buckets_size;
+    //! @note Indexed by bucket, first object in it
+    uint32_t* bucket_first;
+    //! @note Indexed by object
+    uint32_t* object_bucket;
+    uint32_t* object_next;
+    uint32_t* object_prev;
+    //! @note Indexed by object, copied on update, so queries don't touch the snapshot
+    float*    object_x;
+    float*    object_z;
+    uint32_t  objects_fill;
+    uint32_t  objects_size;
+};
+
+/**
+ * Objects a client is interested in, one bit per object, the difference between two queries are the objects that entered and left
+*/
+struct interest_set {
+    uint64_t* is_relevant;
+    //! @note Scratch for the query
+    uint64_t* is_relevant_next;
+    uint32_t  words_size;
+};
+
+/**
+ * @param cell_size in units, the radius of the queries is best around it, so they span 3 by 3 cells
+ * @param objects_size objects that are ever updated at most
+*/
+bool interest_grid__create(interest_grid_t* self, float cell_size, uint32_t objects_size);
+void interest_grid__destroy(interest_grid_t* self);
+
+/**
+ * @brief Moves the first 'objects_fill' of 'objects' into their cells, the ones past it are removed
+ * @param objects_fill at most objects_size
+*/
+void interest_grid__update(interest_grid_t* self, const object_state_t* objects, uint32_t objects_fill);
+
+bool interest_set__create(interest_set_t* self, uint32_t objects_size);
+void interest_set__destroy(interest_set_t* self);
+
+static inline bool interest_set__is_relevant(const interest_set_t* self, uint32_t object_index) {
+    return (self->is_relevant[object_index >> 6] >> (object_index & 63)) & 1;
+}
+
+/**
+ * @brief Makes the objects within 'radius' of 'position' the relevant ones of 'set'
+ * @param entered if not 0, the objects that weren't relevant before, at least objects_size of them
+ * @param left if not 0, the objects that aren't relevant anymore, at least objects_size of them
+*/
+void interest_grid__query(
+    const interest_grid_t* self, interest_set_t* set, const vec3_t* position, float radius,
+    uint32_t* entered, uint32_t* entered_fill, uint32_t* left, uint32_t* left_fill
+);
+
+#endif // INTEREST_GRID_H
@@ -0,0 +1,109 @@
+#include "interest_grid.h"
+
+#include "debug.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define OBJECTS   512
+#define CELL_SIZE 50.0f
+#define WORLD     460.0f
+
+static float random_float(float range) {
+    return ((float) (rand() % 20001) / 10000.0f - 1.0f) * range;
+}
+
+int main() {
+    if (!debug__init_module()) {
+        return 1;
+    }
+
+    interest_grid_t grid;
+    interest_set_t  set;
+    if (!interest_grid__create(&grid, CELL_SIZE, OBJECTS) || !interest_set__create(&set, OBJECTS)) {
+        printf("failed to create the interest grid\n");
+        return 1;
+    }
+
+    static object_state_t objects[OBJECTS];
+    srand(1);
+    for (uint32_t object_index = 0; object_index < OBJECTS; ++object_index) {
+        objects[object_index].position.x = random_float(WORLD);
+        objects[object_index].position.z = random_float(WORLD);
+    }
+
+    uint32_t objects_fill = OBJECTS;
+    bool     is_relevant_previous[OBJECTS] = { 0 };
+    uint32_t entered[OBJECTS];
+    uint32_t left[OBJECTS];
+    uint32_t errors = 0;
+    for (uint32_t step = 0; step < 20000; ++step) {
+        // the trailing objects come and go
+        if (step % 100 == 0) {
+            objects_fill = 1 + (uint32_t) rand() % OBJECTS;
+        }
+        for (uint32_t object_index = 0; object_index < objects_fill; ++object_index) {
+            object_state_t* object = &objects[object_index];
+            if (rand() % 64 == 0) {
+                object->position.x = CELL_SIZE * (float) (rand() % 16 - 8);
+            } else {
+                object->position.x += random_float(3.0f);
+            }
+            object->position.z += random_float(3.0f);
+        }
+        interest_grid__update(&grid, objects, objects_fill);
+
+        const vec3_t position = {
+            .x = random_float(WORLD + 40.0f),
+            .z = random_float(WORLD + 40.0f)
+        };
+        const int radius_kind = rand() % 8;
+        const float radius = radius_kind == 0 ? 4000.0f : radius_kind == 1 ? 10.0f : 100.0f + random_float(60.0f);
+        uint32_t entered_fill = 0;
+        uint32_t left_fill    = 0;
+        interest_grid__query(&grid, &set, &position, radius, entered, &entered_fill, left, &left_fill);
+
+        bool is_relevant[OBJECTS] = { 0 };
+        uint32_t entered_expected = 0;
+        uint32_t left_expected    = 0;
+        for (uint32_t object_index = 0; object_index < OBJECTS; ++object_index) {
+            if (object_index < objects_fill) {
+                const float x = objects[object_index].position.x - position.x;
+                const float z = objects[object_index].position.z - position.z;
+                is_relevant[object_index] = x * x + z * z <= radius * radius;
+            }
+            if (interest_set__is_relevant(&set, object_index) != is_relevant[object_index]) {
+                printf("step %u, object %u: relevant %d, expected %d\n", step, object_index, interest_set__is_relevant(&set, object_index), is_relevant[object_index]);
+                ++errors;
+            }
+            entered_expected += is_relevant[object_index] && !is_relevant_previous[object_index];
+            left_expected    += !is_relevant[object_index] && is_relevant_previous[object_index];
+        }
+        if (entered_fill != entered_expected || left_fill != left_expected) {
+            printf("step %u: entered %u, left %u, expected %u and %u\n", step, entered_fill, left_fill, entered_expected, left_expected);
+            ++errors;
+        }
+        for (uint32_t entered_index = 0; entered_index < entered_fill; ++entered_index) {
+            if (is_relevant_previous[entered[entered_index]] || !is_relevant[entered[entered_index]]) {
+                printf("step %u: object %u didn't enter\n", step, entered[entered_index]);
+                ++errors;
+            }
+        }
+        for (uint32_t left_index = 0; left_index < left_fill; ++left_index) {
+            if (!is_relevant_previous[left[left_index]] || is_relevant[left[left_index]]) {
+                printf("step %u: object %u didn't leave\n", step, left[left_index]);
+                ++errors;
+            }
+        }
+        memcpy(is_relevant_previous, is_relevant, sizeof(is_relevant));
+    }
+
+    printf("errors: %u\n", errors);
+
+    interest_set__destroy(&set);
+    interest_grid__destroy(&grid);
+
+    return errors == 0 ? 0 : 1;
+}
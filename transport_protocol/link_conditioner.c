@@ -0,0 +1,237 @@
+#include "link_conditioner.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+# define LINK_CONDITIONER_DATAGRAM_NONE ((uint32_t) -1)
+
+static double link_conditioner__random(link_conditioner_t* self);
+static double link_conditioner__random_normal(link_conditioner_t* self);
+static bool link_conditioner__is_lost(link_conditioner_t* self);
+static void link_conditioner__release_popped(link_conditioner_t* self);
+static bool link_conditioner__is_due_before(link_conditioner_t* self, uint32_t held_a, uint32_t held_b);
+static void link_conditioner__held_push(link_conditioner_t* self, uint32_t datagram_index);
+static uint32_t link_conditioner__held_pop(link_conditioner_t* self);
+static bool link_conditioner_config__is_key(const char* key, uint32_t key_size, const char* name);
+
+static double link_conditioner__random(link_conditioner_t* self) {
+    // note: xorshift64*, 53 bits of it make a double in [0, 1)
+    self->random_state ^= self->random_state >> 12;
+    self->random_state ^= self->random_state << 25;
+    self->random_state ^= self->random_state >> 27;
+
+    return (double) ((self->random_state * 0x2545f4914f6cdd1dull) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double link_conditioner__random_normal(link_conditioner_t* self) {
+    // note: Box-Muller, 1 - u keeps the log away from 0
+    const double u = 1.0 - link_conditioner__random(self);
+    const double v = link_conditioner__random(self);
+
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+static bool link_conditioner__is_lost(link_conditioner_t* self) {
+    if (self->is_loss_state_bad) {
+        self->is_loss_state_bad = link_conditioner__random(self) >= self->loss_leave_chance;
+    } else {
+        self->is_loss_state_bad = link_conditioner__random(self) < self->loss_enter_chance;
+    }
+
+    return self->is_loss_state_bad;
+}
+
+static void link_conditioner__release_popped(link_conditioner_t* self) {
+    if (self->popped != LINK_CONDITIONER_DATAGRAM_NONE) {
+        self->free[self->free_fill++] = self->popped;
+        self->popped = LINK_CONDITIONER_DATAGRAM_NONE;
+    }
+}
+
+static bool link_conditioner__is_due_before(link_conditioner_t* self, uint32_t held_a, uint32_t held_b) {
+    const link_conditioner_datagram_t* a = &self->datagrams[self->held[held_a]];
+    const link_conditioner_datagram_t* b = &self->datagrams[self->held[held_b]];
+
+    return a->time_due < b->time_due || (a->time_due == b->time_due && a->order < b->order);
+}
+
+static void link_conditioner__held_push(link_conditioner_t* self, uint32_t datagram_index) {
+    uint32_t held_index = self->held_fill++;
+    self->held[held_index] = datagram_index;
+    while (held_index > 0) {
+        const uint32_t parent = (held_index - 1) / 2;
+        if (!link_conditioner__is_due_before(self, held_index, parent)) {
+            break ;
+        }
+        const uint32_t tmp = self->held[parent];
+        self->held[parent] = self->held[held_index];
+        self->held[held_index] = tmp;
+        held_index = parent;
+    }
+}
+
+static uint32_t link_conditioner__held_pop(link_conditioner_t* self) {
+    const uint32_t result = self->held[0];
+    self->held[0] = self->held[--self->held_fill];
+    uint32_t held_index = 0;
+    while (true) {
+        uint32_t child = 2 * held_index + 1;
+        if (child >= self->held_fill) {
+            break ;
+        }
+        if (child + 1 < self->held_fill && link_conditioner__is_due_before(self, child + 1, child)) {
+            ++child;
+        }
+        if (!link_conditioner__is_due_before(self, child, held_index)) {
+            break ;
+        }
+        const uint32_t tmp = self->held[child];
+        self->held[child] = self->held[held_index];
+        self->held[held_index] = tmp;
+        held_index = child;
+    }
+
+    return result;
+}
+
+static bool link_conditioner_config__is_key(const char* key, uint32_t key_size, const char* name) {
+    return strlen(name) == key_size && strncmp(key, name, key_size) == 0;
+}
+
+bool link_conditioner_config__parse(link_conditioner_config_t* self, const char* spec) {
+    memset(self, 0, sizeof(*self));
+    self->loss_burst = 1.0;
+    self->seed       = 1;
+
+    const char* cur = spec;
+    while (*cur) {
+        const char* separator = strchr(cur, '=');
+        if (!separator) {
+            return false;
+        }
+        const uint32_t key_size = (uint32_t) (separator - cur);
+        char* value_end = 0;
+        const double value = strtod(separator + 1, &value_end);
+        if (value_end == separator + 1 || (*value_end != ',' && *value_end != '\0') || !(value >= 0.0)) {
+            return false;
+        }
+
+        if (link_conditioner_config__is_key(cur, key_size, "latency_ms")) {
+            self->latency = value / 1000.0;
+        } else if (link_conditioner_config__is_key(cur, key_size, "jitter_ms")) {
+            self->jitter = value / 1000.0;
+        } else if (link_conditioner_config__is_key(cur, key_size, "loss") && value < 1.0) {
+            self->loss = value;
+        } else if (link_conditioner_config__is_key(cur, key_size, "loss_burst") && value >= 1.0) {
+            self->loss_burst = value;
+        } else if (link_conditioner_config__is_key(cur, key_size, "duplicate") && value <= 1.0) {
+            self->duplicate = value;
+        } else if (link_conditioner_config__is_key(cur, key_size, "reorder") && value <= 1.0) {
+            self->reorder = value;
+        } else if (link_conditioner_config__is_key(cur, key_size, "bandwidth_kbps")) {
+            self->bandwidth = value * 1000.0 / 8.0;
+        } else if (link_conditioner_config__is_key(cur, key_size, "seed")) {
+            self->seed = (uint64_t) value;
+        } else {
+            return false;
+        }
+
+        cur = *value_end == ',' ? value_end + 1 : value_end;
+    }
+
+    return true;
+}
+
+bool link_conditioner__create(link_conditioner_t* self, const link_conditioner_config_t* config) {
+    if (
+        !(config->latency >= 0.0) || !(config->jitter >= 0.0) || !(config->loss >= 0.0 && config->loss < 1.0) ||
+        !(config->loss_burst >= 1.0) || !(config->duplicate >= 0.0 && config->duplicate <= 1.0) ||
+        !(config->reorder >= 0.0 && config->reorder <= 1.0) || !(config->bandwidth >= 0.0)
+    ) {
+        return false;
+    }
+
+    self->config       = *config;
+    // note: xorshift gets stuck at 0
+    self->random_state = config->seed ? config->seed : 1;
+    self->is_loss_state_bad = false;
+    // note: the bad state lasts loss_burst datagrams on average, and it's entered just often enough for 'loss' of them to be lost
+    self->loss_leave_chance = 1.0 / config->loss_burst;
+    self->loss_enter_chance = config->loss * self->loss_leave_chance / (1.0 - config->loss);
+    self->time_link_free = 0.0;
+    self->order          = 0;
+    self->held_fill      = 0;
+    self->free_fill      = LINK_CONDITIONER_DATAGRAMS_SIZE;
+    for (uint32_t datagram_index = 0; datagram_index < LINK_CONDITIONER_DATAGRAMS_SIZE; ++datagram_index) {
+        self->free[datagram_index] = LINK_CONDITIONER_DATAGRAMS_SIZE - 1 - datagram_index;
+    }
+    self->popped = LINK_CONDITIONER_DATAGRAM_NONE;
+    self->datagrams_lost       = 0;
+    self->datagrams_duplicated = 0;
+    self->datagrams_overflowed = 0;
+
+    return true;
+}
+
+void link_conditioner__push(link_conditioner_t* self, const void* data, uint32_t data_size, network_addr_t addr, bool is_connected, double time) {
+    link_conditioner__release_popped(self);
+
+    if (data_size > LINK_CONDITIONER_DATAGRAM_SIZE_MAX) {
+        ++self->datagrams_overflowed;
+        return ;
+    }
+    if (link_conditioner__is_lost(self)) {
+        ++self->datagrams_lost;
+        return ;
+    }
+
+    uint32_t copies = 1;
+    if (link_conditioner__random(self) < self->config.duplicate) {
+        ++copies;
+        ++self->datagrams_duplicated;
+    }
+    for (uint32_t copy_index = 0; copy_index < copies; ++copy_index) {
+        double time_sent = time;
+        if (self->config.bandwidth > 0.0) {
+            const double time_departure = self->time_link_free > time ? self->time_link_free : time;
+            if (time_departure - time > LINK_CONDITIONER_QUEUE_DELAY_MAX) {
+                ++self->datagrams_overflowed;
+                continue ;
+            }
+            self->time_link_free = time_departure + (double) data_size / self->config.bandwidth;
+            time_sent = self->time_link_free;
+        }
+        if (self->free_fill == 0) {
+            ++self->datagrams_overflowed;
+            continue ;
+        }
+
+        double delay = self->config.latency + fabs(link_conditioner__random_normal(self)) * self->config.jitter;
+        if (link_conditioner__random(self) < self->config.reorder) {
+            const double reorder_delay_max = self->config.latency > LINK_CONDITIONER_REORDER_DELAY_MIN ? self->config.latency : LINK_CONDITIONER_REORDER_DELAY_MIN;
+            delay += link_conditioner__random(self) * reorder_delay_max;
+        }
+
+        const uint32_t datagram_index = self->free[--self->free_fill];
+        link_conditioner_datagram_t* datagram = &self->datagrams[datagram_index];
+        datagram->time_due     = time_sent + delay;
+        datagram->order        = self->order++;
+        datagram->addr         = addr;
+        datagram->is_connected = is_connected;
+        datagram->data_size    = data_size;
+        memcpy(datagram->data, data, data_size);
+        link_conditioner__held_push(self, datagram_index);
+    }
+}
+
+const link_conditioner_datagram_t* link_conditioner__pop(link_conditioner_t* self, double time) {
+    link_conditioner__release_popped(self);
+
+    if (self->held_fill == 0 || self->datagrams[self->held[0]].time_due > time) {
+        return 0;
+    }
+    self->popped = link_conditioner__held_pop(self);
+
+    return &self->datagrams[self->popped];
+}
@@ -0,0 +1,95 @@
+#ifndef LINK_CONDITIONER_H
+# define LINK_CONDITIONER_H
+
+# include "tp.h"
+
+# include <stdint.h>
+# include <stdbool.h>
+
+/**
+ * Impairs the datagrams a tp_socket_t sends, to test the netcode under a bad link on a single machine
+ * Datagrams are lost, duplicated, delayed and reordered, then held back until they are due
+ * Held datagrams go out on the next call into the socket that owns it, so delays are rounded up to how often it's called
+ *
+ * Configured with a comma separated list of key=value, for example "latency_ms=50,jitter_ms=10,loss=0.02,loss_burst=3"
+ *   latency_ms       one way delay
+ *   jitter_ms        standard deviation of a normal distribution, the size of a sample of it is added to the latency
+ *   loss             fraction of the datagrams lost
+ *   loss_burst       average number of datagrams lost in a row, losses come in bursts, 1 for independent losses
+ *   duplicate        fraction of the datagrams sent twice
+ *   reorder          fraction of the datagrams held back by up to the latency, so the ones after them overtake them
+ *   bandwidth_kbps   rate the link drains at, datagrams queue behind each other, 0 for unlimited
+ *   seed             seed of the random number generator, runs with the same seed impair the same way
+*/
+# define LINK_CONDITIONER_ENV                "TP_LINK_CONDITIONER"
+//! @note Datagrams held at once, the ones that don't fit are dropped, as a full queue of a router would
+# define LINK_CONDITIONER_DATAGRAMS_SIZE     1024
+//! @note Larger datagrams are dropped
+# define LINK_CONDITIONER_DATAGRAM_SIZE_MAX  2048
+//! @note In seconds, the most a datagram queues for the bandwidth before it's dropped
+# define LINK_CONDITIONER_QUEUE_DELAY_MAX    1.0
+//! @note In seconds, how long reordered datagrams are held back by at most if there is no latency
+# define LINK_CONDITIONER_REORDER_DELAY_MIN  0.01
+
+struct link_conditioner_config {
+    //! @note In seconds
+    double   latency;
+    double   jitter;
+    double   loss;
+    double   loss_burst;
+    double   duplicate;
+    double   reorder;
+    //! @note In bytes per second
+    double   bandwidth;
+    uint64_t seed;
+};
+
+typedef struct link_conditioner_datagram {
+    double         time_due;
+    //! @note Breaks ties in 'time_due', so datagrams that are due together go out in the order they were sent
+    uint64_t       order;
+    network_addr_t addr;
+    bool           is_connected;
+    uint32_t       data_size;
+    uint8_t        data[LINK_CONDITIONER_DATAGRAM_SIZE_MAX];
+} link_conditioner_datagram_t;
+
+struct link_conditioner {
+    link_conditioner_config_t config;
+    uint64_t                  random_state;
+    //! @note Gilbert-Elliott loss, every datagram is lost while in the bad state
+    bool                      is_loss_state_bad;
+    double                    loss_enter_chance;
+    double                    loss_leave_chance;
+    //! @note Time the link is done with the datagrams queued for the bandwidth
+    double                    time_link_free;
+    uint64_t                  order;
+
+    link_conditioner_datagram_t datagrams[LINK_CONDITIONER_DATAGRAMS_SIZE];
+    //! @note Min-heap of the held datagrams by time due, indices into datagrams
+    uint32_t                  held[LINK_CONDITIONER_DATAGRAMS_SIZE];
+    uint32_t                  held_fill;
+    uint32_t                  free[LINK_CONDITIONER_DATAGRAMS_SIZE];
+    uint32_t                  free_fill;
+    //! @note Datagram returned by the last pop, it's freed on the next call
+    uint32_t                  popped;
+
+    uint64_t                  datagrams_lost;
+    uint64_t                  datagrams_duplicated;
+    uint64_t                  datagrams_overflowed;
+};
+
+//! @returns false if 'spec' is malformed, a key is unknown or a value is out of range
+bool link_conditioner_config__parse(link_conditioner_config_t* self, const char* spec);
+
+bool link_conditioner__create(link_conditioner_t* self, const link_conditioner_config_t* config);
+
+/**
+ * @brief Decides the fate of a datagram sent at 'time', holds on to a copy for every time it's going to arrive
+ * @param is_connected if true, it's sent to the address the socket is connected to and 'addr' is ignored
+*/
+void link_conditioner__push(link_conditioner_t* self, const void* data, uint32_t data_size, network_addr_t addr, bool is_connected, double time);
+//! @returns The next datagram that is due at 'time', it's valid until the next call, 0 if there is none
+const link_conditioner_datagram_t* link_conditioner__pop(link_conditioner_t* self, double time);
+
+#endif // LINK_CONDITIONER_H
@@ -2,19 +2,20 @@
 
 #include "debug.h"
 
-void debug__write_ack_bitfield_raw(uint32_t ack_bitfield) {
-    for (int32_t bit_index = (sizeof(ack_bitfield) << 3) - 1; bit_index >= 0; --bit_index) {
-        uint32_t bit = (ack_bitfield & (1 << bit_index)) >> bit_index;
-        debug__write_raw("%c", bit ? '1' : '0');
-        if (bit_index > 0 && bit_index % 8 == 0) {
+//! @brief Every input is delta encoded against the one of the packet, the delta of an array is element-wise
+static void input_history__create_base(input_history_t* self, uint32_t inputs_fill, const packet_t* packet);
+
+void debug__write_ack_window_raw(const ack_window_t* ack_window) {
+    for (uint32_t delta = ack_window->size; delta > 0; --delta) {
+        debug__write_raw("%c", ack_window__is_set(ack_window, delta) ? '1' : '0');
+        if (delta > 1 && (delta - 1) % 8 == 0) {
             debug__write_raw(" ");
         }
     }
 }
 
 void debug__write_packet_raw(packet_t* packet) {
-    debug__write_raw("%-10u%-10u", packet->sequence_id, packet->ack);
-    debug__write_ack_bitfield_raw(packet->ack_bitfield);
+    debug__write_raw("%-10u%-10u%-4u", packet->sequence_id, packet->ack, packet->snapshot_base_age);
     debug__write_raw("\n");
 }
 
@@ -32,3 +33,56 @@ seq_id_t sequence_id__delta(seq_id_t newer_seq_id, seq_id_t older_seq_id) {
 seq_id_t sequence_id__sub(seq_id_t seq_id_1, uint32_t val) {
     return (seq_id_t) (seq_id_1 - val);
 }
+
+void connection__accept(connection_t* self, network_addr_t addr, const packet_t* packet, double time) {
+    self->addr            = addr;
+    self->time_last_seen  = time;
+    self->sequence_id     = packet->sequence_id;
+    ack_window__create(&self->ack_window, self->ack_window.size);
+    self->time_connected  = time;
+    self->rtt             = 0.0;
+    self->packets_dropped = 0;
+    self->connected       = true;
+}
+
+uint32_t connection__receive_packet(connection_t* self, const packet_t* packet, double time) {
+    self->time_last_seen = time;
+
+    uint32_t packets_lost = 0;
+    if (sequence_id__is_more_recent(packet->sequence_id, self->sequence_id)) {
+        // todo: early exit if connection hasn't been alive for long enough to determine if packets have been lost
+        packets_lost = ack_window__advance(&self->ack_window, sequence_id__delta(packet->sequence_id, self->sequence_id));
+        self->packets_dropped += packets_lost;
+        self->sequence_id = packet->sequence_id;
+    } else if (self->sequence_id != packet->sequence_id) {
+        ack_window__set(&self->ack_window, sequence_id__delta(self->sequence_id, packet->sequence_id));
+    }
+    // note: the sender lowered its send rate, the ones it skipped aren't lost
+    const uint32_t packet_delta = sequence_id__delta(self->sequence_id, packet->sequence_id);
+    for (uint32_t skipped = 1; skipped <= packet->sequence_id_skipped; ++skipped) {
+        ack_window__set(&self->ack_window, packet_delta + skipped);
+    }
+
+    return packets_lost;
+}
+
+static void input_history__create_base(input_history_t* self, uint32_t inputs_fill, const packet_t* packet) {
+    self->inputs_fill = inputs_fill;
+    for (uint32_t input_index = 0; input_index < inputs_fill; ++input_index) {
+        self->inputs[input_index] = packet->game_data;
+    }
+}
+
+bool input_history__write_after(const input_history_t* self, const packet_t* packet, void* buffer, uint32_t buffer_size, uint32_t* bytes_written) {
+    input_history_t base;
+    input_history__create_base(&base, self->inputs_fill < INPUT_HISTORY_INPUTS_SIZE ? self->inputs_fill : INPUT_HISTORY_INPUTS_SIZE, packet);
+
+    return input_history__write_delta(self, &base, buffer, buffer_size, bytes_written);
+}
+
+bool input_history__read_after(input_history_t* self, const packet_t* packet, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read) {
+    input_history_t base;
+    input_history__create_base(&base, INPUT_HISTORY_INPUTS_SIZE, packet);
+
+    return input_history__read_delta(self, &base, buffer, buffer_size, bytes_read);
+}
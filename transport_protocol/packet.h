@@ -2,37 +2,34 @@
 # define PACKET_H
 
 # include "tp.h"
+//! @note packet_t and game_data_t are generated from packet_format.g_netformat
+# include "packet_format.h"
+# include "ack_window.h"
+# include "channel.h"
 
 # include <stdbool.h>
 
-struct         packet;
-struct         game_data;
 struct         connection;
-typedef struct packet     packet_t;
-typedef struct game_data  game_data_t;
 typedef struct connection connection_t;
 typedef uint16_t          seq_id_t;
 
-struct game_data {
-    uint32_t buttons;
-};
-
-struct packet {
-    seq_id_t    sequence_id;
-    seq_id_t    ack;
-    /**
-     * a bit is 1 if that sequence id was acknowledged, 0 otherwise
-     * bits represent: [ack - 1, ack - 2, ..., ack - 31]
-    */
-    uint32_t    ack_bitfield;
-    game_data_t game_data;
-};
+/**
+ * Snapshots kept by both ends to delta encode against, indexed by sequence id modulo the size
+ * A client that hasn't acknowledged any of the last SNAPSHOT_HISTORY_SIZE is sent a full snapshot
+*/
+# define SNAPSHOT_HISTORY_SIZE     32
+/**
+ * The packet is followed by its ack window, the reliable messages, see channel_set_t, and then the snapshot in the same message
+ * frame_packer_t splits it into datagrams
+ * The packets of the clients have their previous inputs between the ack window and the reliable messages instead, see input_history_t
+*/
+# define PACKET_MESSAGE_SIZE_MAX   (PACKET_SIZE_MAX + ACK_WINDOW_ENCODING_SIZE_MAX + CHANNEL_SET_WRITE_SIZE_MAX + SNAPSHOT_DELTA_SIZE_MAX)
 
 struct connection {
     network_addr_t addr;
     double         time_last_seen;
     seq_id_t       sequence_id;
-    uint32_t       ack_bitfield;
+    ack_window_t   ack_window;
     uint32_t       packets_dropped;
     // uint32_t       packets_received; // todo: this, and throughput
     double         rtt;
@@ -40,7 +37,7 @@ struct connection {
     bool           connected;
 };
 
-void debug__write_ack_bitfield_raw(uint32_t ack_bitfield);
+void debug__write_ack_window_raw(const ack_window_t* ack_window);
 void debug__write_packet_raw(packet_t* packet);
 
 bool sequence_id__is_more_recent(seq_id_t seq_id_1, seq_id_t seq_id_2);
@@ -52,4 +49,21 @@ seq_id_t sequence_id__delta(seq_id_t newer_seq_id, seq_id_t older_seq_id);
 
 seq_id_t sequence_id__sub(seq_id_t seq_id_1, uint32_t val);
 
+/**
+ * @brief Starts receiving from 'addr', with 'packet' as the newest one received, keeps the size of the ack window
+*/
+void connection__accept(connection_t* self, network_addr_t addr, const packet_t* packet, double time);
+/**
+ * @brief Acknowledges 'packet' and the sequence ids it skipped in the ack window, which moves forward if it's the newest one so far
+ * @returns Number of packets that were found to be lost
+*/
+uint32_t connection__receive_packet(connection_t* self, const packet_t* packet, double time);
+
+/**
+ * @brief Bit-packs the inputs before the one of 'packet', every input that is the same as the one of the packet takes a bit
+ * @returns false if 'buffer_size' is less than INPUT_HISTORY_DELTA_SIZE_MAX
+*/
+bool input_history__write_after(const input_history_t* self, const packet_t* packet, void* buffer, uint32_t buffer_size, uint32_t* bytes_written);
+bool input_history__read_after(input_history_t* self, const packet_t* packet, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read);
+
 #endif // PACKET_H
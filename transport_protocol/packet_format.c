@@ -0,0 +1,1054 @@
+// generated by g_netformat_compiler, do not edit
+#include "packet_format.h"
+
+#include <stddef.h>
+
+struct         netformat_writer;
+struct         netformat_reader;
+typedef struct netformat_writer netformat_writer_t;
+typedef struct netformat_reader netformat_reader_t;
+
+//! @note Fields are appended lsb first into a 64-bit scratch that is stored a 32-bit word at a time
+struct netformat_writer {
+    uint8_t* cur;
+    uint64_t scratch;
+    uint32_t scratch_bits;
+    bool     error;
+};
+
+struct netformat_reader {
+    const uint8_t* cur;
+    const uint8_t* end;
+    uint64_t       scratch;
+    uint32_t       scratch_bits;
+    //! @note Past the end zeros are read, this is checked against the size once at the end
+    uint64_t       bits_read;
+    bool           error;
+};
+
+static inline void netformat_writer__write(netformat_writer_t* self, uint32_t value, uint32_t bits) {
+    self->scratch |= ((uint64_t) value & (((uint64_t) 1 << bits) - 1)) << self->scratch_bits;
+    self->scratch_bits += bits;
+    if (self->scratch_bits >= 32) {
+        const uint32_t word = (uint32_t) self->scratch;
+        self->cur[0] = (uint8_t) word;
+        self->cur[1] = (uint8_t) (word >> 8);
+        self->cur[2] = (uint8_t) (word >> 16);
+        self->cur[3] = (uint8_t) (word >> 24);
+        self->cur += 4;
+        self->scratch >>= 32;
+        self->scratch_bits -= 32;
+    }
+}
+
+static inline void netformat_writer__flush(netformat_writer_t* self) {
+    while (self->scratch_bits > 0) {
+        *self->cur++ = (uint8_t) self->scratch;
+        self->scratch >>= 8;
+        self->scratch_bits = self->scratch_bits > 8 ? self->scratch_bits - 8 : 0;
+    }
+}
+
+static inline uint32_t netformat_reader__read(netformat_reader_t* self, uint32_t bits) {
+    if (self->scratch_bits < bits) {
+        uint32_t word = 0;
+        if (self->end - self->cur >= 4) {
+            word = (uint32_t) self->cur[0] | ((uint32_t) self->cur[1] << 8) | ((uint32_t) self->cur[2] << 16) | ((uint32_t) self->cur[3] << 24);
+            self->cur += 4;
+        } else {
+            for (uint32_t byte_index = 0; self->cur < self->end; ++byte_index) {
+                word |= (uint32_t) *self->cur++ << (byte_index << 3);
+            }
+        }
+        self->scratch |= (uint64_t) word << self->scratch_bits;
+        self->scratch_bits += 32;
+    }
+
+    const uint32_t value = (uint32_t) (self->scratch & (((uint64_t) 1 << bits) - 1));
+    self->scratch >>= bits;
+    self->scratch_bits -= bits;
+    self->bits_read += bits;
+
+    return value;
+}
+
+//! @note Out of range values, including NaN, quantize to 0, they are flagged as errors by the caller
+static inline uint32_t netformat__quantize(float value, float min, float max, float scale, uint32_t steps) {
+    const uint32_t quantized = value >= min && value <= max ? (uint32_t) ((value - min) * scale + 0.5f) : 0;
+
+    return quantized > steps ? steps : quantized;
+}
+
+static inline float netformat__dequantize(uint32_t quantized, float min, float resolution) {
+    return min + (float) quantized * resolution;
+}
+
+static void game_data__write_bits(netformat_writer_t* writer, const game_data_t* self);
+static void game_data__read_bits(netformat_reader_t* reader, game_data_t* self);
+static void game_data__write_delta_bits(netformat_writer_t* writer, const game_data_t* self, const game_data_t* base);
+static void game_data__read_delta_bits(netformat_reader_t* reader, game_data_t* self, const game_data_t* base);
+static void input_history__write_bits(netformat_writer_t* writer, const input_history_t* self);
+static void input_history__read_bits(netformat_reader_t* reader, input_history_t* self);
+static void input_history__write_delta_bits(netformat_writer_t* writer, const input_history_t* self, const input_history_t* base);
+static void input_history__read_delta_bits(netformat_reader_t* reader, input_history_t* self, const input_history_t* base);
+static void vec3__write_bits(netformat_writer_t* writer, const vec3_t* self);
+static void vec3__read_bits(netformat_reader_t* reader, vec3_t* self);
+static void vec3__write_delta_bits(netformat_writer_t* writer, const vec3_t* self, const vec3_t* base);
+static void vec3__read_delta_bits(netformat_reader_t* reader, vec3_t* self, const vec3_t* base);
+static void object_state__write_bits(netformat_writer_t* writer, const object_state_t* self);
+static void object_state__read_bits(netformat_reader_t* reader, object_state_t* self);
+static void object_state__write_delta_bits(netformat_writer_t* writer, const object_state_t* self, const object_state_t* base);
+static void object_state__read_delta_bits(netformat_reader_t* reader, object_state_t* self, const object_state_t* base);
+static void snapshot__write_bits(netformat_writer_t* writer, const snapshot_t* self);
+static void snapshot__read_bits(netformat_reader_t* reader, snapshot_t* self);
+static void snapshot__write_delta_bits(netformat_writer_t* writer, const snapshot_t* self, const snapshot_t* base);
+static void snapshot__read_delta_bits(netformat_reader_t* reader, snapshot_t* self, const snapshot_t* base);
+static void packet__write_bits(netformat_writer_t* writer, const packet_t* self);
+static void packet__read_bits(netformat_reader_t* reader, packet_t* self);
+static void packet__write_delta_bits(netformat_writer_t* writer, const packet_t* self, const packet_t* base);
+static void packet__read_delta_bits(netformat_reader_t* reader, packet_t* self, const packet_t* base);
+
+static void game_data__write_bits(netformat_writer_t* writer, const game_data_t* self) {
+    netformat_writer__write(writer, (uint32_t) self->buttons, 32);
+    {
+        const float value = self->yaw;
+        // note: also true for NaN
+        writer->error |= !(value >= (-3.14159989f) && value <= 3.14159989f);
+        const uint32_t quantized = netformat__quantize(value, (-3.14159989f), 3.14159989f, 100.108223f, 629);
+        netformat_writer__write(writer, quantized, 10);
+    }
+}
+
+bool game_data__write(const game_data_t* self, void* buffer, uint32_t buffer_size, uint32_t* bytes_written) {
+    if (buffer_size < GAME_DATA_SIZE_MAX) {
+        return false;
+    }
+
+    netformat_writer_t writer = { .cur = buffer };
+    game_data__write_bits(&writer, self);
+    netformat_writer__flush(&writer);
+    if (writer.error) {
+        return false;
+    }
+
+    if (bytes_written) {
+        *bytes_written = (uint32_t) (writer.cur - (uint8_t*) buffer);
+    }
+
+    return true;
+}
+
+static void game_data__read_bits(netformat_reader_t* reader, game_data_t* self) {
+    {
+        const uint32_t value = netformat_reader__read(reader, 32);
+        self->buttons = (uint32_t) value;
+    }
+    {
+        const uint32_t quantized = netformat_reader__read(reader, 10);
+        reader->error |= quantized > 629;
+        self->yaw = netformat__dequantize(quantized, (-3.14159989f), 0.00998918898f);
+    }
+}
+
+bool game_data__read(game_data_t* self, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read) {
+    netformat_reader_t reader = { .cur = buffer, .end = (const uint8_t*) buffer + buffer_size };
+    game_data__read_bits(&reader, self);
+    if (reader.error || reader.bits_read > ((uint64_t) buffer_size << 3)) {
+        return false;
+    }
+
+    if (bytes_read) {
+        *bytes_read = (uint32_t) ((reader.bits_read + 7) >> 3);
+    }
+
+    return true;
+}
+
+bool game_data__is_changed(const game_data_t* self, const game_data_t* base) {
+    if (self->buttons != base->buttons) {
+        return true;
+    }
+    if (netformat__quantize(self->yaw, (-3.14159989f), 3.14159989f, 100.108223f, 629) != netformat__quantize(base->yaw, (-3.14159989f), 3.14159989f, 100.108223f, 629)) {
+        return true;
+    }
+
+    return false;
+}
+
+static void game_data__write_delta_bits(netformat_writer_t* writer, const game_data_t* self, const game_data_t* base) {
+    {
+        const bool is_changed = self->buttons != base->buttons;
+        netformat_writer__write(writer, is_changed, 1);
+        netformat_writer__write(writer, (uint32_t) self->buttons, is_changed ? 32 : 0);
+    }
+    {
+        const float value = self->yaw;
+        // note: also true for NaN
+        writer->error |= !(value >= (-3.14159989f) && value <= 3.14159989f);
+        const uint32_t quantized = netformat__quantize(value, (-3.14159989f), 3.14159989f, 100.108223f, 629);
+        const bool is_changed = quantized != netformat__quantize(base->yaw, (-3.14159989f), 3.14159989f, 100.108223f, 629);
+        netformat_writer__write(writer, is_changed, 1);
+        netformat_writer__write(writer, quantized, is_changed ? 10 : 0);
+    }
+}
+
+bool game_data__write_delta(const game_data_t* self, const game_data_t* base, void* buffer, uint32_t buffer_size, uint32_t* bytes_written) {
+    if (buffer_size < GAME_DATA_DELTA_SIZE_MAX) {
+        return false;
+    }
+
+    netformat_writer_t writer = { .cur = buffer };
+    game_data__write_delta_bits(&writer, self, base);
+    netformat_writer__flush(&writer);
+    if (writer.error) {
+        return false;
+    }
+
+    if (bytes_written) {
+        *bytes_written = (uint32_t) (writer.cur - (uint8_t*) buffer);
+    }
+
+    return true;
+}
+
+static void game_data__read_delta_bits(netformat_reader_t* reader, game_data_t* self, const game_data_t* base) {
+    {
+        const bool     is_changed = netformat_reader__read(reader, 1) != 0;
+        const uint32_t value = netformat_reader__read(reader, is_changed ? 32 : 0);
+        self->buttons = !is_changed ? base->buttons : (uint32_t) value;
+    }
+    {
+        const bool     is_changed = netformat_reader__read(reader, 1) != 0;
+        const uint32_t quantized = netformat_reader__read(reader, is_changed ? 10 : 0);
+        reader->error |= quantized > 629;
+        self->yaw = !is_changed ? base->yaw : netformat__dequantize(quantized, (-3.14159989f), 0.00998918898f);
+    }
+}
+
+bool game_data__read_delta(game_data_t* self, const game_data_t* base, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read) {
+    netformat_reader_t reader = { .cur = buffer, .end = (const uint8_t*) buffer + buffer_size };
+    game_data__read_delta_bits(&reader, self, base);
+    if (reader.error || reader.bits_read > ((uint64_t) buffer_size << 3)) {
+        return false;
+    }
+
+    if (bytes_read) {
+        *bytes_read = (uint32_t) ((reader.bits_read + 7) >> 3);
+    }
+
+    return true;
+}
+
+static void input_history__write_bits(netformat_writer_t* writer, const input_history_t* self) {
+    {
+        writer->error |= self->inputs_fill > 15;
+        const uint32_t fill = self->inputs_fill > 15 ? 15 : self->inputs_fill;
+        netformat_writer__write(writer, fill, 4);
+        for (uint32_t element_index = 0; element_index < fill; ++element_index) {
+            game_data__write_bits(writer, &self->inputs[element_index]);
+        }
+    }
+}
+
+bool input_history__write(const input_history_t* self, void* buffer, uint32_t buffer_size, uint32_t* bytes_written) {
+    if (buffer_size < INPUT_HISTORY_SIZE_MAX) {
+        return false;
+    }
+
+    netformat_writer_t writer = { .cur = buffer };
+    input_history__write_bits(&writer, self);
+    netformat_writer__flush(&writer);
+    if (writer.error) {
+        return false;
+    }
+
+    if (bytes_written) {
+        *bytes_written = (uint32_t) (writer.cur - (uint8_t*) buffer);
+    }
+
+    return true;
+}
+
+static void input_history__read_bits(netformat_reader_t* reader, input_history_t* self) {
+    {
+        uint32_t fill = netformat_reader__read(reader, 4);
+        self->inputs_fill = fill;
+        for (uint32_t element_index = 0; element_index < fill; ++element_index) {
+            game_data__read_bits(reader, &self->inputs[element_index]);
+        }
+    }
+}
+
+bool input_history__read(input_history_t* self, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read) {
+    netformat_reader_t reader = { .cur = buffer, .end = (const uint8_t*) buffer + buffer_size };
+    input_history__read_bits(&reader, self);
+    if (reader.error || reader.bits_read > ((uint64_t) buffer_size << 3)) {
+        return false;
+    }
+
+    if (bytes_read) {
+        *bytes_read = (uint32_t) ((reader.bits_read + 7) >> 3);
+    }
+
+    return true;
+}
+
+bool input_history__is_changed(const input_history_t* self, const input_history_t* base) {
+    if (self->inputs_fill != base->inputs_fill) {
+        return true;
+    }
+    for (uint32_t element_index = 0; element_index < self->inputs_fill && element_index < 15; ++element_index) {
+        if (game_data__is_changed(&self->inputs[element_index], &base->inputs[element_index])) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void input_history__write_delta_bits(netformat_writer_t* writer, const input_history_t* self, const input_history_t* base) {
+    {
+        writer->error |= self->inputs_fill > 15;
+        const uint32_t fill        = self->inputs_fill > 15 ? 15 : self->inputs_fill;
+        const uint32_t base_fill   = base->inputs_fill > 15 ? 15 : base->inputs_fill;
+        const uint32_t common_fill = fill < base_fill ? fill : base_fill;
+        netformat_writer__write(writer, fill, 4);
+        uint32_t element_index = 0;
+        for (; element_index < common_fill; ++element_index) {
+            {
+                const bool is_changed = game_data__is_changed(&self->inputs[element_index], &base->inputs[element_index]);
+                netformat_writer__write(writer, is_changed, 1);
+                if (is_changed) {
+                    game_data__write_delta_bits(writer, &self->inputs[element_index], &base->inputs[element_index]);
+                }
+            }
+        }
+        for (; element_index < fill; ++element_index) {
+            game_data__write_bits(writer, &self->inputs[element_index]);
+        }
+    }
+}
+
+bool input_history__write_delta(const input_history_t* self, const input_history_t* base, void* buffer, uint32_t buffer_size, uint32_t* bytes_written) {
+    if (buffer_size < INPUT_HISTORY_DELTA_SIZE_MAX) {
+        return false;
+    }
+
+    netformat_writer_t writer = { .cur = buffer };
+    input_history__write_delta_bits(&writer, self, base);
+    netformat_writer__flush(&writer);
+    if (writer.error) {
+        return false;
+    }
+
+    if (bytes_written) {
+        *bytes_written = (uint32_t) (writer.cur - (uint8_t*) buffer);
+    }
+
+    return true;
+}
+
+static void input_history__read_delta_bits(netformat_reader_t* reader, input_history_t* self, const input_history_t* base) {
+    {
+        const uint32_t base_fill = base->inputs_fill > 15 ? 15 : base->inputs_fill;
+        uint32_t fill = netformat_reader__read(reader, 4);
+        self->inputs_fill = fill;
+        const uint32_t common_fill = fill < base_fill ? fill : base_fill;
+        uint32_t element_index = 0;
+        for (; element_index < common_fill; ++element_index) {
+            if (netformat_reader__read(reader, 1) != 0) {
+                game_data__read_delta_bits(reader, &self->inputs[element_index], &base->inputs[element_index]);
+            } else {
+                self->inputs[element_index] = base->inputs[element_index];
+            }
+        }
+        for (; element_index < fill; ++element_index) {
+            game_data__read_bits(reader, &self->inputs[element_index]);
+        }
+    }
+}
+
+bool input_history__read_delta(input_history_t* self, const input_history_t* base, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read) {
+    netformat_reader_t reader = { .cur = buffer, .end = (const uint8_t*) buffer + buffer_size };
+    input_history__read_delta_bits(&reader, self, base);
+    if (reader.error || reader.bits_read > ((uint64_t) buffer_size << 3)) {
+        return false;
+    }
+
+    if (bytes_read) {
+        *bytes_read = (uint32_t) ((reader.bits_read + 7) >> 3);
+    }
+
+    return true;
+}
+
+static void vec3__write_bits(netformat_writer_t* writer, const vec3_t* self) {
+    {
+        const float value = self->x;
+        // note: also true for NaN
+        writer->error |= !(value >= (-512.0f) && value <= 512.0f);
+        const uint32_t quantized = netformat__quantize(value, (-512.0f), 512.0f, 100.0f, 102400);
+        netformat_writer__write(writer, quantized, 17);
+    }
+    {
+        const float value = self->y;
+        // note: also true for NaN
+        writer->error |= !(value >= (-512.0f) && value <= 512.0f);
+        const uint32_t quantized = netformat__quantize(value, (-512.0f), 512.0f, 100.0f, 102400);
+        netformat_writer__write(writer, quantized, 17);
+    }
+    {
+        const float value = self->z;
+        // note: also true for NaN
+        writer->error |= !(value >= (-512.0f) && value <= 512.0f);
+        const uint32_t quantized = netformat__quantize(value, (-512.0f), 512.0f, 100.0f, 102400);
+        netformat_writer__write(writer, quantized, 17);
+    }
+}
+
+bool vec3__write(const vec3_t* self, void* buffer, uint32_t buffer_size, uint32_t* bytes_written) {
+    if (buffer_size < VEC3_SIZE_MAX) {
+        return false;
+    }
+
+    netformat_writer_t writer = { .cur = buffer };
+    vec3__write_bits(&writer, self);
+    netformat_writer__flush(&writer);
+    if (writer.error) {
+        return false;
+    }
+
+    if (bytes_written) {
+        *bytes_written = (uint32_t) (writer.cur - (uint8_t*) buffer);
+    }
+
+    return true;
+}
+
+static void vec3__read_bits(netformat_reader_t* reader, vec3_t* self) {
+    {
+        const uint32_t quantized = netformat_reader__read(reader, 17);
+        reader->error |= quantized > 102400;
+        self->x = netformat__dequantize(quantized, (-512.0f), 0.00999999978f);
+    }
+    {
+        const uint32_t quantized = netformat_reader__read(reader, 17);
+        reader->error |= quantized > 102400;
+        self->y = netformat__dequantize(quantized, (-512.0f), 0.00999999978f);
+    }
+    {
+        const uint32_t quantized = netformat_reader__read(reader, 17);
+        reader->error |= quantized > 102400;
+        self->z = netformat__dequantize(quantized, (-512.0f), 0.00999999978f);
+    }
+}
+
+bool vec3__read(vec3_t* self, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read) {
+    netformat_reader_t reader = { .cur = buffer, .end = (const uint8_t*) buffer + buffer_size };
+    vec3__read_bits(&reader, self);
+    if (reader.error || reader.bits_read > ((uint64_t) buffer_size << 3)) {
+        return false;
+    }
+
+    if (bytes_read) {
+        *bytes_read = (uint32_t) ((reader.bits_read + 7) >> 3);
+    }
+
+    return true;
+}
+
+bool vec3__is_changed(const vec3_t* self, const vec3_t* base) {
+    if (netformat__quantize(self->x, (-512.0f), 512.0f, 100.0f, 102400) != netformat__quantize(base->x, (-512.0f), 512.0f, 100.0f, 102400)) {
+        return true;
+    }
+    if (netformat__quantize(self->y, (-512.0f), 512.0f, 100.0f, 102400) != netformat__quantize(base->y, (-512.0f), 512.0f, 100.0f, 102400)) {
+        return true;
+    }
+    if (netformat__quantize(self->z, (-512.0f), 512.0f, 100.0f, 102400) != netformat__quantize(base->z, (-512.0f), 512.0f, 100.0f, 102400)) {
+        return true;
+    }
+
+    return false;
+}
+
+static void vec3__write_delta_bits(netformat_writer_t* writer, const vec3_t* self, const vec3_t* base) {
+    {
+        const float value = self->x;
+        // note: also true for NaN
+        writer->error |= !(value >= (-512.0f) && value <= 512.0f);
+        const uint32_t quantized = netformat__quantize(value, (-512.0f), 512.0f, 100.0f, 102400);
+        const bool is_changed = quantized != netformat__quantize(base->x, (-512.0f), 512.0f, 100.0f, 102400);
+        netformat_writer__write(writer, is_changed, 1);
+        netformat_writer__write(writer, quantized, is_changed ? 17 : 0);
+    }
+    {
+        const float value = self->y;
+        // note: also true for NaN
+        writer->error |= !(value >= (-512.0f) && value <= 512.0f);
+        const uint32_t quantized = netformat__quantize(value, (-512.0f), 512.0f, 100.0f, 102400);
+        const bool is_changed = quantized != netformat__quantize(base->y, (-512.0f), 512.0f, 100.0f, 102400);
+        netformat_writer__write(writer, is_changed, 1);
+        netformat_writer__write(writer, quantized, is_changed ? 17 : 0);
+    }
+    {
+        const float value = self->z;
+        // note: also true for NaN
+        writer->error |= !(value >= (-512.0f) && value <= 512.0f);
+        const uint32_t quantized = netformat__quantize(value, (-512.0f), 512.0f, 100.0f, 102400);
+        const bool is_changed = quantized != netformat__quantize(base->z, (-512.0f), 512.0f, 100.0f, 102400);
+        netformat_writer__write(writer, is_changed, 1);
+        netformat_writer__write(writer, quantized, is_changed ? 17 : 0);
+    }
+}
+
+bool vec3__write_delta(const vec3_t* self, const vec3_t* base, void* buffer, uint32_t buffer_size, uint32_t* bytes_written) {
+    if (buffer_size < VEC3_DELTA_SIZE_MAX) {
+        return false;
+    }
+
+    netformat_writer_t writer = { .cur = buffer };
+    vec3__write_delta_bits(&writer, self, base);
+    netformat_writer__flush(&writer);
+    if (writer.error) {
+        return false;
+    }
+
+    if (bytes_written) {
+        *bytes_written = (uint32_t) (writer.cur - (uint8_t*) buffer);
+    }
+
+    return true;
+}
+
+static void vec3__read_delta_bits(netformat_reader_t* reader, vec3_t* self, const vec3_t* base) {
+    {
+        const bool     is_changed = netformat_reader__read(reader, 1) != 0;
+        const uint32_t quantized = netformat_reader__read(reader, is_changed ? 17 : 0);
+        reader->error |= quantized > 102400;
+        self->x = !is_changed ? base->x : netformat__dequantize(quantized, (-512.0f), 0.00999999978f);
+    }
+    {
+        const bool     is_changed = netformat_reader__read(reader, 1) != 0;
+        const uint32_t quantized = netformat_reader__read(reader, is_changed ? 17 : 0);
+        reader->error |= quantized > 102400;
+        self->y = !is_changed ? base->y : netformat__dequantize(quantized, (-512.0f), 0.00999999978f);
+    }
+    {
+        const bool     is_changed = netformat_reader__read(reader, 1) != 0;
+        const uint32_t quantized = netformat_reader__read(reader, is_changed ? 17 : 0);
+        reader->error |= quantized > 102400;
+        self->z = !is_changed ? base->z : netformat__dequantize(quantized, (-512.0f), 0.00999999978f);
+    }
+}
+
+bool vec3__read_delta(vec3_t* self, const vec3_t* base, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read) {
+    netformat_reader_t reader = { .cur = buffer, .end = (const uint8_t*) buffer + buffer_size };
+    vec3__read_delta_bits(&reader, self, base);
+    if (reader.error || reader.bits_read > ((uint64_t) buffer_size << 3)) {
+        return false;
+    }
+
+    if (bytes_read) {
+        *bytes_read = (uint32_t) ((reader.bits_read + 7) >> 3);
+    }
+
+    return true;
+}
+
+static void object_state__write_bits(netformat_writer_t* writer, const object_state_t* self) {
+    vec3__write_bits(writer, &self->position);
+    {
+        const float value = self->yaw;
+        // note: also true for NaN
+        writer->error |= !(value >= (-3.14159989f) && value <= 3.14159989f);
+        const uint32_t quantized = netformat__quantize(value, (-3.14159989f), 3.14159989f, 100.108223f, 629);
+        netformat_writer__write(writer, quantized, 10);
+    }
+}
+
+bool object_state__write(const object_state_t* self, void* buffer, uint32_t buffer_size, uint32_t* bytes_written) {
+    if (buffer_size < OBJECT_STATE_SIZE_MAX) {
+        return false;
+    }
+
+    netformat_writer_t writer = { .cur = buffer };
+    object_state__write_bits(&writer, self);
+    netformat_writer__flush(&writer);
+    if (writer.error) {
+        return false;
+    }
+
+    if (bytes_written) {
+        *bytes_written = (uint32_t) (writer.cur - (uint8_t*) buffer);
+    }
+
+    return true;
+}
+
+static void object_state__read_bits(netformat_reader_t* reader, object_state_t* self) {
+    vec3__read_bits(reader, &self->position);
+    {
+        const uint32_t quantized = netformat_reader__read(reader, 10);
+        reader->error |= quantized > 629;
+        self->yaw = netformat__dequantize(quantized, (-3.14159989f), 0.00998918898f);
+    }
+}
+
+bool object_state__read(object_state_t* self, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read) {
+    netformat_reader_t reader = { .cur = buffer, .end = (const uint8_t*) buffer + buffer_size };
+    object_state__read_bits(&reader, self);
+    if (reader.error || reader.bits_read > ((uint64_t) buffer_size << 3)) {
+        return false;
+    }
+
+    if (bytes_read) {
+        *bytes_read = (uint32_t) ((reader.bits_read + 7) >> 3);
+    }
+
+    return true;
+}
+
+bool object_state__is_changed(const object_state_t* self, const object_state_t* base) {
+    if (vec3__is_changed(&self->position, &base->position)) {
+        return true;
+    }
+    if (netformat__quantize(self->yaw, (-3.14159989f), 3.14159989f, 100.108223f, 629) != netformat__quantize(base->yaw, (-3.14159989f), 3.14159989f, 100.108223f, 629)) {
+        return true;
+    }
+
+    return false;
+}
+
+static void object_state__write_delta_bits(netformat_writer_t* writer, const object_state_t* self, const object_state_t* base) {
+    {
+        const bool is_changed = vec3__is_changed(&self->position, &base->position);
+        netformat_writer__write(writer, is_changed, 1);
+        if (is_changed) {
+            vec3__write_delta_bits(writer, &self->position, &base->position);
+        }
+    }
+    {
+        const float value = self->yaw;
+        // note: also true for NaN
+        writer->error |= !(value >= (-3.14159989f) && value <= 3.14159989f);
+        const uint32_t quantized = netformat__quantize(value, (-3.14159989f), 3.14159989f, 100.108223f, 629);
+        const bool is_changed = quantized != netformat__quantize(base->yaw, (-3.14159989f), 3.14159989f, 100.108223f, 629);
+        netformat_writer__write(writer, is_changed, 1);
+        netformat_writer__write(writer, quantized, is_changed ? 10 : 0);
+    }
+}
+
+bool object_state__write_delta(const object_state_t* self, const object_state_t* base, void* buffer, uint32_t buffer_size, uint32_t* bytes_written) {
+    if (buffer_size < OBJECT_STATE_DELTA_SIZE_MAX) {
+        return false;
+    }
+
+    netformat_writer_t writer = { .cur = buffer };
+    object_state__write_delta_bits(&writer, self, base);
+    netformat_writer__flush(&writer);
+    if (writer.error) {
+        return false;
+    }
+
+    if (bytes_written) {
+        *bytes_written = (uint32_t) (writer.cur - (uint8_t*) buffer);
+    }
+
+    return true;
+}
+
+static void object_state__read_delta_bits(netformat_reader_t* reader, object_state_t* self, const object_state_t* base) {
+    if (netformat_reader__read(reader, 1) != 0) {
+        vec3__read_delta_bits(reader, &self->position, &base->position);
+    } else {
+        self->position = base->position;
+    }
+    {
+        const bool     is_changed = netformat_reader__read(reader, 1) != 0;
+        const uint32_t quantized = netformat_reader__read(reader, is_changed ? 10 : 0);
+        reader->error |= quantized > 629;
+        self->yaw = !is_changed ? base->yaw : netformat__dequantize(quantized, (-3.14159989f), 0.00998918898f);
+    }
+}
+
+bool object_state__read_delta(object_state_t* self, const object_state_t* base, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read) {
+    netformat_reader_t reader = { .cur = buffer, .end = (const uint8_t*) buffer + buffer_size };
+    object_state__read_delta_bits(&reader, self, base);
+    if (reader.error || reader.bits_read > ((uint64_t) buffer_size << 3)) {
+        return false;
+    }
+
+    if (bytes_read) {
+        *bytes_read = (uint32_t) ((reader.bits_read + 7) >> 3);
+    }
+
+    return true;
+}
+
+static void snapshot__write_bits(netformat_writer_t* writer, const snapshot_t* self) {
+    {
+        writer->error |= self->objects_fill > 512;
+        const uint32_t fill = self->objects_fill > 512 ? 512 : self->objects_fill;
+        netformat_writer__write(writer, fill, 10);
+        for (uint32_t element_index = 0; element_index < fill; ++element_index) {
+            object_state__write_bits(writer, &self->objects[element_index]);
+        }
+    }
+}
+
+bool snapshot__write(const snapshot_t* self, void* buffer, uint32_t buffer_size, uint32_t* bytes_written) {
+    if (buffer_size < SNAPSHOT_SIZE_MAX) {
+        return false;
+    }
+
+    netformat_writer_t writer = { .cur = buffer };
+    snapshot__write_bits(&writer, self);
+    netformat_writer__flush(&writer);
+    if (writer.error) {
+        return false;
+    }
+
+    if (bytes_written) {
+        *bytes_written = (uint32_t) (writer.cur - (uint8_t*) buffer);
+    }
+
+    return true;
+}
+
+static void snapshot__read_bits(netformat_reader_t* reader, snapshot_t* self) {
+    {
+        uint32_t fill = netformat_reader__read(reader, 10);
+        reader->error |= fill > 512;
+        fill = fill > 512 ? 512 : fill;
+        self->objects_fill = fill;
+        for (uint32_t element_index = 0; element_index < fill; ++element_index) {
+            object_state__read_bits(reader, &self->objects[element_index]);
+        }
+    }
+}
+
+bool snapshot__read(snapshot_t* self, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read) {
+    netformat_reader_t reader = { .cur = buffer, .end = (const uint8_t*) buffer + buffer_size };
+    snapshot__read_bits(&reader, self);
+    if (reader.error || reader.bits_read > ((uint64_t) buffer_size << 3)) {
+        return false;
+    }
+
+    if (bytes_read) {
+        *bytes_read = (uint32_t) ((reader.bits_read + 7) >> 3);
+    }
+
+    return true;
+}
+
+bool snapshot__is_changed(const snapshot_t* self, const snapshot_t* base) {
+    if (self->objects_fill != base->objects_fill) {
+        return true;
+    }
+    for (uint32_t element_index = 0; element_index < self->objects_fill && element_index < 512; ++element_index) {
+        if (object_state__is_changed(&self->objects[element_index], &base->objects[element_index])) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void snapshot__write_delta_bits(netformat_writer_t* writer, const snapshot_t* self, const snapshot_t* base) {
+    {
+        writer->error |= self->objects_fill > 512;
+        const uint32_t fill        = self->objects_fill > 512 ? 512 : self->objects_fill;
+        const uint32_t base_fill   = base->objects_fill > 512 ? 512 : base->objects_fill;
+        const uint32_t common_fill = fill < base_fill ? fill : base_fill;
+        netformat_writer__write(writer, fill, 10);
+        uint32_t element_index = 0;
+        for (; element_index < common_fill; ++element_index) {
+            {
+                const bool is_changed = object_state__is_changed(&self->objects[element_index], &base->objects[element_index]);
+                netformat_writer__write(writer, is_changed, 1);
+                if (is_changed) {
+                    object_state__write_delta_bits(writer, &self->objects[element_index], &base->objects[element_index]);
+                }
+            }
+        }
+        for (; element_index < fill; ++element_index) {
+            object_state__write_bits(writer, &self->objects[element_index]);
+        }
+    }
+}
+
+bool snapshot__write_delta(const snapshot_t* self, const snapshot_t* base, void* buffer, uint32_t buffer_size, uint32_t* bytes_written) {
+    if (buffer_size < SNAPSHOT_DELTA_SIZE_MAX) {
+        return false;
+    }
+
+    netformat_writer_t writer = { .cur = buffer };
+    snapshot__write_delta_bits(&writer, self, base);
+    netformat_writer__flush(&writer);
+    if (writer.error) {
+        return false;
+    }
+
+    if (bytes_written) {
+        *bytes_written = (uint32_t) (writer.cur - (uint8_t*) buffer);
+    }
+
+    return true;
+}
+
+static void snapshot__read_delta_bits(netformat_reader_t* reader, snapshot_t* self, const snapshot_t* base) {
+    {
+        const uint32_t base_fill = base->objects_fill > 512 ? 512 : base->objects_fill;
+        uint32_t fill = netformat_reader__read(reader, 10);
+        reader->error |= fill > 512;
+        fill = fill > 512 ? 512 : fill;
+        self->objects_fill = fill;
+        const uint32_t common_fill = fill < base_fill ? fill : base_fill;
+        uint32_t element_index = 0;
+        for (; element_index < common_fill; ++element_index) {
+            if (netformat_reader__read(reader, 1) != 0) {
+                object_state__read_delta_bits(reader, &self->objects[element_index], &base->objects[element_index]);
+            } else {
+                self->objects[element_index] = base->objects[element_index];
+            }
+        }
+        for (; element_index < fill; ++element_index) {
+            object_state__read_bits(reader, &self->objects[element_index]);
+        }
+    }
+}
+
+bool snapshot__read_delta(snapshot_t* self, const snapshot_t* base, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read) {
+    netformat_reader_t reader = { .cur = buffer, .end = (const uint8_t*) buffer + buffer_size };
+    snapshot__read_delta_bits(&reader, self, base);
+    if (reader.error || reader.bits_read > ((uint64_t) buffer_size << 3)) {
+        return false;
+    }
+
+    if (bytes_read) {
+        *bytes_read = (uint32_t) ((reader.bits_read + 7) >> 3);
+    }
+
+    return true;
+}
+
+static void packet__write_bits(netformat_writer_t* writer, const packet_t* self) {
+    netformat_writer__write(writer, (uint32_t) self->sequence_id, 16);
+    netformat_writer__write(writer, (uint32_t) self->ack, 16);
+    game_data__write_bits(writer, &self->game_data);
+    netformat_writer__write(writer, (uint32_t) self->snapshot_base_age, 8);
+    writer->error |= self->sequence_id_skipped > 15;
+    netformat_writer__write(writer, (uint32_t) self->sequence_id_skipped, 4);
+    object_state__write_bits(writer, &self->player);
+    {
+        const float value = self->tick_interval;
+        // note: also true for NaN
+        writer->error |= !(value >= 0.0f && value <= 4.0f);
+        const uint32_t quantized = netformat__quantize(value, 0.0f, 4.0f, 10000.0f, 40000);
+        netformat_writer__write(writer, quantized, 16);
+    }
+}
+
+bool packet__write(const packet_t* self, void* buffer, uint32_t buffer_size, uint32_t* bytes_written) {
+    if (buffer_size < PACKET_SIZE_MAX) {
+        return false;
+    }
+
+    netformat_writer_t writer = { .cur = buffer };
+    packet__write_bits(&writer, self);
+    netformat_writer__flush(&writer);
+    if (writer.error) {
+        return false;
+    }
+
+    if (bytes_written) {
+        *bytes_written = (uint32_t) (writer.cur - (uint8_t*) buffer);
+    }
+
+    return true;
+}
+
+static void packet__read_bits(netformat_reader_t* reader, packet_t* self) {
+    {
+        const uint32_t value = netformat_reader__read(reader, 16);
+        self->sequence_id = (uint16_t) value;
+    }
+    {
+        const uint32_t value = netformat_reader__read(reader, 16);
+        self->ack = (uint16_t) value;
+    }
+    game_data__read_bits(reader, &self->game_data);
+    {
+        const uint32_t value = netformat_reader__read(reader, 8);
+        self->snapshot_base_age = (uint8_t) value;
+    }
+    {
+        const uint32_t value = netformat_reader__read(reader, 4);
+        self->sequence_id_skipped = (uint8_t) value;
+    }
+    object_state__read_bits(reader, &self->player);
+    {
+        const uint32_t quantized = netformat_reader__read(reader, 16);
+        reader->error |= quantized > 40000;
+        self->tick_interval = netformat__dequantize(quantized, 0.0f, 9.99999975e-05f);
+    }
+}
+
+bool packet__read(packet_t* self, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read) {
+    netformat_reader_t reader = { .cur = buffer, .end = (const uint8_t*) buffer + buffer_size };
+    packet__read_bits(&reader, self);
+    if (reader.error || reader.bits_read > ((uint64_t) buffer_size << 3)) {
+        return false;
+    }
+
+    if (bytes_read) {
+        *bytes_read = (uint32_t) ((reader.bits_read + 7) >> 3);
+    }
+
+    return true;
+}
+
+bool packet__is_changed(const packet_t* self, const packet_t* base) {
+    if (self->sequence_id != base->sequence_id) {
+        return true;
+    }
+    if (self->ack != base->ack) {
+        return true;
+    }
+    if (game_data__is_changed(&self->game_data, &base->game_data)) {
+        return true;
+    }
+    if (self->snapshot_base_age != base->snapshot_base_age) {
+        return true;
+    }
+    if (self->sequence_id_skipped != base->sequence_id_skipped) {
+        return true;
+    }
+    if (object_state__is_changed(&self->player, &base->player)) {
+        return true;
+    }
+    if (netformat__quantize(self->tick_interval, 0.0f, 4.0f, 10000.0f, 40000) != netformat__quantize(base->tick_interval, 0.0f, 4.0f, 10000.0f, 40000)) {
+        return true;
+    }
+
+    return false;
+}
+
+static void packet__write_delta_bits(netformat_writer_t* writer, const packet_t* self, const packet_t* base) {
+    {
+        const bool is_changed = self->sequence_id != base->sequence_id;
+        netformat_writer__write(writer, is_changed, 1);
+        netformat_writer__write(writer, (uint32_t) self->sequence_id, is_changed ? 16 : 0);
+    }
+    {
+        const bool is_changed = self->ack != base->ack;
+        netformat_writer__write(writer, is_changed, 1);
+        netformat_writer__write(writer, (uint32_t) self->ack, is_changed ? 16 : 0);
+    }
+    {
+        const bool is_changed = game_data__is_changed(&self->game_data, &base->game_data);
+        netformat_writer__write(writer, is_changed, 1);
+        if (is_changed) {
+            game_data__write_delta_bits(writer, &self->game_data, &base->game_data);
+        }
+    }
+    {
+        const bool is_changed = self->snapshot_base_age != base->snapshot_base_age;
+        netformat_writer__write(writer, is_changed, 1);
+        netformat_writer__write(writer, (uint32_t) self->snapshot_base_age, is_changed ? 8 : 0);
+    }
+    writer->error |= self->sequence_id_skipped > 15;
+    {
+        const bool is_changed = self->sequence_id_skipped != base->sequence_id_skipped;
+        netformat_writer__write(writer, is_changed, 1);
+        netformat_writer__write(writer, (uint32_t) self->sequence_id_skipped, is_changed ? 4 : 0);
+    }
+    {
+        const bool is_changed = object_state__is_changed(&self->player, &base->player);
+        netformat_writer__write(writer, is_changed, 1);
+        if (is_changed) {
+            object_state__write_delta_bits(writer, &self->player, &base->player);
+        }
+    }
+    {
+        const float value = self->tick_interval;
+        // note: also true for NaN
+        writer->error |= !(value >= 0.0f && value <= 4.0f);
+        const uint32_t quantized = netformat__quantize(value, 0.0f, 4.0f, 10000.0f, 40000);
+        const bool is_changed = quantized != netformat__quantize(base->tick_interval, 0.0f, 4.0f, 10000.0f, 40000);
+        netformat_writer__write(writer, is_changed, 1);
+        netformat_writer__write(writer, quantized, is_changed ? 16 : 0);
+    }
+}
+
+bool packet__write_delta(const packet_t* self, const packet_t* base, void* buffer, uint32_t buffer_size, uint32_t* bytes_written) {
+    if (buffer_size < PACKET_DELTA_SIZE_MAX) {
+        return false;
+    }
+
+    netformat_writer_t writer = { .cur = buffer };
+    packet__write_delta_bits(&writer, self, base);
+    netformat_writer__flush(&writer);
+    if (writer.error) {
+        return false;
+    }
+
+    if (bytes_written) {
+        *bytes_written = (uint32_t) (writer.cur - (uint8_t*) buffer);
+    }
+
+    return true;
+}
+
+static void packet__read_delta_bits(netformat_reader_t* reader, packet_t* self, const packet_t* base) {
+    {
+        const bool     is_changed = netformat_reader__read(reader, 1) != 0;
+        const uint32_t value = netformat_reader__read(reader, is_changed ? 16 : 0);
+        self->sequence_id = !is_changed ? base->sequence_id : (uint16_t) value;
+    }
+    {
+        const bool     is_changed = netformat_reader__read(reader, 1) != 0;
+        const uint32_t value = netformat_reader__read(reader, is_changed ? 16 : 0);
+        self->ack = !is_changed ? base->ack : (uint16_t) value;
+    }
+    if (netformat_reader__read(reader, 1) != 0) {
+        game_data__read_delta_bits(reader, &self->game_data, &base->game_data);
+    } else {
+        self->game_data = base->game_data;
+    }
+    {
+        const bool     is_changed = netformat_reader__read(reader, 1) != 0;
+        const uint32_t value = netformat_reader__read(reader, is_changed ? 8 : 0);
+        self->snapshot_base_age = !is_changed ? base->snapshot_base_age : (uint8_t) value;
+    }
+    {
+        const bool     is_changed = netformat_reader__read(reader, 1) != 0;
+        const uint32_t value = netformat_reader__read(reader, is_changed ? 4 : 0);
+        self->sequence_id_skipped = !is_changed ? base->sequence_id_skipped : (uint8_t) value;
+    }
+    if (netformat_reader__read(reader, 1) != 0) {
+        object_state__read_delta_bits(reader, &self->player, &base->player);
+    } else {
+        self->player = base->player;
+    }
+    {
+        const bool     is_changed = netformat_reader__read(reader, 1) != 0;
+        const uint32_t quantized = netformat_reader__read(reader, is_changed ? 16 : 0);
+        reader->error |= quantized > 40000;
+        self->tick_interval = !is_changed ? base->tick_interval : netformat__dequantize(quantized, 0.0f, 9.99999975e-05f);
+    }
+}
+
+bool packet__read_delta(packet_t* self, const packet_t* base, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read) {
+    netformat_reader_t reader = { .cur = buffer, .end = (const uint8_t*) buffer + buffer_size };
+    packet__read_delta_bits(&reader, self, base);
+    if (reader.error || reader.bits_read > ((uint64_t) buffer_size << 3)) {
+        return false;
+    }
+
+    if (bytes_read) {
+        *bytes_read = (uint32_t) ((reader.bits_read + 7) >> 3);
+    }
+
+    return true;
+}
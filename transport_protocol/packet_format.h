@@ -0,0 +1,239 @@
+// generated by g_netformat_compiler, do not edit
+#ifndef PACKET_FORMAT_H
+# define PACKET_FORMAT_H
+
+# include <stdint.h>
+# include <stdbool.h>
+
+struct         game_data;
+struct         input_history;
+struct         vec3;
+struct         object_state;
+struct         snapshot;
+struct         packet;
+typedef struct game_data     game_data_t;
+typedef struct input_history input_history_t;
+typedef struct vec3          vec3_t;
+typedef struct object_state  object_state_t;
+typedef struct snapshot      snapshot_t;
+typedef struct packet        packet_t;
+
+# define GAME_DATA_BITS_MAX 42
+# define GAME_DATA_SIZE_MAX 6
+# define GAME_DATA_DELTA_BITS_MAX 44
+# define GAME_DATA_DELTA_SIZE_MAX 6
+
+struct game_data {
+    uint32_t buttons;
+    float    yaw;
+};
+
+/**
+ * @brief Bit-packs 'self' into 'buffer'
+ * @returns false if a field is out of its range or 'buffer_size' is less than GAME_DATA_SIZE_MAX
+*/
+bool game_data__write(const game_data_t* self, void* buffer, uint32_t buffer_size, uint32_t* bytes_written);
+/**
+ * @returns false if 'buffer' is truncated or a field is out of its range, the content of 'self' is unspecified then
+*/
+bool game_data__read(game_data_t* self, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read);
+
+//! @returns true if 'self' differs from 'base' as sent, so after quantization
+bool game_data__is_changed(const game_data_t* self, const game_data_t* base);
+/**
+ * @brief Bit-packs 'self' as a delta against 'base', every field has a bit for whether it changed and only changed fields are sent
+ * @note Array elements past the fill of 'base' are sent in full
+ * @note Nested messages that did not change are skipped whole, so they are only range checked as part of 'base'
+ * @returns false if a field is out of its range or 'buffer_size' is less than GAME_DATA_DELTA_SIZE_MAX
+*/
+bool game_data__write_delta(const game_data_t* self, const game_data_t* base, void* buffer, uint32_t buffer_size, uint32_t* bytes_written);
+/**
+ * @param base must be what the reader decoded for the 'base' of the writer, 'self' and 'base' can be the same
+ * @returns false if 'buffer' is truncated or a field is out of its range, the content of 'self' is unspecified then
+*/
+bool game_data__read_delta(game_data_t* self, const game_data_t* base, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read);
+
+# define INPUT_HISTORY_BITS_MAX 634
+# define INPUT_HISTORY_SIZE_MAX 80
+# define INPUT_HISTORY_DELTA_BITS_MAX 679
+# define INPUT_HISTORY_DELTA_SIZE_MAX 85
+# define INPUT_HISTORY_INPUTS_SIZE 15
+
+struct input_history {
+    game_data_t inputs[INPUT_HISTORY_INPUTS_SIZE];
+    uint32_t    inputs_fill;
+};
+
+/**
+ * @brief Bit-packs 'self' into 'buffer'
+ * @returns false if a field is out of its range or 'buffer_size' is less than INPUT_HISTORY_SIZE_MAX
+*/
+bool input_history__write(const input_history_t* self, void* buffer, uint32_t buffer_size, uint32_t* bytes_written);
+/**
+ * @returns false if 'buffer' is truncated or a field is out of its range, the content of 'self' is unspecified then
+*/
+bool input_history__read(input_history_t* self, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read);
+
+//! @returns true if 'self' differs from 'base' as sent, so after quantization
+bool input_history__is_changed(const input_history_t* self, const input_history_t* base);
+/**
+ * @brief Bit-packs 'self' as a delta against 'base', every field has a bit for whether it changed and only changed fields are sent
+ * @note Array elements past the fill of 'base' are sent in full
+ * @note Nested messages that did not change are skipped whole, so they are only range checked as part of 'base'
+ * @returns false if a field is out of its range or 'buffer_size' is less than INPUT_HISTORY_DELTA_SIZE_MAX
+*/
+bool input_history__write_delta(const input_history_t* self, const input_history_t* base, void* buffer, uint32_t buffer_size, uint32_t* bytes_written);
+/**
+ * @param base must be what the reader decoded for the 'base' of the writer, 'self' and 'base' can be the same
+ * @returns false if 'buffer' is truncated or a field is out of its range, the content of 'self' is unspecified then
+*/
+bool input_history__read_delta(input_history_t* self, const input_history_t* base, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read);
+
+# define VEC3_BITS_MAX 51
+# define VEC3_SIZE_MAX 7
+# define VEC3_DELTA_BITS_MAX 54
+# define VEC3_DELTA_SIZE_MAX 7
+
+struct vec3 {
+    float    x;
+    float    y;
+    float    z;
+};
+
+/**
+ * @brief Bit-packs 'self' into 'buffer'
+ * @returns false if a field is out of its range or 'buffer_size' is less than VEC3_SIZE_MAX
+*/
+bool vec3__write(const vec3_t* self, void* buffer, uint32_t buffer_size, uint32_t* bytes_written);
+/**
+ * @returns false if 'buffer' is truncated or a field is out of its range, the content of 'self' is unspecified then
+*/
+bool vec3__read(vec3_t* self, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read);
+
+//! @returns true if 'self' differs from 'base' as sent, so after quantization
+bool vec3__is_changed(const vec3_t* self, const vec3_t* base);
+/**
+ * @brief Bit-packs 'self' as a delta against 'base', every field has a bit for whether it changed and only changed fields are sent
+ * @note Array elements past the fill of 'base' are sent in full
+ * @note Nested messages that did not change are skipped whole, so they are only range checked as part of 'base'
+ * @returns false if a field is out of its range or 'buffer_size' is less than VEC3_DELTA_SIZE_MAX
+*/
+bool vec3__write_delta(const vec3_t* self, const vec3_t* base, void* buffer, uint32_t buffer_size, uint32_t* bytes_written);
+/**
+ * @param base must be what the reader decoded for the 'base' of the writer, 'self' and 'base' can be the same
+ * @returns false if 'buffer' is truncated or a field is out of its range, the content of 'self' is unspecified then
+*/
+bool vec3__read_delta(vec3_t* self, const vec3_t* base, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read);
+
+# define OBJECT_STATE_BITS_MAX 61
+# define OBJECT_STATE_SIZE_MAX 8
+# define OBJECT_STATE_DELTA_BITS_MAX 66
+# define OBJECT_STATE_DELTA_SIZE_MAX 9
+
+struct object_state {
+    vec3_t   position;
+    float    yaw;
+};
+
+/**
+ * @brief Bit-packs 'self' into 'buffer'
+ * @returns false if a field is out of its range or 'buffer_size' is less than OBJECT_STATE_SIZE_MAX
+*/
+bool object_state__write(const object_state_t* self, void* buffer, uint32_t buffer_size, uint32_t* bytes_written);
+/**
+ * @returns false if 'buffer' is truncated or a field is out of its range, the content of 'self' is unspecified then
+*/
+bool object_state__read(object_state_t* self, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read);
+
+//! @returns true if 'self' differs from 'base' as sent, so after quantization
+bool object_state__is_changed(const object_state_t* self, const object_state_t* base);
+/**
+ * @brief Bit-packs 'self' as a delta against 'base', every field has a bit for whether it changed and only changed fields are sent
+ * @note Array elements past the fill of 'base' are sent in full
+ * @note Nested messages that did not change are skipped whole, so they are only range checked as part of 'base'
+ * @returns false if a field is out of its range or 'buffer_size' is less than OBJECT_STATE_DELTA_SIZE_MAX
+*/
+bool object_state__write_delta(const object_state_t* self, const object_state_t* base, void* buffer, uint32_t buffer_size, uint32_t* bytes_written);
+/**
+ * @param base must be what the reader decoded for the 'base' of the writer, 'self' and 'base' can be the same
+ * @returns false if 'buffer' is truncated or a field is out of its range, the content of 'self' is unspecified then
+*/
+bool object_state__read_delta(object_state_t* self, const object_state_t* base, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read);
+
+# define SNAPSHOT_BITS_MAX 31242
+# define SNAPSHOT_SIZE_MAX 3906
+# define SNAPSHOT_DELTA_BITS_MAX 34314
+# define SNAPSHOT_DELTA_SIZE_MAX 4290
+# define SNAPSHOT_OBJECTS_SIZE 512
+
+struct snapshot {
+    object_state_t objects[SNAPSHOT_OBJECTS_SIZE];
+    uint32_t       objects_fill;
+};
+
+/**
+ * @brief Bit-packs 'self' into 'buffer'
+ * @returns false if a field is out of its range or 'buffer_size' is less than SNAPSHOT_SIZE_MAX
+*/
+bool snapshot__write(const snapshot_t* self, void* buffer, uint32_t buffer_size, uint32_t* bytes_written);
+/**
+ * @returns false if 'buffer' is truncated or a field is out of its range, the content of 'self' is unspecified then
+*/
+bool snapshot__read(snapshot_t* self, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read);
+
+//! @returns true if 'self' differs from 'base' as sent, so after quantization
+bool snapshot__is_changed(const snapshot_t* self, const snapshot_t* base);
+/**
+ * @brief Bit-packs 'self' as a delta against 'base', every field has a bit for whether it changed and only changed fields are sent
+ * @note Array elements past the fill of 'base' are sent in full
+ * @note Nested messages that did not change are skipped whole, so they are only range checked as part of 'base'
+ * @returns false if a field is out of its range or 'buffer_size' is less than SNAPSHOT_DELTA_SIZE_MAX
+*/
+bool snapshot__write_delta(const snapshot_t* self, const snapshot_t* base, void* buffer, uint32_t buffer_size, uint32_t* bytes_written);
+/**
+ * @param base must be what the reader decoded for the 'base' of the writer, 'self' and 'base' can be the same
+ * @returns false if 'buffer' is truncated or a field is out of its range, the content of 'self' is unspecified then
+*/
+bool snapshot__read_delta(snapshot_t* self, const snapshot_t* base, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read);
+
+# define PACKET_BITS_MAX 163
+# define PACKET_SIZE_MAX 21
+# define PACKET_DELTA_BITS_MAX 177
+# define PACKET_DELTA_SIZE_MAX 23
+
+struct packet {
+    uint16_t       sequence_id;
+    uint16_t       ack;
+    game_data_t    game_data;
+    uint8_t        snapshot_base_age;
+    uint8_t        sequence_id_skipped;
+    object_state_t player;
+    float          tick_interval;
+};
+
+/**
+ * @brief Bit-packs 'self' into 'buffer'
+ * @returns false if a field is out of its range or 'buffer_size' is less than PACKET_SIZE_MAX
+*/
+bool packet__write(const packet_t* self, void* buffer, uint32_t buffer_size, uint32_t* bytes_written);
+/**
+ * @returns false if 'buffer' is truncated or a field is out of its range, the content of 'self' is unspecified then
+*/
+bool packet__read(packet_t* self, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read);
+
+//! @returns true if 'self' differs from 'base' as sent, so after quantization
+bool packet__is_changed(const packet_t* self, const packet_t* base);
+/**
+ * @brief Bit-packs 'self' as a delta against 'base', every field has a bit for whether it changed and only changed fields are sent
+ * @note Array elements past the fill of 'base' are sent in full
+ * @note Nested messages that did not change are skipped whole, so they are only range checked as part of 'base'
+ * @returns false if a field is out of its range or 'buffer_size' is less than PACKET_DELTA_SIZE_MAX
+*/
+bool packet__write_delta(const packet_t* self, const packet_t* base, void* buffer, uint32_t buffer_size, uint32_t* bytes_written);
+/**
+ * @param base must be what the reader decoded for the 'base' of the writer, 'self' and 'base' can be the same
+ * @returns false if 'buffer' is truncated or a field is out of its range, the content of 'self' is unspecified then
+*/
+bool packet__read_delta(packet_t* self, const packet_t* base, const void* buffer, uint32_t buffer_size, uint32_t* bytes_read);
+
+#endif // PACKET_FORMAT_H
@@ -0,0 +1,78 @@
+#include "packet_pool.h"
+
+#include "memory.h"
+#include "debug.h"
+
+#include <string.h>
+
+bool packet_pool__create(packet_pool_t* self, uint32_t buffers_size, uint32_t buffer_size) {
+    memset(self, 0, sizeof(*self));
+    if (buffers_size == 0 || buffer_size == 0) {
+        return false;
+    }
+
+    self->buffers_size = buffers_size;
+    self->buffer_size  = (buffer_size + PACKET_POOL_ALIGNMENT - 1) & ~(uint32_t) (PACKET_POOL_ALIGNMENT - 1);
+    // note: over-allocated by an alignment, so the first buffer can start on a cache line
+    self->memory  = memory__malloc(DEBUG_MODULE_TP, (uint64_t) buffers_size * self->buffer_size + PACKET_POOL_ALIGNMENT);
+    self->buffers = memory__calloc(DEBUG_MODULE_TP, buffers_size, sizeof(*self->buffers));
+    self->free    = memory__malloc(DEBUG_MODULE_TP, buffers_size * sizeof(*self->free));
+    if (!self->memory || !self->buffers || !self->free) {
+        memory__free(DEBUG_MODULE_TP, self->memory);
+        memory__free(DEBUG_MODULE_TP, self->buffers);
+        memory__free(DEBUG_MODULE_TP, self->free);
+        memset(self, 0, sizeof(*self));
+        return false;
+    }
+
+    uint8_t* data = (uint8_t*) (((uintptr_t) self->memory + PACKET_POOL_ALIGNMENT - 1) & ~(uintptr_t) (PACKET_POOL_ALIGNMENT - 1));
+    for (uint32_t buffer_index = 0; buffer_index < buffers_size; ++buffer_index) {
+        packet_buffer_t* buffer = &self->buffers[buffer_index];
+        buffer->data      = data + (uint64_t) buffer_index * self->buffer_size;
+        buffer->data_size = self->buffer_size;
+        buffer->pool      = self;
+        // note: handed out from the first one, so a lightly used pool touches few cache lines
+        self->free[buffers_size - 1 - buffer_index] = buffer;
+    }
+    self->free_fill = buffers_size;
+
+    return true;
+}
+
+void packet_pool__destroy(packet_pool_t* self) {
+    ASSERT(self->free_fill == self->buffers_size);
+
+    memory__free(DEBUG_MODULE_TP, self->memory);
+    memory__free(DEBUG_MODULE_TP, self->buffers);
+    memory__free(DEBUG_MODULE_TP, self->free);
+    memset(self, 0, sizeof(*self));
+}
+
+packet_buffer_t* packet_pool__acquire(packet_pool_t* self) {
+    if (self->free_fill == 0) {
+        ++self->acquires_failed;
+        return 0;
+    }
+
+    packet_buffer_t* result = self->free[--self->free_fill];
+    result->refs     = 1;
+    result->data_len = 0;
+
+    return result;
+}
+
+void packet_buffer__retain(packet_buffer_t* self) {
+    ASSERT(self->refs > 0);
+    ++self->refs;
+}
+
+void packet_buffer__release(packet_buffer_t* self) {
+    ASSERT(self->refs > 0);
+    if (--self->refs > 0) {
+        return ;
+    }
+
+    packet_pool_t* pool = self->pool;
+    ASSERT(pool->free_fill < pool->buffers_size);
+    pool->free[pool->free_fill++] = self;
+}
@@ -0,0 +1,57 @@
+#ifndef PACKET_POOL_H
+# define PACKET_POOL_H
+
+# include <stdint.h>
+# include <stdbool.h>
+
+struct         packet_pool;
+struct         packet_buffer;
+typedef struct packet_pool   packet_pool_t;
+typedef struct packet_buffer packet_buffer_t;
+
+/**
+ * Fixed number of fixed size buffers for datagrams and encoded messages, allocated once
+ * A buffer is reference counted, so a payload encoded once can be referenced by many datagrams, for example
+ * a snapshot shared by every client that is sent the same one, it goes back to the pool once the last reference is released
+ * Not thread-safe, every thread that sends or receives owns its pool
+*/
+//! @note Buffers start on a cache line and their sizes are rounded up to it, so neighbouring buffers never share one
+# define PACKET_POOL_ALIGNMENT 64
+
+struct packet_buffer {
+    //! @note PACKET_POOL_ALIGNMENT aligned, 'data_size' bytes
+    uint8_t*       data;
+    uint32_t       data_size;
+    //! @note Bytes in use, set by the owner
+    uint32_t       data_len;
+    uint32_t       refs;
+    packet_pool_t* pool;
+};
+
+struct packet_pool {
+    void*             memory;
+    packet_buffer_t*  buffers;
+    uint32_t          buffers_size;
+    uint32_t          buffer_size;
+    //! @note Stack of the free buffers
+    packet_buffer_t** free;
+    uint32_t          free_fill;
+    //! @note Acquires that failed because every buffer was in use
+    uint64_t          acquires_failed;
+};
+
+/**
+ * @param buffer_size rounded up to PACKET_POOL_ALIGNMENT
+*/
+bool packet_pool__create(packet_pool_t* self, uint32_t buffers_size, uint32_t buffer_size);
+//! @note Every buffer must be released by then
+void packet_pool__destroy(packet_pool_t* self);
+
+//! @returns A buffer with a single reference and no bytes in use, 0 if every buffer is in use
+packet_buffer_t* packet_pool__acquire(packet_pool_t* self);
+
+void packet_buffer__retain(packet_buffer_t* self);
+//! @brief Drops a reference, the buffer goes back to its pool with the last one
+void packet_buffer__release(packet_buffer_t* self);
+
+#endif // PACKET_POOL_H
@@ -0,0 +1,124 @@
+#include "prediction.h"
+
+#include <math.h>
+#include <string.h>
+#include <assert.h>
+
+//! @note Range of vec3_t in packet_format.g_netformat
+#define PREDICTION_POSITION_MAX 512.0f
+
+static float prediction__clamp_position(float value);
+//! @brief Rounds 'self' to what the other end decodes
+static void object_state__quantize(object_state_t* self);
+static void game_data__quantize(game_data_t* self);
+
+static float prediction__clamp_position(float value) {
+    if (!(value >= -PREDICTION_POSITION_MAX)) {
+        return -PREDICTION_POSITION_MAX;
+    }
+
+    return value > PREDICTION_POSITION_MAX ? PREDICTION_POSITION_MAX : value;
+}
+
+static void object_state__quantize(object_state_t* self) {
+    uint8_t buffer[OBJECT_STATE_SIZE_MAX];
+    const bool is_written = object_state__write(self, buffer, sizeof(buffer), 0);
+    const bool is_read = is_written && object_state__read(self, buffer, sizeof(buffer), 0);
+    assert(is_read);
+    (void) is_read;
+}
+
+static void game_data__quantize(game_data_t* self) {
+    uint8_t buffer[GAME_DATA_SIZE_MAX];
+    if (!game_data__write(self, buffer, sizeof(buffer), 0) || !game_data__read(self, buffer, sizeof(buffer), 0)) {
+        // note: out of range, the server can't be sent it either
+        self->yaw = 0.0f;
+    }
+}
+
+void prediction__simulate(prediction_simulate_t simulate, object_state_t* state, const game_data_t* input) {
+    simulate(state, input, (float) PREDICTION_INPUT_TIME);
+    state->position.x = prediction__clamp_position(state->position.x);
+    state->position.y = prediction__clamp_position(state->position.y);
+    state->position.z = prediction__clamp_position(state->position.z);
+    object_state__quantize(state);
+}
+
+void prediction__create(prediction_t* self, const object_state_t* state, prediction_simulate_t simulate) {
+    memset(self, 0, sizeof(*self));
+    self->simulate  = simulate;
+    self->predicted = *state;
+    object_state__quantize(&self->predicted);
+}
+
+void prediction__push_input(prediction_t* self, seq_id_t sequence_id, const game_data_t* input) {
+    prediction_input_t* prediction_input = &self->inputs[sequence_id % PREDICTION_INPUTS_SIZE];
+    prediction_input->sequence_id = sequence_id;
+    prediction_input->input       = *input;
+    // note: the server simulates the input as it decodes it
+    game_data__quantize(&prediction_input->input);
+    self->sequence_id_newest = sequence_id;
+    self->is_pushed          = true;
+
+    prediction__simulate(self->simulate, &self->predicted, &prediction_input->input);
+}
+
+void prediction__reconcile(prediction_t* self, seq_id_t sequence_id, const object_state_t* state) {
+    if (self->is_reconciled && !sequence_id__is_more_recent(sequence_id, self->sequence_id_reconciled)) {
+        return ;
+    }
+    if (!self->is_pushed || sequence_id__is_more_recent(sequence_id, self->sequence_id_newest)) {
+        // note: the server only acknowledges what was sent, it's not from this session
+        return ;
+    }
+    self->sequence_id_reconciled = sequence_id;
+    self->is_reconciled          = true;
+    ++self->reconciles;
+
+    const object_state_t predicted_previous = self->predicted;
+    self->predicted = *state;
+    const uint32_t inputs_to_replay = sequence_id__delta(self->sequence_id_newest, sequence_id);
+    if (inputs_to_replay < PREDICTION_INPUTS_SIZE) {
+        for (uint32_t input_offset = 1; input_offset <= inputs_to_replay; ++input_offset) {
+            const seq_id_t input_sequence_id = sequence_id__sub(self->sequence_id_newest, inputs_to_replay - input_offset);
+            const prediction_input_t* prediction_input = &self->inputs[input_sequence_id % PREDICTION_INPUTS_SIZE];
+            if (prediction_input->sequence_id != input_sequence_id) {
+                // note: from before the first input pushed
+                continue ;
+            }
+            prediction__simulate(self->simulate, &self->predicted, &prediction_input->input);
+        }
+    }
+
+    // note: what's shown stays where it was, the correction decays from there
+    const vec3_t error = {
+        .x = predicted_previous.position.x - self->predicted.position.x,
+        .y = predicted_previous.position.y - self->predicted.position.y,
+        .z = predicted_previous.position.z - self->predicted.position.z
+    };
+    if (error.x == 0.0f && error.y == 0.0f && error.z == 0.0f) {
+        return ;
+    }
+    ++self->reconciles_corrected;
+    self->correction.x += error.x;
+    self->correction.y += error.y;
+    self->correction.z += error.z;
+    const float correction_distance = sqrtf(
+        self->correction.x * self->correction.x + self->correction.y * self->correction.y + self->correction.z * self->correction.z
+    );
+    if (correction_distance > PREDICTION_CORRECTION_SNAP_DISTANCE) {
+        memset(&self->correction, 0, sizeof(self->correction));
+    }
+}
+
+void prediction__smooth(prediction_t* self, double s, object_state_t* shown) {
+    const float decay = (float) pow(0.5, s / PREDICTION_CORRECTION_HALF_LIFE);
+    self->correction.x *= decay;
+    self->correction.y *= decay;
+    self->correction.z *= decay;
+
+    *shown = self->predicted;
+    shown->position.x += self->correction.x;
+    shown->position.y += self->correction.y;
+    shown->position.z += self->correction.z;
+}
@@ -0,0 +1,79 @@
+#ifndef PREDICTION_H
+# define PREDICTION_H
+
+# include "packet.h"
+
+# include <stdint.h>
+# include <stdbool.h>
+
+struct         prediction;
+struct         prediction_input;
+typedef struct prediction       prediction_t;
+typedef struct prediction_input prediction_input_t;
+
+/**
+ * Client-side prediction of the player of the client
+ * Inputs move the player locally as soon as they are sent, the same way the server moves it when they arrive, see prediction__simulate
+ * Every packet of the server carries the state of the player after the newest input it received, so the client restarts from it
+ * and replays the inputs it sent since, they are kept in a ring by sequence id, the player only ever shows the round trip
+ * when the server disagrees, for example after an input was lost
+ * Corrections are not applied at once, the difference is kept as an offset that decays, so the player glides to where it should be
+*/
+//! @note Power of two, inputs unacknowledged for longer can't be replayed, the player snaps to the server then
+# define PREDICTION_INPUTS_SIZE              128
+//! @note In seconds, how long it takes for half of a correction to show
+# define PREDICTION_CORRECTION_HALF_LIFE     0.1
+//! @note Larger corrections are shown at once, for example a teleport
+# define PREDICTION_CORRECTION_SNAP_DISTANCE 4.0f
+//! @note In seconds, how far a player moves with the input of a single packet, both ends step by the same time so they agree
+# define PREDICTION_INPUT_TIME               (1.0 / 60.0)
+
+/**
+ * Moves 'state' by a single input for 's' seconds, the rules of the game, both ends must step by the same one
+ * It doesn't need to keep the state in the range of the wire format, prediction__simulate does
+*/
+typedef void (*prediction_simulate_t)(object_state_t* state, const game_data_t* input, float s);
+
+struct prediction_input {
+    seq_id_t    sequence_id;
+    game_data_t input;
+};
+
+struct prediction {
+    prediction_simulate_t simulate;
+    //! @note Indexed by sequence id modulo PREDICTION_INPUTS_SIZE
+    prediction_input_t inputs[PREDICTION_INPUTS_SIZE];
+    seq_id_t           sequence_id_newest;
+    bool               is_pushed;
+    //! @note Sequence id of the input the last state of the server was after
+    seq_id_t           sequence_id_reconciled;
+    bool               is_reconciled;
+    object_state_t     predicted;
+    //! @note Added to 'predicted' when shown, decays to 0
+    vec3_t             correction;
+    uint32_t           reconciles;
+    uint32_t           reconciles_corrected;
+};
+
+/**
+ * @brief Moves 'state' by a single input with 'simulate', PREDICTION_INPUT_TIME long, the server steps its players through it too
+ * @note The result is quantized as it's sent, so the client replays from the exact state the server simulated
+*/
+void prediction__simulate(prediction_simulate_t simulate, object_state_t* state, const game_data_t* input);
+
+void prediction__create(prediction_t* self, const object_state_t* state, prediction_simulate_t simulate);
+
+//! @brief Keeps the input sent with 'sequence_id' and moves the predicted player by it
+void prediction__push_input(prediction_t* self, seq_id_t sequence_id, const game_data_t* input);
+/**
+ * @brief Restarts from 'state', the state of the server after the input sent with 'sequence_id', and replays the newer inputs
+ * @note Ignored if it's older than the last one, packets of the server can arrive out of order
+*/
+void prediction__reconcile(prediction_t* self, seq_id_t sequence_id, const object_state_t* state);
+/**
+ * @brief Decays the correction by 's' seconds
+ * @param shown the predicted player with what is left of the correction, as it's to be shown
+*/
+void prediction__smooth(prediction_t* self, double s, object_state_t* shown);
+
+#endif // PREDICTION_H
@@ -0,0 +1,117 @@
+#include "priority_accumulator.h"
+
+#include "memory.h"
+#include "debug.h"
+
+#include <math.h>
+#include <string.h>
+
+static float vec3__distance(const vec3_t* a, const vec3_t* b);
+/**
+ * @brief Reorders 'candidates' so the 'count' ones with the highest priority are in front, quickselect
+ * @param count less than 'candidates_fill'
+*/
+static void priority_accumulator__select(const float* priorities, uint32_t* candidates, uint32_t candidates_fill, uint32_t count);
+
+static float vec3__distance(const vec3_t* a, const vec3_t* b) {
+    const float x = a->x - b->x;
+    const float y = a->y - b->y;
+    const float z = a->z - b->z;
+
+    return sqrtf(x * x + y * y + z * z);
+}
+
+static void priority_accumulator__select(const float* priorities, uint32_t* candidates, uint32_t candidates_fill, uint32_t count) {
+    uint32_t left  = 0;
+    uint32_t right = candidates_fill - 1;
+    while (left < right) {
+        // note: median of three, the priorities of objects that are sent often are sorted already
+        const uint32_t middle = left + (right - left) / 2;
+        const float a = priorities[candidates[left]];
+        const float b = priorities[candidates[middle]];
+        const float c = priorities[candidates[right]];
+        const float pivot = (a > b) == (b > c) ? b : ((a > b) == (a < c) ? a : c);
+
+        uint32_t i = left;
+        uint32_t j = right;
+        while (i <= j) {
+            while (priorities[candidates[i]] > pivot) {
+                ++i;
+            }
+            while (priorities[candidates[j]] < pivot) {
+                --j;
+            }
+            if (i <= j) {
+                const uint32_t candidate = candidates[i];
+                candidates[i] = candidates[j];
+                candidates[j] = candidate;
+                ++i;
+                if (j == 0) {
+                    break ;
+                }
+                --j;
+            }
+        }
+
+        // note: [left, j] >= pivot >= [i, right], the boundary is at 'count'
+        if (count <= j) {
+            right = j;
+        } else if (count >= i) {
+            left = i;
+        } else {
+            break ;
+        }
+    }
+}
+
+bool priority_accumulator__create(priority_accumulator_t* self, uint32_t objects_size) {
+    memset(self, 0, sizeof(*self));
+
+    self->priorities = memory__calloc(DEBUG_MODULE_TP, objects_size, sizeof(*self->priorities));
+    self->candidates = memory__malloc(DEBUG_MODULE_TP, objects_size * sizeof(*self->candidates));
+    if (!self->priorities || !self->candidates) {
+        priority_accumulator__destroy(self);
+        return false;
+    }
+    self->objects_size = objects_size;
+
+    return true;
+}
+
+void priority_accumulator__destroy(priority_accumulator_t* self) {
+    memory__free(DEBUG_MODULE_TP, self->priorities);
+    memory__free(DEBUG_MODULE_TP, self->candidates);
+    memset(self, 0, sizeof(*self));
+}
+
+void priority_accumulator__clear(priority_accumulator_t* self) {
+    memset(self->priorities, 0, self->objects_size * sizeof(*self->priorities));
+}
+
+float priority_accumulator__object_priority(const object_state_t* object, const object_state_t* sent, const object_state_t* viewer) {
+    const float distance = vec3__distance(&object->position, &viewer->position);
+    const float change   = vec3__distance(&object->position, &sent->position);
+
+    return (1.0f + change * PRIORITY_ACCUMULATOR_CHANGE_WEIGHT) / (1.0f + distance / PRIORITY_ACCUMULATOR_DISTANCE_HALF);
+}
+
+uint32_t priority_accumulator__pop(priority_accumulator_t* self, uint32_t* selected, uint32_t selected_size) {
+    uint32_t candidates_fill = 0;
+    for (uint32_t object_index = 0; object_index < self->objects_size; ++object_index) {
+        if (self->priorities[object_index] > 0.0f) {
+            self->candidates[candidates_fill++] = object_index;
+        }
+    }
+
+    if (candidates_fill > selected_size) {
+        priority_accumulator__select(self->priorities, self->candidates, candidates_fill, selected_size);
+        candidates_fill = selected_size;
+    }
+    for (uint32_t candidate_index = 0; candidate_index < candidates_fill; ++candidate_index) {
+        const uint32_t object_index = self->candidates[candidate_index];
+        selected[candidate_index] = object_index;
+        self->priorities[object_index] = 0.0f;
+    }
+
+    return candidates_fill;
+}
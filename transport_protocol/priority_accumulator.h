@@ -0,0 +1,60 @@
+#ifndef PRIORITY_ACCUMULATOR_H
+# define PRIORITY_ACCUMULATOR_H
+
+# include "packet.h"
+
+# include <stdint.h>
+# include <stdbool.h>
+
+struct         priority_accumulator;
+typedef struct priority_accumulator priority_accumulator_t;
+
+/**
+ * Decides which objects a client is sent when they don't all fit into its budget
+ * Every object that is out of date on the client accrues priority every tick, more the closer it is to the client and the more it moved,
+ * the ones with the most priority are sent and start over from 0, so the rest catch up eventually however far they are
+ * The selection is a partial sort, only the objects that are sent end up in front, in no particular order
+*/
+//! @note Distance to the client at which the priority of an object halves
+# define PRIORITY_ACCUMULATOR_DISTANCE_HALF 16.0f
+//! @note Priority added per unit an object moved since it was sent, on top of 1
+# define PRIORITY_ACCUMULATOR_CHANGE_WEIGHT 1.0f
+
+struct priority_accumulator {
+    //! @note Indexed by object
+    float*    priorities;
+    //! @note Scratch for the selection
+    uint32_t* candidates;
+    uint32_t  objects_size;
+};
+
+bool priority_accumulator__create(priority_accumulator_t* self, uint32_t objects_size);
+void priority_accumulator__destroy(priority_accumulator_t* self);
+
+void priority_accumulator__clear(priority_accumulator_t* self);
+
+/**
+ * @param object current state of the object
+ * @param sent state of the object the client has
+ * @param viewer where the client is
+ * @returns Priority 'object' accrues for a tick
+*/
+float priority_accumulator__object_priority(const object_state_t* object, const object_state_t* sent, const object_state_t* viewer);
+
+static inline void priority_accumulator__add(priority_accumulator_t* self, uint32_t object_index, float priority) {
+    self->priorities[object_index] += priority;
+}
+
+//! @brief Drops the priority 'object_index' accrued, for an object that isn't relevant to the client anymore
+static inline void priority_accumulator__reset(priority_accumulator_t* self, uint32_t object_index) {
+    self->priorities[object_index] = 0.0f;
+}
+
+/**
+ * @brief Selects up to 'selected_size' objects with the highest priority above 0, their priority starts over
+ * @param selected at least 'selected_size' of them
+ * @returns Number of objects selected
+*/
+uint32_t priority_accumulator__pop(priority_accumulator_t* self, uint32_t* selected, uint32_t selected_size);
+
+#endif // PRIORITY_ACCUMULATOR_H
@@ -0,0 +1,122 @@
+#include "send_rate.h"
+
+#include <math.h>
+#include <string.h>
+
+static void send_rate__pop(send_rate_t* self);
+static void send_rate__add_rtt_sample(send_rate_t* self, double rtt);
+static void send_rate__add_loss_sample(send_rate_t* self, bool is_lost);
+static void send_rate__update_interval(send_rate_t* self, double time);
+
+static void send_rate__pop(send_rate_t* self) {
+    self->sent_head = (self->sent_head + 1) % SEND_RATE_SENT_SIZE;
+    --self->sent_fill;
+}
+
+static void send_rate__add_rtt_sample(send_rate_t* self, double rtt) {
+    if (!self->has_rtt) {
+        self->rtt_smoothed = rtt;
+        self->rtt_variance = rtt / 2.0;
+        self->has_rtt      = true;
+    } else {
+        self->rtt_variance = 0.75 * self->rtt_variance + 0.25 * fabs(self->rtt_smoothed - rtt);
+        self->rtt_smoothed = 0.875 * self->rtt_smoothed + 0.125 * rtt;
+    }
+}
+
+static void send_rate__add_loss_sample(send_rate_t* self, bool is_lost) {
+    self->loss += ((is_lost ? 1.0 : 0.0) - self->loss) * SEND_RATE_LOSS_GAIN;
+}
+
+static void send_rate__update_interval(send_rate_t* self, double time) {
+    const bool is_link_degraded = self->loss > SEND_RATE_LOSS_DEGRADED || (self->has_rtt && self->rtt_smoothed > SEND_RATE_RTT_DEGRADED);
+    const bool is_link_good     = self->loss < SEND_RATE_LOSS_GOOD && (!self->has_rtt || self->rtt_smoothed < SEND_RATE_RTT_GOOD);
+    double settle_time = self->has_rtt ? self->rtt_smoothed + 4.0 * self->rtt_variance : 0.0;
+    if (settle_time < SEND_RATE_SETTLE_TIME_MIN) {
+        settle_time = SEND_RATE_SETTLE_TIME_MIN;
+    }
+
+    if (is_link_degraded && self->send_interval < SEND_RATE_INTERVAL_MAX && time - self->time_changed >= settle_time) {
+        self->send_interval = self->send_interval << 1 < SEND_RATE_INTERVAL_MAX ? self->send_interval << 1 : SEND_RATE_INTERVAL_MAX;
+        // note: the loss that triggered it is accounted for, it takes fresh loss to back off further
+        if (self->loss > SEND_RATE_LOSS_DEGRADED / 2.0) {
+            self->loss = SEND_RATE_LOSS_DEGRADED / 2.0;
+        }
+        self->time_changed = time;
+    } else if (is_link_good && self->send_interval > 1 && time - self->time_changed >= SEND_RATE_RECOVERY_PERIOD) {
+        --self->send_interval;
+        self->time_changed = time;
+    }
+}
+
+void send_rate__create(send_rate_t* self, double time) {
+    memset(self, 0, sizeof(*self));
+    self->send_interval = 1;
+    self->time_changed  = time;
+}
+
+bool send_rate__tick(send_rate_t* self) {
+    if (++self->ticks_since_sent < self->send_interval) {
+        return false;
+    }
+    self->ticks_since_sent = 0;
+
+    return true;
+}
+
+uint32_t send_rate__skipped(const send_rate_t* self, seq_id_t sequence_id) {
+    if (!self->is_sent) {
+        return 0;
+    }
+
+    const uint32_t skipped = (uint32_t) sequence_id__delta(sequence_id, self->sequence_id_sent) - 1;
+
+    return skipped < SEND_RATE_INTERVAL_MAX ? skipped : SEND_RATE_INTERVAL_MAX - 1;
+}
+
+void send_rate__on_sent(send_rate_t* self, seq_id_t sequence_id, double time) {
+    if (self->sent_fill == SEND_RATE_SENT_SIZE) {
+        // note: nothing heard back about it for a long time, it's left out of the loss rate rather than guessed
+        send_rate__pop(self);
+    }
+
+    const uint32_t sent_index = (self->sent_head + self->sent_fill) % SEND_RATE_SENT_SIZE;
+    self->sent_sequence_ids[sent_index] = sequence_id;
+    self->sent_times[sent_index]        = time;
+    ++self->sent_fill;
+    self->sequence_id_sent = sequence_id;
+    self->is_sent          = true;
+}
+
+void send_rate__on_ack(send_rate_t* self, seq_id_t ack, const ack_window_t* ack_window, double time) {
+    uint32_t sent_acked_fill = 0;
+    for (uint32_t sent_offset = 0; sent_offset < self->sent_fill; ++sent_offset) {
+        if (sequence_id__is_more_recent(self->sent_sequence_ids[(self->sent_head + sent_offset) % SEND_RATE_SENT_SIZE], ack)) {
+            break ;
+        }
+        ++sent_acked_fill;
+    }
+
+    // note: the packets up to the ack are resolved in order, an unacknowledged one holds up the ones after it until it's found lost
+    while (sent_acked_fill > 0) {
+        const seq_id_t sequence_id = self->sent_sequence_ids[self->sent_head];
+        const uint32_t ack_delta = sequence_id__delta(ack, sequence_id);
+        const bool is_acked = ack_delta == 0 || ack_window__is_set(ack_window, ack_delta);
+        if (!is_acked && sent_acked_fill - 1 < SEND_RATE_LOSS_THRESHOLD) {
+            break ;
+        }
+
+        if (ack_delta == 0) {
+            send_rate__add_rtt_sample(self, time - self->sent_times[self->sent_head]);
+        }
+        send_rate__add_loss_sample(self, !is_acked);
+        send_rate__pop(self);
+        --sent_acked_fill;
+    }
+
+    send_rate__update_interval(self, time);
+}
+
+bool send_rate__is_degraded(const send_rate_t* self) {
+    return self->send_interval > 1;
+}
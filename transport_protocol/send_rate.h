@@ -0,0 +1,72 @@
+#ifndef SEND_RATE_H
+# define SEND_RATE_H
+
+# include "packet.h"
+
+# include <stdint.h>
+# include <stdbool.h>
+
+struct         send_rate;
+typedef struct send_rate send_rate_t;
+
+/**
+ * Per connection send rate, packets go out every 'send_interval' ticks
+ * The interval doubles when the link degrades, that is loss or rtt past the degraded thresholds,
+ * and it comes back one tick at a time while the link stays good
+*/
+# define SEND_RATE_INTERVAL_MAX       8
+//! @note Packets sent and not acknowledged or lost yet, older ones are dropped without being counted
+# define SEND_RATE_SENT_SIZE          32
+//! @note A packet is lost if it's unacknowledged while this many packets sent after it were received, tolerates some reordering
+# define SEND_RATE_LOSS_THRESHOLD     3
+//! @note Weight of a packet in the loss rate
+# define SEND_RATE_LOSS_GAIN          (1.0 / 16.0)
+# define SEND_RATE_LOSS_DEGRADED      0.1
+# define SEND_RATE_LOSS_GOOD          0.02
+//! @note In seconds
+# define SEND_RATE_RTT_DEGRADED       0.3
+# define SEND_RATE_RTT_GOOD           0.2
+//! @note Time the link needs to stay good for the interval to come down by a tick
+# define SEND_RATE_RECOVERY_PERIOD    1.0
+//! @note Least time between two changes, it's a round trip otherwise, so a change shows in the measurements before the next one
+# define SEND_RATE_SETTLE_TIME_MIN    0.25
+
+struct send_rate {
+    //! @note rfc 6298 estimators, in seconds
+    double   rtt_smoothed;
+    double   rtt_variance;
+    //! @note Moving average of the fraction of packets lost
+    double   loss;
+    double   time_changed;
+    uint32_t send_interval;
+    uint32_t ticks_since_sent;
+    bool     has_rtt;
+    bool     is_sent;
+    seq_id_t sequence_id_sent;
+
+    //! @note Queue of the packets in flight, oldest first
+    seq_id_t sent_sequence_ids[SEND_RATE_SENT_SIZE];
+    double   sent_times[SEND_RATE_SENT_SIZE];
+    uint32_t sent_head;
+    uint32_t sent_fill;
+};
+
+void send_rate__create(send_rate_t* self, double time);
+
+//! @returns true if a packet is due this tick
+bool send_rate__tick(send_rate_t* self);
+/**
+ * @returns Number of sequence ids before 'sequence_id' that weren't sent since the previous packet, see packet_t::sequence_id_skipped
+*/
+uint32_t send_rate__skipped(const send_rate_t* self, seq_id_t sequence_id);
+void send_rate__on_sent(send_rate_t* self, seq_id_t sequence_id, double time);
+/**
+ * @brief Updates the estimators from the ack window of a packet received at 'time', and the send interval from them
+ * @param ack newest of our sequence ids they received, only call with acks that were validated against what was sent
+*/
+void send_rate__on_ack(send_rate_t* self, seq_id_t ack, const ack_window_t* ack_window, double time);
+
+//! @returns true if the interval is raised because of the link
+bool send_rate__is_degraded(const send_rate_t* self);
+
+#endif // SEND_RATE_H
@@ -0,0 +1,145 @@
+#include "snapshot_buffer.h"
+
+#include <math.h>
+#include <string.h>
+
+static void object_state__interpolate(object_state_t* self, const object_state_t* from, const object_state_t* to, float t);
+static void snapshot__interpolate(snapshot_t* self, const snapshot_t* from, const snapshot_t* to, float t);
+
+static void object_state__interpolate(object_state_t* self, const object_state_t* from, const object_state_t* to, float t) {
+    self->position.x = from->position.x + (to->position.x - from->position.x) * t;
+    self->position.y = from->position.y + (to->position.y - from->position.y) * t;
+    self->position.z = from->position.z + (to->position.z - from->position.z) * t;
+    // note: turns the short way around
+    const float yaw_delta = remainderf(to->yaw - from->yaw, 2.0f * (float) M_PI);
+    self->yaw = remainderf(from->yaw + yaw_delta * t, 2.0f * (float) M_PI);
+}
+
+static void snapshot__interpolate(snapshot_t* self, const snapshot_t* from, const snapshot_t* to, float t) {
+    const uint32_t objects_common = from->objects_fill < to->objects_fill ? from->objects_fill : to->objects_fill;
+    for (uint32_t object_index = 0; object_index < objects_common; ++object_index) {
+        object_state__interpolate(&self->objects[object_index], &from->objects[object_index], &to->objects[object_index], t);
+    }
+    // note: objects that are only in the newer one appear at once
+    memcpy(&self->objects[objects_common], &to->objects[objects_common], (to->objects_fill - objects_common) * sizeof(*self->objects));
+    self->objects_fill = to->objects_fill;
+}
+
+void snapshot_buffer__create(snapshot_buffer_t* self) {
+    memset(self, 0, sizeof(*self));
+}
+
+void snapshot_buffer__push(snapshot_buffer_t* self, seq_id_t sequence_id, double tick_interval, double time) {
+    if (!self->is_started || tick_interval != self->tick_interval || !(tick_interval > 0.0)) {
+        snapshot_buffer__create(self);
+        self->is_started         = tick_interval > 0.0;
+        self->tick_interval      = tick_interval;
+        self->sequence_id_newest = sequence_id;
+        self->offset             = time;
+        self->time_offset        = time;
+        self->gap                = 1.0;
+        return ;
+    }
+
+    int64_t tick = self->tick_newest;
+    if (sequence_id__is_more_recent(sequence_id, self->sequence_id_newest)) {
+        const uint32_t ticks_advanced = sequence_id__delta(sequence_id, self->sequence_id_newest);
+        self->gap += ((double) ticks_advanced - self->gap) * SNAPSHOT_BUFFER_GAIN;
+        tick += ticks_advanced;
+        self->tick_newest        = tick;
+        self->sequence_id_newest = sequence_id;
+    } else {
+        tick -= sequence_id__delta(self->sequence_id_newest, sequence_id);
+    }
+
+    // note: the estimate only moves later slowly, so a single fast snapshot pulls it back to the fastest path
+    const double offset         = time - (double) tick * self->tick_interval;
+    const double offset_drifted = self->offset + (time - self->time_offset) * SNAPSHOT_BUFFER_OFFSET_DRIFT;
+    self->offset      = offset < offset_drifted ? offset : offset_drifted;
+    self->time_offset = time;
+    self->jitter     += (offset - self->offset - self->jitter) * SNAPSHOT_BUFFER_GAIN;
+}
+
+double snapshot_buffer__delay_target(const snapshot_buffer_t* self) {
+    const double delay = self->gap * self->tick_interval + SNAPSHOT_BUFFER_JITTER_FACTOR * self->jitter + SNAPSHOT_BUFFER_DELAY_MARGIN;
+    // note: what is shown has to stay in the history
+    const double delay_max = (SNAPSHOT_HISTORY_SIZE / 2) * self->tick_interval;
+
+    return delay < delay_max ? delay : delay_max;
+}
+
+bool snapshot_buffer__sample(
+    snapshot_buffer_t* self, double time,
+    const snapshot_t* snapshots, const seq_id_t* sequence_ids, const bool* is_valid,
+    snapshot_t* result
+) {
+    if (!self->is_started) {
+        return false;
+    }
+
+    const double delay_target = snapshot_buffer__delay_target(self);
+    if (!self->is_shown) {
+        self->delay    = delay_target;
+        self->is_shown = true;
+    } else if (time > self->time_shown) {
+        const double delay_step = (time - self->time_shown) * SNAPSHOT_BUFFER_DELAY_SLEW;
+        if (self->delay < delay_target) {
+            self->delay = self->delay + delay_step < delay_target ? self->delay + delay_step : delay_target;
+        } else {
+            self->delay = self->delay - delay_step > delay_target ? self->delay - delay_step : delay_target;
+        }
+    }
+    self->time_shown = time;
+
+    // note: in ticks before the newest snapshot, negative if it's past it
+    const double tick_shown  = (time - self->offset - self->delay) / self->tick_interval;
+    double       ticks_behind = (double) self->tick_newest - tick_shown;
+
+    // note: the snapshots right after and right before the time shown, by their age in ticks
+    uint32_t age_after  = SNAPSHOT_HISTORY_SIZE;
+    uint32_t age_before = SNAPSHOT_HISTORY_SIZE;
+    for (uint32_t age = 0; age < SNAPSHOT_HISTORY_SIZE; ++age) {
+        const seq_id_t sequence_id = sequence_id__sub(self->sequence_id_newest, age);
+        const uint32_t index       = sequence_id % SNAPSHOT_HISTORY_SIZE;
+        if (!is_valid[index] || sequence_ids[index] != sequence_id) {
+            continue ;
+        }
+        if ((double) age < ticks_behind) {
+            age_after = age;
+        } else if (age_before == SNAPSHOT_HISTORY_SIZE) {
+            age_before = age;
+            if (age_after < SNAPSHOT_HISTORY_SIZE) {
+                break ;
+            }
+        } else {
+            // note: past the newest one, extrapolated from the two newest
+            age_after = age_before;
+            age_before = age;
+            break ;
+        }
+    }
+
+    if (age_before == SNAPSHOT_HISTORY_SIZE && age_after == SNAPSHOT_HISTORY_SIZE) {
+        return false;
+    }
+    if (age_before == SNAPSHOT_HISTORY_SIZE || age_after == SNAPSHOT_HISTORY_SIZE) {
+        // note: older than the history or a single snapshot in it, held
+        const uint32_t age = age_before == SNAPSHOT_HISTORY_SIZE ? age_after : age_before;
+        *result = snapshots[sequence_id__sub(self->sequence_id_newest, age) % SNAPSHOT_HISTORY_SIZE];
+        return true;
+    }
+
+    const double ticks_behind_min = (double) age_after - SNAPSHOT_BUFFER_EXTRAPOLATION_MAX / self->tick_interval;
+    if (ticks_behind < ticks_behind_min) {
+        ticks_behind = ticks_behind_min;
+    }
+    const float t = (float) (((double) age_before - ticks_behind) / (double) (age_before - age_after));
+    snapshot__interpolate(
+        result,
+        &snapshots[sequence_id__sub(self->sequence_id_newest, age_before) % SNAPSHOT_HISTORY_SIZE],
+        &snapshots[sequence_id__sub(self->sequence_id_newest, age_after) % SNAPSHOT_HISTORY_SIZE],
+        t
+    );
+
+    return true;
+}
@@ -0,0 +1,76 @@
+#ifndef SNAPSHOT_BUFFER_H
+# define SNAPSHOT_BUFFER_H
+
+# include "packet.h"
+
+# include <stdint.h>
+# include <stdbool.h>
+
+struct         snapshot_buffer;
+typedef struct snapshot_buffer snapshot_buffer_t;
+
+/**
+ * Jitter buffer of the snapshots a client receives, the remote objects are shown a short delay behind the newest snapshot,
+ * interpolated between the two snapshots around that time, so they move smoothly at any frame rate and any send rate of the server
+ * Snapshots are timed by their sequence id, the ticks of the server, see packet_t::tick_interval
+ * The arrival time of tick 0 is estimated from the fastest arrival seen, the delay is what it takes for a snapshot to be there
+ * by the time it's shown, the average gap between the snapshots plus a multiple of how late they arrive on average
+ * The delay follows it by speeding up or slowing down the clock of the shown snapshots, so the objects never jump
+ * Past the newest snapshot, on loss or a late one, the objects are extrapolated for up to SNAPSHOT_BUFFER_EXTRAPOLATION_MAX and then held
+*/
+//! @note Weight of a sample in the averages of the jitter and the gap between snapshots
+# define SNAPSHOT_BUFFER_GAIN              (1.0 / 16.0)
+//! @note Delay added per second of average lateness
+# define SNAPSHOT_BUFFER_JITTER_FACTOR     3.0
+//! @note In seconds, the delay is at least this much on top of the gap between snapshots, the scheduler of either end is late too
+# define SNAPSHOT_BUFFER_DELAY_MARGIN      0.005
+//! @note In seconds per second, how fast the estimated arrival of tick 0 moves later, follows a slower path or clock drift
+# define SNAPSHOT_BUFFER_OFFSET_DRIFT      0.01
+//! @note Fraction the shown time runs faster or slower by at most while the delay moves to its target
+# define SNAPSHOT_BUFFER_DELAY_SLEW        0.05
+//! @note In seconds past the newest snapshot
+# define SNAPSHOT_BUFFER_EXTRAPOLATION_MAX 0.1
+
+struct snapshot_buffer {
+    bool     is_started;
+    double   tick_interval;
+    //! @note Ticks since the first snapshot, sequence ids wrap around
+    int64_t  tick_newest;
+    seq_id_t sequence_id_newest;
+    //! @note Estimated arrival time of tick 0 on the fastest path
+    double   offset;
+    double   time_offset;
+    //! @note In seconds, average time the snapshots arrive after 'offset' says
+    double   jitter;
+    //! @note In ticks, average difference between the newest sequence ids received, more than 1 on loss or lowered send rate
+    double   gap;
+
+    //! @note In seconds behind the arrival of the fastest snapshots
+    double   delay;
+    bool     is_shown;
+    double   time_shown;
+};
+
+void snapshot_buffer__create(snapshot_buffer_t* self);
+
+/**
+ * @brief Times the snapshot of 'sequence_id', which arrived at 'time'
+ * @param tick_interval of the sender, see packet_t::tick_interval, the estimates restart if it changes
+*/
+void snapshot_buffer__push(snapshot_buffer_t* self, seq_id_t sequence_id, double tick_interval, double time);
+
+//! @returns Delay the shown time moves towards, in seconds behind the arrival of the fastest snapshots
+double snapshot_buffer__delay_target(const snapshot_buffer_t* self);
+
+/**
+ * @brief Interpolates the snapshots around the time shown at 'time', the delay is moved towards its target since the previous call
+ * @param snapshots history, indexed by sequence id modulo SNAPSHOT_HISTORY_SIZE, valid where 'is_valid' is and 'sequence_ids' match
+ * @returns false if no snapshot was pushed yet or none of them is in the history
+*/
+bool snapshot_buffer__sample(
+    snapshot_buffer_t* self, double time,
+    const snapshot_t* snapshots, const seq_id_t* sequence_ids, const bool* is_valid,
+    snapshot_t* result
+);
+
+#endif // SNAPSHOT_BUFFER_H
@@ -1,4 +1,13 @@
+// note: recvmmsg/sendmmsg
+#define _GNU_SOURCE
+
 #include "tp.h"
+#include "link_conditioner.h"
+#include "tp_shm.h"
+
+#include "system.h"
+#include "memory.h"
+#include "thread.h"
 
 #include <stdio.h>
 
@@ -7,10 +16,157 @@
 #include <assert.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/udp.h>
+#include <linux/filter.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <ifaddrs.h>
 #include <errno.h>
+#include <poll.h>
+
+//! kernel limits for a single UDP_SEGMENT send
+#define TP_GSO_SEGMENTS_MAX 64
+#define TP_GSO_PAYLOAD_MAX  (UINT16_MAX - sizeof(struct udphdr) - 20)
+
+static bool tp_socket__create_internal(tp_socket_t* self, socket_type_t type, uint16_t port, bool is_reuseport);
+static void network_addr__to_sockaddr(network_addr_t addr, struct sockaddr_in* sockaddr);
+static void network_addr__from_sockaddr(network_addr_t* self, const struct sockaddr_in* sockaddr);
+static bool tp_socket__send_raw(tp_socket_t* self, const void* data, uint32_t data_size, network_addr_t dst_info, bool is_connected);
+//! @brief Copies a gathered message into 'buffer'
+//! @returns false if it doesn't fit
+static bool tp_message__flatten(const tp_message_t* self, void* buffer, uint32_t buffer_size);
+//! @brief Sends the datagrams held by the link conditioner that are due
+static void tp_socket__release_conditioned(tp_socket_t* self);
+//! @returns The shared memory link a datagram of 'data_size' bytes to 'addr' goes through, 0 if it goes over UDP
+static tp_shm_link_t* tp_socket__shm_link(tp_socket_t* self, network_addr_t addr, uint32_t data_size);
+//! @brief Sends a datagram through the link to 'addr' if there is one
+//! @returns false if it has to go over UDP
+static bool tp_socket__send_shm(tp_socket_t* self, const void* data, uint32_t data_size, network_addr_t addr);
+//! @returns false once the peer of a connected socket is linked, UDP is only read every TP_SHM_MAINTENANCE_INTERVAL then
+static bool tp_socket__is_udp_due(tp_socket_t* self);
+/**
+ * @param messages_failed number of messages the kernel refused, they were skipped
+ * @returns Number of messages sent, the socket buffer stayed full if fewer than 'messages_size' were sent or failed
+*/
+static uint32_t tp_socket__send_data_batch_udp(tp_socket_t* self, const tp_message_t* messages, uint32_t messages_size, uint32_t* messages_failed);
+//! @returns false if the socket buffer didn't drain within TP_SEND_WRITABLE_TIMEOUT_MS
+static bool tp_socket__wait_writable(tp_socket_t* self);
+/**
+ * @brief Hands the proofs of shm addresses among 'messages' to the shm links, the last message takes the place of each
+ * @returns Number of messages left
+*/
+static uint32_t tp_socket__receive_shm_proofs(tp_socket_t* self, tp_message_t* messages, uint32_t messages_fill);
+
+static void network_addr__to_sockaddr(network_addr_t addr, struct sockaddr_in* sockaddr) {
+    memset(sockaddr, 0, sizeof(*sockaddr));
+    sockaddr->sin_addr.s_addr = addr.addr;
+    sockaddr->sin_family = AF_INET;
+    sockaddr->sin_port = addr.port;
+}
+
+static void network_addr__from_sockaddr(network_addr_t* self, const struct sockaddr_in* sockaddr) {
+    self->addr = sockaddr->sin_addr.s_addr;
+    self->port = sockaddr->sin_port;
+}
+
+static bool tp_socket__send_raw(tp_socket_t* self, const void* data, uint32_t data_size, network_addr_t dst_info, bool is_connected) {
+    if (is_connected) {
+        return send(self->socket, data, data_size, MSG_DONTWAIT) != -1;
+    }
+
+    struct sockaddr_in dst_addr;
+    network_addr__to_sockaddr(dst_info, &dst_addr);
+
+    return sendto(self->socket, data, data_size, MSG_DONTWAIT, (const struct sockaddr*) &dst_addr, sizeof(dst_addr)) != -1;
+}
+
+static void tp_socket__release_conditioned(tp_socket_t* self) {
+    const double time = system__get_time();
+    const link_conditioner_datagram_t* datagram = 0;
+    while ((datagram = link_conditioner__pop(self->link_conditioner, time))) {
+        // note: a full socket buffer loses it, as a congested link would
+        tp_socket__send_raw(self, datagram->data, datagram->data_size, datagram->addr, datagram->is_connected);
+    }
+}
+
+static tp_shm_link_t* tp_socket__shm_link(tp_socket_t* self, network_addr_t addr, uint32_t data_size) {
+    if (!self->shm || self->shm->links_active == 0 || self->link_conditioner || data_size > TP_SHM_DATAGRAM_SIZE_MAX) {
+        return 0;
+    }
+
+    return tp_shm__find_link(self->shm, addr);
+}
+
+static bool tp_socket__send_shm(tp_socket_t* self, const void* data, uint32_t data_size, network_addr_t addr) {
+    tp_shm_link_t* link = tp_socket__shm_link(self, addr, data_size);
+    if (!link) {
+        return false;
+    }
+
+    // note: a full ring drops it, as a full socket buffer of the peer would
+    tp_shm_link__send(link, data, data_size, 0, 0);
+    tp_shm__ring_doorbells(self->shm);
+
+    return true;
+}
+
+static bool tp_socket__is_udp_due(tp_socket_t* self) {
+    tp_shm_t* shm = self->shm;
+
+    return !shm || !shm->is_connected || shm->is_udp_due || !tp_shm__find_link(shm, shm->connected_addr);
+}
+
+static uint32_t tp_socket__receive_shm_proofs(tp_socket_t* self, tp_message_t* messages, uint32_t messages_fill) {
+    uint32_t message_index = 0;
+    while (message_index < messages_fill) {
+        tp_message_t* message = &messages[message_index];
+        if (!tp_shm__receive_proof(self->shm, message->data, message->data_len, message->addr)) {
+            ++message_index;
+            continue ;
+        }
+        // note: the messages keep their buffers, callers tell them apart by index
+        tp_message_t* last = &messages[--messages_fill];
+        if (last != message) {
+            memcpy(message->data, last->data, last->data_len);
+            message->data_len     = last->data_len;
+            message->segment_size = last->segment_size;
+            message->time_arrival = last->time_arrival;
+            message->addr         = last->addr;
+        }
+    }
+
+    return messages_fill;
+}
+
+static bool tp_message__flatten(const tp_message_t* self, void* buffer, uint32_t buffer_size) {
+    if (buffer_size < self->data_size) {
+        return false;
+    }
+
+    uint8_t* cur = buffer;
+    for (uint32_t iov_index = 0; iov_index < self->iovs_fill; ++iov_index) {
+        memcpy(cur, self->iovs[iov_index].iov_base, self->iovs[iov_index].iov_len);
+        cur += self->iovs[iov_index].iov_len;
+    }
+    assert((uint32_t) (cur - (uint8_t*) buffer) == self->data_size);
+
+    return true;
+}
+
+void tp_message__parse_control(tp_message_t* self, struct msghdr* msg) {
+    self->segment_size = self->data_len;
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(msg); cmsg; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+            int segment_size;
+            memcpy(&segment_size, CMSG_DATA(cmsg), sizeof(segment_size));
+            self->segment_size = segment_size;
+        } else if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            struct timespec timestamp;
+            memcpy(&timestamp, CMSG_DATA(cmsg), sizeof(timestamp));
+            self->time_arrival = system__get_time_from_platform_ns(timestamp.tv_sec * 1000000000ULL + timestamp.tv_nsec);
+        }
+    }
+}
 
 bool network_addr__create(network_addr_t* self, const char* ip, uint16_t port) {
     in_addr_t dst_in_addr = inet_addr(ip);
@@ -28,7 +184,27 @@ bool network_addr__is_same(network_addr_t* self, network_addr_t* other) {
     return self->addr == other->addr && self->port == other->port;
 }
 
-bool tp_socket__create(tp_socket_t* self, socket_type_t type, uint16_t port) {
+uint32_t hash_fn__network_addr(const void* network_addr_key) {
+    const network_addr_t* network_addr = network_addr_key;
+    // note: murmur3 finalizer, clients behind the same NAT only differ in the port
+    uint32_t result = network_addr->addr ^ (network_addr->port * 0x9e3779b1U);
+    result ^= result >> 16;
+    result *= 0x85ebca6bU;
+    result ^= result >> 13;
+    result *= 0xc2b2ae35U;
+    result ^= result >> 16;
+
+    return result;
+}
+
+bool eq_fn__network_addr(const void* network_addr_key_a, const void* network_addr_key_b) {
+    const network_addr_t* network_addr_a = network_addr_key_a;
+    const network_addr_t* network_addr_b = network_addr_key_b;
+
+    return network_addr_a->addr == network_addr_b->addr && network_addr_a->port == network_addr_b->port;
+}
+
+static bool tp_socket__create_internal(tp_socket_t* self, socket_type_t type, uint16_t port, bool is_reuseport) {
     struct sockaddr_in src_addr;
     src_addr.sin_addr.s_addr = htonl(INADDR_ANY);
     src_addr.sin_family = AF_INET;
@@ -59,19 +235,106 @@ bool tp_socket__create(tp_socket_t* self, socket_type_t type, uint16_t port) {
         close(socket_fd);
         return false;
     }
+    // note: has to be set before bind, on every socket of the port
+    if (is_reuseport && setsockopt(socket_fd, SOL_SOCKET, SO_REUSEPORT, (const void*) &opt, sizeof(opt)) != 0) {
+        perror(0);
+        close(socket_fd);
+        return false;
+    }
 
     if (bind(socket_fd, (const struct sockaddr*) &src_addr, sizeof(src_addr)) == -1) {
         perror(0);
+        close(socket_fd);
         return false;
     }
 
     self->socket = socket_fd;
+    self->offload = 0;
+    self->link_conditioner = 0;
+    self->shm = 0;
+    self->messages_send_failed = 0;
 
     return true;
 }
 
+bool tp_socket__create(tp_socket_t* self, socket_type_t type, uint16_t port) {
+    return tp_socket__create_internal(self, type, port, false);
+}
+
+bool tp_socket__create_reuseport(tp_socket_t* self, uint16_t port) {
+    return tp_socket__create_internal(self, SOCKET_TYPE_UDP, port, true);
+}
+
+bool tp_socket__steer_reuseport_by_cpu(tp_socket_t* self, uint32_t sockets_size) {
+    if (sockets_size == 0) {
+        return false;
+    }
+
+    // note: the cores the sockets are read on are the ones thread__pin_current picks, which are the allowed ones, not the first ones
+    uint32_t cpus[TP_STEER_CPUS_MAX];
+    uint32_t cores_size = thread__cores(cpus, TP_STEER_CPUS_MAX);
+    if (cores_size > TP_STEER_CPUS_MAX) {
+        cores_size = TP_STEER_CPUS_MAX;
+    }
+
+    /**
+     * The program returns the index of the socket in the group, a compare per allowed core:
+     *   A = cpu; if A == cpus[k] return k % sockets_size; ...; return A % sockets_size
+     * Cores the process can't run on fall through to the modulo, any socket does for them
+    */
+    const uint32_t code_size = 2 * cores_size + 3;
+    struct sock_filter* code = memory__malloc(DEBUG_MODULE_TP, code_size * sizeof(*code));
+    if (!code) {
+        return false;
+    }
+    uint32_t code_fill = 0;
+    code[code_fill++] = (struct sock_filter) { BPF_LD | BPF_W | BPF_ABS, 0, 0, (uint32_t) SKF_AD_OFF + SKF_AD_CPU };
+    for (uint32_t core = 0; core < cores_size; ++core) {
+        code[code_fill++] = (struct sock_filter) { BPF_JMP | BPF_JEQ | BPF_K, 0, 1, cpus[core] };
+        code[code_fill++] = (struct sock_filter) { BPF_RET | BPF_K, 0, 0, core % sockets_size };
+    }
+    code[code_fill++] = (struct sock_filter) { BPF_ALU | BPF_MOD | BPF_K, 0, 0, sockets_size };
+    code[code_fill++] = (struct sock_filter) { BPF_RET | BPF_A, 0, 0, 0 };
+    struct sock_fprog program = {
+        .len    = (unsigned short) code_fill,
+        .filter = code
+    };
+    const bool result = setsockopt(self->socket, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, (const void*) &program, sizeof(program)) == 0;
+    if (!result) {
+        perror("SO_ATTACH_REUSEPORT_CBPF");
+    }
+    memory__free(DEBUG_MODULE_TP, code);
+
+    return result;
+}
+
 void tp_socket__destroy(tp_socket_t* self) {
     close(self->socket);
+    memory__free(DEBUG_MODULE_TP, self->link_conditioner);
+    self->link_conditioner = 0;
+    if (self->shm) {
+        tp_shm__destroy(self->shm);
+        memory__free(DEBUG_MODULE_TP, self->shm);
+        self->shm = 0;
+    }
+}
+
+bool tp_socket__enable_shm(tp_socket_t* self) {
+    if (self->shm) {
+        return true;
+    }
+
+    tp_shm_t* shm = memory__malloc(DEBUG_MODULE_TP, sizeof(*shm));
+    if (!shm) {
+        return false;
+    }
+    if (!tp_shm__create(shm, self->socket)) {
+        memory__free(DEBUG_MODULE_TP, shm);
+        return false;
+    }
+    self->shm = shm;
+
+    return true;
 }
 
 bool tp_socket__connect(tp_socket_t* self, network_addr_t addr) {
@@ -85,47 +348,390 @@ bool tp_socket__connect(tp_socket_t* self, network_addr_t addr) {
         return false;
     }
 
+    if (self->shm) {
+        // note: the handshake finishes on a later call, datagrams go over UDP until then
+        tp_shm__connect(self->shm, self->socket, addr);
+    }
+
     return true;
 }
 
 bool tp_socket__send_data(tp_socket_t* self, const void* data, uint32_t data_size) {
-    if (send(self->socket, data, data_size, MSG_DONTWAIT) == -1) {
-        return false;
+    const network_addr_t dst_info = { 0 };
+    if (self->link_conditioner) {
+        link_conditioner__push(self->link_conditioner, data, data_size, dst_info, true, system__get_time());
+        tp_socket__release_conditioned(self);
+        return true;
     }
 
-    return true;
+    if (self->shm && self->shm->is_connected && tp_socket__send_shm(self, data, data_size, self->shm->connected_addr)) {
+        return true;
+    }
+
+    return tp_socket__send_raw(self, data, data_size, dst_info, true);
 }
 
 bool tp_socket__send_data_to(tp_socket_t* self, const void* data, uint32_t data_size, network_addr_t dst_info) {
-    struct sockaddr_in dst_addr = { 0 };
-    dst_addr.sin_addr.s_addr = dst_info.addr;
-    dst_addr.sin_family = AF_INET;
-    dst_addr.sin_port = dst_info.port;
-    if (sendto(self->socket, data, data_size, MSG_DONTWAIT, (const struct sockaddr*) &dst_addr, sizeof(dst_addr)) == -1) {
-        return false;
+    if (self->link_conditioner) {
+        link_conditioner__push(self->link_conditioner, data, data_size, dst_info, false, system__get_time());
+        tp_socket__release_conditioned(self);
+        return true;
     }
 
-    return true;
+    if (tp_socket__send_shm(self, data, data_size, dst_info)) {
+        return true;
+    }
+
+    return tp_socket__send_raw(self, data, data_size, dst_info, false);
 }
 
 bool tp_socket__get_data(tp_socket_t* self, void* data, uint32_t data_size, uint32_t* data_len, network_addr_t* sender_addr) {
-    struct sockaddr src_addr;
-    socklen_t src_addr_len_original = sizeof(src_addr);
-    socklen_t src_addr_len = src_addr_len_original;
-    ssize_t message_len = recvfrom(self->socket, data, data_size, MSG_DONTWAIT, &src_addr, &src_addr_len);
-    if (message_len == -1) {
-        return false;
+    if (self->link_conditioner) {
+        tp_socket__release_conditioned(self);
+    }
+
+    if (self->shm) {
+        const double time = system__get_time();
+        tp_shm__maintain(self->shm, time);
+        tp_message_t message = { .data = data, .data_size = data_size };
+        if (tp_shm__receive(self->shm, &message, 1, time) == 1) {
+            if (data_len) {
+                *data_len = message.data_len;
+            }
+            if (sender_addr) {
+                *sender_addr = message.addr;
+            }
+            return true;
+        }
+        if (!tp_socket__is_udp_due(self)) {
+            return false;
+        }
     }
 
-    if (data_len) {
-        *data_len = message_len;
+    while (true) {
+        struct sockaddr src_addr;
+        socklen_t src_addr_len_original = sizeof(src_addr);
+        socklen_t src_addr_len = src_addr_len_original;
+        ssize_t message_len = recvfrom(self->socket, data, data_size, MSG_DONTWAIT, &src_addr, &src_addr_len);
+        if (message_len == -1) {
+            if (self->shm) {
+                self->shm->is_udp_due = false;
+            }
+            return false;
+        }
+
+        network_addr_t addr = { 0 };
+        if (src_addr.sa_family == AF_INET && src_addr_len == src_addr_len_original) {
+            network_addr__from_sockaddr(&addr, (struct sockaddr_in*) &src_addr);
+        }
+        if (self->shm && tp_shm__receive_proof(self->shm, data, (uint32_t) message_len, addr)) {
+            continue ;
+        }
+
+        if (data_len) {
+            *data_len = message_len;
+        }
+        if (src_addr.sa_family == AF_INET && src_addr_len == src_addr_len_original && sender_addr) {
+            *sender_addr = addr;
+        }
+
+        return true;
     }
+}
 
-    if (src_addr.sa_family == AF_INET && src_addr_len == src_addr_len_original && sender_addr) {
-        struct sockaddr_in* src_addr_in = (struct sockaddr_in*) &src_addr;
-        sender_addr->addr = src_addr_in->sin_addr.s_addr;
-        sender_addr->port = src_addr_in->sin_port;
+bool tp_socket__enable_offload(tp_socket_t* self, uint32_t offload) {
+    // note: GSO is requested per send with a control message, this only probes for kernel support
+    if (offload & TP_SOCKET_OFFLOAD_GSO) {
+        int segment_size = 0;
+        if (setsockopt(self->socket, SOL_UDP, UDP_SEGMENT, (const void*) &segment_size, sizeof(segment_size)) == 0) {
+            self->offload |= TP_SOCKET_OFFLOAD_GSO;
+        }
     }
 
+    if (offload & TP_SOCKET_OFFLOAD_GRO) {
+        int opt = 1;
+        if (setsockopt(self->socket, SOL_UDP, UDP_GRO, (const void*) &opt, sizeof(opt)) == 0) {
+            self->offload |= TP_SOCKET_OFFLOAD_GRO;
+        }
+    }
+
+    if (offload & TP_SOCKET_OFFLOAD_TIMESTAMP) {
+        int opt = 1;
+        if (setsockopt(self->socket, SOL_SOCKET, SO_TIMESTAMPNS, (const void*) &opt, sizeof(opt)) == 0) {
+            self->offload |= TP_SOCKET_OFFLOAD_TIMESTAMP;
+        }
+    }
+
+    return (self->offload & offload) == offload;
+}
+
+bool tp_socket__set_link_conditioner(tp_socket_t* self, const link_conditioner_config_t* config) {
+    if (!config) {
+        memory__free(DEBUG_MODULE_TP, self->link_conditioner);
+        self->link_conditioner = 0;
+        return true;
+    }
+
+    link_conditioner_t* link_conditioner = self->link_conditioner;
+    if (!link_conditioner) {
+        link_conditioner = memory__malloc(DEBUG_MODULE_TP, sizeof(*link_conditioner));
+        if (!link_conditioner) {
+            return false;
+        }
+    }
+    if (!link_conditioner__create(link_conditioner, config)) {
+        if (link_conditioner != self->link_conditioner) {
+            memory__free(DEBUG_MODULE_TP, link_conditioner);
+        }
+        return false;
+    }
+    self->link_conditioner = link_conditioner;
+
     return true;
 }
+
+uint32_t tp_socket__get_data_batch(tp_socket_t* self, tp_message_t* messages, uint32_t messages_size) {
+    struct mmsghdr     mmsgs[TP_BATCH_SIZE];
+    struct iovec       iovs[TP_BATCH_SIZE];
+    struct sockaddr_in src_addrs[TP_BATCH_SIZE];
+    union {
+        char           buffer[TP_RECEIVE_CONTROL_SIZE];
+        struct cmsghdr align;
+    } controls[TP_BATCH_SIZE];
+
+    if (self->link_conditioner) {
+        tp_socket__release_conditioned(self);
+    }
+
+    uint32_t messages_received = 0;
+    if (self->shm) {
+        const double time = system__get_time();
+        tp_shm__maintain(self->shm, time);
+        messages_received = tp_shm__receive(self->shm, messages, messages_size, time);
+        if (!tp_socket__is_udp_due(self)) {
+            return messages_received;
+        }
+        self->shm->is_udp_due = false;
+    }
+
+    while (messages_received < messages_size) {
+        const uint32_t batch_size = messages_size - messages_received < TP_BATCH_SIZE ? messages_size - messages_received : TP_BATCH_SIZE;
+        tp_message_t* batch_messages = messages + messages_received;
+        for (uint32_t message_index = 0; message_index < batch_size; ++message_index) {
+            iovs[message_index].iov_base = batch_messages[message_index].data;
+            iovs[message_index].iov_len  = batch_messages[message_index].data_size;
+
+            struct msghdr* msg = &mmsgs[message_index].msg_hdr;
+            memset(msg, 0, sizeof(*msg));
+            msg->msg_name    = &src_addrs[message_index];
+            msg->msg_namelen = sizeof(src_addrs[message_index]);
+            msg->msg_iov     = &iovs[message_index];
+            msg->msg_iovlen  = 1;
+            if (self->offload & (TP_SOCKET_OFFLOAD_GRO | TP_SOCKET_OFFLOAD_TIMESTAMP)) {
+                msg->msg_control    = controls[message_index].buffer;
+                msg->msg_controllen = sizeof(controls[message_index].buffer);
+            }
+        }
+
+        int result = recvmmsg(self->socket, mmsgs, batch_size, MSG_DONTWAIT, 0);
+        if (result <= 0) {
+            break ;
+        }
+
+        const double time_received = system__get_time();
+
+        for (uint32_t message_index = 0; message_index < (uint32_t) result; ++message_index) {
+            tp_message_t* message = &batch_messages[message_index];
+            struct msghdr* msg = &mmsgs[message_index].msg_hdr;
+            message->data_len     = mmsgs[message_index].msg_len;
+            message->time_arrival = time_received;
+            tp_message__parse_control(message, msg);
+            if (src_addrs[message_index].sin_family == AF_INET && msg->msg_namelen == sizeof(src_addrs[message_index])) {
+                network_addr__from_sockaddr(&message->addr, &src_addrs[message_index]);
+            } else {
+                memset(&message->addr, 0, sizeof(message->addr));
+            }
+        }
+        messages_received += self->shm ? tp_socket__receive_shm_proofs(self, batch_messages, (uint32_t) result) : (uint32_t) result;
+
+        if ((uint32_t) result < batch_size) {
+            // note: socket is drained, avoid the extra syscall that would return EAGAIN
+            break ;
+        }
+    }
+
+    return messages_received;
+}
+
+static bool tp_socket__wait_writable(tp_socket_t* self) {
+    struct pollfd poll_fd = { .fd = self->socket, .events = POLLOUT };
+    int result = 0;
+    do {
+        result = poll(&poll_fd, 1, TP_SEND_WRITABLE_TIMEOUT_MS);
+    } while (result == -1 && errno == EINTR);
+
+    return result > 0 && (poll_fd.revents & POLLOUT);
+}
+
+static uint32_t tp_socket__send_data_batch_udp(tp_socket_t* self, const tp_message_t* messages, uint32_t messages_size, uint32_t* messages_failed) {
+    struct mmsghdr     mmsgs[TP_BATCH_SIZE];
+    struct iovec       iovs[TP_BATCH_SIZE * TP_MESSAGE_IOVS_MAX];
+    struct sockaddr_in dst_addrs[TP_BATCH_SIZE];
+    //! number of messages that each mmsg carries, more than 1 if they were coalesced with GSO
+    uint32_t           mmsg_messages[TP_BATCH_SIZE];
+    union {
+        char           buffer[CMSG_SPACE(sizeof(uint16_t))];
+        struct cmsghdr align;
+    } controls[TP_BATCH_SIZE];
+
+    uint32_t messages_sent = 0;
+    *messages_failed = 0;
+    while (messages_sent + *messages_failed < messages_size) {
+        const uint32_t messages_done = messages_sent + *messages_failed;
+        const uint32_t batch_size = messages_size - messages_done < TP_BATCH_SIZE ? messages_size - messages_done : TP_BATCH_SIZE;
+        const tp_message_t* batch_messages = messages + messages_done;
+        uint32_t mmsgs_size = 0;
+        uint32_t iovs_fill = 0;
+        uint32_t message_index = 0;
+        while (message_index < batch_size) {
+            const tp_message_t* message = &batch_messages[message_index];
+            uint32_t segments = 1;
+            uint32_t segments_payload = message->data_size;
+            if (self->offload & TP_SOCKET_OFFLOAD_GSO) {
+                // note: every segment but the last must be exactly the size of the first one
+                while (
+                    message_index + segments < batch_size &&
+                    segments < TP_GSO_SEGMENTS_MAX &&
+                    batch_messages[message_index + segments - 1].data_size == message->data_size &&
+                    batch_messages[message_index + segments].data_size <= message->data_size &&
+                    segments_payload + batch_messages[message_index + segments].data_size <= TP_GSO_PAYLOAD_MAX &&
+                    network_addr__is_same((network_addr_t*) &batch_messages[message_index + segments].addr, (network_addr_t*) &message->addr)
+                ) {
+                    segments_payload += batch_messages[message_index + segments].data_size;
+                    ++segments;
+                }
+            }
+
+            // note: the kernel splits the segments by size, so they can be gathered from any number of buffers each
+            const uint32_t iovs_first = iovs_fill;
+            for (uint32_t segment_index = 0; segment_index < segments; ++segment_index) {
+                const tp_message_t* segment = &batch_messages[message_index + segment_index];
+                if (segment->iovs) {
+                    assert(segment->iovs_fill <= TP_MESSAGE_IOVS_MAX);
+                    memcpy(&iovs[iovs_fill], segment->iovs, segment->iovs_fill * sizeof(*segment->iovs));
+                    iovs_fill += segment->iovs_fill;
+                } else {
+                    iovs[iovs_fill].iov_base = segment->data;
+                    iovs[iovs_fill].iov_len  = segment->data_size;
+                    ++iovs_fill;
+                }
+            }
+
+            network_addr__to_sockaddr(message->addr, &dst_addrs[mmsgs_size]);
+            struct msghdr* msg = &mmsgs[mmsgs_size].msg_hdr;
+            memset(msg, 0, sizeof(*msg));
+            msg->msg_name    = &dst_addrs[mmsgs_size];
+            msg->msg_namelen = sizeof(dst_addrs[mmsgs_size]);
+            msg->msg_iov     = &iovs[iovs_first];
+            msg->msg_iovlen  = iovs_fill - iovs_first;
+            if (segments > 1) {
+                msg->msg_control    = controls[mmsgs_size].buffer;
+                msg->msg_controllen = sizeof(controls[mmsgs_size].buffer);
+                struct cmsghdr* cmsg = CMSG_FIRSTHDR(msg);
+                cmsg->cmsg_level = SOL_UDP;
+                cmsg->cmsg_type  = UDP_SEGMENT;
+                cmsg->cmsg_len   = CMSG_LEN(sizeof(uint16_t));
+                const uint16_t segment_size = (uint16_t) message->data_size;
+                memcpy(CMSG_DATA(cmsg), &segment_size, sizeof(segment_size));
+            }
+            mmsg_messages[mmsgs_size] = segments;
+            ++mmsgs_size;
+
+            message_index += segments;
+        }
+
+        // note: the kernel stops at the first message that fails, it's reported by the next call
+        uint32_t mmsgs_sent = 0;
+        while (mmsgs_sent < mmsgs_size) {
+            int result = sendmmsg(self->socket, mmsgs + mmsgs_sent, mmsgs_size - mmsgs_sent, MSG_DONTWAIT);
+            if (result > 0) {
+                for (uint32_t mmsg_index = mmsgs_sent; mmsg_index < mmsgs_sent + (uint32_t) result; ++mmsg_index) {
+                    messages_sent += mmsg_messages[mmsg_index];
+                }
+                mmsgs_sent += (uint32_t) result;
+                continue ;
+            }
+            if (result == -1 && errno == EINTR) {
+                continue ;
+            }
+            if (result == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)) {
+                if (tp_socket__wait_writable(self)) {
+                    continue ;
+                }
+                // note: socket buffer is full
+                return messages_sent;
+            }
+            *messages_failed           += mmsg_messages[mmsgs_sent];
+            self->messages_send_failed += mmsg_messages[mmsgs_sent];
+            ++mmsgs_sent;
+        }
+    }
+
+    return messages_sent;
+}
+
+uint32_t tp_socket__send_data_batch(tp_socket_t* self, const tp_message_t* messages, uint32_t messages_size) {
+    if (self->link_conditioner) {
+        const double time = system__get_time();
+        for (uint32_t message_index = 0; message_index < messages_size; ++message_index) {
+            const tp_message_t* message = &messages[message_index];
+            if (message->iovs) {
+                // note: larger ones would be dropped by the link conditioner anyway
+                uint8_t datagram[LINK_CONDITIONER_DATAGRAM_SIZE_MAX];
+                if (tp_message__flatten(message, datagram, sizeof(datagram))) {
+                    link_conditioner__push(self->link_conditioner, datagram, message->data_size, message->addr, false, time);
+                }
+            } else {
+                link_conditioner__push(self->link_conditioner, message->data, message->data_size, message->addr, false, time);
+            }
+        }
+        tp_socket__release_conditioned(self);
+        return messages_size;
+    }
+
+    if (!self->shm || self->shm->links_active == 0) {
+        uint32_t messages_failed = 0;
+        return tp_socket__send_data_batch_udp(self, messages, messages_size, &messages_failed);
+    }
+
+    // note: the datagrams to linked peers are pushed to their rings, the rest are gathered for sendmmsg
+    tp_message_t udp_messages[TP_BATCH_SIZE];
+    uint32_t messages_sent = 0;
+    uint32_t message_index = 0;
+    while (message_index < messages_size) {
+        uint32_t udp_messages_fill = 0;
+        uint32_t shm_messages_sent = 0;
+        while (message_index < messages_size && udp_messages_fill < TP_BATCH_SIZE) {
+            const tp_message_t* message = &messages[message_index++];
+            tp_shm_link_t* link = tp_socket__shm_link(self, message->addr, message->data_size);
+            if (link) {
+                // note: a full ring drops it, as a full socket buffer of the peer would
+                tp_shm_link__send(link, message->data, message->data_size, message->iovs, message->iovs_fill);
+                ++shm_messages_sent;
+            } else {
+                udp_messages[udp_messages_fill++] = *message;
+            }
+        }
+
+        uint32_t udp_messages_failed = 0;
+        const uint32_t udp_messages_sent = udp_messages_fill > 0 ? tp_socket__send_data_batch_udp(self, udp_messages, udp_messages_fill, &udp_messages_failed) : 0;
+        messages_sent += shm_messages_sent + udp_messages_sent;
+        if (udp_messages_sent + udp_messages_failed < udp_messages_fill) {
+            // note: socket buffer is full
+            break ;
+        }
+    }
+    tp_shm__ring_doorbells(self->shm);
+
+    return messages_sent;
+}
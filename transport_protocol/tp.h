@@ -3,16 +3,48 @@
 
 # include <stdint.h>
 # include <stdbool.h>
+# include <time.h>
+# include <sys/socket.h>
+# include <sys/uio.h>
 
 struct         tp_socket;
 struct         network_addr;
+struct         tp_message;
+struct         link_conditioner;
+struct         link_conditioner_config;
+struct         tp_shm;
 enum           socket_type;
-typedef struct tp_socket    tp_socket_t;
-typedef struct network_addr network_addr_t;
-typedef enum   socket_type  socket_type_t;
+enum           tp_socket_offload;
+typedef struct tp_socket         tp_socket_t;
+typedef struct network_addr      network_addr_t;
+typedef struct tp_message        tp_message_t;
+typedef struct link_conditioner  link_conditioner_t;
+typedef struct link_conditioner_config link_conditioner_config_t;
+typedef struct tp_shm            tp_shm_t;
+typedef enum   socket_type       socket_type_t;
+typedef enum   tp_socket_offload tp_socket_offload_t;
+
+//! @brief Max number of messages that are moved with a single syscall by the batch APIs
+# define TP_BATCH_SIZE 64
+//! @note Cores tp_socket__steer_reuseport_by_cpu maps to their socket at most, a classic BPF program has 4096 instructions at most
+# define TP_STEER_CPUS_MAX 1024
+//! @brief Max number of buffers a message can be gathered from on send, see tp_message_t::iovs
+# define TP_MESSAGE_IOVS_MAX 4
+//! @brief Time the batch send waits for the socket buffer to drain once it's full, before it gives up on the rest of the batch
+# define TP_SEND_WRITABLE_TIMEOUT_MS 1
+//! @brief Size of the control buffer needed to receive every ancillary data of tp_socket_offload_t
+# define TP_RECEIVE_CONTROL_SIZE (CMSG_SPACE(sizeof(int)) + CMSG_SPACE(sizeof(struct timespec)))
 
 struct tp_socket {
-    int32_t socket;
+    int32_t  socket;
+    //! @note Mask of tp_socket_offload_t that were successfully enabled
+    uint32_t offload;
+    //! @note Impairs what's sent if set, see link_conditioner_t
+    link_conditioner_t* link_conditioner;
+    //! @note Datagrams to and from peers on this host go through shared memory if set, see tp_shm_t
+    tp_shm_t*           shm;
+    //! @note Datagrams the kernel refused to send by the batch API, they are skipped so the rest of the batch still goes out
+    uint64_t            messages_send_failed;
 };
 
 struct network_addr {
@@ -20,15 +52,65 @@ struct network_addr {
     uint32_t port;
 };
 
+struct tp_message {
+    void*          data;
+    //! @note Capacity of 'data' on receive, number of bytes to send on send
+    uint32_t       data_size;
+    //! @note Set on receive to the number of bytes received
+    uint32_t       data_len;
+    /**
+     * Set on receive, size of the datagrams that were coalesced into 'data' by GRO, the last one can be shorter
+     * Equals 'data_len' if nothing was coalesced
+    */
+    uint32_t       segment_size;
+    //! @note Set on receive, system time of arrival, taken by the kernel if TP_SOCKET_OFFLOAD_TIMESTAMP is enabled
+    double         time_arrival;
+    //! @note Sender on receive, destination on send
+    network_addr_t addr;
+    /**
+     * Send only, if set the datagram is gathered from these 'iovs_fill' buffers instead of read from 'data',
+     * at most TP_MESSAGE_IOVS_MAX, 'data_size' is still the size of the whole datagram
+    */
+    const struct iovec* iovs;
+    uint32_t            iovs_fill;
+};
+
 enum socket_type {
     SOCKET_TYPE_UDP,
     SOCKET_TYPE_TCP
 };
 
+enum tp_socket_offload {
+    //! consecutive equal-sized messages to the same destination are sent as a single UDP_SEGMENT datagram
+    TP_SOCKET_OFFLOAD_GSO = 1 << 0,
+    //! kernel coalesces datagrams of the same flow on receive, see tp_message_t::segment_size
+    TP_SOCKET_OFFLOAD_GRO = 1 << 1,
+    //! kernel timestamps datagrams when they arrive, see tp_message_t::time_arrival
+    TP_SOCKET_OFFLOAD_TIMESTAMP = 1 << 2
+};
+
 bool network_addr__create(network_addr_t* self, const char* ip, uint16_t port);
 bool network_addr__is_same(network_addr_t* self, network_addr_t* other);
+//! @note Hash and equality functions for hash_map_t with network_addr_t keys
+uint32_t hash_fn__network_addr(const void* network_addr_key);
+bool eq_fn__network_addr(const void* network_addr_key_a, const void* network_addr_key_b);
 
 bool tp_socket__create(tp_socket_t* self, socket_type_t type, uint16_t port);
+/**
+ * @brief Creates a UDP socket that shares 'port' with the other sockets created this way, with SO_REUSEPORT
+ * The kernel spreads the datagrams over the sockets of the port by a hash of the source and destination,
+ * so the datagrams of a client keep arriving on the same socket as long as no socket joins or leaves
+*/
+bool tp_socket__create_reuseport(tp_socket_t* self, uint16_t port);
+/**
+ * @brief Replaces the hash that spreads the datagrams over the sockets sharing the port of 'self' by the core that received them,
+ * the i-th socket created gets the datagrams received by cores i, i + 'sockets_size', ... of the ones the process may run on, see thread__cores,
+ * so a thread that thread__pin_current pinned to core i reads datagrams that are still in its caches,
+ * a client still stays on a single socket as the NIC steers a flow to a single core
+ * Only the first TP_STEER_CPUS_MAX of them are steered that way, the other cores by their cpu number modulo 'sockets_size' 
+ * @note Any socket of the port can set it, it applies to all of them
+*/
+bool tp_socket__steer_reuseport_by_cpu(tp_socket_t* self, uint32_t sockets_size);
 
 // bool tp_socket__create(tp_socket_t* self);
 void tp_socket__destroy(tp_socket_t* self);
@@ -42,4 +124,40 @@ bool tp_socket__send_data(tp_socket_t* self, const void* data, uint32_t data_siz
 bool tp_socket__send_data_to(tp_socket_t* self, const void* data, uint32_t data_size, network_addr_t dst_info);
 bool tp_socket__get_data(tp_socket_t* self, void* data, uint32_t data_size, uint32_t* data_len, network_addr_t* sender_addr);
 
+/**
+ * @brief Enables the requested UDP offloads that the kernel supports
+ * @returns true if all of them were enabled, the ones enabled are stored in 'offload' either way
+*/
+bool tp_socket__enable_offload(tp_socket_t* self, uint32_t offload);
+
+/**
+ * @brief Receives up to 'messages_size' datagrams with as few syscalls as possible
+ * @returns Number of messages filled
+*/
+uint32_t tp_socket__get_data_batch(tp_socket_t* self, tp_message_t* messages, uint32_t messages_size);
+/**
+ * @brief Sends up to 'messages_size' datagrams with as few syscalls as possible
+ * A datagram the kernel refuses, e.g. an unreachable destination, is skipped and counted in 'messages_send_failed'
+ * Once the socket buffer is full it waits up to TP_SEND_WRITABLE_TIMEOUT_MS for it to drain
+ * @returns Number of messages sent, stops early if the socket buffer stays full
+*/
+uint32_t tp_socket__send_data_batch(tp_socket_t* self, const tp_message_t* messages, uint32_t messages_size);
+
+/**
+ * @brief Impairs the datagrams sent from now on, GSO is not used while it's set
+ * @param config 0 to stop, the datagrams still held are dropped
+*/
+bool tp_socket__set_link_conditioner(tp_socket_t* self, const link_conditioner_config_t* config);
+
+/**
+ * @brief Moves the datagrams to and from peers on this host to shared memory, the others stay on UDP, see tp_shm_t
+ * Links to the peer of tp_socket__connect if it's local, and links with the local peers that connect to the port of 'self'
+ * Nothing goes through shared memory while a link conditioner is set
+ * @returns false if shared memory can't be set up, the socket keeps working over UDP
+*/
+bool tp_socket__enable_shm(tp_socket_t* self);
+
+//! @brief Fills the fields of a received message that are carried by the ancillary data of 'msg', 'data_len' must already be set
+void tp_message__parse_control(tp_message_t* self, struct msghdr* msg);
+
 #endif // TP_H
@@ -0,0 +1,186 @@
+#include "tp_capture.h"
+
+#include "memory.h"
+#include "debug.h"
+
+#include <math.h>
+#include <string.h>
+
+static bool tp_capture__create(tp_capture_t* self, const char* path, bool is_reading);
+//! @brief Makes 'size' bytes from the next record on available in the buffer, unless the file ends before
+static bool tp_capture__fill(tp_capture_t* self, uint32_t size);
+static uint64_t tp_capture__time_to_us(double time);
+
+static bool tp_capture__create(tp_capture_t* self, const char* path, bool is_reading) {
+    memset(self, 0, sizeof(*self));
+
+    self->is_reading = is_reading;
+    self->buffer     = memory__malloc(DEBUG_MODULE_TP, TP_CAPTURE_BUFFER_SIZE);
+    if (!self->buffer) {
+        return false;
+    }
+    if (!file__open(
+        &self->file, path,
+        is_reading ? FILE_ACCESS_MODE_READ : FILE_ACCESS_MODE_WRITE,
+        is_reading ? FILE_CREATION_MODE_OPEN : FILE_CREATION_MODE_CREATE
+    )) {
+        memory__free(DEBUG_MODULE_TP, self->buffer);
+        self->buffer = 0;
+        return false;
+    }
+
+    return true;
+}
+
+static bool tp_capture__fill(tp_capture_t* self, uint32_t size) {
+    ASSERT(size <= TP_CAPTURE_BUFFER_SIZE);
+    if (self->buffer_fill - self->buffer_offset >= size) {
+        return true;
+    }
+
+    memmove(self->buffer, self->buffer + self->buffer_offset, self->buffer_fill - self->buffer_offset);
+    self->buffer_fill  -= self->buffer_offset;
+    self->buffer_offset = 0;
+    while (!self->is_end_of_file && self->buffer_fill < size) {
+        size_t bytes_read = 0;
+        if (!file__read(&self->file, self->buffer + self->buffer_fill, TP_CAPTURE_BUFFER_SIZE - self->buffer_fill, &bytes_read)) {
+            self->error = true;
+            return false;
+        }
+        self->is_end_of_file = bytes_read == 0;
+        self->buffer_fill   += (uint32_t) bytes_read;
+    }
+
+    return self->buffer_fill >= size;
+}
+
+static uint64_t tp_capture__time_to_us(double time) {
+    return time > 0.0 ? (uint64_t) llround(time * 1000000.0) : 0;
+}
+
+bool tp_capture__create_writer(tp_capture_t* self, const char* path) {
+    if (!tp_capture__create(self, path, false)) {
+        return false;
+    }
+
+    memcpy(self->buffer, TP_CAPTURE_MAGIC, TP_CAPTURE_MAGIC_SIZE);
+    self->buffer_fill = TP_CAPTURE_MAGIC_SIZE;
+
+    return true;
+}
+
+bool tp_capture__create_reader(tp_capture_t* self, const char* path) {
+    if (!tp_capture__create(self, path, true)) {
+        return false;
+    }
+
+    if (!tp_capture__fill(self, TP_CAPTURE_MAGIC_SIZE) || memcmp(self->buffer, TP_CAPTURE_MAGIC, TP_CAPTURE_MAGIC_SIZE) != 0) {
+        tp_capture__destroy(self);
+        return false;
+    }
+    self->buffer_offset = TP_CAPTURE_MAGIC_SIZE;
+
+    return true;
+}
+
+void tp_capture__destroy(tp_capture_t* self) {
+    if (!self->is_reading) {
+        tp_capture__flush(self);
+    }
+    file__close(&self->file);
+    memory__free(DEBUG_MODULE_TP, self->buffer);
+    memset(self, 0, sizeof(*self));
+}
+
+bool tp_capture__write(tp_capture_t* self, const void* data, uint32_t data_len, network_addr_t addr, double time_arrival) {
+    ASSERT(!self->is_reading);
+    if (self->error || data_len > TP_CAPTURE_DATAGRAM_SIZE_MAX) {
+        return false;
+    }
+    if (TP_CAPTURE_BUFFER_SIZE - self->buffer_fill < TP_CAPTURE_RECORD_HEADER_SIZE + data_len && !tp_capture__flush(self)) {
+        return false;
+    }
+
+    // note: arrival timestamps of the kernel can be slightly out of order between batches, those are taken as simultaneous
+    const uint64_t time      = tp_capture__time_to_us(time_arrival);
+    const uint64_t delta     = time > self->time_previous ? time - self->time_previous : 0;
+    const uint32_t time_delta = delta < UINT32_MAX ? (uint32_t) delta : UINT32_MAX;
+    const uint16_t port      = (uint16_t) addr.port;
+    const uint16_t len       = (uint16_t) data_len;
+    self->time_previous += time_delta;
+
+    uint8_t* record = self->buffer + self->buffer_fill;
+    memcpy(record, &time_delta, sizeof(time_delta));
+    memcpy(record + 4, &addr.addr, sizeof(addr.addr));
+    memcpy(record + 8, &port, sizeof(port));
+    memcpy(record + 10, &len, sizeof(len));
+    memcpy(record + TP_CAPTURE_RECORD_HEADER_SIZE, data, data_len);
+    self->buffer_fill += TP_CAPTURE_RECORD_HEADER_SIZE + data_len;
+    ++self->records;
+
+    return true;
+}
+
+bool tp_capture__flush(tp_capture_t* self) {
+    ASSERT(!self->is_reading);
+    uint32_t offset = 0;
+    while (!self->error && offset < self->buffer_fill) {
+        size_t bytes_written = 0;
+        if (!file__write(&self->file, self->buffer + offset, self->buffer_fill - offset, &bytes_written) || bytes_written == 0) {
+            self->error = true;
+        }
+        offset += (uint32_t) bytes_written;
+    }
+    self->buffer_fill = 0;
+
+    return !self->error;
+}
+
+bool tp_capture__peek(tp_capture_t* self, double* time_arrival) {
+    ASSERT(self->is_reading);
+    if (self->error || !tp_capture__fill(self, TP_CAPTURE_RECORD_HEADER_SIZE)) {
+        // note: a partial record at the end is from a capture that was cut short, it's ignored
+        return false;
+    }
+
+    uint32_t time_delta = 0;
+    memcpy(&time_delta, self->buffer + self->buffer_offset, sizeof(time_delta));
+    *time_arrival = (double) (self->time_previous + time_delta) / 1000000.0;
+
+    return true;
+}
+
+uint32_t tp_capture__read_batch(tp_capture_t* self, tp_message_t* messages, uint32_t messages_size, double time) {
+    uint32_t messages_fill = 0;
+    double time_arrival = 0.0;
+    while (messages_fill < messages_size && tp_capture__peek(self, &time_arrival) && time_arrival <= time) {
+        uint16_t len = 0;
+        memcpy(&len, self->buffer + self->buffer_offset + 10, sizeof(len));
+        if (!tp_capture__fill(self, TP_CAPTURE_RECORD_HEADER_SIZE + len)) {
+            break ;
+        }
+
+        const uint8_t* record = self->buffer + self->buffer_offset;
+        uint32_t time_delta = 0;
+        memcpy(&time_delta, record, sizeof(time_delta));
+        self->time_previous += time_delta;
+        self->buffer_offset += TP_CAPTURE_RECORD_HEADER_SIZE + len;
+        ++self->records;
+
+        tp_message_t* message = &messages[messages_fill];
+        if (len > message->data_size) {
+            continue ;
+        }
+        uint16_t port = 0;
+        memcpy(&message->addr.addr, record + 4, sizeof(message->addr.addr));
+        memcpy(&port, record + 8, sizeof(port));
+        message->addr.port    = port;
+        memcpy(message->data, record + TP_CAPTURE_RECORD_HEADER_SIZE, len);
+        message->data_len     = len;
+        message->segment_size = 0;
+        message->time_arrival = time_arrival;
+        ++messages_fill;
+    }
+
+    return messages_fill;
+}
@@ -0,0 +1,72 @@
+#ifndef TP_CAPTURE_H
+# define TP_CAPTURE_H
+
+# include "tp.h"
+# include "file.h"
+
+# include <stdint.h>
+# include <stdbool.h>
+
+struct         tp_capture;
+typedef struct tp_capture tp_capture_t;
+
+/**
+ * Capture file of the datagrams a socket received, with their arrival time and sender, to replay them later without a socket
+ * After an 8 byte header, a record per datagram of a 12 byte header and the datagram:
+ *   uint32_t time_delta  microseconds since the arrival of the previous datagram, since time 0 for the first one
+ *   uint32_t addr        as in network_addr_t
+ *   uint16_t port
+ *   uint16_t data_len
+ * In the byte order of the host, captures are replayed where they are taken
+ * Times are in the clock of system__get_time, so they start around 0 when the capture is taken from the start of the server
+ * Records are written and read through a buffer, a syscall every TP_CAPTURE_BUFFER_SIZE bytes
+*/
+# define TP_CAPTURE_MAGIC         "tpcap\0\0\1"
+# define TP_CAPTURE_MAGIC_SIZE    8
+# define TP_CAPTURE_RECORD_HEADER_SIZE 12
+# define TP_CAPTURE_DATAGRAM_SIZE_MAX  UINT16_MAX
+//! @note Fits the largest record
+# define TP_CAPTURE_BUFFER_SIZE   (1 << 17)
+
+struct tp_capture {
+    file_t   file;
+    bool     is_reading;
+    //! @note Set once a read or write failed, or the capture is malformed, nothing is read or written after
+    bool     error;
+    uint8_t* buffer;
+    uint32_t buffer_fill;
+    //! @note Reading only, start of the next record in 'buffer'
+    uint32_t buffer_offset;
+    bool     is_end_of_file;
+    //! @note Arrival of the previous record, in microseconds
+    uint64_t time_previous;
+    uint64_t records;
+};
+
+//! @brief Creates or truncates the capture at 'path' to write into
+bool tp_capture__create_writer(tp_capture_t* self, const char* path);
+bool tp_capture__create_reader(tp_capture_t* self, const char* path);
+//! @note Writes out what is still buffered
+void tp_capture__destroy(tp_capture_t* self);
+
+/**
+ * @brief Appends a datagram that arrived at 'time_arrival', system time
+ * @returns false if it failed or the capture failed before, larger datagrams than TP_CAPTURE_DATAGRAM_SIZE_MAX fail without failing the capture
+*/
+bool tp_capture__write(tp_capture_t* self, const void* data, uint32_t data_len, network_addr_t addr, double time_arrival);
+//! @brief Writes out what is buffered
+bool tp_capture__flush(tp_capture_t* self);
+
+/**
+ * @param time_arrival arrival of the next datagram, system time
+ * @returns false at the end of the capture or if it failed, see 'error'
+*/
+bool tp_capture__peek(tp_capture_t* self, double* time_arrival);
+/**
+ * @brief Reads the next datagrams that arrived until 'time', at most 'messages_size', as tp_socket__get_data_batch receives them
+ * Datagrams that don't fit into the 'data_size' of their message are skipped
+ * @returns Number of messages filled
+*/
+uint32_t tp_capture__read_batch(tp_capture_t* self, tp_message_t* messages, uint32_t messages_size, double time);
+
+#endif // TP_CAPTURE_H
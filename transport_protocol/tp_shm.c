@@ -0,0 +1,646 @@
+// note: memfd_create, accept4, MSG_CMSG_CLOEXEC
+#define _GNU_SOURCE
+
+#include "tp_shm.h"
+
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <unistd.h>
+#include <ifaddrs.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/eventfd.h>
+#include <sys/random.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+typedef struct tp_shm_hello {
+    uint32_t       magic;
+    uint32_t       version;
+    //! @note UDP address of the side that connects, it's only a claim until it's proven, unused in the replies
+    network_addr_t addr;
+    //! @note Set in the challenge of the listener, to come back in the proof
+    uint64_t       nonce;
+} tp_shm_hello_t;
+
+//! @note Sent over UDP from the claimed address to the listener, exactly this size
+typedef struct tp_shm_proof {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t nonce;
+} tp_shm_proof_t;
+
+//! @brief Abstract unix socket address of the links to the UDP port 'port', in network byte order
+static socklen_t tp_shm__listen_addr(struct sockaddr_un* sockaddr, uint32_t port);
+//! @returns true if 'addr' is the loopback or the address of an interface of this host
+static bool tp_shm__is_local(network_addr_t addr);
+static bool tp_shm__send_hello(int32_t fd, const tp_shm_hello_t* hello, const int32_t* fds, uint32_t fds_size);
+/**
+ * @brief Receives a hello with exactly 'fds_size' fds, at most 2
+ * Every fd that came with a malformed one is closed, those past 'fds_size' too, whichever SCM_RIGHTS they came in
+ * @returns 1 if one was received, 0 if it hasn't arrived yet, -1 if the peer is gone or misbehaved
+*/
+static int32_t tp_shm__receive_hello(int32_t fd, tp_shm_hello_t* hello, int32_t* fds, uint32_t fds_size);
+static tp_shm_link_t* tp_shm__push_link(tp_shm_t* self, int32_t control_fd);
+static void tp_shm__remove_link(tp_shm_t* self, uint32_t link_index);
+static void tp_shm__accept(tp_shm_t* self);
+//! @returns false if the link is to be removed
+static bool tp_shm__handshake(tp_shm_t* self, tp_shm_link_t* link);
+//! @brief Connector side, answers the challenge of the listener with a proof and waits for its doorbell
+static bool tp_shm__handshake_connector(tp_shm_t* self, tp_shm_link_t* link);
+static void tp_shm__send_proof(tp_shm_t* self, const tp_shm_link_t* link);
+static bool tp_shm_link__is_alive(tp_shm_link_t* self);
+static void tp_shm_link__activate(tp_shm_t* self, tp_shm_link_t* link, int32_t peer_wake_fd);
+
+static socklen_t tp_shm__listen_addr(struct sockaddr_un* sockaddr, uint32_t port) {
+    memset(sockaddr, 0, sizeof(*sockaddr));
+    sockaddr->sun_family = AF_UNIX;
+    // note: abstract, the leading 0 keeps it off the file system, it's gone with the socket
+    const int name_len = snprintf(sockaddr->sun_path + 1, sizeof(sockaddr->sun_path) - 1, "tp_shm.%u", ntohs((uint16_t) port));
+
+    return (socklen_t) (offsetof(struct sockaddr_un, sun_path) + 1 + name_len);
+}
+
+static bool tp_shm__is_local(network_addr_t addr) {
+    if ((ntohl(addr.addr) >> 24) == 127) {
+        return true;
+    }
+
+    struct ifaddrs* ifaddrs = 0;
+    if (getifaddrs(&ifaddrs) == -1) {
+        return false;
+    }
+    bool result = false;
+    for (struct ifaddrs* ifaddr = ifaddrs; ifaddr && !result; ifaddr = ifaddr->ifa_next) {
+        if (ifaddr->ifa_addr && ifaddr->ifa_addr->sa_family == AF_INET) {
+            result = ((const struct sockaddr_in*) ifaddr->ifa_addr)->sin_addr.s_addr == addr.addr;
+        }
+    }
+    freeifaddrs(ifaddrs);
+
+    return result;
+}
+
+static bool tp_shm__send_hello(int32_t fd, const tp_shm_hello_t* hello, const int32_t* fds, uint32_t fds_size) {
+    union {
+        char           buffer[CMSG_SPACE(2 * sizeof(int32_t))];
+        struct cmsghdr align;
+    } control;
+    assert(fds_size <= 2);
+
+    struct iovec iov = { .iov_base = (void*) hello, .iov_len = sizeof(*hello) };
+    struct msghdr msg = { 0 };
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    if (fds_size > 0) {
+        msg.msg_control    = control.buffer;
+        msg.msg_controllen = CMSG_SPACE(fds_size * sizeof(int32_t));
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type  = SCM_RIGHTS;
+        cmsg->cmsg_len   = CMSG_LEN(fds_size * sizeof(int32_t));
+        memcpy(CMSG_DATA(cmsg), fds, fds_size * sizeof(int32_t));
+    }
+
+    return sendmsg(fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL) == (ssize_t) sizeof(*hello);
+}
+
+static int32_t tp_shm__receive_hello(int32_t fd, tp_shm_hello_t* hello, int32_t* fds, uint32_t fds_size) {
+    union {
+        char           buffer[CMSG_SPACE(2 * sizeof(int32_t))];
+        struct cmsghdr align;
+    } control;
+    assert(fds_size <= 2);
+
+    struct iovec iov = { .iov_base = hello, .iov_len = sizeof(*hello) };
+    struct msghdr msg = { 0 };
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = control.buffer;
+    msg.msg_controllen = sizeof(control.buffer);
+    const ssize_t result = recvmsg(fd, &msg, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+    if (result == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return 0;
+    }
+    if (result == -1) {
+        return -1;
+    }
+
+    // note: the count comes from the peer, only the first 'fds_size' are kept, the rest are closed as they are seen
+    uint32_t fds_received = 0;
+    uint32_t fds_stored   = 0;
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS || cmsg->cmsg_len < CMSG_LEN(0)) {
+            continue ;
+        }
+        const uint32_t cmsg_fds = (uint32_t) ((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int32_t));
+        for (uint32_t cmsg_fd_index = 0; cmsg_fd_index < cmsg_fds; ++cmsg_fd_index) {
+            int32_t received_fd;
+            memcpy(&received_fd, CMSG_DATA(cmsg) + cmsg_fd_index * sizeof(int32_t), sizeof(received_fd));
+            ++fds_received;
+            if (fds_stored < fds_size) {
+                fds[fds_stored++] = received_fd;
+            } else {
+                close(received_fd);
+            }
+        }
+    }
+
+    if (
+        result != (ssize_t) sizeof(*hello) || (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) || fds_received != fds_size ||
+        hello->magic != TP_SHM_MAGIC || hello->version != TP_SHM_VERSION
+    ) {
+        for (uint32_t fd_index = 0; fd_index < fds_stored; ++fd_index) {
+            close(fds[fd_index]);
+        }
+        return -1;
+    }
+
+    return 1;
+}
+
+static tp_shm_link_t* tp_shm__push_link(tp_shm_t* self, int32_t control_fd) {
+    if (self->links_fill == TP_SHM_LINKS_SIZE) {
+        return 0;
+    }
+
+    tp_shm_link_t* link = &self->links[self->links_fill++];
+    memset(link, 0, sizeof(*link));
+    link->state        = TP_SHM_LINK_STATE_HANDSHAKE;
+    link->control_fd   = control_fd;
+    link->peer_wake_fd = -1;
+
+    return link;
+}
+
+static void tp_shm__remove_link(tp_shm_t* self, uint32_t link_index) {
+    assert(link_index < self->links_fill);
+    tp_shm_link_t* link = &self->links[link_index];
+    if (link->state != TP_SHM_LINK_STATE_HANDSHAKE) {
+        --self->links_active;
+    }
+    if (link->region) {
+        munmap(link->region, sizeof(*link->region));
+    }
+    if (link->peer_wake_fd != -1) {
+        close(link->peer_wake_fd);
+    }
+    close(link->control_fd);
+
+    self->links[link_index] = self->links[--self->links_fill];
+    self->link_receive_first = 0;
+}
+
+static void tp_shm_link__activate(tp_shm_t* self, tp_shm_link_t* link, int32_t peer_wake_fd) {
+    link->state               = TP_SHM_LINK_STATE_ACTIVE;
+    link->peer_wake_fd        = peer_wake_fd;
+    link->send_tail_cached    = __atomic_load_n(&link->ring_send->tail, __ATOMIC_ACQUIRE);
+    link->receive_head_cached = link->ring_receive->tail;
+    ++self->links_active;
+}
+
+static void tp_shm__accept(tp_shm_t* self) {
+    while (true) {
+        const int32_t control_fd = accept4(self->listen_fd, 0, 0, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (control_fd == -1) {
+            return ;
+        }
+        if (!tp_shm__push_link(self, control_fd)) {
+            // note: the peer sees it closed and stays on UDP
+            close(control_fd);
+        }
+    }
+}
+
+static bool tp_shm__handshake(tp_shm_t* self, tp_shm_link_t* link) {
+    if (link->is_connector) {
+        return tp_shm__handshake_connector(self, link);
+    }
+    if (link->is_challenged) {
+        // note: waiting for the proof, it arrives over UDP, see tp_shm__receive_proof
+        return tp_shm_link__is_alive(link);
+    }
+
+    // note: listening, the hello carries the region and the doorbell of the connector
+    tp_shm_hello_t hello;
+    int32_t fds[2] = { -1, -1 };
+    const int32_t result = tp_shm__receive_hello(link->control_fd, &hello, fds, 2);
+    if (result != 1) {
+        return result == 0;
+    }
+
+    struct stat region_stat;
+    tp_shm_region_t* region = MAP_FAILED;
+    if (fstat(fds[0], &region_stat) == 0 && region_stat.st_size == (off_t) sizeof(*region)) {
+        region = mmap(0, sizeof(*region), PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+    }
+    close(fds[0]);
+    if (region == MAP_FAILED) {
+        close(fds[1]);
+        return false;
+    }
+    link->region       = region;
+    link->ring_send    = &region->rings[TP_SHM_RING_TO_CONNECTOR];
+    link->ring_receive = &region->rings[TP_SHM_RING_TO_LISTENER];
+    // note: any local process can claim any address here, the link isn't used before the claim is proven
+    link->addr         = hello.addr;
+    link->peer_wake_fd = fds[1];
+    if (
+        region->magic != TP_SHM_MAGIC || region->version != TP_SHM_VERSION ||
+        getrandom(&link->nonce, sizeof(link->nonce), GRND_NONBLOCK) != (ssize_t) sizeof(link->nonce)
+    ) {
+        return false;
+    }
+    const tp_shm_hello_t challenge = {
+        .magic   = TP_SHM_MAGIC,
+        .version = TP_SHM_VERSION,
+        .nonce   = link->nonce
+    };
+    if (!tp_shm__send_hello(link->control_fd, &challenge, 0, 0)) {
+        return false;
+    }
+    link->is_challenged = true;
+
+    return true;
+}
+
+static bool tp_shm__handshake_connector(tp_shm_t* self, tp_shm_link_t* link) {
+    tp_shm_hello_t hello;
+    if (!link->is_challenged) {
+        const int32_t result = tp_shm__receive_hello(link->control_fd, &hello, 0, 0);
+        if (result != 1) {
+            return result == 0;
+        }
+        link->nonce         = hello.nonce;
+        link->is_challenged = true;
+    }
+
+    // note: the reply to the proof carries the doorbell of the listener
+    int32_t peer_wake_fd = -1;
+    const int32_t result = tp_shm__receive_hello(link->control_fd, &hello, &peer_wake_fd, 1);
+    if (result == 1) {
+        tp_shm_link__activate(self, link, peer_wake_fd);
+        return true;
+    }
+    if (result == 0) {
+        // note: UDP may drop the proof, it's sent again on every maintenance until the listener replies
+        tp_shm__send_proof(self, link);
+    }
+
+    return result != -1;
+}
+
+static void tp_shm__send_proof(tp_shm_t* self, const tp_shm_link_t* link) {
+    const tp_shm_proof_t proof = {
+        .magic   = TP_SHM_PROOF_MAGIC,
+        .version = TP_SHM_VERSION,
+        .nonce   = link->nonce
+    };
+    struct sockaddr_in dst_addr = { 0 };
+    dst_addr.sin_family      = AF_INET;
+    dst_addr.sin_addr.s_addr = link->addr.addr;
+    dst_addr.sin_port        = (in_port_t) link->addr.port;
+    if (sendto(self->udp_socket, &proof, sizeof(proof), MSG_DONTWAIT, (const struct sockaddr*) &dst_addr, sizeof(dst_addr)) == -1) {
+        // note: sent again on the next maintenance
+    }
+}
+
+static bool tp_shm_link__is_alive(tp_shm_link_t* self) {
+    if (self->state == TP_SHM_LINK_STATE_BROKEN) {
+        return false;
+    }
+
+    uint8_t byte;
+    const ssize_t result = recv(self->control_fd, &byte, sizeof(byte), MSG_DONTWAIT | MSG_PEEK);
+
+    return result == -1 && (errno == EAGAIN || errno == EWOULDBLOCK);
+}
+
+bool tp_shm__create(tp_shm_t* self, int32_t udp_socket) {
+    memset(self, 0, sizeof(*self));
+    self->udp_socket = udp_socket;
+    self->listen_fd  = -1;
+    self->wake_fd    = -1;
+
+    struct sockaddr_in udp_addr;
+    socklen_t udp_addr_len = sizeof(udp_addr);
+    if (getsockname(udp_socket, (struct sockaddr*) &udp_addr, &udp_addr_len) == -1 || udp_addr.sin_family != AF_INET) {
+        return false;
+    }
+
+    self->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (self->wake_fd == -1) {
+        perror("eventfd");
+        goto err;
+    }
+
+    self->listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (self->listen_fd == -1) {
+        perror(0);
+        goto err;
+    }
+    struct sockaddr_un listen_addr;
+    const socklen_t listen_addr_len = tp_shm__listen_addr(&listen_addr, udp_addr.sin_port);
+    if (
+        bind(self->listen_fd, (const struct sockaddr*) &listen_addr, listen_addr_len) == -1 ||
+        listen(self->listen_fd, TP_SHM_LINKS_SIZE) == -1
+    ) {
+        perror("tp_shm listen");
+        goto err;
+    }
+
+    return true;
+
+err:
+    tp_shm__destroy(self);
+
+    return false;
+}
+
+void tp_shm__destroy(tp_shm_t* self) {
+    while (self->links_fill > 0) {
+        tp_shm__remove_link(self, self->links_fill - 1);
+    }
+    if (self->listen_fd != -1) {
+        close(self->listen_fd);
+        self->listen_fd = -1;
+    }
+    if (self->wake_fd != -1) {
+        close(self->wake_fd);
+        self->wake_fd = -1;
+    }
+}
+
+void tp_shm__connect(tp_shm_t* self, int32_t udp_socket, network_addr_t addr) {
+    for (uint32_t link_index = 0; link_index < self->links_fill; ++link_index) {
+        if (self->is_connected && network_addr__is_same(&self->links[link_index].addr, &self->connected_addr)) {
+            tp_shm__remove_link(self, link_index);
+            break ;
+        }
+    }
+    self->is_connected   = true;
+    self->connected_addr = addr;
+
+    if (!tp_shm__is_local(addr)) {
+        return ;
+    }
+
+    // note: the address the peer sees the datagrams of this socket come from
+    struct sockaddr_in udp_addr;
+    socklen_t udp_addr_len = sizeof(udp_addr);
+    if (getsockname(udp_socket, (struct sockaddr*) &udp_addr, &udp_addr_len) == -1 || udp_addr.sin_family != AF_INET) {
+        return ;
+    }
+
+    const int32_t region_fd = memfd_create("tp_shm", MFD_CLOEXEC);
+    if (region_fd == -1) {
+        return ;
+    }
+    tp_shm_region_t* region = MAP_FAILED;
+    if (ftruncate(region_fd, sizeof(*region)) == 0) {
+        region = mmap(0, sizeof(*region), PROT_READ | PROT_WRITE, MAP_SHARED, region_fd, 0);
+    }
+    if (region == MAP_FAILED) {
+        close(region_fd);
+        return ;
+    }
+    // note: the rest is zeroed by ftruncate, the rings start empty
+    region->magic   = TP_SHM_MAGIC;
+    region->version = TP_SHM_VERSION;
+
+    const int32_t control_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    struct sockaddr_un listen_addr;
+    const socklen_t listen_addr_len = tp_shm__listen_addr(&listen_addr, addr.port);
+    const tp_shm_hello_t hello = {
+        .magic   = TP_SHM_MAGIC,
+        .version = TP_SHM_VERSION,
+        .addr    = { .addr = udp_addr.sin_addr.s_addr, .port = udp_addr.sin_port }
+    };
+    const int32_t fds[2] = { region_fd, self->wake_fd };
+    tp_shm_link_t* link = 0;
+    if (
+        control_fd == -1 ||
+        // note: fails if the peer doesn't listen, it stays on UDP then
+        connect(control_fd, (const struct sockaddr*) &listen_addr, listen_addr_len) == -1 ||
+        !tp_shm__send_hello(control_fd, &hello, fds, 2) ||
+        !(link = tp_shm__push_link(self, control_fd))
+    ) {
+        if (control_fd != -1) {
+            close(control_fd);
+        }
+        munmap(region, sizeof(*region));
+        close(region_fd);
+        return ;
+    }
+    close(region_fd);
+
+    link->addr         = addr;
+    link->is_connector = true;
+    link->region       = region;
+    link->ring_send    = &region->rings[TP_SHM_RING_TO_LISTENER];
+    link->ring_receive = &region->rings[TP_SHM_RING_TO_CONNECTOR];
+}
+
+bool tp_shm__maintain(tp_shm_t* self, double time) {
+    if (time < self->time_maintenance_next) {
+        return false;
+    }
+    self->time_maintenance_next = time + TP_SHM_MAINTENANCE_INTERVAL;
+    self->is_udp_due = true;
+
+    tp_shm__accept(self);
+
+    uint32_t link_index = 0;
+    while (link_index < self->links_fill) {
+        tp_shm_link_t* link = &self->links[link_index];
+        const bool is_kept = link->state == TP_SHM_LINK_STATE_HANDSHAKE ? tp_shm__handshake(self, link) : tp_shm_link__is_alive(link);
+        if (is_kept) {
+            ++link_index;
+        } else {
+            tp_shm__remove_link(self, link_index);
+        }
+    }
+
+    return true;
+}
+
+bool tp_shm__receive_proof(tp_shm_t* self, const void* data, uint32_t data_len, network_addr_t addr) {
+    tp_shm_proof_t proof;
+    if (data_len != sizeof(proof)) {
+        return false;
+    }
+    memcpy(&proof, data, sizeof(proof));
+    if (proof.magic != TP_SHM_PROOF_MAGIC || proof.version != TP_SHM_VERSION) {
+        return false;
+    }
+
+    for (uint32_t link_index = 0; link_index < self->links_fill; ++link_index) {
+        tp_shm_link_t* link = &self->links[link_index];
+        if (
+            link->state != TP_SHM_LINK_STATE_HANDSHAKE || link->is_connector || !link->is_challenged ||
+            link->nonce != proof.nonce || !network_addr__is_same(&link->addr, &addr)
+        ) {
+            continue ;
+        }
+
+        const tp_shm_hello_t accept = {
+            .magic   = TP_SHM_MAGIC,
+            .version = TP_SHM_VERSION
+        };
+        if (!tp_shm__send_hello(link->control_fd, &accept, &self->wake_fd, 1)) {
+            // note: the connector sends the proof again if it's still there
+            return true;
+        }
+        // note: the address is proven, an older link to it is of a socket that was closed and reused since
+        for (uint32_t other_index = 0; other_index < self->links_fill; ++other_index) {
+            tp_shm_link_t* other = &self->links[other_index];
+            if (other->state == TP_SHM_LINK_STATE_ACTIVE && network_addr__is_same(&other->addr, &addr)) {
+                other->state = TP_SHM_LINK_STATE_BROKEN;
+            }
+        }
+        tp_shm_link__activate(self, link, link->peer_wake_fd);
+        return true;
+    }
+
+    return true;
+}
+
+tp_shm_link_t* tp_shm__find_link(tp_shm_t* self, network_addr_t addr) {
+    for (uint32_t link_index = 0; link_index < self->links_fill; ++link_index) {
+        tp_shm_link_t* link = &self->links[link_index];
+        if (link->state == TP_SHM_LINK_STATE_ACTIVE && network_addr__is_same(&link->addr, &addr)) {
+            return link;
+        }
+    }
+
+    return 0;
+}
+
+bool tp_shm_link__send(tp_shm_link_t* self, const void* data, uint32_t data_size, const struct iovec* iovs, uint32_t iovs_fill) {
+    assert(self->state == TP_SHM_LINK_STATE_ACTIVE && data_size <= TP_SHM_DATAGRAM_SIZE_MAX);
+    tp_shm_ring_t* ring = self->ring_send;
+    const uint32_t head = ring->head;
+    if (head - self->send_tail_cached >= TP_SHM_RING_SIZE) {
+        self->send_tail_cached = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        if (head - self->send_tail_cached >= TP_SHM_RING_SIZE) {
+            return false;
+        }
+    }
+
+    tp_shm_slot_t* slot = &ring->slots[head & (TP_SHM_RING_SIZE - 1)];
+    if (iovs) {
+        uint8_t* cur = slot->data;
+        for (uint32_t iov_index = 0; iov_index < iovs_fill; ++iov_index) {
+            memcpy(cur, iovs[iov_index].iov_base, iovs[iov_index].iov_len);
+            cur += iovs[iov_index].iov_len;
+        }
+        assert((uint32_t) (cur - slot->data) == data_size);
+    } else {
+        memcpy(slot->data, data, data_size);
+    }
+    slot->data_size = data_size;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    self->is_doorbell_due = true;
+
+    return true;
+}
+
+void tp_shm__ring_doorbells(tp_shm_t* self) {
+    // note: pairs with the fence of tp_shm__prepare_wait, either the consumer sees the push or this sees it waiting
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    for (uint32_t link_index = 0; link_index < self->links_fill; ++link_index) {
+        tp_shm_link_t* link = &self->links[link_index];
+        if (!link->is_doorbell_due) {
+            continue ;
+        }
+        link->is_doorbell_due = false;
+        if (__atomic_load_n(&link->ring_send->is_consumer_waiting, __ATOMIC_RELAXED)) {
+            const uint64_t value = 1;
+            if (write(link->peer_wake_fd, &value, sizeof(value)) == -1) {
+                // note: the counter is saturated, the peer is woken up already
+            }
+        }
+    }
+}
+
+uint32_t tp_shm__receive(tp_shm_t* self, tp_message_t* messages, uint32_t messages_size, double time) {
+    uint32_t messages_received = 0;
+    for (uint32_t link_offset = 0; link_offset < self->links_fill && messages_received < messages_size; ++link_offset) {
+        tp_shm_link_t* link = &self->links[(self->link_receive_first + link_offset) % self->links_fill];
+        if (link->state != TP_SHM_LINK_STATE_ACTIVE) {
+            continue ;
+        }
+
+        tp_shm_ring_t* ring = link->ring_receive;
+        uint32_t tail = ring->tail;
+        if (link->receive_head_cached == tail) {
+            link->receive_head_cached = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        }
+        // note: the memory is shared with the peer, what it wrote is checked as a datagram from the network would be
+        if (link->receive_head_cached - tail > TP_SHM_RING_SIZE) {
+            link->state = TP_SHM_LINK_STATE_BROKEN;
+            continue ;
+        }
+        while (tail != link->receive_head_cached && messages_received < messages_size) {
+            const tp_shm_slot_t* slot = &ring->slots[tail & (TP_SHM_RING_SIZE - 1)];
+            const uint32_t data_size = __atomic_load_n(&slot->data_size, __ATOMIC_RELAXED);
+            ++tail;
+            tp_message_t* message = &messages[messages_received];
+            if (data_size > TP_SHM_DATAGRAM_SIZE_MAX || data_size > message->data_size) {
+                // note: recvmmsg would truncate it, it's dropped instead
+                continue ;
+            }
+            memcpy(message->data, slot->data, data_size);
+            message->data_len     = data_size;
+            message->segment_size = data_size;
+            message->time_arrival = time;
+            message->addr         = link->addr;
+            ++messages_received;
+        }
+        __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+    }
+    if (self->links_fill > 0) {
+        self->link_receive_first = (self->link_receive_first + 1) % self->links_fill;
+    }
+
+    return messages_received;
+}
+
+bool tp_shm__prepare_wait(tp_shm_t* self) {
+    for (uint32_t link_index = 0; link_index < self->links_fill; ++link_index) {
+        tp_shm_link_t* link = &self->links[link_index];
+        if (link->state == TP_SHM_LINK_STATE_ACTIVE) {
+            __atomic_store_n(&link->ring_receive->is_consumer_waiting, 1, __ATOMIC_RELAXED);
+        }
+    }
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    for (uint32_t link_index = 0; link_index < self->links_fill; ++link_index) {
+        tp_shm_link_t* link = &self->links[link_index];
+        if (link->state == TP_SHM_LINK_STATE_ACTIVE && __atomic_load_n(&link->ring_receive->head, __ATOMIC_ACQUIRE) != link->ring_receive->tail) {
+            tp_shm__finish_wait(self, false);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void tp_shm__finish_wait(tp_shm_t* self, bool is_woken) {
+    for (uint32_t link_index = 0; link_index < self->links_fill; ++link_index) {
+        tp_shm_link_t* link = &self->links[link_index];
+        if (link->state == TP_SHM_LINK_STATE_ACTIVE) {
+            __atomic_store_n(&link->ring_receive->is_consumer_waiting, 0, __ATOMIC_RELAXED);
+        }
+    }
+    if (is_woken) {
+        uint64_t value;
+        if (read(self->wake_fd, &value, sizeof(value)) == -1) {
+            assert(errno == EAGAIN);
+        }
+    }
+}
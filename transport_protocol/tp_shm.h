@@ -0,0 +1,180 @@
+#ifndef TP_SHM_H
+# define TP_SHM_H
+
+# include "tp.h"
+
+# include <stdint.h>
+# include <stdbool.h>
+
+struct         tp_shm;
+struct         tp_shm_link;
+struct         tp_shm_ring;
+struct         tp_shm_region;
+enum           tp_shm_link_state;
+typedef struct tp_shm            tp_shm_t;
+typedef struct tp_shm_link       tp_shm_link_t;
+typedef struct tp_shm_ring       tp_shm_ring_t;
+typedef struct tp_shm_region     tp_shm_region_t;
+typedef enum   tp_shm_link_state tp_shm_link_state_t;
+
+/**
+ * Shared memory transport between tp_socket_t of the same host, datagrams skip the network stack
+ * A socket that connects to a peer on this host hands it a memfd with a ring for each direction over a unix socket,
+ * the datagrams between the two go through the rings from then on, while everything else keeps going over UDP
+ * Neither side makes a syscall for a datagram unless the other is asleep, a consumer raises 'is_consumer_waiting'
+ * before it sleeps on its doorbell, an eventfd, so it can wait on it with epoll along with the UDP socket
+ * The address the connecting side claims is proven before its link is used, the listener answers its hello with a random nonce
+ * that has to come back in a UDP datagram from that address, see tp_shm__receive_proof, so a local process can't take the link
+ * of another one, only the process that owns a UDP socket receives what is sent to it
+ * The handshake is finished and dead peers are noticed on the calls into the socket, so links come up and fall back
+ * to UDP within TP_SHM_MAINTENANCE_INTERVAL, datagrams are never lost by either, only reordered
+ * Larger datagrams than TP_SHM_DATAGRAM_SIZE_MAX go over UDP
+*/
+# define TP_SHM_MAGIC                0x6d687374
+# define TP_SHM_VERSION              1
+//! @note Of the UDP datagram that proves the address of the connecting side
+# define TP_SHM_PROOF_MAGIC          0x666f7270
+# define TP_SHM_CACHE_LINE_SIZE      64
+//! @note Power of two, a full ring drops the datagram, as a full socket buffer of the receiver would
+# define TP_SHM_RING_SIZE            256
+# define TP_SHM_SLOT_SIZE            2048
+# define TP_SHM_DATAGRAM_SIZE_MAX    (TP_SHM_SLOT_SIZE - sizeof(uint32_t))
+//! @note Links at once, the peers that don't fit stay on UDP
+# define TP_SHM_LINKS_SIZE           16
+//! @note In seconds, how often links are accepted and checked, and how often UDP is read once the peer of a connected socket is linked
+# define TP_SHM_MAINTENANCE_INTERVAL 0.1
+
+typedef struct tp_shm_slot {
+    uint32_t data_size;
+    uint8_t  data[TP_SHM_DATAGRAM_SIZE_MAX];
+} tp_shm_slot_t;
+
+struct tp_shm_ring {
+    //! @note Written by the producer only, indices grow forever and wrap around uint32_t
+    uint32_t      head;
+    uint8_t       _padding0[TP_SHM_CACHE_LINE_SIZE - sizeof(uint32_t)];
+    //! @note Written by the consumer only
+    uint32_t      tail;
+    uint8_t       _padding1[TP_SHM_CACHE_LINE_SIZE - sizeof(uint32_t)];
+    //! @note Written by the consumer only, the producer rings the doorbell after a push if it's set
+    uint32_t      is_consumer_waiting;
+    uint8_t       _padding2[TP_SHM_CACHE_LINE_SIZE - sizeof(uint32_t)];
+    tp_shm_slot_t slots[TP_SHM_RING_SIZE];
+};
+
+enum {
+    TP_SHM_RING_TO_LISTENER,
+    TP_SHM_RING_TO_CONNECTOR,
+    _TP_SHM_RING_SIZE
+};
+
+//! @note Mapped by both sides, created by the side that connects
+struct tp_shm_region {
+    uint32_t      magic;
+    uint32_t      version;
+    uint8_t       _padding[TP_SHM_CACHE_LINE_SIZE - 2 * sizeof(uint32_t)];
+    tp_shm_ring_t rings[_TP_SHM_RING_SIZE];
+};
+
+enum tp_shm_link_state {
+    //! waiting for the hello of the other side or the proof of its address, datagrams still go over UDP
+    TP_SHM_LINK_STATE_HANDSHAKE,
+    TP_SHM_LINK_STATE_ACTIVE,
+    //! the peer broke the ring, removed on the next maintenance
+    TP_SHM_LINK_STATE_BROKEN
+};
+
+struct tp_shm_link {
+    tp_shm_link_state_t state;
+    //! @note UDP address of the peer, datagrams to it go through the link, datagrams from the link are received from it
+    network_addr_t      addr;
+    //! @note Set on the side that connected, it proves its address, the other side checks it
+    bool                is_connector;
+    //! @note Set once the listener sent 'nonce', the link waits for it to come back from 'addr' over UDP then
+    bool                is_challenged;
+    uint64_t            nonce;
+    //! @note Unix socket of the handshake, kept open so either side notices when the other is gone
+    int32_t             control_fd;
+    //! @note Doorbell of the peer, -1 until the handshake is done
+    int32_t             peer_wake_fd;
+    tp_shm_region_t*    region;
+    tp_shm_ring_t*      ring_send;
+    tp_shm_ring_t*      ring_receive;
+    //! @note Local copies of the indices of the peer, reloaded only when the ring looks full or empty
+    uint32_t            send_tail_cached;
+    uint32_t            receive_head_cached;
+    bool                is_doorbell_due;
+};
+
+struct tp_shm {
+    //! @note UDP socket of the owner, proofs of the address are sent from it
+    int32_t        udp_socket;
+    //! @note Abstract unix socket named after the UDP port, peers that connect to the port link up through it
+    int32_t        listen_fd;
+    //! @note Doorbell of this side, an eventfd handed to every peer
+    int32_t        wake_fd;
+    double         time_maintenance_next;
+    tp_shm_link_t  links[TP_SHM_LINKS_SIZE];
+    uint32_t       links_fill;
+    uint32_t       links_active;
+    //! @note Link the next receive starts at, so a busy peer can't starve the others
+    uint32_t       link_receive_first;
+    //! @note Set by tp_shm__connect, the peer the owner sends to without an address
+    bool           is_connected;
+    network_addr_t connected_addr;
+    //! @note Set by every maintenance, cleared by the owner once it read UDP
+    bool           is_udp_due;
+};
+
+/**
+ * @brief Listens for links from the local peers of the UDP socket 'udp_socket'
+ * @returns false if another socket listens on its port already, for example with SO_REUSEPORT
+*/
+bool tp_shm__create(tp_shm_t* self, int32_t udp_socket);
+void tp_shm__destroy(tp_shm_t* self);
+
+/**
+ * @brief Starts a handshake with the peer at 'addr' if it's on this host, the link of a previous connect is dropped
+ * @param udp_socket connected to 'addr' already, the peer is told its address
+*/
+void tp_shm__connect(tp_shm_t* self, int32_t udp_socket, network_addr_t addr);
+
+/**
+ * @brief Accepts links, progresses handshakes and drops the links of dead peers, at most every TP_SHM_MAINTENANCE_INTERVAL
+ * @returns true if it ran
+*/
+bool tp_shm__maintain(tp_shm_t* self, double time);
+
+/**
+ * @brief Checks whether a datagram received over UDP from 'addr' proves the address of a link in its handshake, the link is activated if so
+ * @returns true if it's a proof, whether it matched or not, it isn't handed to the owner then
+*/
+bool tp_shm__receive_proof(tp_shm_t* self, const void* data, uint32_t data_len, network_addr_t addr);
+
+//! @returns The active link to 'addr', 0 if there is none
+tp_shm_link_t* tp_shm__find_link(tp_shm_t* self, network_addr_t addr);
+
+/**
+ * @brief Pushes a datagram of 'data_size' bytes, gathered from 'iovs' if set, the doorbell is rung by tp_shm__ring_doorbells
+ * @returns false if the ring is full, the datagram is dropped
+*/
+bool tp_shm_link__send(tp_shm_link_t* self, const void* data, uint32_t data_size, const struct iovec* iovs, uint32_t iovs_fill);
+
+//! @brief Wakes the peers that are asleep and were sent datagrams since the last call
+void tp_shm__ring_doorbells(tp_shm_t* self);
+
+/**
+ * @brief Receives up to 'messages_size' datagrams from the links, same as tp_socket__get_data_batch
+ * @returns Number of messages filled
+*/
+uint32_t tp_shm__receive(tp_shm_t* self, tp_message_t* messages, uint32_t messages_size, double time);
+
+/**
+ * @brief Tells the peers to ring the doorbell from now on, call it right before sleeping on 'wake_fd'
+ * @returns false if datagrams arrived meanwhile, so it must not sleep, tp_shm__finish_wait is called already then
+*/
+bool tp_shm__prepare_wait(tp_shm_t* self);
+//! @param is_woken true if 'wake_fd' was signaled, it's reset then
+void tp_shm__finish_wait(tp_shm_t* self, bool is_woken);
+
+#endif // TP_SHM_H